@@ -179,10 +179,22 @@ public:
         scanDAlbumsTimer(0),
         updatePAlbumsTimer(0),
         albumItemCountTimer(0),
-        tagItemCountTimer(0)
+        tagItemCountTimer(0),
+        dateItemCountTimer(0),
+        personCountDirty(false)
     {
     }
 
+    /**
+     * Above these numbers of changed albums/tags or changed items,
+     * the counts are recomputed from scratch instead of incrementally.
+     */
+    enum
+    {
+        MaxIncrementalCountKeys  = 500,
+        MaxIncrementalCountItems = 5000
+    };
+
     bool                        changed;
     bool                        hasPriorizedDbPath;
 
@@ -221,12 +233,21 @@ public:
     QTimer*                     updatePAlbumsTimer;
     QTimer*                     albumItemCountTimer;
     QTimer*                     tagItemCountTimer;
+    QTimer*                     dateItemCountTimer;
     QSet<int>                   changedPAlbums;
 
     QMap<int, int>              pAlbumsCount;
     QMap<int, int>              tAlbumsCount;
     QMap<YearMonth, int>        dAlbumsCount;
     QMap<int, int>              fAlbumsCount;
+    QMap<QDateTime, int>        datesCount;
+
+    /// Albums, tags and items whose counts changed since the last count job was started
+    QSet<int>                   countChangedAlbums;
+    QSet<int>                   countChangedTags;
+    QSet<qlonglong>             countChangedTagItems;
+    QSet<qlonglong>             countChangedDateItems;
+    bool                        personCountDirty;
 
 public:
 
@@ -337,7 +358,7 @@ AlbumManager::AlbumManager()
     d->albumItemCountTimer->setSingleShot(true);
 
     connect(d->albumItemCountTimer, SIGNAL(timeout()),
-            this, SLOT(getAlbumItemsCount()));
+            this, SLOT(updateAlbumItemsCount()));
 
     // more expensive
     d->tagItemCountTimer = new QTimer(this);
@@ -345,7 +366,15 @@ AlbumManager::AlbumManager()
     d->tagItemCountTimer->setSingleShot(true);
 
     connect(d->tagItemCountTimer, SIGNAL(timeout()),
-            this, SLOT(getTagItemsCount()));
+            this, SLOT(updateTagItemsCount()));
+
+    // only counts the changed items, the complete scan is done by scanDAlbumsTimer
+    d->dateItemCountTimer = new QTimer(this);
+    d->dateItemCountTimer->setInterval(1000);
+    d->dateItemCountTimer->setSingleShot(true);
+
+    connect(d->dateItemCountTimer, SIGNAL(timeout()),
+            this, SLOT(updateDAlbumsCount()));
 }
 
 AlbumManager::~AlbumManager()
@@ -1493,6 +1522,7 @@ void AlbumManager::updateChangedPAlbums()
 void AlbumManager::getAlbumItemsCount()
 {
     d->albumItemCountTimer->stop();
+    d->countChangedAlbums.clear();
 
     if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
     {
@@ -1516,6 +1546,47 @@ void AlbumManager::getAlbumItemsCount()
             this, SLOT(slotAlbumsJobData(QMap<int,int>)));
 }
 
+void AlbumManager::updateAlbumItemsCount()
+{
+    d->albumItemCountTimer->stop();
+
+    if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
+    {
+        d->countChangedAlbums.clear();
+        return;
+    }
+
+    if (d->albumListJob)
+    {
+        // The running job may not see all changes, count them afterwards.
+        d->albumItemCountTimer->start();
+        return;
+    }
+
+    if (d->pAlbumsCount.isEmpty() || d->countChangedAlbums.size() > Private::MaxIncrementalCountKeys)
+    {
+        getAlbumItemsCount();
+        return;
+    }
+
+    if (d->countChangedAlbums.isEmpty())
+    {
+        return;
+    }
+
+    AlbumsDBJobInfo jInfo;
+    jInfo.setFoldersJob();
+    jInfo.setAlbumsIds(d->countChangedAlbums.toList());
+    d->countChangedAlbums.clear();
+    d->albumListJob = DBJobsManager::instance()->startAlbumsJobThread(jInfo);
+
+    connect(d->albumListJob, SIGNAL(finished()),
+            this, SLOT(slotAlbumsJobResult()));
+
+    connect(d->albumListJob, SIGNAL(foldersData(QMap<int,int>)),
+            this, SLOT(slotAlbumsJobChangedData(QMap<int,int>)));
+}
+
 void AlbumManager::scanTAlbums()
 {
     d->scanTAlbumsTimer->stop();
@@ -1671,8 +1742,65 @@ void AlbumManager::getTagItemsCount()
     personItemsCount();
 }
 
+void AlbumManager::updateTagItemsCount()
+{
+    d->tagItemCountTimer->stop();
+
+    if (!ApplicationSettings::instance()->getShowFolderTreeViewItemsCount())
+    {
+        d->countChangedTags.clear();
+        d->countChangedTagItems.clear();
+        d->personCountDirty = false;
+        return;
+    }
+
+    if (d->personCountDirty)
+    {
+        d->personCountDirty = false;
+        personItemsCount();
+    }
+
+    if (d->tagListJob)
+    {
+        // The running job may not see all changes, count them afterwards.
+        d->tagItemCountTimer->start();
+        return;
+    }
+
+    if (d->tAlbumsCount.isEmpty()                                              ||
+        d->countChangedTags.size()     > Private::MaxIncrementalCountKeys ||
+        d->countChangedTagItems.size() > Private::MaxIncrementalCountItems)
+    {
+        tagItemsCount();
+        return;
+    }
+
+    if (d->countChangedTags.isEmpty() && d->countChangedTagItems.isEmpty())
+    {
+        return;
+    }
+
+    TagsDBJobInfo jInfo;
+    jInfo.setFoldersJob();
+    jInfo.setTagsIds(d->countChangedTags.toList());
+    jInfo.setImageIds(d->countChangedTagItems.toList());
+    d->countChangedTags.clear();
+    d->countChangedTagItems.clear();
+
+    d->tagListJob = DBJobsManager::instance()->startTagsJobThread(jInfo);
+
+    connect(d->tagListJob, SIGNAL(finished()),
+            this, SLOT(slotTagsJobResult()));
+
+    connect(d->tagListJob, SIGNAL(foldersData(QMap<int,int>)),
+            this, SLOT(slotTagsJobChangedData(QMap<int,int>)));
+}
+
 void AlbumManager::tagItemsCount()
 {
+    d->countChangedTags.clear();
+    d->countChangedTagItems.clear();
+
     if (d->tagListJob)
     {
         d->tagListJob->cancel();
@@ -1803,6 +1931,8 @@ void AlbumManager::scanDAlbumsScheduled()
 void AlbumManager::scanDAlbums()
 {
     d->scanDAlbumsTimer->stop();
+    d->dateItemCountTimer->stop();
+    d->countChangedDateItems.clear();
 
     if (d->dateListJob)
     {
@@ -1821,6 +1951,48 @@ void AlbumManager::scanDAlbums()
             this, SLOT(slotDatesJobData(QMap<QDateTime, int>)));
 }
 
+void AlbumManager::updateDAlbumsCount()
+{
+    d->dateItemCountTimer->stop();
+
+    if (d->dateListJob)
+    {
+        // The running job may not see all changes, count them afterwards.
+        d->dateItemCountTimer->start();
+        return;
+    }
+
+    if (d->datesCount.isEmpty() || d->countChangedDateItems.size() > Private::MaxIncrementalCountItems)
+    {
+        // Fall back to the complete, expensive scan.
+        d->countChangedDateItems.clear();
+
+        if (!d->scanDAlbumsTimer->isActive())
+        {
+            d->scanDAlbumsTimer->start();
+        }
+
+        return;
+    }
+
+    if (d->countChangedDateItems.isEmpty())
+    {
+        return;
+    }
+
+    DatesDBJobInfo jInfo;
+    jInfo.setFoldersJob();
+    jInfo.setImageIds(d->countChangedDateItems.toList());
+    d->countChangedDateItems.clear();
+    d->dateListJob = DBJobsManager::instance()->startDatesJobThread(jInfo);
+
+    connect(d->dateListJob, SIGNAL(finished()),
+            this, SLOT(slotDatesJobResult()));
+
+    connect(d->dateListJob, SIGNAL(foldersData(QMap<QDateTime,int>)),
+            this, SLOT(slotDatesJobChangedData(QMap<QDateTime, int>)));
+}
+
 AlbumList AlbumManager::allPAlbums() const
 {
     AlbumList list;
@@ -3086,6 +3258,21 @@ void AlbumManager::slotAlbumsJobData(const QMap<int, int> &albumsStatMap)
     emit signalPAlbumsDirty(albumsStatMap);
 }
 
+void AlbumManager::slotAlbumsJobChangedData(const QMap<int, int>& albumsStatMap)
+{
+    if (albumsStatMap.isEmpty())
+    {
+        return;
+    }
+
+    for (QMap<int, int>::const_iterator it = albumsStatMap.constBegin() ; it != albumsStatMap.constEnd() ; ++it)
+    {
+        d->pAlbumsCount[it.key()] = it.value();
+    }
+
+    emit signalPAlbumsDirty(d->pAlbumsCount);
+}
+
 void AlbumManager::slotPeopleJobResult()
 {
     if (!d->personListJob)
@@ -3159,6 +3346,21 @@ void AlbumManager::slotTagsJobData(const QMap<int,int>& tagsStatMap)
     emit signalTAlbumsDirty(tagsStatMap);
 }
 
+void AlbumManager::slotTagsJobChangedData(const QMap<int,int>& tagsStatMap)
+{
+    if (tagsStatMap.isEmpty())
+    {
+        return;
+    }
+
+    for (QMap<int, int>::const_iterator it = tagsStatMap.constBegin() ; it != tagsStatMap.constEnd() ; ++it)
+    {
+        d->tAlbumsCount[it.key()] = it.value();
+    }
+
+    emit signalTAlbumsDirty(d->tAlbumsCount);
+}
+
 void AlbumManager::slotDatesJobResult()
 {
     if (!d->dateListJob)
@@ -3179,6 +3381,30 @@ void AlbumManager::slotDatesJobResult()
     emit signalAllDAlbumsLoaded();
 }
 
+void AlbumManager::slotDatesJobChangedData(const QMap<QDateTime, int>& datesStatMap)
+{
+    if (datesStatMap.isEmpty() || !d->rootDAlbum)
+    {
+        return;
+    }
+
+    QMap<QDateTime, int> datesCount = d->datesCount;
+
+    for (QMap<QDateTime, int>::const_iterator it = datesStatMap.constBegin() ; it != datesStatMap.constEnd() ; ++it)
+    {
+        if (it.value() > 0)
+        {
+            datesCount[it.key()] = it.value();
+        }
+        else
+        {
+            datesCount.remove(it.key());
+        }
+    }
+
+    slotDatesJobData(datesCount);
+}
+
 void AlbumManager::slotDatesJobData(const QMap<QDateTime, int>& datesStatMap)
 {
     if (datesStatMap.isEmpty() || !d->rootDAlbum)
@@ -3186,6 +3412,8 @@ void AlbumManager::slotDatesJobData(const QMap<QDateTime, int>& datesStatMap)
         return;
     }
 
+    d->datesCount = datesStatMap;
+
     // insert all the DAlbums into a qmap for quick access
     QMap<QDate, DAlbum*> mAlbumMap;
     QMap<int, DAlbum*>   yAlbumMap;
@@ -3445,18 +3673,35 @@ void AlbumManager::slotCollectionImageChange(const CollectionImageChangeset& cha
         case CollectionImageChangeset::Added:
         case CollectionImageChangeset::Removed:
         case CollectionImageChangeset::RemovedAll:
+        {
+            // Only the counts of the affected albums, dates and tags are recomputed.
+            const QList<qlonglong> ids = changeset.ids();
 
-            if (!d->scanDAlbumsTimer->isActive())
-            {
-                d->scanDAlbumsTimer->start();
-            }
+            d->countChangedAlbums    += changeset.albums().toSet();
+            d->countChangedDateItems += ids.toSet();
 
             if (!d->albumItemCountTimer->isActive())
             {
                 d->albumItemCountTimer->start();
             }
 
+            if (!d->dateItemCountTimer->isActive())
+            {
+                d->dateItemCountTimer->start();
+            }
+
+            if (!ids.isEmpty())
+            {
+                d->countChangedTagItems += ids.toSet();
+
+                if (!d->tagItemCountTimer->isActive())
+                {
+                    d->tagItemCountTimer->start();
+                }
+            }
+
             break;
+        }
 
         default:
             break;
@@ -3475,6 +3720,17 @@ void AlbumManager::slotImageTagChange(const ImageTagChangeset& changeset)
         case ImageTagChangeset::Added:
         case ImageTagChangeset::Removed:
         case ImageTagChangeset::RemovedAll:
+
+            d->countChangedTags += changeset.tags().toSet();
+            d->personCountDirty  = true;
+
+            if (!d->tagItemCountTimer->isActive())
+            {
+                d->tagItemCountTimer->start();
+            }
+
+            break;
+
         // Add properties changed.
         // Reason: in people sidebar, the images are not
         // connected with the ImageTag table but by
@@ -3483,6 +3739,8 @@ void AlbumManager::slotImageTagChange(const ImageTagChangeset& changeset)
         // updated. This adoption should fix the problem.
         case ImageTagChangeset::PropertiesChanged:
 
+            d->personCountDirty = true;
+
             if (!d->tagItemCountTimer->isActive())
             {
                 d->tagItemCountTimer->start();
@@ -673,10 +673,13 @@ private Q_SLOTS:
 
     void slotDatesJobResult();
     void slotDatesJobData(const QMap<QDateTime, int>& datesStatMap);
+    void slotDatesJobChangedData(const QMap<QDateTime, int>& datesStatMap);
     void slotAlbumsJobResult();
     void slotAlbumsJobData(const QMap<int,int>& albumsStatMap);
+    void slotAlbumsJobChangedData(const QMap<int,int>& albumsStatMap);
     void slotTagsJobResult();
     void slotTagsJobData(const QMap<int,int>& tagsStatMap);
+    void slotTagsJobChangedData(const QMap<int,int>& tagsStatMap);
     void slotPeopleJobResult();
     void slotPeopleJobData(const QMap<QString,QMap<int,int> >& facesStatMap);
 
@@ -716,11 +719,24 @@ private Q_SLOTS:
     void scanDAlbumsScheduled();
     void scanDAlbums();
 
+    /**
+     * Update the counts of the dates of items added or removed since the last scan.
+     */
+    void updateDAlbumsCount();
+
     void getAlbumItemsCount();
     void getTagItemsCount();
     void tagItemsCount();
     void personItemsCount();
 
+    /**
+     * Update the counts of the albums and tags which changed since the last count,
+     * falling back to getAlbumItemsCount() and tagItemsCount() if there are no counts yet
+     * or too many changes.
+     */
+    void updateAlbumItemsCount();
+    void updateTagItemsCount();
+
 private:
 
     friend class AlbumManagerCreator;
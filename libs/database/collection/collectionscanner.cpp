@@ -34,14 +34,20 @@
 
 // Qt includes
 
+#include <QAtomicInt>
 #include <QDir>
 #include <QFileInfo>
+#include <QFuture>
 #include <QReadWriteLock>
 #include <QReadLocker>
+#include <QScopedPointer>
 #include <QStringList>
 #include <QSet>
+#include <QThread>
+#include <QThreadPool>
 #include <QTime>
 #include <QWriteLocker>
+#include <QtConcurrent>
 
 // Local includes
 
@@ -52,6 +58,7 @@
 #include "collectionlocation.h"
 #include "collectionscannerhints.h"
 #include "collectionscannerobserver.h"
+#include "imagehashcache.h"
 #include "coredbaccess.h"
 #include "coredbbackend.h"
 #include "coredbtransaction.h"
@@ -105,6 +112,32 @@ inline uint qHash(const NewlyAppearedFile& file)
 
 // --------------------------------------------------------------------
 
+/** A new file found by the directory walk of a pipelined scan.
+ *  The file is loaded from disk in a thread of the pipeline pool,
+ *  then identified and committed to the database in the scanning thread.
+ */
+class PipelinedNewFile
+{
+
+public:
+
+    PipelinedNewFile(const QFileInfo& info, int albumId)
+        : info(info),
+          albumId(albumId),
+          scanner(info)
+    {
+    }
+
+public:
+
+    QFileInfo     info;
+    int           albumId;
+    ImageScanner  scanner;
+    QFuture<void> loading;
+};
+
+// --------------------------------------------------------------------
+
 static bool modificationDateEquals(const QDateTime& a, const QDateTime& b)
 {
     if (a != b)
@@ -279,8 +312,30 @@ public:
         updatingHashHint(false),
         recordHistoryIds(false),
         deferredFileScanning(false),
-        observer(0)
+        observer(0),
+        pipelinedScanning(false),
+        albumScanDepth(0),
+        uniqueHashVersion(0)
+    {
+        // File loading is mostly waiting for I/O, on network storage in particular.
+        pipelinePool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+    }
+
+    ~Private()
+    {
+        pipelinePool.waitForDone();
+    }
+
+    enum
+    {
+        /// Number of new files committed in one database transaction
+        PipelineCommitBatch = 32
+    };
+
+    /// Maximum number of new files loaded in advance of the database commits
+    int maxPipelinedFiles() const
     {
+        return 4 * PipelineCommitBatch + 4 * pipelinePool.maxThreadCount();
     }
 
 public:
@@ -316,7 +371,8 @@ public:
         return false;
     }
 
-    void finishScanner(ImageScanner& scanner);
+    void useHashCache(ImageScanner& scanner, bool preloaded = false);
+    void finishScanner(ImageScanner& scanner, ImageScannerBulkCommit* const bulk = 0);
 
 public:
 
@@ -342,14 +398,41 @@ public:
     QSet<QString>                                 deferredAlbumPaths;
 
     CollectionScannerObserver*                    observer;
+
+    bool                                          pipelinedScanning;
+    int                                           albumScanDepth;
+    int                                           uniqueHashVersion;
+    QList<PipelinedNewFile*>                      pipeline;
+    QAtomicInt                                    pipelineCancelled;
+    QThreadPool                                   pipelinePool;
+
+    ImageHashCache                                hashCache;
 };
 
-void CollectionScanner::Private::finishScanner(ImageScanner& scanner)
+void CollectionScanner::Private::useHashCache(ImageScanner& scanner, bool preloaded)
+{
+    // Loading the whole cache pays off for the many new files of a pipelined scan.
+    // Otherwise each file is looked up in the database.
+    if (preloaded && !hashCache.isPreloaded())
+    {
+        hashCache.preload();
+    }
+
+    scanner.setHashCache(&hashCache);
+}
+
+void CollectionScanner::Private::finishScanner(ImageScanner& scanner, ImageScannerBulkCommit* const bulk)
 {
     // Perform the actual write operation to the database
     {
         CoreDbOperationGroup group;
-        scanner.commit();
+        scanner.commit(bulk);
+
+        // With a bulk commit, the cache is written with the whole batch.
+        if (!bulk)
+        {
+            hashCache.commit();
+        }
     }
 
     if (recordHistoryIds && scanner.hasHistoryToResolve())
@@ -419,6 +502,11 @@ void CollectionScanner::setObserver(CollectionScannerObserver* const observer)
     d->observer = observer;
 }
 
+void CollectionScanner::setPipelinedScanning(bool on)
+{
+    d->pipelinedScanning = on;
+}
+
 void CollectionScanner::setDeferredFileScanning(bool defer)
 {
     d->deferredFileScanning = defer;
@@ -588,6 +676,9 @@ void CollectionScanner::completeScanCleanupPart()
 {
     completeHistoryScanning();
 
+    // Only after a complete scan, the cache entries of all moved files are up to date
+    d->hashCache.prune();
+
     updateRemovedItemsTime();
 
     // Items may be set to status removed, without being definitely deleted.
@@ -1014,6 +1105,28 @@ int CollectionScanner::checkAlbum(const CollectionLocation& location, const QStr
 }
 
 void CollectionScanner::scanAlbum(const CollectionLocation& location, const QString& album)
+{
+    // New files found in a pipelined scan are committed, at the latest,
+    // when the outermost album scan has finished.
+
+    ++d->albumScanDepth;
+
+    scanAlbumEntries(location, album);
+
+    if (--d->albumScanDepth == 0)
+    {
+        if (d->checkObserver())
+        {
+            commitPipeline(-1);
+        }
+        else
+        {
+            cancelPipeline();
+        }
+    }
+}
+
+void CollectionScanner::scanAlbumEntries(const CollectionLocation& location, const QString& album)
 {
     // + Adds album if it does not yet exist in the db.
     // + Recursively scans subalbums of album.
@@ -1103,7 +1216,14 @@ void CollectionScanner::scanAlbum(const CollectionLocation& location, const QStr
             {
                 //qCDebug(DIGIKAM_DATABASE_LOG) << "Adding item " << fi->fileName();
 
-                scanNewFile(*fi, albumID);
+                if (d->pipelinedScanning)
+                {
+                    scheduleNewFile(*fi, albumID);
+                }
+                else
+                {
+                    scanNewFile(*fi, albumID);
+                }
 
                 // emit signals for scanned files with much higher granularity
                 if (d->wantSignals && counter && (counter % 2 == 0))
@@ -1248,7 +1368,15 @@ qlonglong CollectionScanner::scanNewFile(const QFileInfo& info, int albumId)
 
     ImageScanner scanner(info);
     scanner.setCategory(category(info));
+    d->useHashCache(scanner);
+    identifyNewFile(scanner, info, albumId);
+    d->finishScanner(scanner);
+
+    return scanner.id();
+}
 
+void CollectionScanner::identifyNewFile(ImageScanner& scanner, const QFileInfo& info, int albumId)
+{
     // Check copy/move hints for single items
     qlonglong srcId = 0;
 
@@ -1283,10 +1411,107 @@ qlonglong CollectionScanner::scanNewFile(const QFileInfo& info, int albumId)
             scanner.newFile(albumId);
         }
     }
+}
 
-    d->finishScanner(scanner);
+void CollectionScanner::scheduleNewFile(const QFileInfo& info, int albumId)
+{
+    if (d->checkDeferred(info))
+    {
+        return;
+    }
 
-    return scanner.id();
+    if (!d->uniqueHashVersion)
+    {
+        d->uniqueHashVersion = CoreDbAccess().db()->getUniqueHashVersion();
+    }
+
+    PipelinedNewFile* const file = new PipelinedNewFile(info, albumId);
+    file->scanner.setCategory(category(info));
+    // The loading threads must not wait for the database, which may be locked by this thread.
+    file->scanner.setUniqueHashVersion(d->uniqueHashVersion);
+    d->useHashCache(file->scanner, true);
+
+    // Reading the file, parsing its metadata and computing the unique hash is done in the pool.
+    // The identification with existing items needs the database and is done at commit time.
+
+    ImageScanner* const scanner  = &file->scanner;
+    QAtomicInt* const cancelled  = &d->pipelineCancelled;
+
+    file->loading = QtConcurrent::run(&d->pipelinePool, [scanner, cancelled]()
+        {
+            if (!cancelled->load())
+            {
+                scanner->loadFromDisk();
+            }
+        }
+    );
+
+    d->pipeline << file;
+
+    if (d->pipeline.size() >= d->maxPipelinedFiles())
+    {
+        commitPipeline(Private::PipelineCommitBatch);
+    }
+}
+
+void CollectionScanner::commitPipeline(int count)
+{
+    // count < 0 commits all pending files, in batches.
+
+    while (!d->pipeline.isEmpty() && count != 0)
+    {
+        int size = qMin(d->pipeline.size(), (int)Private::PipelineCommitBatch);
+
+        if (count > 0)
+        {
+            size   = qMin(size, count);
+            count -= size;
+        }
+
+        QList<PipelinedNewFile*> batch = d->pipeline.mid(0, size);
+        d->pipeline.erase(d->pipeline.begin(), d->pipeline.begin() + size);
+
+        // Wait for the files to be loaded before starting the transaction.
+        foreach (PipelinedNewFile* const file, batch)
+        {
+            file->loading.waitForFinished();
+        }
+
+        {
+            // The rows of the whole batch are written with multi-row statements in one transaction.
+            CoreDbOperationGroup   group;
+            ImageScannerBulkCommit bulk;
+
+            foreach (PipelinedNewFile* const file, batch)
+            {
+                identifyNewFile(file->scanner, file->info, file->albumId);
+                d->finishScanner(file->scanner, &bulk);
+            }
+
+            bulk.write();
+            d->hashCache.commit();
+        }
+
+        qDeleteAll(batch);
+    }
+}
+
+void CollectionScanner::cancelPipeline()
+{
+    // Files which are not yet loaded are skipped, the others are discarded.
+    // They will be found again as new files by the next scan.
+
+    d->pipelineCancelled.store(1);
+
+    foreach (PipelinedNewFile* const file, d->pipeline)
+    {
+        file->loading.waitForFinished();
+    }
+
+    qDeleteAll(d->pipeline);
+    d->pipeline.clear();
+
+    d->pipelineCancelled.store(0);
 }
 
 qlonglong CollectionScanner::scanNewFileFullScan(const QFileInfo& info, int albumId)
@@ -1298,6 +1523,7 @@ qlonglong CollectionScanner::scanNewFileFullScan(const QFileInfo& info, int albu
 
     ImageScanner scanner(info);
     scanner.setCategory(category(info));
+    d->useHashCache(scanner);
     scanner.newFileFullScan(albumId);
     d->finishScanner(scanner);
 
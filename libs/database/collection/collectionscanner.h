@@ -48,6 +48,7 @@ class AlbumCopyMoveHint;
 class CollectionLocation;
 class CollectionScannerObserver;
 class ImageInfo;
+class ImageScanner;
 class ItemCopyMoveHint;
 class ItemChangeHint;
 class ItemMetadataAdjustmentHint;
@@ -119,6 +120,15 @@ public:
     void setDeferredFileScanning(bool defer);
     QStringList deferredAlbumPaths() const;
 
+    /**
+     * If you enable pipelined scanning, new files found while walking the albums
+     * are read from disk, metadata parsed and hash computed, by a pool of threads,
+     * and committed to the database in batches by the scanning thread.
+     * This is meant for scans of large collections, as the initial scan.
+     * Default is off.
+     */
+    void setPipelinedScanning(bool on);
+
     /**
      * Carries out a partial scan on the specified path of the collection.
      * The includes scanning for new files + albums and updating modified file data.
@@ -246,6 +256,7 @@ protected:
     void scanForStaleAlbums(const QList<int>& locationIdsToScan);
     void scanAlbumRoot(const CollectionLocation& location);
     void scanAlbum(const CollectionLocation& location, const QString& album);
+    void scanAlbumEntries(const CollectionLocation& location, const QString& album);
     int  checkAlbum(const CollectionLocation& location, const QString& album);
     void scanExistingFile(const QFileInfo& fi, qlonglong id);
     void scanFileNormal(const QFileInfo& info, const ItemScanInfo& scanInfo);
@@ -273,6 +284,11 @@ protected:
     qlonglong scanFile(const QFileInfo& fi, int albumId, qlonglong id, FileScanMode mode);
     qlonglong scanNewFile(const QFileInfo& info, int albumId);
     qlonglong scanNewFileFullScan(const QFileInfo& info, int albumId);
+    void      identifyNewFile(ImageScanner& scanner, const QFileInfo& info, int albumId);
+
+    void      scheduleNewFile(const QFileInfo& info, int albumId);
+    void      commitPipeline(int count);
+    void      cancelPipeline();
 
 private:
 
@@ -45,6 +45,7 @@ extern "C"
 #include <QFileInfo>
 #include <QDir>
 #include <QVariant>
+#include <QSet>
 
 // KDE includes
 
@@ -1329,21 +1330,36 @@ QVector<QList<int> > CoreDB::getItemsTagIDs(const QList<qlonglong> imageIds)
         return QVector<QList<int> >();
     }
 
-    QVector<QList<int> > results(imageIds.size());
-    DbEngineSqlQuery query = d->db->prepareQuery(QString::fromUtf8("SELECT tagid FROM ImageTags WHERE imageID=?;"));
-    QVariantList values;
+    QHash<qlonglong, QList<int> > tagIdsById;
 
-    for (int i = 0; i < imageIds.size(); i++)
+    for (int start = 0 ; start < imageIds.size() ; start += 500)
     {
-        d->db->execSql(query, imageIds[i], &values);
-        QList<int>& tagIds = results[i];
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT imageid, tagid FROM ImageTags WHERE imageid IN (");
+
+        foreach(const qlonglong& imageID, imageIds.mid(start, 500))
+        {
+            boundValues << imageID;
+        }
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(");");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
 
-        foreach(const QVariant& v, values)
+        while (cursor.next())
         {
-            tagIds << v.toInt();
+            tagIdsById[cursor.toLongLong(0)] << cursor.toInt(1);
         }
     }
 
+    QVector<QList<int> > results(imageIds.size());
+
+    for (int i = 0; i < imageIds.size(); i++)
+    {
+        results[i] = tagIdsById.value(imageIds.at(i));
+    }
+
     return results;
 }
 
@@ -1636,6 +1652,121 @@ QVariantList CoreDB::getImageInformation(qlonglong imageID, DatabaseFields::Imag
     return values;
 }
 
+QHash<qlonglong, QVariantList> CoreDB::getImagesFields(const QList<qlonglong>& imageIDs, DatabaseFields::Images fields)
+{
+    QHash<qlonglong, QVariantList> results;
+
+    if (fields == DatabaseFields::ImagesNone)
+    {
+        return results;
+    }
+
+    QStringList fieldNames = imagesFieldList(fields);
+    int dateIndex          = (fields & DatabaseFields::ModificationDate) ? fieldNames.indexOf(QLatin1String("modificationDate")) : -1;
+
+    for (int start = 0 ; start < imageIDs.size() ; start += 500)
+    {
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT id, ");
+        sql                += fieldNames.join(QString::fromUtf8(", "));
+        sql                += QString::fromUtf8(" FROM Images WHERE id IN (");
+
+        foreach(const qlonglong& imageID, imageIDs.mid(start, 500))
+        {
+            boundValues << imageID;
+        }
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(");");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
+        {
+            QVariantList values;
+
+            for (int i = 0 ; i < fieldNames.size() ; ++i)
+            {
+                values << cursor.value(i + 1);
+            }
+
+            // Convert date times to QDateTime, they come as QString
+            if (dateIndex != -1)
+            {
+                values[dateIndex] = (values.at(dateIndex).isNull() ? QDateTime()
+                                     : QDateTime::fromString(values.at(dateIndex).toString(), Qt::ISODate));
+            }
+
+            results.insert(cursor.toLongLong(0), values);
+        }
+    }
+
+    return results;
+}
+
+QHash<qlonglong, QVariantList> CoreDB::getImageInformation(const QList<qlonglong>& imageIDs,
+                                                           DatabaseFields::ImageInformation fields)
+{
+    QHash<qlonglong, QVariantList> results;
+
+    if (fields == DatabaseFields::ImageInformationNone)
+    {
+        return results;
+    }
+
+    QStringList fieldNames = imageInformationFieldList(fields);
+    QList<int>  dateIndexes;
+
+    if (fields & DatabaseFields::CreationDate)
+    {
+        dateIndexes << fieldNames.indexOf(QLatin1String("creationDate"));
+    }
+
+    if (fields & DatabaseFields::DigitizationDate)
+    {
+        dateIndexes << fieldNames.indexOf(QLatin1String("digitizationDate"));
+    }
+
+    for (int start = 0 ; start < imageIDs.size() ; start += 500)
+    {
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT imageid, ");
+        sql                += fieldNames.join(QString::fromUtf8(", "));
+        sql                += QString::fromUtf8(" FROM ImageInformation WHERE imageid IN (");
+
+        foreach(const qlonglong& imageID, imageIDs.mid(start, 500))
+        {
+            boundValues << imageID;
+        }
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(");");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
+        {
+            QVariantList values;
+
+            for (int i = 0 ; i < fieldNames.size() ; ++i)
+            {
+                values << cursor.value(i + 1);
+            }
+
+            // Convert date times to QDateTime, they come as QString
+            foreach(int index, dateIndexes)
+            {
+                values[index] = (values.at(index).isNull() ? QDateTime()
+                                 : QDateTime::fromString(values.at(index).toString(), Qt::ISODate));
+            }
+
+            results.insert(cursor.toLongLong(0), values);
+        }
+    }
+
+    return results;
+}
+
 QVariantList CoreDB::getImageMetadata(qlonglong imageID, DatabaseFields::ImageMetadata fields)
 {
     QVariantList values;
@@ -1840,6 +1971,37 @@ void CoreDB::addImageInformation(qlonglong imageID, const QVariantList& infos, D
     d->db->recordChangeset(ImageChangeset(imageID, fields));
 }
 
+void CoreDB::addImageInformation(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                                  DatabaseFields::ImageInformation fields)
+{
+    if (fields == DatabaseFields::ImageInformationNone || imageIDs.isEmpty())
+    {
+        return;
+    }
+
+    Q_ASSERT(imageIDs.size() == infos.size());
+
+    QList<QVariantList> values = infos;
+
+    // Take care for datetime values
+    if ((fields & DatabaseFields::CreationDate) || (fields & DatabaseFields::DigitizationDate))
+    {
+        for (QList<QVariantList>::iterator it = values.begin() ; it != values.end() ; ++it)
+        {
+            for (QVariantList::iterator value = it->begin() ; value != it->end() ; ++value)
+            {
+                if (value->type() == QVariant::DateTime || value->type() == QVariant::Date)
+                {
+                    *value = value->toDateTime().toString(Qt::ISODate);
+                }
+            }
+        }
+    }
+
+    replaceRows(QLatin1String("ImageInformation"), imageInformationFieldList(fields), imageIDs, values);
+    d->db->recordChangeset(ImageChangeset(imageIDs, fields));
+}
+
 void CoreDB::changeImageInformation(qlonglong imageId, const QVariantList& infos,
                                      DatabaseFields::ImageInformation fields)
 {
@@ -1893,6 +2055,20 @@ void CoreDB::addImageMetadata(qlonglong imageID, const QVariantList& infos, Data
     d->db->recordChangeset(ImageChangeset(imageID, fields));
 }
 
+void CoreDB::addImageMetadata(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                               DatabaseFields::ImageMetadata fields)
+{
+    if (fields == DatabaseFields::ImageMetadataNone || imageIDs.isEmpty())
+    {
+        return;
+    }
+
+    Q_ASSERT(imageIDs.size() == infos.size());
+
+    replaceRows(QLatin1String("ImageMetadata"), imageMetadataFieldList(fields), imageIDs, infos);
+    d->db->recordChangeset(ImageChangeset(imageIDs, fields));
+}
+
 void CoreDB::changeImageMetadata(qlonglong imageId, const QVariantList& infos,
                                   DatabaseFields::ImageMetadata fields)
 {
@@ -3157,6 +3333,46 @@ QStringList CoreDB::imageCommentsFieldList(DatabaseFields::ImageComments fields)
     return list;
 }
 
+void CoreDB::replaceRows(const QString& table, const QStringList& fieldNames,
+                         const QList<qlonglong>& imageIDs, const QList<QVariantList>& values)
+{
+    // SQLite accepts at most 999 bound values per statement with its default compile options.
+    const int valuesPerRow = fieldNames.size() + 1;
+    const int rowsPerQuery = qMax(1, 999 / valuesPerRow);
+
+    QString row(QLatin1String("("));
+    addBoundValuePlaceholders(row, valuesPerRow);
+    row += QLatin1Char(')');
+
+    for (int start = 0 ; start < imageIDs.size() ; start += rowsPerQuery)
+    {
+        const int rows = qMin(rowsPerQuery, imageIDs.size() - start);
+
+        QString query = QString::fromUtf8("REPLACE INTO %1 ( imageid, %2 ) VALUES ")
+                        .arg(table, fieldNames.join(QLatin1String(", ")));
+
+        QVariantList boundValues;
+        boundValues.reserve(rows * valuesPerRow);
+
+        for (int i = start ; i < start + rows ; ++i)
+        {
+            Q_ASSERT(fieldNames.size() == values.at(i).size());
+
+            if (i != start)
+            {
+                query += QLatin1Char(',');
+            }
+
+            query       += row;
+            boundValues << imageIDs.at(i) << values.at(i);
+        }
+
+        query += QLatin1Char(';');
+
+        d->db->execSql(query, boundValues);
+    }
+}
+
 void CoreDB::addBoundValuePlaceholders(QString& query, int count)
 {
     // adds no spaces at beginning or end
@@ -3445,137 +3661,259 @@ QList<QDateTime> CoreDB::getAllCreationDates()
 
 QMap<QDateTime, int> CoreDB::getAllCreationDatesAndNumberOfImages()
 {
-    QList<QVariant> values;
-    d->db->execSql(QString::fromUtf8("SELECT creationDate FROM ImageInformation "
-                   " INNER JOIN Images ON Images.id=ImageInformation.imageid "
-                   " WHERE Images.status=1;"), &values);
-
     QMap<QDateTime, int> datesStatMap;
+    DbEngineSqlCursor    cursor = d->db->execCursor(QString::fromUtf8(
+                                      "SELECT creationDate, COUNT(*) FROM ImageInformation "
+                                      " INNER JOIN Images ON Images.id=ImageInformation.imageid "
+                                      " WHERE Images.status=1 "
+                                      " GROUP BY creationDate;"));
 
-    foreach(const QVariant& value, values)
+    while (cursor.next())
     {
-        if (!value.isNull())
-        {
-            QDateTime dateTime = QDateTime::fromString(value.toString(), Qt::ISODate);
-
-            if (!dateTime.isValid())
-            {
-                continue;
-            }
+        const QDateTime dateTime = cursor.toDateTime(0);
 
-            QMap<QDateTime, int>::iterator it2 = datesStatMap.find(dateTime);
-
-            if (it2 == datesStatMap.end())
-            {
-                datesStatMap.insert(dateTime, 1);
-            }
-            else
-            {
-                it2.value()++;
-            }
+        if (!dateTime.isValid())
+        {
+            continue;
         }
+
+        // different strings may give the same date
+        datesStatMap[dateTime] += cursor.toInt(1);
     }
+
     return datesStatMap;
 }
 
 QMap<int, int> CoreDB::getNumberOfImagesInAlbums()
 {
-    QList<QVariant> values, allAbumIDs;
-    QMap<int, int>  albumsStatMap;
-    int             albumID;
+    QMap<int, int> albumsStatMap;
 
-    // initialize allAbumIDs with all existing albums from db to prevent
-    // wrong album image counters
-    d->db->execSql(QString::fromUtf8("SELECT id from Albums"), &allAbumIDs);
+    {
+        // initialize with all existing albums from db to prevent
+        // wrong album image counters
+        DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT id from Albums"));
 
-    for (QList<QVariant>::const_iterator it = allAbumIDs.constBegin(); it != allAbumIDs.constEnd(); ++it)
+        while (cursor.next())
+        {
+            albumsStatMap.insert(cursor.toInt(0), 0);
+        }
+    }
+
+    DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT album, COUNT(*) FROM Images "
+                                                                   " WHERE Images.status=1 GROUP BY album;"));
+
+    while (cursor.next())
     {
-        albumID = (*it).toInt();
-        albumsStatMap.insert(albumID, 0);
+        albumsStatMap[cursor.toInt(0)] = cursor.toInt(1);
     }
 
-    d->db->execSql(QString::fromUtf8("SELECT album FROM Images WHERE Images.status=1;"), &values);
+    return albumsStatMap;
+}
+
+QMap<int, int> CoreDB::getNumberOfImagesInTags()
+{
+    QMap<int, int> tagsStatMap;
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
     {
-        albumID = (*it).toInt();
-        ++it;
+        // initialize with all existing tags from db to prevent
+        // wrong tag counters
+        DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT id from Tags"));
+
+        while (cursor.next())
+        {
+            tagsStatMap.insert(cursor.toInt(0), 0);
+        }
+    }
+
+    DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT tagid, COUNT(*) FROM ImageTags "
+                                                                   " INNER JOIN Images ON Images.id=ImageTags.imageid "
+                                                                   " WHERE Images.status=1 GROUP BY tagid;"));
+
+    while (cursor.next())
+    {
+        tagsStatMap[cursor.toInt(0)] = cursor.toInt(1);
+    }
+
+    return tagsStatMap;
+}
+
+QMap<int, int> CoreDB::getNumberOfImagesInAlbums(const QList<int>& albumIds)
+{
+    QMap<int, int> albumsStatMap;
 
-        QMap<int, int>::iterator it2 = albumsStatMap.find(albumID);
+    for (int start = 0 ; start < albumIds.size() ; start += 500)
+    {
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT album, COUNT(*) FROM Images "
+                                                " WHERE Images.status=1 AND Images.album IN (");
 
-        if (it2 == albumsStatMap.end())
+        foreach(const int albumID, albumIds.mid(start, 500))
         {
-            albumsStatMap.insert(albumID, 1);
+            // prevent wrong counters of albums which are empty now
+            albumsStatMap.insert(albumID, 0);
+            boundValues << albumID;
         }
-        else
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(") GROUP BY album;");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
         {
-            it2.value()++;
+            albumsStatMap[cursor.toInt(0)] = cursor.toInt(1);
         }
     }
 
     return albumsStatMap;
 }
 
-QMap<int, int> CoreDB::getNumberOfImagesInTags()
+QMap<int, int> CoreDB::getNumberOfImagesInTags(const QList<int>& tagIds)
 {
-    QList<QVariant> values, allTagIDs;
-    QMap<int, int>  tagsStatMap;
-    int             tagID;
+    QMap<int, int> tagsStatMap;
+
+    for (int start = 0 ; start < tagIds.size() ; start += 500)
+    {
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT tagid, COUNT(*) FROM ImageTags "
+                                                " INNER JOIN Images ON Images.id=ImageTags.imageid "
+                                                " WHERE Images.status=1 AND ImageTags.tagid IN (");
+
+        foreach(const int tagID, tagIds.mid(start, 500))
+        {
+            // prevent wrong counters of tags which are empty now
+            tagsStatMap.insert(tagID, 0);
+            boundValues << tagID;
+        }
 
-    // initialize allTagIDs with all existing tags from db to prevent
-    // wrong tag counters
-    d->db->execSql(QString::fromUtf8("SELECT id from Tags"), &allTagIDs);
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(") GROUP BY tagid;");
 
-    for (QList<QVariant>::const_iterator it = allTagIDs.constBegin(); it != allTagIDs.constEnd(); ++it)
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
+        {
+            tagsStatMap[cursor.toInt(0)] = cursor.toInt(1);
+        }
+    }
+
+    return tagsStatMap;
+}
+
+QList<int> CoreDB::getTagIdsOfItems(const QList<qlonglong>& imageIds)
+{
+    QSet<int> tagIds;
+
+    for (int start = 0 ; start < imageIds.size() ; start += 500)
     {
-        tagID = (*it).toInt();
-        tagsStatMap.insert(tagID, 0);
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT DISTINCT tagid FROM ImageTags WHERE imageid IN (");
+
+        foreach(const qlonglong& imageID, imageIds.mid(start, 500))
+        {
+            boundValues << imageID;
+        }
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(");");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
+        {
+            tagIds << cursor.toInt(0);
+        }
     }
 
-    d->db->execSql(QString::fromUtf8("SELECT tagid FROM ImageTags "
-                   " LEFT JOIN Images ON Images.id=ImageTags.imageid "
-                   " WHERE Images.status=1;"), &values);
+    return tagIds.toList();
+}
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
+QMap<QDateTime, int> CoreDB::getCreationDatesAndNumberOfImages(const QList<qlonglong>& imageIds)
+{
+    // First find the dates of the items, then count all available items at these dates.
+
+    QSet<QString> dates;
+
+    for (int start = 0 ; start < imageIds.size() ; start += 500)
     {
-        tagID = (*it).toInt();
-        ++it;
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT DISTINCT creationDate FROM ImageInformation WHERE imageid IN (");
+
+        foreach(const qlonglong& imageID, imageIds.mid(start, 500))
+        {
+            boundValues << imageID;
+        }
 
-        QMap<int, int>::iterator it2 = tagsStatMap.find(tagID);
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(");");
 
-        if (it2 == tagsStatMap.end())
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
         {
-            tagsStatMap.insert(tagID, 1);
+            if (!cursor.isNull(0))
+            {
+                dates << cursor.toString(0);
+            }
         }
-        else
+    }
+
+    QMap<QDateTime, int> datesStatMap;
+    const QStringList    dateList = dates.toList();
+
+    for (int start = 0 ; start < dateList.size() ; start += 500)
+    {
+        QList<QVariant> boundValues;
+        QString         sql = QString::fromUtf8("SELECT creationDate, COUNT(*) FROM ImageInformation "
+                                                " INNER JOIN Images ON Images.id=ImageInformation.imageid "
+                                                " WHERE Images.status=1 AND ImageInformation.creationDate IN (");
+
+        foreach(const QString& date, dateList.mid(start, 500))
+        {
+            const QDateTime dateTime = QDateTime::fromString(date, Qt::ISODate);
+
+            // Distinct date strings can give the same date-time, which may be already counted
+            // in a previous chunk: do not reset its count.
+            if (dateTime.isValid() && !datesStatMap.contains(dateTime))
+            {
+                datesStatMap.insert(dateTime, 0);
+            }
+
+            boundValues << date;
+        }
+
+        addBoundValuePlaceholders(sql, boundValues.size());
+        sql += QString::fromUtf8(") GROUP BY creationDate;");
+
+        DbEngineSqlCursor cursor = d->db->execCursor(sql, boundValues);
+
+        while (cursor.next())
         {
-            it2.value()++;
+            const QDateTime dateTime = cursor.toDateTime(0);
+
+            if (dateTime.isValid())
+            {
+                datesStatMap[dateTime] += cursor.toInt(1);
+            }
         }
     }
 
-    return tagsStatMap;
+    return datesStatMap;
 }
 
 QMap<int, int> CoreDB::getNumberOfImagesInTagProperties(const QString& property)
 {
-    QList<QVariant> values;
-    QMap<int, int>  tagsStatMap;
-    int             tagID, count;
+    QMap<int, int>    tagsStatMap;
+    DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8(
+                                   "SELECT tagid, COUNT(*) FROM ImageTagProperties "
+                                   " LEFT JOIN Images ON Images.id=ImageTagProperties.imageid "
+                                   " WHERE ImageTagProperties.property=? AND Images.status=1 "
+                                   " GROUP BY tagid;"),
+                                   QList<QVariant>() << property);
 
-    d->db->execSql(QString::fromUtf8("SELECT tagid, COUNT(*) FROM ImageTagProperties "
-                   " LEFT JOIN Images ON Images.id=ImageTagProperties.imageid "
-                   " WHERE ImageTagProperties.property=? AND Images.status=1 "
-                   " GROUP BY tagid;"),
-                   property, &values);
-
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
+    while (cursor.next())
     {
-        tagID = (*it).toInt();
-        ++it;
-        count = (*it).toInt();
-        ++it;
-
-        tagsStatMap[tagID] = count;
+        tagsStatMap[cursor.toInt(0)] = cursor.toInt(1);
     }
 
     return tagsStatMap;
@@ -35,6 +35,7 @@
 #include <QDateTime>
 #include <QPair>
 #include <QMap>
+#include <QHash>
 #include <QUuid>
 
 // Local includes
@@ -360,6 +361,13 @@ public:
      */
     QMap<int, int> getNumberOfImagesInAlbums();
 
+    /**
+     * Returns a QMap<int,int> of album id -> count of items
+     * in the album, only for the given albums.
+     * Use this to update the counts after changes to some albums.
+     */
+    QMap<int, int> getNumberOfImagesInAlbums(const QList<int>& albumIds);
+
     // ----------- Operations on TAlbums -----------
 
     /**
@@ -694,6 +702,14 @@ public:
      */
     QMap<QDateTime, int> getAllCreationDatesAndNumberOfImages();
 
+    /**
+     * Returns a QMap<QDateTime,int> of creationDate -> count of items,
+     * for the creation dates of the given items only, independent of their status.
+     * Dates without any remaining items are returned with a count of 0.
+     * Use this to update the counts after the given items were added or removed.
+     */
+    QMap<QDateTime, int> getCreationDatesAndNumberOfImages(const QList<qlonglong>& imageIds);
+
     // ----------- Item properties -----------
 
     /**
@@ -763,6 +779,13 @@ public:
      */
     QVariantList getImagesFields(qlonglong imageID, DatabaseFields::Images imagesFields);
 
+    /**
+     * Reads the given fields of several items with a few set-based queries.
+     * Returns, for each id found, the values in the order given above.
+     */
+    QHash<qlonglong, QVariantList> getImagesFields(const QList<qlonglong>& imageIDs,
+                                                   DatabaseFields::Images imagesFields);
+
     /**
      * Add (or replace) the ImageInformation of the specified item.
      * If there is already an entry, it will be discarded.
@@ -783,6 +806,14 @@ public:
     void addImageInformation(qlonglong imageID, const QVariantList& infos,
                              DatabaseFields::ImageInformation fields = DatabaseFields::ImageInformationAll);
 
+    /**
+     * Add (or replace) the ImageInformation of several items at once, using multi-row statements.
+     * infos holds, for each id of imageIDs, a list of values as for the method above.
+     * All lists contain the same fields.
+     */
+    void addImageInformation(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                             DatabaseFields::ImageInformation fields = DatabaseFields::ImageInformationAll);
+
     /**
      * Change the indicated fields of the image information for the specified item.
      * Fields not indicated by the fields parameter will not be touched.
@@ -798,6 +829,13 @@ public:
     QVariantList getImageInformation(qlonglong imageID,
                                      DatabaseFields::ImageInformation infoFields = DatabaseFields::ImageInformationAll);
 
+    /**
+     * Read the image information of several items with a few set-based queries.
+     * Returns, for each id which has an entry, the values as above.
+     */
+    QHash<qlonglong, QVariantList> getImageInformation(const QList<qlonglong>& imageIDs,
+                                                       DatabaseFields::ImageInformation infoFields);
+
     /**
      * Add (or replace) the ImageMetadata of the specified item.
      * If there is already an entry, it will be discarded.
@@ -825,6 +863,13 @@ public:
     void addImageMetadata(qlonglong imageID, const QVariantList& infos,
                           DatabaseFields::ImageMetadata fields = DatabaseFields::ImageMetadataAll);
 
+    /**
+     * Add (or replace) the ImageMetadata of several items at once, using multi-row statements.
+     * Parameters as for addImageInformation() above.
+     */
+    void addImageMetadata(const QList<qlonglong>& imageIDs, const QList<QVariantList>& infos,
+                          DatabaseFields::ImageMetadata fields = DatabaseFields::ImageMetadataAll);
+
     /**
      * Change the indicated fields of the image information for the specified item.
      * This method does nothing if the item does not yet have an entry in the ImageInformation table.
@@ -1237,6 +1282,18 @@ public:
      */
     QMap<int, int> getNumberOfImagesInTags();
 
+    /**
+     * Returns a QMap<int,int> of tag id -> count of items
+     * with the tag, only for the given tags.
+     * Use this to update the counts after changes to some tags.
+     */
+    QMap<int, int> getNumberOfImagesInTags(const QList<int>& tagIds);
+
+    /**
+     * Returns the ids of all tags assigned to at least one of the given items.
+     */
+    QList<int> getTagIdsOfItems(const QList<qlonglong>& imageIds);
+
     /**
      * Returns a QMap<int,int> of tag id -> count of items
      * with the given tag property
@@ -1363,6 +1420,13 @@ private:
     void readSettings();
     void writeSettings();
 
+    /**
+     * Executes "REPLACE INTO table ( imageid, fieldNames ) VALUES (...), (...)" for all items,
+     * with as many rows per statement as the bound values limit of the database allows.
+     */
+    void replaceRows(const QString& table, const QStringList& fieldNames,
+                     const QList<qlonglong>& imageIDs, const QList<QVariantList>& values);
+
 private:
 
     class Private;
@@ -149,6 +149,7 @@ bool CoreDbSchemaUpdater::update()
     }
 
     updateFilterSettings();
+    createImageHashCache();
 
     if (d->observer)
     {
@@ -560,6 +561,12 @@ bool CoreDbSchemaUpdater::createTriggers()
     return d->backend->execDBAction(d->backend->getDBAction(QLatin1String("CreateTriggers")));
 }
 
+bool CoreDbSchemaUpdater::createImageHashCache()
+{
+    // The cache is not part of the versioned schema: it can be recreated empty at any time.
+    return d->backend->execDBAction(d->backend->getDBAction(QLatin1String("CreateImageHashCache")));
+}
+
 bool CoreDbSchemaUpdater::updateUniqueHash()
 {
     if (isUniqueHashUpToDate())
@@ -1067,7 +1074,11 @@ bool CoreDbSchemaUpdater::updateV4toV7()
 
     // --- do a full scan ---
 
+    // The scan fills the hash cache, which is otherwise only created after the update
+    createImageHashCache();
+
     CollectionScanner scanner;
+    scanner.setPipelinedScanning(true);
 
     if (d->observer)
     {
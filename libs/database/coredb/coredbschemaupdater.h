@@ -79,6 +79,7 @@ private:
     bool createTables();
     bool createIndices();
     bool createTriggers();
+    bool createImageHashCache();
     bool copyV3toV4(const QString& digikam3DBPath, const QString& currentDBPath);
     bool performUpdateToVersion(const QString& actionName, int newVersion, int newRequiredVersion);
     bool updateToVersion(int targetVersion);
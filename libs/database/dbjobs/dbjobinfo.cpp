@@ -91,6 +91,16 @@ QString AlbumsDBJobInfo::album()
     return m_album;
 }
 
+void AlbumsDBJobInfo::setAlbumsIds(const QList<int>& albumsIds)
+{
+    m_albumsIds = albumsIds;
+}
+
+QList<int> AlbumsDBJobInfo::albumsIds() const
+{
+    return m_albumsIds;
+}
+
 // ---------------------------------------------
 
 TagsDBJobInfo::TagsDBJobInfo()
@@ -129,6 +139,16 @@ QList<int> TagsDBJobInfo::tagsIds() const
     return m_tagsIds;
 }
 
+void TagsDBJobInfo::setImageIds(const QList<qlonglong>& imageIds)
+{
+    m_imageIds = imageIds;
+}
+
+QList<qlonglong> TagsDBJobInfo::imageIds() const
+{
+    return m_imageIds;
+}
+
 // ---------------------------------------------
 
 GPSDBJobInfo::GPSDBJobInfo()
@@ -337,4 +357,14 @@ QDate DatesDBJobInfo::endDate() const
     return m_endDate;
 }
 
+void DatesDBJobInfo::setImageIds(const QList<qlonglong>& imageIds)
+{
+    m_imageIds = imageIds;
+}
+
+QList<qlonglong> DatesDBJobInfo::imageIds() const
+{
+    return m_imageIds;
+}
+
 } // namespace Digikam
@@ -74,10 +74,17 @@ public:
     void setAlbum(const QString& album);
     QString album();
 
+    /**
+     * With a folders job, only count the items of the given albums.
+     */
+    void setAlbumsIds(const QList<int>& albumsIds);
+    QList<int> albumsIds() const;
+
 private:
 
-    int     m_albumRootId;
-    QString m_album;
+    int        m_albumRootId;
+    QString    m_album;
+    QList<int> m_albumsIds;
 };
 
 // ---------------------------------------------
@@ -97,11 +104,19 @@ public:
     void setTagsIds(const QList<int>& tagsIds);
     QList<int> tagsIds() const;
 
+    /**
+     * With a folders job, only count the items of the given tags
+     * and of all tags assigned to the given items.
+     */
+    void setImageIds(const QList<qlonglong>& imageIds);
+    QList<qlonglong> imageIds() const;
+
 private:
 
-    bool       m_faceFolders;
-    QString    m_specialTag;
-    QList<int> m_tagsIds;
+    bool             m_faceFolders;
+    QString          m_specialTag;
+    QList<int>       m_tagsIds;
+    QList<qlonglong> m_imageIds;
 };
 
 // ---------------------------------------------
@@ -203,10 +218,17 @@ public:
     void setEndDate(const QDate& date);
     QDate endDate() const;
 
+    /**
+     * With a folders job, only count the items at the creation dates of the given items.
+     */
+    void setImageIds(const QList<qlonglong>& imageIds);
+    QList<qlonglong> imageIds() const;
+
 private:
 
-    QDate m_startDate;
-    QDate m_endDate;
+    QDate            m_startDate;
+    QDate            m_endDate;
+    QList<qlonglong> m_imageIds;
 };
 
 } // namespace Digikam
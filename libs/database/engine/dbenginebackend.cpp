@@ -1025,6 +1025,14 @@ DbEngineSqlQuery BdEngineBackend::execQuery(const QString& sql, const QList<QVar
     return query;
 }
 
+DbEngineSqlCursor BdEngineBackend::execCursor(const QString& sql, const QList<QVariant>& boundValues)
+{
+    DbEngineSqlQuery query = prepareQuery(sql);
+    execQuery(query, boundValues);
+
+    return DbEngineSqlCursor(query);
+}
+
 DbEngineSqlQuery BdEngineBackend::execQuery(const QString& sql)
 {
     DbEngineSqlQuery query = prepareQuery(sql);
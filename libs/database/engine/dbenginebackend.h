@@ -40,6 +40,7 @@
 #include "digikam_export.h"
 #include "dbengineparameters.h"
 #include "dbenginesqlquery.h"
+#include "dbenginesqlcursor.h"
 
 namespace Digikam
 {
@@ -351,6 +352,14 @@ public:
                        const QVariant& boundValue3, const QVariant& boundValue4);
     DbEngineSqlQuery execQuery(const QString& sql, const QList<QVariant>& boundValues);
 
+    /**
+     * Executes the statement as a forward-only query and returns a cursor on the result rows.
+     * Use this instead of execSql() with a values list for potentially large result sets:
+     * rows are read one by one from the database, no list of all values is built.
+     * Check DbEngineSqlCursor::isValid() for errors, lastError() gives the message.
+     */
+    DbEngineSqlCursor execCursor(const QString& sql, const QList<QVariant>& boundValues = QList<QVariant>());
+
     /**
      * Binds the values and executes the prepared query.
      */
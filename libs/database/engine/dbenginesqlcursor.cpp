@@ -0,0 +1,95 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Database engine forward-only row cursor
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dbenginesqlcursor.h"
+
+namespace Digikam
+{
+
+DbEngineSqlCursor::DbEngineSqlCursor(const DbEngineSqlQuery& query)
+    : m_query(query)
+{
+}
+
+DbEngineSqlCursor::~DbEngineSqlCursor()
+{
+}
+
+bool DbEngineSqlCursor::isValid() const
+{
+    return m_query.isActive();
+}
+
+bool DbEngineSqlCursor::next()
+{
+    return m_query.next();
+}
+
+bool DbEngineSqlCursor::isNull(int column) const
+{
+    return m_query.isNull(column);
+}
+
+QVariant DbEngineSqlCursor::value(int column) const
+{
+    return m_query.value(column);
+}
+
+int DbEngineSqlCursor::toInt(int column) const
+{
+    return m_query.value(column).toInt();
+}
+
+qlonglong DbEngineSqlCursor::toLongLong(int column) const
+{
+    return m_query.value(column).toLongLong();
+}
+
+double DbEngineSqlCursor::toDouble(int column) const
+{
+    return m_query.value(column).toDouble();
+}
+
+QString DbEngineSqlCursor::toString(int column) const
+{
+    return m_query.value(column).toString();
+}
+
+QDateTime DbEngineSqlCursor::toDateTime(int column) const
+{
+    const QVariant value = m_query.value(column);
+
+    if (value.isNull())
+    {
+        return QDateTime();
+    }
+
+    return QDateTime::fromString(value.toString(), Qt::ISODate);
+}
+
+const DbEngineSqlQuery& DbEngineSqlCursor::query() const
+{
+    return m_query;
+}
+
+} // namespace Digikam
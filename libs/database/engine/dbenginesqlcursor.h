@@ -0,0 +1,100 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Database engine forward-only row cursor
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DATABASE_ENGINE_SQL_CURSOR_H
+#define DATABASE_ENGINE_SQL_CURSOR_H
+
+// Qt includes
+
+#include <QDateTime>
+#include <QString>
+#include <QVariant>
+
+// Local includes
+
+#include "digikam_export.h"
+#include "dbenginesqlquery.h"
+
+namespace Digikam
+{
+
+/**
+ * Walks the rows of an executed, forward-only query one by one, with typed access
+ * to the columns of the current row. In contrast to BdEngineBackend::execSql(),
+ * the result set is never copied into a list, so memory stays bounded for any result size.
+ *
+ * Get a cursor from BdEngineBackend::execCursor(). The cursor reads from the database
+ * connection, so keep the database access (e.g. CoreDbAccess) locked while using it.
+ *
+ *   DbEngineSqlCursor cursor = access.backend()->execCursor(sql, boundValues);
+ *
+ *   while (cursor.next())
+ *   {
+ *       qlonglong id = cursor.toLongLong(0);
+ *       QString name = cursor.toString(1);
+ *   }
+ */
+class DIGIKAM_EXPORT DbEngineSqlCursor
+{
+public:
+
+    explicit DbEngineSqlCursor(const DbEngineSqlQuery& query);
+    ~DbEngineSqlCursor();
+
+    /**
+     * Returns true if the query was executed successfully.
+     */
+    bool isValid() const;
+
+    /**
+     * Moves to the next row. Returns false if there is no more row.
+     * Call this once before reading the first row.
+     */
+    bool next();
+
+    /**
+     * The values of the current row, by column index.
+     * toDateTime() parses the ISO date strings as stored in the database,
+     * a null value gives a null QDateTime.
+     */
+    bool      isNull(int column)     const;
+    QVariant  value(int column)      const;
+    int       toInt(int column)      const;
+    qlonglong toLongLong(int column) const;
+    double    toDouble(int column)   const;
+    QString   toString(int column)   const;
+    QDateTime toDateTime(int column) const;
+
+    /**
+     * Gives access to the underlying query, e.g. for the last error.
+     */
+    const DbEngineSqlQuery& query() const;
+
+private:
+
+    DbEngineSqlQuery m_query;
+};
+
+}  // namespace Digikam
+
+#endif // DATABASE_ENGINE_SQL_CURSOR_H
@@ -33,6 +33,7 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <queue>
 
 // Qt includes
@@ -44,6 +45,20 @@
 
 #include "dimg.h"
 
+// SSE2 is part of all x86-64 CPUs and is used unconditionally when the compiler targets it.
+// AVX2 is only used after a check of the running CPU, in functions compiled for it.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define HAAR_USE_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    (defined(__clang__) || (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#   define HAAR_USE_AVX2
+#   include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace Digikam
@@ -156,6 +171,165 @@ WeightBin::WeightBin()
 
 // --------------------------------------------------------------------
 
+#ifdef HAAR_USE_AVX2
+
+static bool detectAvx2()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static bool cpuHasAvx2()
+{
+    static const bool hasAvx2 = detectAvx2();
+    return hasAvx2;
+}
+
+/** Scores four targets at once, each in its own lane, with the same sequence
+    of double precision operations per target as the scalar code: the results are identical.
+    Returns the number of scored targets, a multiple of 4.
+*/
+__attribute__((target("avx2")))
+static int scoreAvx2(const float* const table, const double* const qavg, const double* const avgWeights,
+                     const double* const avgs, const Idx* const sigs, int count, double* const scores)
+{
+    const int     sigSize  = 3 * NumberOfCoefficients;
+    const __m256d absMask  = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const __m128i avgIndex = _mm_setr_epi32(0, 3, 6, 9);
+    const __m128i sigIndex = _mm_setr_epi32(0, sigSize, 2 * sigSize, 3 * sigSize);
+    int           n        = 0;
+
+    for ( ; n + 4 <= count; n += 4)
+    {
+        __m256d score = _mm256_setzero_pd();
+
+        // Step 1: average intensity values of all three channels
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            __m256d tavg = _mm256_i32gather_pd(avgs + 3 * n + channel, avgIndex, 8);
+            __m256d diff = _mm256_and_pd(_mm256_sub_pd(_mm256_set1_pd(qavg[channel]), tavg), absMask);
+            score        = _mm256_add_pd(score, _mm256_mul_pd(_mm256_set1_pd(avgWeights[channel]), diff));
+        }
+
+        // Step 2: subtract the weights of the coefficients in common with the query
+        const Idx* const sig = sigs + sigSize * n;
+
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            const float* const weights = table + (2 * channel + 1) * NumberOfPixelsSquared;
+
+            for (int coef = 0; coef < NumberOfCoefficients; ++coef)
+            {
+                __m128i x = _mm_i32gather_epi32(reinterpret_cast<const int*>(sig + channel * NumberOfCoefficients + coef),
+                                                sigIndex, 4);
+                __m128  w = _mm_i32gather_ps(weights, x, 4);
+                score     = _mm256_sub_pd(score, _mm256_cvtps_pd(w));
+            }
+        }
+
+        _mm256_storeu_pd(scores + n, score);
+    }
+
+    return n;
+}
+
+#endif // HAAR_USE_AVX2
+
+Scorer::Scorer(const Weights& weights, const WeightBin& bin)
+    : m_hasQuery(false),
+      m_weights(weights),
+      m_bin(bin)
+{
+    m_table = new float[3 * 2 * NumberOfPixelsSquared];
+    memset(m_table, 0, 3 * 2 * NumberOfPixelsSquared * sizeof(float));
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        m_avg[channel]        = 0.0;
+        m_avgWeights[channel] = m_weights.weightForAverage(channel);
+    }
+}
+
+Scorer::~Scorer()
+{
+    delete [] m_table;
+}
+
+void Scorer::setQuery(const SignatureData& query)
+{
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        float* const weights = m_table + (2 * channel + 1) * NumberOfPixelsSquared;
+
+        // Only the entries of the previous query are set
+        if (m_hasQuery)
+        {
+            for (int coef = 0; coef < NumberOfCoefficients; ++coef)
+            {
+                weights[m_query.sig[channel][coef]] = 0.0F;
+            }
+        }
+
+        for (int coef = 0; coef < NumberOfCoefficients; ++coef)
+        {
+            Idx x      = query.sig[channel][coef];
+            weights[x] = m_weights.weight(m_bin.binAbs(x), channel);
+        }
+
+        m_avg[channel] = query.avg[channel];
+    }
+
+    m_query    = query;
+    m_hasQuery = true;
+}
+
+double Scorer::score(const double* const avg, const Idx* const sig) const
+{
+    double score = 0.0;
+
+    // Step 1: Initialize scores with average intensity values of all three channels
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        score += m_avgWeights[channel] * fabs( m_avg[channel] - avg[channel] );
+    }
+
+    // Step 2: Decrease the score if query and target have significant coefficients in common.
+    // The weight is 0 for coefficients not in the query: subtracting it leaves the score unchanged.
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        const float* const weights = m_table + (2 * channel + 1) * NumberOfPixelsSquared;
+        const Idx*   const csig    = sig + channel * NumberOfCoefficients;
+
+        for (int coef = 0; coef < NumberOfCoefficients; ++coef)
+        {
+            score -= weights[csig[coef]];
+        }
+    }
+
+    return score;
+}
+
+void Scorer::score(const double* const avgs, const Idx* const sigs, int count, double* const scores) const
+{
+    int n = 0;
+
+#ifdef HAAR_USE_AVX2
+
+    if (cpuHasAvx2())
+    {
+        n = scoreAvx2(m_table, m_avg, m_avgWeights, avgs, sigs, count, scores);
+    }
+
+#endif
+
+    for ( ; n < count; ++n)
+    {
+        scores[n] = score(avgs + 3 * n, sigs + 3 * NumberOfCoefficients * n);
+    }
+}
+
+// --------------------------------------------------------------------
+
 Calculator::Calculator()
 {
 }
@@ -164,11 +338,79 @@ Calculator::~Calculator()
 {
 }
 
+/** Compute diff[k] = (x[k] - y[k]) * C and sum[k] = x[k] + y[k] for k < n.
+    sum may be the same array as x.
+*/
+static inline void subAddScaled(const Unit* const x, const Unit* const y,
+                                Unit* const diff, Unit* const sum, Unit C, int n)
+{
+    int k = 0;
+
+#ifdef HAAR_USE_SSE2
+
+    const __m128d c = _mm_set1_pd(C);
+
+    for ( ; k + 2 <= n; k += 2)
+    {
+        __m128d vx = _mm_loadu_pd(x + k);
+        __m128d vy = _mm_loadu_pd(y + k);
+        _mm_storeu_pd(diff + k, _mm_mul_pd(_mm_sub_pd(vx, vy), c));
+        _mm_storeu_pd(sum  + k, _mm_add_pd(vx, vy));
+    }
+
+#endif
+
+    for ( ; k < n; ++k)
+    {
+        Unit vx = x[k];
+        Unit vy = y[k];
+        diff[k] = (vx - vy) * C;
+        sum[k]  = (vx + vy);
+    }
+}
+
+/** Same as subAddScaled(), with x and y interleaved in a:
+    diff[k] = (a[2k] - a[2k+1]) * C and a[k] = a[2k] + a[2k+1].
+*/
+static inline void subAddScaledPairs(Unit* const a, Unit* const diff, Unit C, int n)
+{
+    int k = 0;
+
+#ifdef HAAR_USE_SSE2
+
+    const __m128d c = _mm_set1_pd(C);
+
+    // a[k], a[k+1] are written after a[2k]..a[2k+3] have been read, never before.
+    for ( ; k + 2 <= n; k += 2)
+    {
+        __m128d p0   = _mm_loadu_pd(a + 2*k);
+        __m128d p1   = _mm_loadu_pd(a + 2*k + 2);
+        __m128d even = _mm_unpacklo_pd(p0, p1);
+        __m128d odd  = _mm_unpackhi_pd(p0, p1);
+        _mm_storeu_pd(diff + k, _mm_mul_pd(_mm_sub_pd(even, odd), c));
+        _mm_storeu_pd(a    + k, _mm_add_pd(even, odd));
+    }
+
+#endif
+
+    for ( ; k < n; ++k)
+    {
+        Unit even = a[2*k];
+        Unit odd  = a[2*k+1];
+        diff[k]   = (even - odd) * C;
+        a[k]      = (even + odd);
+    }
+}
+
 /** Do the Haar tensorial 2d transform itself.
     Here input is RGB data [0..255] in Unit arrays
     Computation is (almost) in-situ.
+    buffer must hold NumberOfPixelsSquared / 2 values.
+    The columns are all decomposed at once, row by row, which gives exactly the
+    same operations per element as a column after column decomposition,
+    but on contiguous memory.
 */
-void Calculator::haar2D(Unit a[])
+void Calculator::haar2D(Unit a[], Unit* const buffer)
 {
     int  i;
     Unit t[NumberOfPixels >> 1];
@@ -187,17 +429,10 @@ void Calculator::haar2D(Unit a[])
 
         for (h = NumberOfPixels; h > 1; h = h1)
         {
-            int j1, j2, k;
-
             h1 = h >> 1;        // h = 2*h1
             C *= 0.7071;        // 1/sqrt(2)
 
-            for (k = 0, j1 = j2 = i; k < h1; ++k, ++j1, j2 += 2)
-            {
-                int j21 = j2+1;
-                t[k]    = (a[j2] - a[j21]) * C;
-                a[j1]   = (a[j2] + a[j21]);
-            }
+            subAddScaledPairs(a+i, t, C, h1);
 
             // Write back subtraction results:
             memcpy(a+i+h1, t, h1*sizeof(a[0]));
@@ -214,34 +449,34 @@ void Calculator::haar2D(Unit a[])
     */
 
     // Decompose columns:
-    for (i = 0; i < NumberOfPixels; ++i)
     {
         Unit C = 1;
-        int  h, h1;
+        int  h, h1, k;
 
         for (h = NumberOfPixels; h > 1; h = h1)
         {
-            int j1, j2, k;
-
             h1 = h >> 1;
             C *= 0.7071;       // 1/sqrt(2) = 0.7071
 
-            for (k = 0, j1 = j2 = i; k < h1; ++k, j1 += NumberOfPixels, j2 += 2*NumberOfPixels)
+            // Row k is written after rows 2k and 2k+1 have been read.
+            for (k = 0; k < h1; ++k)
             {
-                int j21 = j2+NumberOfPixels;
-                t[k]    = (a[j2] - a[j21]) * C;
-                a[j1]   = (a[j2] + a[j21]);
+                subAddScaled(a + (2*k)   * NumberOfPixels,
+                             a + (2*k+1) * NumberOfPixels,
+                             buffer + k  * NumberOfPixels,
+                             a + k       * NumberOfPixels,
+                             C, NumberOfPixels);
             }
 
             // Write back subtraction results:
-            for (k = 0, j1 = i+h1*NumberOfPixels; k < h1; ++k, j1 += NumberOfPixels)
-            {
-                a[j1] = t[k];
-            }
+            memcpy(a + h1*NumberOfPixels, buffer, h1*NumberOfPixels*sizeof(a[0]));
         }
 
         // Fix first element of each column:
-        a[i] *= C;
+        for (i = 0; i < NumberOfPixels; ++i)
+        {
+            a[i] *= C;
+        }
     }
 }
 
@@ -258,8 +493,35 @@ void Calculator::transform(ImageData* const data)
     Unit* a = data->data1;
     Unit* b = data->data2;
     Unit* c = data->data3;
+    int   i = 0;
 
-    for (int i = 0; i < NumberOfPixelsSquared; ++i)
+#ifdef HAAR_USE_SSE2
+
+    for ( ; i + 2 <= NumberOfPixelsSquared; i += 2)
+    {
+        __m128d va = _mm_loadu_pd(a + i);
+        __m128d vb = _mm_loadu_pd(b + i);
+        __m128d vc = _mm_loadu_pd(c + i);
+
+        // Same evaluation order as the scalar code below
+        __m128d Y  = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.299), va),
+                                           _mm_mul_pd(_mm_set1_pd(0.587), vb)),
+                                _mm_mul_pd(_mm_set1_pd(0.114), vc));
+        __m128d I  = _mm_sub_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(0.596), va),
+                                           _mm_mul_pd(_mm_set1_pd(0.275), vb)),
+                                _mm_mul_pd(_mm_set1_pd(0.321), vc));
+        __m128d Q  = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(0.212), va),
+                                           _mm_mul_pd(_mm_set1_pd(0.523), vb)),
+                                _mm_mul_pd(_mm_set1_pd(0.311), vc));
+
+        _mm_storeu_pd(a + i, Y);
+        _mm_storeu_pd(b + i, I);
+        _mm_storeu_pd(c + i, Q);
+    }
+
+#endif
+
+    for ( ; i < NumberOfPixelsSquared; ++i)
     {
         Unit Y, I, Q;
 
@@ -271,9 +533,13 @@ void Calculator::transform(ImageData* const data)
         c[i] = Q;
     }
 
-    haar2D(a);
-    haar2D(b);
-    haar2D(c);
+    Unit* const buffer = new Unit[NumberOfPixelsSquared >> 1];
+
+    haar2D(a, buffer);
+    haar2D(b, buffer);
+    haar2D(c, buffer);
+
+    delete [] buffer;
 
     // Reintroduce the skipped scaling factors
     a[0] /= 256 * 128;
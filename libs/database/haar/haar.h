@@ -238,6 +238,50 @@ private:
 
 // ---------------------------------------------------------------------------------
 
+/** Scores one query signature against many target signatures.
+ *  Targets are packed: 3 averages per item, and 3*40 coefficients per item,
+ *  channel after channel. A lower score is a better match.
+ *  An AVX2 kernel scoring four targets at once is used if the CPU supports it,
+ *  else the scalar code. Both give the same results, bit for bit.
+ */
+class Scorer
+{
+public:
+
+    Scorer(const Weights& weights, const WeightBin& bin);
+    ~Scorer();
+
+    /// Set the query signature. Must be called before scoring.
+    void   setQuery(const SignatureData& query);
+
+    /// Score count targets, writing count values to scores
+    void   score(const double* const avgs, const Idx* const sigs, int count, double* const scores) const;
+
+    /// Score a single target
+    double score(const double* const avg, const Idx* const sig) const;
+
+private:
+
+    // Not copyable
+    Scorer(const Scorer&);
+    Scorer& operator=(const Scorer&);
+
+private:
+
+    /** For each channel, and each coefficient index -16383..16383, the weight to subtract
+     *  if the coefficient is also in the query signature, or 0.
+     */
+    float*           m_table;
+    double           m_avg[3];
+    double           m_avgWeights[3];
+    SignatureData    m_query;
+    bool             m_hasQuery;
+    Weights          m_weights;
+    const WeightBin& m_bin;
+};
+
+// ---------------------------------------------------------------------------------
+
 class Calculator
 {
 
@@ -252,7 +296,7 @@ public:
 
 private:
 
-    void        haar2D(Unit a[]);
+    void        haar2D(Unit a[], Unit* const buffer);
     inline void getmLargests(Unit* const cdata, Idx* const sig);
 };
 
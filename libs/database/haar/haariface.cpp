@@ -31,6 +31,7 @@
 #include <fstream>
 #include <cmath>
 #include <cstring>
+#include <algorithm>
 
 // Qt includes
 
@@ -39,6 +40,11 @@
 #include <QImage>
 #include <QImageReader>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 // Local includes
 
@@ -52,232 +58,148 @@
 #include "coredbbackend.h"
 #include "coredbsearchxml.h"
 #include "dbenginesqlquery.h"
+#include "haarsignaturestore.h"
 
 using namespace std;
 
 namespace Digikam
 {
 
-typedef QMap<qlonglong, Haar::SignatureData> SignatureCache;
-typedef QMap<qlonglong, int>                 AlbumCache;
-
-/** This class encapsulates the Haar signature in a QByteArray
- *  that can be stored as a BLOB in the database.
- *
- *  Reading and writing is done in a platform-independent manner, which
- *  induces a certain overhead, but which is necessary IMO.
- */
-class DatabaseBlob
+class HaarIface::Private
 {
 public:
 
-    enum
+    Private()
     {
-        Version = 1
-    };
-
-public:
+        data         = 0;
+        bin          = 0;
+        indexBatched = false;
+    }
 
-    DatabaseBlob()
+    ~Private()
     {
+        delete data;
+        delete bin;
     }
 
-    /** Read the QByteArray into the Haar::SignatureData.
-     */
-    void read(const QByteArray& array, Haar::SignatureData* const data)
+    void createLoadingBuffer()
     {
-        QDataStream stream(array);
-
-        // check version
-        qint32 version;
-        stream >> version;
-
-        if (version != Version)
-        {
-            qCDebug(DIGIKAM_DATABASE_LOG) << "Unsupported binary version of Haar Blob in database";
-            return;
-        }
-
-        stream.setVersion(QDataStream::Qt_4_3);
-
-        // read averages
-        for (int i = 0; i < 3; ++i)
-        {
-            stream >> data->avg[i];
-        }
-
-        // read coefficients
-        for (int i = 0; i < 3; ++i)
+        if (!data)
         {
-            for (int j = 0; j < Haar::NumberOfCoefficients; ++j)
-            {
-                stream >> data->sig[i][j];
-            }
+            data = new Haar::ImageData;
         }
     }
 
-    QByteArray write(Haar::SignatureData* const data)
+    void createWeightBin()
     {
-        QByteArray array;
-        array.reserve(sizeof(qint32) + 3*sizeof(double) + 3*sizeof(qint32)*Haar::NumberOfCoefficients);
-        QDataStream stream(&array, QIODevice::WriteOnly);
-        stream.setVersion(QDataStream::Qt_4_3);
-
-        // write version
-        stream << (qint32)Version;
-
-        // write averages
-        for (int i = 0; i < 3; ++i)
+        if (!bin)
         {
-            stream << data->avg[i];
+            bin = new Haar::WeightBin;
         }
+    }
 
-        // write coefficients
-        for (int i = 0; i < 3; ++i)
-        {
-            for (int j = 0; j < Haar::NumberOfCoefficients; ++j)
-            {
-                stream << data->sig[i][j];
-            }
-        }
+    Haar::ImageData*  data;
+    Haar::WeightBin*  bin;
 
-        return array;
-    }
+    QSet<int>         albumRootsToSearch;
+
+    bool              indexBatched;
+    QList<qlonglong>  pendingIds;
+    QList<QByteArray> pendingSignatures;
 };
 
 // -----------------------------------------------------------------------------------------------------
 
-class HaarIface::Private
+/** Shared state of a parallel duplicates search.
+ *
+ *  The signatures to scan are copied to a flat table, and an inverted index maps each
+ *  (channel, signed coefficient) pair to the list of targets having this coefficient.
+ *  For a query, the sum of the weights of common coefficients can then be accumulated
+ *  by walking only the 3*40 posting lists of the query, instead of scoring all targets.
+ */
+class HaarIface::DuplicatesContext
 {
 public:
 
-    Private()
+    enum
     {
-        data                       = 0;
-        bin                        = 0;
-        signatureCache             = 0;
-        albumCache                 = 0;
-        useSignatureCache          = false;
-
-        signatureQuery             = QString::fromUtf8("SELECT M.imageid, 0, M.matrix, Images.album "
-                                             " FROM ImageHaarMatrix AS M "
-                                             "    INNER JOIN Images ON Images.id=M.imageid "
-                                             " WHERE Images.status=1; ");
-
-        signatureByAlbumRootsQuery = QString::fromUtf8("SELECT M.imageid, Albums.albumRoot, M.matrix, Images.album "
-                                             " FROM ImageHaarMatrix AS M "
-                                             "    INNER JOIN Images ON Images.id=M.imageid "
-                                             "    INNER JOIN Albums ON Albums.id=Images.album"
-                                             " WHERE Images.status=1;");
-    }
+        /// Number of query images a worker takes from the queue at once
+        ChunkSize = 32
+    };
 
-    ~Private()
+    DuplicatesContext()
+        : requiredPercentage(0.0),
+          maximumPercentage(0.0),
+          searchResultRestriction(None),
+          type(ScannedSketch)
     {
-        delete data;
-        delete bin;
-        delete signatureCache;
-        delete albumCache;
     }
 
-    void createLoadingBuffer()
+    static int postingKey(int channel, Haar::Idx index)
     {
-        if (!data)
-        {
-            data = new Haar::ImageData;
-        }
-    }
-
-    void createWeightBin()
-    {
-        if (!bin)
-        {
-            bin = new Haar::WeightBin;
-        }
+        return (channel * 2 * Haar::NumberOfPixelsSquared) + index + Haar::NumberOfPixelsSquared;
     }
 
-    void setSignatureCacheEnabled(bool cache, const QSet<qlonglong>& imageIds)
+    void build(const HaarSignatureTable& table, const QSet<qlonglong>& images2Scan)
     {
-        setSignatureCacheEnabled(cache);
+        postings.resize(3 * 2 * Haar::NumberOfPixelsSquared);
 
-        // stop here if we disable cached signatures
-        if (!cache || imageIds.isEmpty())
+        for (int i = 0 ; i < table.count() ; ++i)
         {
-            return;
-        }
-
-        // Remove all ids from the fully created signatureCache that are not needed for the duplicates search.
-        // This is usually faster then starting a query for every single id in imageIds.
-        for (SignatureCache::iterator it = signatureCache->begin();
-             it != signatureCache->end(); )
-        {
-            if (!imageIds.contains(it.key()))
-            {
-                it = signatureCache->erase(it);
-            }
-            else
+            if (!images2Scan.contains(table.ids.at(i)))
             {
-                ++it;
+                continue;
             }
-        }
-    }
 
-    void setSignatureCacheEnabled(bool cache)
-    {
-        delete signatureCache;
-        signatureCache = 0;
-        delete albumCache;
-        albumCache     = 0;
+            const int pos = targets.count();
+            targets.append(table, i);
+            allTargets << pos;
+            positions.insert(table.ids.at(i), pos);
 
-        if (cache)
-        {
-            signatureCache = new SignatureCache();
-            albumCache     = new AlbumCache();
-        }
-        useSignatureCache = cache;
+            for (int channel = 0 ; channel < 3 ; ++channel)
+            {
+                const Haar::Idx* const sig = targets.sig(pos, channel);
 
-        // stop here if we disable cached signatures
-        if (!cache)
-        {
-            return;
+                for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+                {
+                    postings[postingKey(channel, sig[coef])] << pos;
+                }
+            }
         }
 
-        // Variables for data read from DB
-        CoreDbAccess      access;
-        DatabaseBlob        blob;
-        qlonglong           imageid;
-        int                 albumid;
-        Haar::SignatureData targetSig;
-
-        // reference for easier access
-        SignatureCache& signatureCache = *this->signatureCache;
-        AlbumCache&     albumCache     = *this->albumCache;
-
-        DbEngineSqlQuery query = access.backend()->prepareQuery(signatureQuery);
+        // Keep the iteration order of the set: results are merged in this order afterwards.
+        queryIds.reserve(images2Scan.count());
 
-        if (!access.backend()->exec(query))
+        foreach(const qlonglong& id, images2Scan)
         {
-            return;
+            queryIds << id;
         }
 
-        while (query.next())
-        {
-            imageid = query.value(0).toLongLong();
-            blob.read(query.value(2).toByteArray(), &targetSig);
-            albumid = query.value(3).toInt();
-            signatureCache[imageid] = targetSig;
-            albumCache[imageid]     = albumid;
-        }
+        results.resize(queryIds.size());
+        done.fill(false, queryIds.size());
     }
 
-    bool             useSignatureCache;
-    Haar::ImageData* data;
-    Haar::WeightBin* bin;
-    SignatureCache*  signatureCache;
-    AlbumCache*      albumCache;
+public:
 
-    QString          signatureQuery;
-    QString          signatureByAlbumRootsQuery;
-    QSet<int>        albumRootsToSearch;
+    double                            requiredPercentage;
+    double                            maximumPercentage;
+    DuplicatesSearchRestrictions      searchResultRestriction;
+    SketchType                        type;
+
+    /// The signatures of the images to scan, with the position of each image
+    HaarSignatureTable                targets;
+    QVector<int>                      allTargets;
+    QHash<qlonglong, int>             positions;
+    QVector<QVector<int> >            postings;
+
+    /// Query images, and for each of them the matches with their similarity
+    QVector<qlonglong>                queryIds;
+    QVector<QMap<qlonglong, double> > results;
+    QVector<bool>                     done;
+
+    QAtomicInt                        nextQuery;
+    QAtomicInt                        processed;
+    QAtomicInt                        canceled;
 };
 
 HaarIface::HaarIface()
@@ -287,9 +209,50 @@ HaarIface::HaarIface()
 
 HaarIface::~HaarIface()
 {
+    commitIndex();
     delete d;
 }
 
+void HaarIface::setIndexBatched(bool batched)
+{
+    d->indexBatched = batched;
+
+    if (!batched)
+    {
+        commitIndex();
+    }
+}
+
+void HaarIface::commitIndex()
+{
+    if (d->pendingIds.isEmpty())
+    {
+        return;
+    }
+
+    {
+        CoreDbAccess access;
+        CoreDbTransaction transaction(&access);
+
+        for (int i = 0 ; i < d->pendingIds.size() ; ++i)
+        {
+            access.backend()->execSql(QString::fromUtf8("REPLACE INTO ImageHaarMatrix "
+                                              " (imageid, modificationDate, uniqueHash, matrix) "
+                                              " SELECT id, modificationDate, uniqueHash, ? "
+                                              "  FROM Images WHERE id=?; "),
+                                      d->pendingSignatures.at(i), d->pendingIds.at(i));
+        }
+    }
+
+    foreach(const qlonglong& imageid, d->pendingIds)
+    {
+        HaarSignatureStore::instance()->signatureChanged(imageid);
+    }
+
+    d->pendingIds.clear();
+    d->pendingSignatures.clear();
+}
+
 void HaarIface::setAlbumRootsToSearch(QList<int> albumRootIds)
 {
     setAlbumRootsToSearch(albumRootIds.toSet());
@@ -376,14 +339,21 @@ bool HaarIface::indexImage(qlonglong imageid)
     Haar::SignatureData sig;
     haar.calcHaar(d->data, &sig);
 
+    // prepare blob
+    DatabaseBlob blob;
+    QByteArray array = blob.write(&sig);
+
+    if (d->indexBatched)
+    {
+        d->pendingIds        << imageid;
+        d->pendingSignatures << array;
+        return true;
+    }
+
     CoreDbAccess access;
 
     // Store main entry
     {
-        // prepare blob
-        DatabaseBlob blob;
-        QByteArray array = blob.write(&sig);
-
         access.backend()->execSql(QString::fromUtf8("REPLACE INTO ImageHaarMatrix "
                                           " (imageid, modificationDate, uniqueHash, matrix) "
                                           " SELECT id, modificationDate, uniqueHash, ? "
@@ -391,6 +361,8 @@ bool HaarIface::indexImage(qlonglong imageid)
                                   array, imageid);
     }
 
+    HaarSignatureStore::instance()->signatureChanged(imageid);
+
     return true;
 }
 
@@ -455,8 +427,7 @@ QPair<double,QMap<qlonglong,double>> HaarIface::bestMatchesForImageWithThreshold
     haar.calcHaar(d->data, &sig);
 
     // Remove all previous similarities from pictures
-    CoreDbAccess access;
-    access.db()->removeImagePropertyByName(QLatin1String("similarityTo_")+QString::number(0));
+    CoreDbAccess().db()->removeImagePropertyByName(QLatin1String("similarityTo_")+QString::number(0));
 
     // Apply duplicates search for the image. Use the image id 0 which cannot be present.
     return bestMatchesWithThreshold(0, &sig, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, type);
@@ -466,24 +437,14 @@ QPair<double,QMap<qlonglong,double>> HaarIface::bestMatchesForImageWithThreshold
                                                              double maximumPercentage, QList<int>& targetAlbums,
                                                              DuplicatesSearchRestrictions searchResultRestriction, SketchType type)
 {
-    if ( !d->useSignatureCache || (d->signatureCache->isEmpty() && d->useSignatureCache) )
-    {
-        Haar::SignatureData sig;
-
-        if (!retrieveSignatureFromDB(imageid, &sig))
-        {
-            return QPair<double,QMap<qlonglong,double>>();
-        }
+    Haar::SignatureData sig;
 
-        return bestMatchesWithThreshold(imageid, &sig, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, type);
-    }
-    else
+    if (!retrieveSignatureFromDB(imageid, &sig))
     {
-        // reference for easier access
-        SignatureCache& signatureCache = *d->signatureCache;
-        Haar::SignatureData& sig       = signatureCache[imageid];
-        return bestMatchesWithThreshold(imageid, &sig, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, type);
+        return QPair<double,QMap<qlonglong,double>>();
     }
+
+    return bestMatchesWithThreshold(imageid, &sig, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, type);
 }
 
 QList<qlonglong> HaarIface::bestMatchesForFile(const QString& filename, QList<int>& targetAlbums, int numberOfResults, SketchType type)
@@ -695,112 +656,44 @@ QMap<qlonglong, double> HaarIface::searchDatabase(Haar::SignatureData* const que
     Haar::Weights weights((Haar::Weights::SketchType)type);
 
     // layout the query signature for fast lookup
-    Haar::SignatureMap queryMapY, queryMapI, queryMapQ;
-    queryMapY.fill(querySig->sig[0]);
-    queryMapI.fill(querySig->sig[1]);
-    queryMapQ.fill(querySig->sig[2]);
-    Haar::SignatureMap* queryMaps[3] = { &queryMapY, &queryMapI, &queryMapQ };
+    Haar::Scorer scorer(weights, *d->bin);
+    scorer.setQuery(*querySig);
 
     // Map imageid -> score. Lowest score is best.
     // any newly inserted value will be initialized with a score of 0, as required
     QMap<qlonglong, double> scores;
 
-    // Variables for data read from DB
-    CoreDbAccess      access;
-    DatabaseBlob        blob;
-    qlonglong           imageid;
-    int                 albumid;
-    Haar::SignatureData targetSig;
-
-    // reference for easier access
-    SignatureCache& signatureCache = *d->signatureCache;
-    AlbumCache&     albumCache     = *d->albumCache;
+    // All signatures, read from the database only at first use
+    const HaarSignatureTable table = HaarSignatureStore::instance()->table();
+    bool filterByAlbumRoots        = !d->albumRootsToSearch.isEmpty();
 
-    bool filterByAlbumRoots = !d->albumRootsToSearch.isEmpty();
+    // The table is scored in blocks, small enough to stay in the cache until filtered.
+    const int       blockSize = 1024;
+    QVector<double> blockScores(blockSize);
 
-    // if no cache is used or the cache signature map is empty, query the database
-    if (!d->useSignatureCache || (signatureCache.isEmpty() && d->useSignatureCache))
+    for (int first = 0; first < table.count(); first += blockSize)
     {
-        QString queryText;
-
-        if (filterByAlbumRoots)
-        {
-            queryText = d->signatureByAlbumRootsQuery;
-        }
-        else
-        {
-            queryText = d->signatureQuery;
-        }
-
-        DbEngineSqlQuery query = access.backend()->prepareQuery(queryText);
-
-        if (!access.backend()->exec(query))
-        {
-            return scores;
-        }
+        const int count = qMin(blockSize, table.count() - first);
+        scorer.score(table.avg(first), table.sig(first, 0), count, blockScores.data());
 
-        // We don't use CoreDbBackend's convenience calls, as the result set is large
-        // and we try to avoid copying in a temporary QList<QVariant>
-        int albumRootId = 0;
-
-        while (query.next())
+        for (int pos = first; pos < first + count; ++pos)
         {
-            imageid = query.value(0).toLongLong();
-
-            if (filterByAlbumRoots)
+            if (filterByAlbumRoots && !d->albumRootsToSearch.contains(table.albumRoots.at(pos)))
             {
-                albumRootId = query.value(1).toInt();
-
-                if (!d->albumRootsToSearch.contains(albumRootId))
-                {
-                    continue;
-                }
+                continue;
             }
 
-            blob.read(query.value(2).toByteArray(), &targetSig);
-            albumid = query.value(3).toInt();
-
-            if (d->useSignatureCache)
-            {
-                signatureCache[imageid] = targetSig;
-                albumCache[imageid]     = albumid;
-            }
+            const qlonglong imageid = table.ids.at(pos);
 
             // If the image is the original one or
             // No restrictions apply or
             // SameAlbum restriction applies and the albums are equal or
             // DifferentAlbum restriction applies and the albums differ
-            // then calculate the score.
+            // then use the score.
             // Also, restrict to target album
-            if ( fulfillsRestrictions(imageid, albumid, originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
+            if ( fulfillsRestrictions(imageid, table.albums.at(pos), originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
             {
-                double&              score = scores[imageid];
-                Haar::SignatureData& qSig  = *querySig;
-                Haar::SignatureData& tSig  = targetSig;
-
-                score = calculateScore(qSig, tSig, weights, queryMaps);
-            }
-        }
-    }
-    // read cached signature map if possible
-    else
-    {
-        foreach(const qlonglong& imageid, signatureCache.keys())
-        {
-            albumid = albumCache[imageid];
-
-            // If the image is the original one or
-            // No restrictions apply or
-            // SameAlbum restriction applies and the albums are equal or
-            // DifferentAlbum restriction applies and the albums differ
-            // then calculate the score.
-            if ( fulfillsRestrictions(imageid, albumid, originalImageId, originalAlbumId, targetAlbums, searchResultRestriction) )
-            {
-                double& score              = scores[imageid];
-                Haar::SignatureData& qSig  = *querySig;
-                Haar::SignatureData& tSig  = signatureCache[imageid];
-
-                score = calculateScore(qSig, tSig, weights, queryMaps);
+                scores[imageid] = blockScores.at(pos - first);
             }
         }
     }
@@ -840,6 +733,11 @@ QImage HaarIface::loadQImage(const QString& filename)
 
 bool HaarIface::retrieveSignatureFromDB(qlonglong imageid, Haar::SignatureData* const sig)
 {
+    if (HaarSignatureStore::instance()->signature(imageid, sig))
+    {
+        return true;
+    }
+
     QList<QVariant> values;
     CoreDbAccess().backend()->execSql(QString::fromUtf8("SELECT matrix FROM ImageHaarMatrix WHERE imageid=?"),
                                         imageid, &values);
@@ -1072,75 +970,126 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
 {
     QMap<double,QMap<qlonglong,QList<qlonglong>>> resultsMap;
     QMap<double,QMap<qlonglong,QList<qlonglong>>>::iterator similarity_it;
-    QSet<qlonglong>::const_iterator     it;
-    QPair<double,QMap<qlonglong,double>>      bestMatches;
     QList<qlonglong>                    imageIdList;
     QSet<qlonglong>                     resultsCandidates;
+    QSet<qlonglong>                     removedTargets;
 
-    int                                 total        = 0;
-    int                                 progress     = 0;
-    int                                 progressStep = 20;
+    int                                 total        = images2Scan.count();
 
     if (observer)
     {
-        total        = images2Scan.count();
-        progressStep = qMax(progressStep, total / 100);
         observer->totalNumberToScan(total);
     }
 
-    // create signature cache map for fast lookup
-    d->setSignatureCacheEnabled(true, images2Scan);
+    d->createWeightBin();
+
+    // Step 1: score all images in parallel. The matches of each image do not depend
+    //         on the other queries, so this is where almost all the time is spent.
+
+    DuplicatesContext ctx;
+    ctx.requiredPercentage      = requiredPercentage;
+    ctx.maximumPercentage       = maximumPercentage;
+    ctx.searchResultRestriction = searchResultRestriction;
+    ctx.type                    = ScannedSketch;
+    ctx.build(HaarSignatureStore::instance()->table(), images2Scan);
+
+    QList<QFuture<void> > tasks;
+    const int workers = qMax(0, QThreadPool::globalInstance()->maxThreadCount() - 1);
 
-    for (it = images2Scan.constBegin(); it != images2Scan.constEnd(); ++it)
+    for (int i = 0 ; i < workers ; ++i)
     {
-        if (observer && observer->isCanceled())
-        {
-            break;
-        }
+        tasks.append(QtConcurrent::run(this,
+                                       &HaarIface::findDuplicatesWorker,
+                                       &ctx,
+                                       (HaarProgressObserver*)0));
+    }
 
-        if (!resultsCandidates.contains(*it))
+    // The calling thread takes part in the search, and is the only one to talk to the observer.
+    findDuplicatesWorker(&ctx, observer);
+
+    foreach(QFuture<void> t, tasks)
+    {
+        t.waitForFinished();
+    }
+
+    // Step 2: merge the results in the order of the sequential algorithm.
+    //         An image already found as duplicate is not used as reference again,
+    //         and an image without any duplicate is no longer a candidate for the following ones.
+
+    {
+        CoreDbAccess      access;
+        CoreDbTransaction transaction(&access);
+
+        for (int i = 0 ; i < ctx.queryIds.size() ; ++i)
         {
-            QList<int> targetAlbums;
-            // find images with required similarity
-            bestMatches = bestMatchesForImageWithThreshold(*it, requiredPercentage, maximumPercentage, targetAlbums, searchResultRestriction, ScannedSketch);
-            // We need only the image ids from the best matches map.
-            imageIdList = bestMatches.second.keys();
-            if (!imageIdList.isEmpty())
+            // If the search has been canceled, only keep the results of the images processed in order.
+            if (!ctx.done.at(i))
             {
+                break;
+            }
+
+            const qlonglong imageid = ctx.queryIds.at(i);
+
+            if (!resultsCandidates.contains(imageid))
+            {
+                const QMap<qlonglong, double>& matches = ctx.results.at(i);
+                double avgPercentage                   = 0.0;
+
+                imageIdList.clear();
+
+                for (QMap<qlonglong, double>::const_iterator it = matches.constBegin() ; it != matches.constEnd() ; ++it)
+                {
+                    if (removedTargets.contains(it.key()))
+                    {
+                        continue;
+                    }
+
+                    imageIdList << it.key();
+
+                    // Save the similarity of the found image to the original image.
+                    if (it.key() != imageid)
+                    {
+                        access.db()->setImageProperty(it.key(), QLatin1String("similarityTo_") + QString::number(imageid),
+                                                      QString::number(it.value()));
+                        avgPercentage += it.value();
+                    }
+                }
+
+                // The average percentage is the sum of all percentages
+                // (without the original picture) divided by the count of pictures -1.
+                if (imageIdList.count() > 1)
+                {
+                    avgPercentage = avgPercentage / (imageIdList.count() - 1);
+                }
+
                 // the list will usually contain one image: the original. Filter out.
-                if (!(imageIdList.count() == 1 && imageIdList.first() == *it))
+                if (!imageIdList.isEmpty() && !(imageIdList.count() == 1 && imageIdList.first() == imageid))
                 {
                     // make a lookup for the average similarity
-                    similarity_it = resultsMap.find(bestMatches.first);
+                    similarity_it = resultsMap.find(avgPercentage);
+
                     // If there is an entry for this similarity, add the result set. Else, create a new similarity entry.
                     if (similarity_it != resultsMap.end())
                     {
-                        similarity_it->insert(*it,imageIdList);
+                        similarity_it->insert(imageid, imageIdList);
                     }
                     else
                     {
                         QMap<qlonglong,QList<qlonglong>> result;
-                        result.insert(*it, imageIdList);
-                        resultsMap.insert(bestMatches.first,result);
+                        result.insert(imageid, imageIdList);
+                        resultsMap.insert(avgPercentage, result);
                     }
-                    resultsCandidates << *it;
+
+                    resultsCandidates << imageid;
                     resultsCandidates.unite(imageIdList.toSet());
                 }
             }
-        }
-
-        // if an imageid is not a results candidate, remove it from the cached signature map as well,
-        // to greatly improve speed
-        if (!resultsCandidates.contains(*it))
-        {
-            d->signatureCache->remove(*it);
-        }
 
-        ++progress;
-
-        if (observer && (progress == total || progress % progressStep == 0))
-        {
-            observer->processedNumber(progress);
+            // if an imageid is not a results candidate, it is no longer a possible match of the following images
+            if (!resultsCandidates.contains(imageid))
+            {
+                removedTargets << imageid;
+            }
         }
     }
 
@@ -1150,49 +1099,172 @@ QMap< double,QMap< qlonglong,QList<qlonglong> > > HaarIface::findDuplicates(cons
         observer->processedNumber(total);
     }
 
-    // disable cache
-    d->setSignatureCacheEnabled(false);
-
     return resultsMap;
 }
 
-double HaarIface::calculateScore(Haar::SignatureData& querySig, Haar::SignatureData& targetSig,
-                                 Haar::Weights& weights, Haar::SignatureMap** const queryMaps)
+void HaarIface::findDuplicatesWorker(DuplicatesContext* const ctx, HaarProgressObserver* const observer)
 {
-    double score = 0.0;
+    // The table of constant weight factors applied to each channel and bin
+    Haar::Weights weights((Haar::Weights::SketchType)ctx->type);
 
-    // Step 1: Initialize scores with average intensity values of all three channels
-    for (int channel = 0; channel < 3; ++channel)
-    {
-        score += weights.weightForAverage(channel) * fabs( querySig.avg[channel] - targetSig.avg[channel] );
-    }
+    // layout the query signature for fast lookup
+    Haar::Scorer        scorer(weights, *d->bin);
 
-    // Step 2: Decrease the score if query and target have significant coefficients in common
-    Haar::Idx* sig               = 0;
-    Haar::SignatureMap* queryMap = 0;
-    int x                        = 0;
+    // Per thread accumulator of the weights of the coefficients in common with the query
+    QVector<double>     common(ctx->targets.count(), 0.0);
+    QVector<double>     allScores;
+    QVector<int>        touched;
+    QList<int>          targetAlbums;
 
-    for (int channel = 0; channel < 3; ++channel)
+    const int           queryCount   = ctx->queryIds.size();
+    const int           progressStep = qMax(20, queryCount / 100);
+    int                 lastProgress = 0;
+
+    // Rounding margin: the accumulated weights are summed in a different order than in the Scorer.
+    const double        epsilon      = 1.0E-6;
+
+    while (!ctx->canceled.load())
     {
-        sig      = targetSig.sig[channel];
-        queryMap = queryMaps[channel];
+        const int first = ctx->nextQuery.fetchAndAddOrdered(DuplicatesContext::ChunkSize);
 
-        for (int coef = 0; coef < Haar::NumberOfCoefficients; ++coef)
+        if (first >= queryCount)
         {
-            // x is a pixel index, either positive or negative, 0..16384
-            x = sig[coef];
+            break;
+        }
 
-            // If x is a significant coefficient with the same sign in the query signature as well,
-            // decrease the score (lower is better)
-            // Note: both method calls called with x accept positive or negative values
-            if ((*queryMap)[x])
+        const int last = qMin(first + (int)DuplicatesContext::ChunkSize, queryCount);
+
+        for (int i = first ; i < last ; ++i)
+        {
+            const qlonglong imageid = ctx->queryIds.at(i);
+            const int       pos     = ctx->positions.value(imageid, -1);
+
+            // No signature stored in the database for this image.
+            if (pos == -1)
             {
-                score -= weights.weight(d->bin->binAbs(x), channel);
+                continue;
             }
+
+            Haar::SignatureData querySig;
+            ctx->targets.signature(pos, &querySig);
+            const int albumId = ctx->targets.albums.at(pos);
+
+            double lowest, highest;
+            getBestAndWorstPossibleScore(&querySig, ctx->type, &lowest, &highest);
+
+            // See bestMatchesWithThreshold() for the meaning of these values.
+            double scoreRange      = highest - lowest;
+            double percentageRange = 1.0 - ctx->requiredPercentage;
+            double requiredScore   = lowest + scoreRange * percentageRange;
+            double supremum        = (floor(ctx->maximumPercentage*100 + 1.0))/100;
+
+            scorer.setQuery(querySig);
+
+            const QVector<int>* candidates = &ctx->allTargets;
+
+            // The average term of the score is never negative. If the required score is negative,
+            // a target can only match if the weights of the common coefficients compensate it,
+            // so only targets which have at least one coefficient in common need to be scored.
+            if (requiredScore < -epsilon)
+            {
+                touched.clear();
+
+                for (int channel = 0 ; channel < 3 ; ++channel)
+                {
+                    for (int coef = 0 ; coef < Haar::NumberOfCoefficients ; ++coef)
+                    {
+                        const Haar::Idx     x      = querySig.sig[channel][coef];
+                        const double        weight = weights.weight(d->bin->binAbs(x), channel);
+                        const QVector<int>& list   = ctx->postings.at(DuplicatesContext::postingKey(channel, x));
+
+                        foreach(int t, list)
+                        {
+                            if (common[t] == 0.0)
+                            {
+                                touched << t;
+                            }
+
+                            common[t] += weight;
+                        }
+                    }
+                }
+
+                const double minCommon = -requiredScore - epsilon;
+                int          count     = 0;
+
+                for (int j = 0 ; j < touched.size() ; ++j)
+                {
+                    const int t = touched.at(j);
+
+                    if (common.at(t) >= minCommon)
+                    {
+                        touched[count++] = t;
+                    }
+
+                    common[t] = 0.0;
+                }
+
+                touched.resize(count);
+                std::sort(touched.begin(), touched.end());
+                candidates = &touched;
+            }
+            else
+            {
+                // No pruning possible: score all targets in one pass
+                allScores.resize(ctx->targets.count());
+                scorer.score(ctx->targets.avg(0), ctx->targets.sig(0, 0), ctx->targets.count(), allScores.data());
+            }
+
+            const bool fullScan = (candidates == &ctx->allTargets);
+
+            QMap<qlonglong, double> matches;
+
+            foreach(int t, *candidates)
+            {
+                const qlonglong targetId = ctx->targets.ids.at(t);
+
+                if (!fulfillsRestrictions(targetId, ctx->targets.albums.at(t), imageid, albumId,
+                                          targetAlbums, ctx->searchResultRestriction))
+                {
+                    continue;
+                }
+
+                double score = fullScan ? allScores.at(t)
+                                        : scorer.score(ctx->targets.avg(t), ctx->targets.sig(t, 0));
+
+                // If the score of the picture is at most the required (maximum) score and
+                if (score <= requiredScore)
+                {
+                    double percentage = 1.0 - (score - lowest) / scoreRange;
+
+                    // If the found image is the original one (check by id) or the percentage is below the maximum.
+                    if ((targetId == imageid) || (percentage < supremum))
+                    {
+                        matches.insert(targetId, percentage);
+                    }
+                }
+            }
+
+            ctx->results[i] = matches;
+            ctx->done[i]    = true;
         }
-    }
 
-    return score;
+        const int progress = ctx->processed.fetchAndAddOrdered(last - first) + (last - first);
+
+        if (observer)
+        {
+            if (progress - lastProgress >= progressStep)
+            {
+                observer->processedNumber(progress);
+                lastProgress = progress;
+            }
+
+            if (observer->isCanceled())
+            {
+                ctx->canceled.store(1);
+            }
+        }
+    }
 }
 
 }  // namespace Digikam
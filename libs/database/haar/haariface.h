@@ -106,6 +106,14 @@ public:
     bool indexImage(qlonglong imageid, const QImage& image);
     bool indexImage(qlonglong imageid, const DImg& image);
 
+    /** In batched mode, the signatures computed by indexImage() are kept in memory
+     *  and written together by commitIndex(), in one database transaction.
+     *  Pending signatures are also written when batched mode is switched off
+     *  and when this object is destroyed.
+     */
+    void setIndexBatched(bool batched);
+    void commitIndex();
+
     /** Searches the database for the best matches for the specified query image.
      *  The numberOfResults best matches are returned.
      */
@@ -193,6 +201,7 @@ public:
                                  HaarProgressObserver* const observer = 0);
 
     /** Retrieve the Haar signature from database using image id.
+     *  The in-memory signature store is used if it holds the item.
      *  Return true if item signature exist else false.
      */
     bool retrieveSignatureFromDB(qlonglong imageid, Haar::SignatureData* const sig);
@@ -237,8 +246,15 @@ private:
     QMap<qlonglong, double> searchDatabase(Haar::SignatureData* const data, SketchType type, QList<int>& targetAlbums,
                                            DuplicatesSearchRestrictions searchResultRestriction = None,
                                            qlonglong originalImageId = -1, int albumId = -1);
-    double calculateScore(Haar::SignatureData& querySig, Haar::SignatureData& targetSig,
-                          Haar::Weights& weights, Haar::SignatureMap** const queryMaps);
+
+    /**
+     * Worker of findDuplicates(): takes chunks of query images from the shared context
+     * and scores them against the cached signatures, using the inverted coefficient index
+     * to skip all targets which cannot reach the required similarity.
+     * Can be run concurrently from several threads on the same context.
+     */
+    class DuplicatesContext;
+    void findDuplicatesWorker(DuplicatesContext* const ctx, HaarProgressObserver* const observer);
 
 private:
 
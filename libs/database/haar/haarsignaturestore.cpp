@@ -0,0 +1,601 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Flat in-memory store of Haar signatures
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "haarsignaturestore.h"
+
+// C++ includes
+
+#include <cstring>
+
+// Qt includes
+
+#include <QDataStream>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtEndian>
+
+// Local includes
+
+#include "digikam_debug.h"
+#include "coredbaccess.h"
+#include "coredb.h"
+#include "coredbbackend.h"
+#include "coredbwatch.h"
+#include "dbenginesqlcursor.h"
+
+namespace Digikam
+{
+
+void DatabaseBlob::read(const QByteArray& array, Haar::SignatureData* const data)
+{
+    QDataStream stream(array);
+
+    // check version
+    qint32 version;
+    stream >> version;
+
+    if (version != Version)
+    {
+        qCDebug(DIGIKAM_DATABASE_LOG) << "Unsupported binary version of Haar Blob in database";
+        return;
+    }
+
+    stream.setVersion(QDataStream::Qt_4_3);
+
+    // read averages
+    for (int i = 0; i < 3; ++i)
+    {
+        stream >> data->avg[i];
+    }
+
+    // read coefficients
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < Haar::NumberOfCoefficients; ++j)
+        {
+            stream >> data->sig[i][j];
+        }
+    }
+}
+
+bool DatabaseBlob::read(const QByteArray& array, double* const avg, Haar::Idx* const sig)
+{
+    if (array.size() < Size)
+    {
+        return false;
+    }
+
+    // Same layout as written by QDataStream: big endian integers and IEEE 754 doubles.
+    const uchar* p = reinterpret_cast<const uchar*>(array.constData());
+
+    if (qFromBigEndian<qint32>(p) != Version)
+    {
+        qCDebug(DIGIKAM_DATABASE_LOG) << "Unsupported binary version of Haar Blob in database";
+        return false;
+    }
+
+    p += sizeof(qint32);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        quint64 bits = qFromBigEndian<quint64>(p);
+        memcpy(&avg[i], &bits, sizeof(double));
+        p           += sizeof(quint64);
+    }
+
+    for (int i = 0; i < 3 * Haar::NumberOfCoefficients; ++i)
+    {
+        sig[i] = qFromBigEndian<qint32>(p);
+        p     += sizeof(qint32);
+    }
+
+    return true;
+}
+
+QByteArray DatabaseBlob::write(Haar::SignatureData* const data)
+{
+    QByteArray array;
+    array.reserve(Size);
+    QDataStream stream(&array, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_3);
+
+    // write version
+    stream << (qint32)Version;
+
+    // write averages
+    for (int i = 0; i < 3; ++i)
+    {
+        stream << data->avg[i];
+    }
+
+    // write coefficients
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < Haar::NumberOfCoefficients; ++j)
+        {
+            stream << data->sig[i][j];
+        }
+    }
+
+    return array;
+}
+
+// -----------------------------------------------------------------------------------------------------
+
+void HaarSignatureTable::signature(int pos, Haar::SignatureData* const data) const
+{
+    memcpy(data->avg, avg(pos), 3 * sizeof(double));
+
+    for (int channel = 0; channel < 3; ++channel)
+    {
+        memcpy(data->sig[channel], sig(pos, channel), Haar::NumberOfCoefficients * sizeof(Haar::Idx));
+    }
+}
+
+void HaarSignatureTable::append(qlonglong imageid, int album, int albumRoot,
+                                const double* const avg, const Haar::Idx* const sig)
+{
+    const int size = coefficients.size();
+
+    ids          << imageid;
+    albums       << album;
+    albumRoots   << albumRoot;
+    averages     << avg[0] << avg[1] << avg[2];
+    coefficients.resize(size + 3 * Haar::NumberOfCoefficients);
+    memcpy(coefficients.data() + size, sig, 3 * Haar::NumberOfCoefficients * sizeof(Haar::Idx));
+}
+
+void HaarSignatureTable::append(const HaarSignatureTable& other, int pos)
+{
+    append(other.ids.at(pos), other.albums.at(pos), other.albumRoots.at(pos), other.avg(pos), other.sig(pos, 0));
+}
+
+// -----------------------------------------------------------------------------------------------------
+
+class HaarSignatureStore::Private
+{
+public:
+
+    enum
+    {
+        /// Maximum number of ids read back with one query when updating the store
+        IdsPerQuery = 500
+    };
+
+public:
+
+    Private()
+        : loaded(false),
+          loading(false),
+          generation(0)
+    {
+        signatureQuery = QString::fromUtf8("SELECT M.imageid, Albums.albumRoot, M.matrix, Images.album "
+                                           " FROM ImageHaarMatrix AS M "
+                                           "    INNER JOIN Images ON Images.id=M.imageid "
+                                           "    INNER JOIN Albums ON Albums.id=Images.album"
+                                           " WHERE Images.status=1");
+    }
+
+    /// Reads all rows of the cursor into the table. Called without the lock.
+    static void readRows(DbEngineSqlCursor& cursor, HaarSignatureTable& rows)
+    {
+        DatabaseBlob blob;
+        double       avg[3];
+        Haar::Idx    sig[3 * Haar::NumberOfCoefficients];
+
+        while (cursor.next())
+        {
+            if (!blob.read(cursor.value(2).toByteArray(), avg, sig))
+            {
+                continue;
+            }
+
+            rows.append(cursor.toLongLong(0), cursor.toInt(3), cursor.toInt(1), avg, sig);
+        }
+    }
+
+    /// Fills the table with all signatures. Called without the lock.
+    void loadAll(HaarSignatureTable& rows)
+    {
+        CoreDbAccess      access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(signatureQuery);
+
+        readRows(cursor, rows);
+    }
+
+    /// Fills the table with the signatures of the given images. Called without the lock.
+    void loadIds(const QList<qlonglong>& imageIds, HaarSignatureTable& rows)
+    {
+        CoreDbAccess access;
+
+        for (int i = 0; i < imageIds.size(); i += IdsPerQuery)
+        {
+            QList<qlonglong> chunk = imageIds.mid(i, IdsPerQuery);
+            QList<QVariant>  boundValues;
+            QString          sql   = signatureQuery + QString::fromUtf8(" AND M.imageid IN (");
+            CoreDB::addBoundValuePlaceholders(sql, chunk.size());
+            sql                   += QString::fromUtf8(");");
+
+            foreach(const qlonglong& id, chunk)
+            {
+                boundValues << id;
+            }
+
+            DbEngineSqlCursor cursor = access.backend()->execCursor(sql, boundValues);
+            readRows(cursor, rows);
+        }
+    }
+
+    /// Called under write lock
+    void setTable(const HaarSignatureTable& rows)
+    {
+        table = rows;
+        positions.clear();
+        positions.reserve(table.count());
+
+        for (int pos = 0; pos < table.count(); ++pos)
+        {
+            positions.insert(table.ids.at(pos), pos);
+        }
+    }
+
+    /// Called under write lock
+    void insert(const HaarSignatureTable& rows, int pos)
+    {
+        removeImage(rows.ids.at(pos));
+        positions.insert(rows.ids.at(pos), table.count());
+        table.append(rows, pos);
+    }
+
+    /// Called under write lock. The last entry is moved to the position of the removed one.
+    void removeImage(qlonglong imageid)
+    {
+        QHash<qlonglong, int>::iterator it = positions.find(imageid);
+
+        if (it == positions.end())
+        {
+            return;
+        }
+
+        const int pos  = it.value();
+        const int last = table.count() - 1;
+        positions.erase(it);
+
+        if (pos != last)
+        {
+            const qlonglong lastId = table.ids.at(last);
+
+            table.ids[pos]         = lastId;
+            table.albums[pos]      = table.albums.at(last);
+            table.albumRoots[pos]  = table.albumRoots.at(last);
+            memcpy(table.averages.data() + 3 * pos, table.averages.constData() + 3 * last, 3 * sizeof(double));
+            memcpy(table.coefficients.data()     + 3 * Haar::NumberOfCoefficients * pos,
+                   table.coefficients.constData() + 3 * Haar::NumberOfCoefficients * last,
+                   3 * Haar::NumberOfCoefficients * sizeof(Haar::Idx));
+            positions[lastId]      = pos;
+        }
+
+        table.ids.resize(last);
+        table.albums.resize(last);
+        table.albumRoots.resize(last);
+        table.averages.resize(3 * last);
+        table.coefficients.resize(3 * Haar::NumberOfCoefficients * last);
+    }
+
+public:
+
+    QString               signatureQuery;
+
+    /// Serializes loading from the database. Never acquired while holding the lock.
+    QMutex                loadMutex;
+    QReadWriteLock        lock;
+
+    bool                  loaded;
+    bool                  loading;
+    int                   generation;
+    HaarSignatureTable    table;
+    QHash<qlonglong, int> positions;
+
+    /// Images to read again from the database at next access
+    QSet<qlonglong>       dirtyIds;
+
+    /// Images removed while an update from the database was running
+    QSet<qlonglong>       removedIds;
+};
+
+// -----------------------------------------------------------------------------------------------------
+
+class HaarSignatureStoreCreator
+{
+public:
+
+    HaarSignatureStore object;
+};
+
+Q_GLOBAL_STATIC(HaarSignatureStoreCreator, creator)
+
+// -----------------------------------------------------------------------------------------------------
+
+HaarSignatureStore* HaarSignatureStore::instance()
+{
+    return &creator->object;
+}
+
+HaarSignatureStore::HaarSignatureStore()
+    : d(new Private)
+{
+    CoreDbWatch* const dbwatch = CoreDbAccess::databaseWatch();
+
+    // NOTE: changesets are sent with the database lock held. The slots only touch the store lock.
+
+    connect(dbwatch, SIGNAL(collectionImageChange(CollectionImageChangeset)),
+            this, SLOT(slotCollectionImageChange(CollectionImageChangeset)),
+            Qt::DirectConnection);
+
+    connect(dbwatch, SIGNAL(albumRootChange(AlbumRootChangeset)),
+            this, SLOT(slotAlbumRootChange(AlbumRootChangeset)),
+            Qt::DirectConnection);
+
+    connect(dbwatch, SIGNAL(imageChange(ImageChangeset)),
+            this, SLOT(slotImageChange(ImageChangeset)),
+            Qt::DirectConnection);
+
+    connect(dbwatch, SIGNAL(databaseChanged()),
+            this, SLOT(invalidate()),
+            Qt::DirectConnection);
+}
+
+HaarSignatureStore::~HaarSignatureStore()
+{
+    delete d;
+}
+
+HaarSignatureTable HaarSignatureStore::table()
+{
+    QMutexLocker loadLocker(&d->loadMutex);
+
+    bool             loadAll;
+    int              generation;
+    QList<qlonglong> dirtyIds;
+
+    {
+        QWriteLocker locker(&d->lock);
+        loadAll    = !d->loaded;
+        generation = d->generation;
+        d->loading = true;
+        dirtyIds   = d->dirtyIds.toList();
+        d->dirtyIds.clear();
+        d->removedIds.clear();
+
+        if (!loadAll && dirtyIds.isEmpty())
+        {
+            d->loading = false;
+            return d->table;
+        }
+    }
+
+    // Read from the database without holding the lock, see the note in the constructor.
+
+    HaarSignatureTable rows;
+
+    if (loadAll)
+    {
+        d->loadAll(rows);
+    }
+    else
+    {
+        d->loadIds(dirtyIds, rows);
+    }
+
+    QWriteLocker locker(&d->lock);
+    d->loading = false;
+
+    if (generation != d->generation)
+    {
+        // Invalidated meanwhile: use the data this time, but load again next time.
+        return rows;
+    }
+
+    if (loadAll)
+    {
+        d->setTable(rows);
+        d->loaded = true;
+
+        foreach(const qlonglong& imageid, d->removedIds)
+        {
+            d->removeImage(imageid);
+        }
+
+        qCDebug(DIGIKAM_DATABASE_LOG) << "Loaded" << d->table.count() << "Haar signatures";
+    }
+    else
+    {
+        // Images not found anymore have no signature or are not visible.
+        foreach(const qlonglong& imageid, dirtyIds)
+        {
+            d->removeImage(imageid);
+        }
+
+        for (int pos = 0; pos < rows.count(); ++pos)
+        {
+            if (!d->removedIds.contains(rows.ids.at(pos)))
+            {
+                d->insert(rows, pos);
+            }
+        }
+    }
+
+    d->removedIds.clear();
+
+    return d->table;
+}
+
+bool HaarSignatureStore::signature(qlonglong imageid, Haar::SignatureData* const sig)
+{
+    QReadLocker locker(&d->lock);
+
+    if (!d->loaded || d->dirtyIds.contains(imageid))
+    {
+        return false;
+    }
+
+    QHash<qlonglong, int>::const_iterator it = d->positions.constFind(imageid);
+
+    if (it == d->positions.constEnd())
+    {
+        return false;
+    }
+
+    d->table.signature(it.value(), sig);
+
+    return true;
+}
+
+void HaarSignatureStore::signatureChanged(qlonglong imageid)
+{
+    QWriteLocker locker(&d->lock);
+
+    if (d->loaded || d->loading)
+    {
+        d->dirtyIds << imageid;
+    }
+}
+
+void HaarSignatureStore::invalidate()
+{
+    QWriteLocker locker(&d->lock);
+
+    d->loaded = false;
+    d->generation++;
+    d->setTable(HaarSignatureTable());
+    d->dirtyIds.clear();
+    d->removedIds.clear();
+}
+
+void HaarSignatureStore::remove(qlonglong imageid)
+{
+    // Called under write lock
+    d->removeImage(imageid);
+    d->dirtyIds.remove(imageid);
+    d->removedIds << imageid;
+}
+
+void HaarSignatureStore::slotCollectionImageChange(const CollectionImageChangeset& changeset)
+{
+    QWriteLocker locker(&d->lock);
+
+    // Nothing to update as long as the store was never used.
+    if (!d->loaded && !d->loading)
+    {
+        return;
+    }
+
+    switch (changeset.operation())
+    {
+        case CollectionImageChangeset::Added:
+        {
+            foreach(const qlonglong& imageid, changeset.ids())
+            {
+                d->dirtyIds << imageid;
+            }
+
+            break;
+        }
+        case CollectionImageChangeset::Removed:
+        case CollectionImageChangeset::Deleted:
+        case CollectionImageChangeset::RemovedDeleted:
+        {
+            foreach(const qlonglong& imageid, changeset.ids())
+            {
+                remove(imageid);
+            }
+
+            break;
+        }
+        case CollectionImageChangeset::RemovedAll:
+        {
+            QList<qlonglong> imageIds;
+
+            for (int pos = 0; pos < d->table.count(); ++pos)
+            {
+                if (changeset.containsAlbum(d->table.albums.at(pos)))
+                {
+                    imageIds << d->table.ids.at(pos);
+                }
+            }
+
+            foreach(const qlonglong& imageid, imageIds)
+            {
+                remove(imageid);
+            }
+
+            break;
+        }
+        case CollectionImageChangeset::Moved:
+        case CollectionImageChangeset::Copied:
+        {
+            // Extra information: Added and Removed changesets follow.
+            break;
+        }
+        default:
+        {
+            locker.unlock();
+            invalidate();
+            break;
+        }
+    }
+}
+
+void HaarSignatureStore::slotImageChange(const ImageChangeset& changeset)
+{
+    // Trashed, obsolete or hidden images are not visible any more, and restored ones are again.
+    if (!(changeset.changes() & DatabaseFields::Status))
+    {
+        return;
+    }
+
+    QWriteLocker locker(&d->lock);
+
+    if (!d->loaded && !d->loading)
+    {
+        return;
+    }
+
+    foreach(const qlonglong& imageid, changeset.ids())
+    {
+        d->dirtyIds << imageid;
+    }
+}
+
+void HaarSignatureStore::slotAlbumRootChange(const AlbumRootChangeset&)
+{
+    // Rare: the album root of all signatures has to be read again.
+    invalidate();
+}
+
+}  // namespace Digikam
@@ -0,0 +1,188 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Flat in-memory store of Haar signatures
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef HAARSIGNATURESTORE_H
+#define HAARSIGNATURESTORE_H
+
+// Qt includes
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+
+// Local includes
+
+#include "haar.h"
+#include "coredbchangesets.h"
+
+namespace Digikam
+{
+
+/** This class encapsulates the Haar signature in a QByteArray
+ *  that can be stored as a BLOB in the database.
+ *
+ *  Reading and writing is done in a platform-independent manner, which
+ *  induces a certain overhead, but which is necessary IMO.
+ */
+class DatabaseBlob
+{
+public:
+
+    enum
+    {
+        Version = 1
+    };
+
+    /** Size in bytes of a blob of the current version.
+     */
+    enum
+    {
+        Size = sizeof(qint32) + 3*sizeof(double) + 3*sizeof(qint32)*Haar::NumberOfCoefficients
+    };
+
+public:
+
+    DatabaseBlob()
+    {
+    }
+
+    /** Read the QByteArray into the Haar::SignatureData.
+     */
+    void read(const QByteArray& array, Haar::SignatureData* const data);
+
+    /** Read the QByteArray directly into flat arrays of 3 averages
+     *  and 3*NumberOfCoefficients coefficients.
+     *  The big endian data is decoded in place, without a QDataStream.
+     *  Returns false if the blob is not valid.
+     */
+    bool read(const QByteArray& array, double* const avg, Haar::Idx* const sig);
+
+    QByteArray write(Haar::SignatureData* const data);
+};
+
+// -----------------------------------------------------------------------------------------------------
+
+/** A structure-of-arrays table of signatures: item n has its three averages
+ *  at averages[3*n] and its 3*40 coefficients, channel after channel, at coefficients[120*n].
+ *  All members are implicitly shared, so a copy of a table is cheap and stays
+ *  valid while the store is updated.
+ */
+class HaarSignatureTable
+{
+public:
+
+    int count() const
+    {
+        return ids.size();
+    }
+
+    const double* avg(int pos) const
+    {
+        return averages.constData() + 3 * pos;
+    }
+
+    const Haar::Idx* sig(int pos, int channel) const
+    {
+        return coefficients.constData() + (3 * pos + channel) * Haar::NumberOfCoefficients;
+    }
+
+    /// Copy the signature at position pos to the classic structure
+    void signature(int pos, Haar::SignatureData* const data) const;
+
+    /// Add an entry at the end of the table. sig holds the 3*40 coefficients.
+    void append(qlonglong imageid, int album, int albumRoot,
+                const double* const avg, const Haar::Idx* const sig);
+
+    /// Add a copy of the entry at position pos of the other table
+    void append(const HaarSignatureTable& other, int pos);
+
+public:
+
+    QVector<qlonglong> ids;
+    QVector<int>       albums;
+    QVector<int>       albumRoots;
+    QVector<double>    averages;
+    QVector<Haar::Idx> coefficients;
+};
+
+// -----------------------------------------------------------------------------------------------------
+
+/** Process-wide cache of all Haar signatures of visible images.
+ *
+ *  The signatures are read once from the database at first use. Afterwards, only
+ *  the images reported by CoreDbWatch as added or removed, and the images indexed by
+ *  HaarIface, are read again, lazily, at the next access.
+ *  All methods are thread-safe.
+ */
+// No EXPORT class
+class HaarSignatureStore : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    static HaarSignatureStore* instance();
+
+    /** Returns a table with the current signatures, loading or updating it from the database if needed.
+     *  Do not call this while holding a CoreDbAccess.
+     */
+    HaarSignatureTable table();
+
+    /** Retrieves the signature of the given image, if stored. Does not access the database.
+     */
+    bool signature(qlonglong imageid, Haar::SignatureData* const sig);
+
+    /** Tell the store that the signature of the given image was written to the database.
+     */
+    void signatureChanged(qlonglong imageid);
+
+public Q_SLOTS:
+
+    /** Discard all data. The store is entirely reloaded at next access.
+     */
+    void invalidate();
+
+private Q_SLOTS:
+
+    void slotCollectionImageChange(const CollectionImageChangeset& changeset);
+    void slotImageChange(const ImageChangeset& changeset);
+    void slotAlbumRootChange(const AlbumRootChangeset& changeset);
+
+private:
+
+    HaarSignatureStore();
+    ~HaarSignatureStore();
+
+    void remove(qlonglong imageid);
+
+private:
+
+    class Private;
+    Private* const d;
+
+    friend class HaarSignatureStoreCreator;
+};
+
+}  // namespace Digikam
+
+#endif // HAARSIGNATURESTORE_H
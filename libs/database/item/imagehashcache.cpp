@@ -0,0 +1,379 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Cache of unique hashes by file system identity
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "imagehashcache.h"
+
+// C++ includes
+
+#ifndef Q_OS_WIN
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#endif
+
+// Qt includes
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVariant>
+
+// Local includes
+
+#include "coredbaccess.h"
+#include "coredbbackend.h"
+#include "coredbtransaction.h"
+#include "dbenginesqlcursor.h"
+
+namespace Digikam
+{
+
+#ifndef Q_OS_WIN
+
+static qlonglong nanoSeconds(const struct timespec& time)
+{
+    return (qlonglong)time.tv_sec * 1000000000LL + (qlonglong)time.tv_nsec;
+}
+
+#endif
+
+ImageHashCache::FileId::FileId()
+    : device(0),
+      inode(0),
+      fileSize(-1),
+      modificationTime(-1),
+      changeTime(-1)
+{
+}
+
+ImageHashCache::FileId ImageHashCache::FileId::fromFile(const QString& filePath)
+{
+    FileId id;
+
+#ifndef Q_OS_WIN
+    // On Windows, stat() does not return file identifiers.
+    struct stat st;
+
+    if (::stat(QFile::encodeName(filePath).constData(), &st) == 0)
+    {
+        id.device           = (qlonglong)st.st_dev;
+        id.inode            = (qlonglong)st.st_ino;
+        id.fileSize         = (qlonglong)st.st_size;
+#   ifdef Q_OS_OSX
+        id.modificationTime = nanoSeconds(st.st_mtimespec);
+        id.changeTime       = nanoSeconds(st.st_ctimespec);
+#   else
+        id.modificationTime = nanoSeconds(st.st_mtim);
+        id.changeTime       = nanoSeconds(st.st_ctim);
+#   endif
+        id.filePath         = filePath;
+    }
+#else
+    Q_UNUSED(filePath);
+#endif
+
+    return id;
+}
+
+bool ImageHashCache::FileId::isValid() const
+{
+    return (inode != 0);
+}
+
+bool ImageHashCache::FileId::operator==(const FileId& other) const
+{
+    return (device           == other.device           &&
+            inode            == other.inode            &&
+            fileSize         == other.fileSize         &&
+            modificationTime == other.modificationTime &&
+            changeTime       == other.changeTime);
+}
+
+// ---------------------------------------------------------------------------------------
+
+class ImageHashCache::Private
+{
+public:
+
+    typedef QPair<qlonglong, qlonglong> Key;
+
+    class Entry
+    {
+    public:
+
+        FileId  id;
+        QString uniqueHash;
+    };
+
+public:
+
+    Private()
+        : preloaded(false)
+    {
+    }
+
+    static Key key(const FileId& id)
+    {
+        return qMakePair(id.device, id.inode);
+    }
+
+    static FileId fileId(const DbEngineSqlCursor& cursor, int column);
+
+    void record(const FileId& id, const QString& uniqueHash);
+
+public:
+
+    bool                           preloaded;
+    QHash<Key, Entry>              entries;
+
+    QList<QPair<FileId, QString> > pending;
+
+    mutable QMutex                 mutex;
+};
+
+ImageHashCache::FileId ImageHashCache::Private::fileId(const DbEngineSqlCursor& cursor, int column)
+{
+    FileId id;
+    id.device           = cursor.toLongLong(column);
+    id.inode            = cursor.toLongLong(column + 1);
+    id.fileSize         = cursor.toLongLong(column + 2);
+    id.modificationTime = cursor.toLongLong(column + 3);
+    id.changeTime       = cursor.toLongLong(column + 4);
+    id.filePath         = cursor.toString(column + 5);
+
+    return id;
+}
+
+void ImageHashCache::Private::record(const FileId& id, const QString& uniqueHash)
+{
+    QMutexLocker locker(&mutex);
+
+    pending << qMakePair(id, uniqueHash);
+
+    if (preloaded)
+    {
+        Entry entry;
+        entry.id         = id;
+        entry.uniqueHash = uniqueHash;
+
+        entries.insert(key(id), entry);
+    }
+}
+
+ImageHashCache::ImageHashCache()
+    : d(new Private)
+{
+}
+
+ImageHashCache::~ImageHashCache()
+{
+    delete d;
+}
+
+void ImageHashCache::preload()
+{
+    QHash<Private::Key, Private::Entry> entries;
+
+    {
+        CoreDbAccess access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(QString::fromUtf8(
+                                       "SELECT device, inode, fileSize, modificationTime, changeTime, filePath, "
+                                       "uniqueHash FROM ImageHashCache;"));
+
+        while (cursor.next())
+        {
+            Private::Entry entry;
+            entry.id         = Private::fileId(cursor, 0);
+            entry.uniqueHash = cursor.toString(6);
+
+            entries.insert(Private::key(entry.id), entry);
+        }
+    }
+
+    QMutexLocker locker(&d->mutex);
+    d->entries   = entries;
+    d->preloaded = true;
+}
+
+bool ImageHashCache::isPreloaded() const
+{
+    QMutexLocker locker(&d->mutex);
+
+    return d->preloaded;
+}
+
+QString ImageHashCache::find(const FileId& id) const
+{
+    if (!id.isValid())
+    {
+        return QString();
+    }
+
+    Private::Entry entry;
+    bool           preloaded;
+
+    {
+        QMutexLocker locker(&d->mutex);
+        preloaded = d->preloaded;
+
+        if (preloaded)
+        {
+            entry = d->entries.value(Private::key(id));
+        }
+    }
+
+    if (!preloaded)
+    {
+        QList<QVariant> values;
+
+        CoreDbAccess().backend()->execSql(QString::fromUtf8("SELECT fileSize, modificationTime, changeTime, filePath, "
+                                                            "uniqueHash FROM ImageHashCache WHERE device=? AND inode=?;"),
+                                          id.device, id.inode, &values);
+
+        if (values.size() == 5)
+        {
+            entry.id                  = id;
+            entry.id.fileSize         = values.at(0).toLongLong();
+            entry.id.modificationTime = values.at(1).toLongLong();
+            entry.id.changeTime       = values.at(2).toLongLong();
+            entry.id.filePath         = values.at(3).toString();
+            entry.uniqueHash          = values.at(4).toString();
+        }
+    }
+
+    if (!(entry.id == id))
+    {
+        return QString();
+    }
+
+    if (entry.id.filePath != id.filePath)
+    {
+        // Record where the file is now, so that prune() keeps the entry
+        d->record(id, entry.uniqueHash);
+    }
+
+    return entry.uniqueHash;
+}
+
+void ImageHashCache::insert(const FileId& id, const QString& uniqueHash)
+{
+    if (!id.isValid() || uniqueHash.isEmpty())
+    {
+        return;
+    }
+
+    d->record(id, uniqueHash);
+}
+
+void ImageHashCache::commit()
+{
+    QList<QPair<FileId, QString> > pending;
+
+    {
+        QMutexLocker locker(&d->mutex);
+        pending.swap(d->pending);
+    }
+
+    if (pending.isEmpty())
+    {
+        return;
+    }
+
+    CoreDbAccess access;
+    CoreDbTransaction transaction(&access);
+
+    for (int i = 0 ; i < pending.size() ; ++i)
+    {
+        const FileId& id = pending.at(i).first;
+
+        access.backend()->execSql(QString::fromUtf8("REPLACE INTO ImageHashCache "
+                                                    " (device, inode, fileSize, modificationTime, changeTime, "
+                                                    "  filePath, uniqueHash) "
+                                                    " VALUES (?, ?, ?, ?, ?, ?, ?);"),
+                                  QList<QVariant>() << id.device << id.inode << id.fileSize
+                                                    << id.modificationTime << id.changeTime
+                                                    << id.filePath << pending.at(i).second);
+    }
+}
+
+void ImageHashCache::prune()
+{
+    // Pending hashes were just computed, write them first so that they are checked as well
+    commit();
+
+    QList<FileId> cached;
+
+    {
+        CoreDbAccess access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(QString::fromUtf8(
+                                       "SELECT device, inode, fileSize, modificationTime, changeTime, filePath "
+                                       "FROM ImageHashCache;"));
+
+        while (cursor.next())
+        {
+            cached << Private::fileId(cursor, 0);
+        }
+    }
+
+    // The files are checked without holding the database
+
+    QList<FileId> stale;
+
+    foreach(const FileId& id, cached)
+    {
+        if (!(FileId::fromFile(id.filePath) == id))
+        {
+            stale << id;
+        }
+    }
+
+    if (stale.isEmpty())
+    {
+        return;
+    }
+
+    {
+        CoreDbAccess access;
+        CoreDbTransaction transaction(&access);
+
+        foreach(const FileId& id, stale)
+        {
+            access.backend()->execSql(QString::fromUtf8("DELETE FROM ImageHashCache WHERE device=? AND inode=?;"),
+                                      id.device, id.inode);
+        }
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    if (d->preloaded)
+    {
+        foreach(const FileId& id, stale)
+        {
+            d->entries.remove(Private::key(id));
+        }
+    }
+}
+
+} // namespace Digikam
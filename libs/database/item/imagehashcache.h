@@ -0,0 +1,130 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : Cache of unique hashes by file system identity
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef IMAGEHASHCACHE_H
+#define IMAGEHASHCACHE_H
+
+// Qt includes
+
+#include <QString>
+
+// Local includes
+
+#include "digikam_export.h"
+
+namespace Digikam
+{
+
+/**
+ * Remembers the unique hash (version 2) of files by their device and inode numbers,
+ * so that a file which was already hashed is not read again as long as its size,
+ * its modification time and its status change time are unchanged. Both times are
+ * compared with the precision of the file system, up to nanoseconds.
+ * The cache is kept in the ImageHashCache table of the core database.
+ *
+ * By default, find() queries the database for each file. After preload(), the whole
+ * table is held in memory, and find() and insert() never access the database, so they
+ * can be used from several threads while the database is locked by another thread.
+ * Inserted hashes are written by commit(). prune() drops the entries of files
+ * which were deleted or changed since.
+ */
+class DIGIKAM_DATABASE_EXPORT ImageHashCache
+{
+public:
+
+    class FileId
+    {
+    public:
+
+        FileId();
+
+        /**
+         * Reads the identity of the file from the file system.
+         * Returns an invalid id if the platform has no stable inode numbers.
+         */
+        static FileId fromFile(const QString& filePath);
+
+        bool isValid() const;
+
+        /**
+         * True if both ids describe the same, unchanged file. The path is not compared.
+         */
+        bool operator==(const FileId& other) const;
+
+    public:
+
+        qlonglong device;
+        qlonglong inode;
+        qlonglong fileSize;
+        qlonglong modificationTime;     ///< in ns since the epoch
+        qlonglong changeTime;           ///< in ns since the epoch
+        QString   filePath;             ///< where the file was seen last
+    };
+
+public:
+
+    ImageHashCache();
+    ~ImageHashCache();
+
+    /**
+     * Loads all cached hashes. Needs the database.
+     */
+    void    preload();
+    bool    isPreloaded() const;
+
+    /**
+     * Returns the cached hash of the file, or a null string if it is unknown or outdated.
+     */
+    QString find(const FileId& id) const;
+
+    /**
+     * Records the hash of the file, to be written by the next commit().
+     */
+    void    insert(const FileId& id, const QString& uniqueHash);
+
+    /**
+     * Writes the recorded hashes to the database. Needs the database.
+     */
+    void    commit();
+
+    /**
+     * Removes the entries of files which are gone, or which changed since they were hashed.
+     * Checks each cached file on disk. Needs the database.
+     */
+    void    prune();
+
+private:
+
+    // Not copyable
+    ImageHashCache(const ImageHashCache&);
+    ImageHashCache& operator=(const ImageHashCache&);
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // IMAGEHASHCACHE_H
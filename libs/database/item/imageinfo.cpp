@@ -247,12 +247,21 @@ ImageInfo::ImageInfo(const ImageListerRecord& record)
 {
     m_data                         = ImageInfoStatic::cache()->infoForId(record.imageID);
 
-    ImageInfoWriteLocker lock;
-    bool newlyCreated              = m_data->albumId == -1;
+    {
+        ImageInfoWriteLocker lock;
+        bool newlyCreated          = m_data->albumId == -1;
 
-    m_data->albumId                = record.albumID;
-    m_data->albumRootId            = record.albumRootID;
-    m_data->name                   = record.name;
+        m_data->albumId            = record.albumID;
+        m_data->albumRootId        = record.albumRootID;
+        m_data->name               = record.name;
+
+        if (newlyCreated)
+        {
+            ImageInfoStatic::cache()->cacheByName(m_data);
+        }
+    }
+
+    ImageInfoWriteLocker lock(m_data);
 
     m_data->rating                 = record.rating;
     m_data->category               = record.category;
@@ -277,11 +286,6 @@ ImageInfo::ImageInfo(const ImageListerRecord& record)
     m_data->hasVideoMetadata       = true;
     m_data->hasImageMetadata       = true;
     m_data->databaseFieldsHashRaw.clear();
-
-    if (newlyCreated)
-    {
-        ImageInfoStatic::cache()->cacheByName(m_data);
-    }
 }
 
 ImageInfo::ImageInfo(qlonglong ID)
@@ -494,20 +498,20 @@ QString ImageInfo::name() const
     return m_data->name;
 }
 
-#define RETURN_IF_CACHED(x)       \
-    if (m_data->x##Cached)        \
-    {                             \
-        ImageInfoReadLocker lock; \
-        if (m_data->x##Cached)    \
-        {                         \
-            return m_data->x;     \
-        }                         \
+#define RETURN_IF_CACHED(x)               \
+    if (m_data->x##Cached)                \
+    {                                     \
+        ImageInfoReadLocker lock(m_data); \
+        if (m_data->x##Cached)            \
+        {                                 \
+            return m_data->x;             \
+        }                                 \
     }
 
 #define RETURN_ASPECTRATIO_IF_IMAGESIZE_CACHED()       \
     if (m_data->imageSizeCached)  \
     {                             \
-        ImageInfoReadLocker lock; \
+        ImageInfoReadLocker lock(m_data); \
         if (m_data->imageSizeCached)    \
         {                         \
     return (double)m_data->imageSize.width()/m_data->imageSize.height();     \
@@ -515,7 +519,7 @@ QString ImageInfo::name() const
     }
 
 #define STORE_IN_CACHE_AND_RETURN(x, retrieveMethod) \
-    ImageInfoWriteLocker lock;                       \
+    ImageInfoWriteLocker lock(m_data);               \
     m_data.constCastData()->x##Cached = true;        \
     if (!values.isEmpty())                           \
     {                                                \
@@ -553,7 +557,7 @@ QString ImageInfo::title() const
         title = comments.defaultComment(DatabaseComment::Title);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->defaultTitle       = title;
     m_data.constCastData()->defaultTitleCached = true;
     return m_data->defaultTitle;
@@ -575,7 +579,7 @@ QString ImageInfo::comment() const
         comment = comments.defaultComment();
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->defaultComment       = comment;
     m_data.constCastData()->defaultCommentCached = true;
     return m_data->defaultComment;
@@ -604,7 +608,7 @@ int ImageInfo::pickLabel() const
 
     int pickLabel = TagsCache::instance()->pickLabelFromTags(tagIds());
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->pickLabel       = (pickLabel == -1) ? NoPickLabel : pickLabel;
     m_data.constCastData()->pickLabelCached = true;
     return m_data->pickLabel;
@@ -621,7 +625,7 @@ int ImageInfo::colorLabel() const
 
     int colorLabel = TagsCache::instance()->colorLabelFromTags(tagIds());
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->colorLabel       = (colorLabel == -1) ? NoColorLabel : colorLabel;
     m_data.constCastData()->colorLabelCached = true;
     return m_data->colorLabel;
@@ -697,7 +701,7 @@ QSize ImageInfo::dimensions() const
 
     RETURN_IF_CACHED(imageSize)
     QVariantList values = CoreDbAccess().db()->getImageInformation(m_data->id, DatabaseFields::Width | DatabaseFields::Height);
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->imageSizeCached = true;
 
     if (values.size() == 2)
@@ -718,7 +722,7 @@ QList<int> ImageInfo::tagIds() const
     RETURN_IF_CACHED(tagIds)
 
     QList<int> ids = CoreDbAccess().db()->getItemTagIDs(m_data->id);
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->tagIds       = ids;
     m_data.constCastData()->tagIdsCached = true;
     return ids;
@@ -728,8 +732,6 @@ void ImageInfoList::loadTagIds() const
 {
     QVector<QList<int> > allTagIds = CoreDbAccess().db()->getItemsTagIDs(toImageIdList());
 
-    ImageInfoWriteLocker lock;
-
     for (int i = 0 ; i < size() ; i++)
     {
         const ImageInfo& info = at(i);
@@ -740,11 +742,234 @@ void ImageInfoList::loadTagIds() const
             continue;
         }
 
+        ImageInfoWriteLocker lock(info.m_data);
         info.m_data.constCastData()->tagIds       = ids;
         info.m_data.constCastData()->tagIdsCached = true;
     }
 }
 
+void ImageInfoList::loadFields(const DatabaseFields::Set& fields) const
+{
+    const DatabaseFields::Images imagesFields         = fields.getImages() &
+                                                        (DatabaseFields::Category         |
+                                                         DatabaseFields::ModificationDate |
+                                                         DatabaseFields::FileSize);
+    DatabaseFields::ImageInformation infoFields       = fields.getImageInformation() &
+                                                        (DatabaseFields::Rating       |
+                                                         DatabaseFields::CreationDate |
+                                                         DatabaseFields::Width        |
+                                                         DatabaseFields::Height       |
+                                                         DatabaseFields::Format);
+    const bool loadLabels                             = fields.getImageInformation() &
+                                                        (DatabaseFields::ColorLabel |
+                                                         DatabaseFields::PickLabel);
+
+    // The cache stores the image size as a whole
+
+    if (infoFields & (DatabaseFields::Width | DatabaseFields::Height))
+    {
+        infoFields |= DatabaseFields::Width | DatabaseFields::Height;
+    }
+
+    if (imagesFields == DatabaseFields::ImagesNone && infoFields == DatabaseFields::ImageInformationNone && !loadLabels)
+    {
+        return;
+    }
+
+    // Collect the items which miss at least one of the fields
+
+    ImageInfoList    imagesInfos;
+    ImageInfoList    informationInfos;
+    ImageInfoList    labelInfos;
+    ImageInfoList    tagInfos;
+    QList<qlonglong> imagesIds;
+    QList<qlonglong> informationIds;
+
+    foreach(const ImageInfo& info, *this)
+    {
+        if (!info.m_data)
+        {
+            continue;
+        }
+
+        ImageInfoReadLocker lock(info.m_data);
+
+        if (((imagesFields & DatabaseFields::Category)         && !info.m_data->categoryCached)         ||
+            ((imagesFields & DatabaseFields::ModificationDate) && !info.m_data->modificationDateCached) ||
+            ((imagesFields & DatabaseFields::FileSize)         && !info.m_data->fileSizeCached))
+        {
+            imagesInfos << info;
+            imagesIds   << info.m_data->id;
+        }
+
+        if (((infoFields & DatabaseFields::Rating)                           && !info.m_data->ratingCached)       ||
+            ((infoFields & DatabaseFields::CreationDate)                     && !info.m_data->creationDateCached) ||
+            ((infoFields & (DatabaseFields::Width | DatabaseFields::Height)) && !info.m_data->imageSizeCached)    ||
+            ((infoFields & DatabaseFields::Format)                           && !info.m_data->formatCached))
+        {
+            informationInfos << info;
+            informationIds   << info.m_data->id;
+        }
+
+        if (loadLabels && (!info.m_data->colorLabelCached || !info.m_data->pickLabelCached))
+        {
+            labelInfos << info;
+
+            if (!info.m_data->tagIdsCached)
+            {
+                tagInfos << info;
+            }
+        }
+    }
+
+    if (imagesIds.isEmpty() && informationIds.isEmpty() && labelInfos.isEmpty())
+    {
+        return;
+    }
+
+    QHash<qlonglong, QVariantList> imagesValues;
+    QHash<qlonglong, QVariantList> informationValues;
+
+    {
+        CoreDbAccess access;
+
+        if (!imagesIds.isEmpty())
+        {
+            imagesValues = access.db()->getImagesFields(imagesIds, imagesFields);
+        }
+
+        if (!informationIds.isEmpty())
+        {
+            informationValues = access.db()->getImageInformation(informationIds, infoFields);
+        }
+    }
+
+    // The labels are derived from the tags, which are loaded as a list too
+
+    tagInfos.loadTagIds();
+
+    // The values come in the order of the field enums, see CoreDB::getImagesFields()
+
+    foreach(const ImageInfo& info, imagesInfos)
+    {
+        ImageInfoData* const data = info.m_data.constCastData();
+        ImageInfoWriteLocker lock(data);
+        const QVariantList values = imagesValues.value(data->id);
+        int index                 = 0;
+
+        if (imagesFields & DatabaseFields::Category)
+        {
+            if (!data->categoryCached && !values.isEmpty())
+            {
+                data->category = (DatabaseItem::Category)values.at(index).toInt();
+            }
+
+            data->categoryCached = true;
+            ++index;
+        }
+
+        if (imagesFields & DatabaseFields::ModificationDate)
+        {
+            if (!data->modificationDateCached && !values.isEmpty())
+            {
+                data->modificationDate = values.at(index).toDateTime();
+            }
+
+            data->modificationDateCached = true;
+            ++index;
+        }
+
+        if (imagesFields & DatabaseFields::FileSize)
+        {
+            if (!data->fileSizeCached && !values.isEmpty())
+            {
+                data->fileSize = values.at(index).toLongLong();
+            }
+
+            data->fileSizeCached = true;
+        }
+    }
+
+    foreach(const ImageInfo& info, informationInfos)
+    {
+        ImageInfoData* const data = info.m_data.constCastData();
+        ImageInfoWriteLocker lock(data);
+        const QVariantList values = informationValues.value(data->id);
+        int index                 = 0;
+
+        if (infoFields & DatabaseFields::Rating)
+        {
+            if (!data->ratingCached && !values.isEmpty())
+            {
+                data->rating = values.at(index).toInt();
+            }
+
+            data->ratingCached = true;
+            ++index;
+        }
+
+        if (infoFields & DatabaseFields::CreationDate)
+        {
+            if (!data->creationDateCached && !values.isEmpty())
+            {
+                data->creationDate = values.at(index).toDateTime();
+            }
+
+            data->creationDateCached = true;
+            ++index;
+        }
+
+        if (infoFields & (DatabaseFields::Width | DatabaseFields::Height))
+        {
+            if (!data->imageSizeCached && !values.isEmpty())
+            {
+                data->imageSize = QSize(values.at(index).toInt(), values.at(index + 1).toInt());
+            }
+
+            data->imageSizeCached = true;
+            index += 2;
+        }
+
+        if (infoFields & DatabaseFields::Format)
+        {
+            if (!data->formatCached && !values.isEmpty())
+            {
+                data->format = values.at(index).toString();
+            }
+
+            data->formatCached = true;
+        }
+    }
+
+    foreach(const ImageInfo& info, labelInfos)
+    {
+        ImageInfoData* const data = info.m_data.constCastData();
+        QList<int> tagIds;
+
+        {
+            ImageInfoReadLocker lock(data);
+            tagIds = data->tagIds;
+        }
+
+        int colorLabel = TagsCache::instance()->colorLabelFromTags(tagIds);
+        int pickLabel  = TagsCache::instance()->pickLabelFromTags(tagIds);
+
+        ImageInfoWriteLocker lock(data);
+
+        if (!data->colorLabelCached)
+        {
+            data->colorLabel       = (colorLabel == -1) ? NoColorLabel : colorLabel;
+            data->colorLabelCached = true;
+        }
+
+        if (!data->pickLabelCached)
+        {
+            data->pickLabel       = (pickLabel == -1) ? NoPickLabel : pickLabel;
+            data->pickLabelCached = true;
+        }
+    }
+}
+
 int ImageInfo::orientation() const
 {
     if (!m_data)
@@ -933,7 +1158,7 @@ int ImageInfo::numberOfGroupedImages() const
     RETURN_IF_CACHED(groupedImages)
 
     int groupedImages                           = CoreDbAccess().db()->getImagesRelatingTo(m_data->id, DatabaseRelation::Grouped).size();
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->groupedImages       = groupedImages;
     m_data.constCastData()->groupedImagesCached = true;
     return m_data->groupedImages;
@@ -952,7 +1177,7 @@ qlonglong ImageInfo::groupImageId() const
     // list size should be 0 or 1
     int groupImage       = ids.isEmpty() ? -1 : ids.first();
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data.constCastData()->groupImage       = groupImage;
     m_data.constCastData()->groupImageCached = true;
     return m_data->groupImage;
@@ -961,7 +1186,6 @@ qlonglong ImageInfo::groupImageId() const
 void ImageInfoList::loadGroupImageIds() const
 {
     QVector<QList<qlonglong> > allGroupIds = CoreDbAccess().db()->getImagesRelatedFrom(toImageIdList(), DatabaseRelation::Grouped);
-    ImageInfoWriteLocker lock;
 
     for (int i = 0 ; i < size() ; i++)
     {
@@ -973,6 +1197,7 @@ void ImageInfoList::loadGroupImageIds() const
             continue;
         }
 
+        ImageInfoWriteLocker lock(info.m_data);
         info.m_data.constCastData()->groupImage       = groupIds.isEmpty() ? -1 : groupIds.first();
         info.m_data.constCastData()->groupImageCached = true;
     }
@@ -1128,7 +1353,7 @@ ImagePosition ImageInfo::imagePosition() const
 
     if (!m_data->positionsCached)
     {
-        ImageInfoWriteLocker lock;
+        ImageInfoWriteLocker lock(m_data);
         m_data.constCastData()->longitude       = pos.longitudeNumber();
         m_data.constCastData()->latitude        = pos.latitudeNumber();
         m_data.constCastData()->altitude        = pos.altitude();
@@ -1597,7 +1822,7 @@ void ImageInfo::setPickLabel(int pickId)
         setTag(pickLabelTags[pickId]);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->pickLabel       = pickId;
     m_data->pickLabelCached = true;
 }
@@ -1628,7 +1853,7 @@ void ImageInfo::setColorLabel(int colorId)
         setTag(colorLabelTags[colorId]);
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->colorLabel       = colorId;
     m_data->colorLabelCached = true;
 }
@@ -1642,7 +1867,7 @@ void ImageInfo::setRating(int value)
 
     CoreDbAccess().db()->changeImageInformation(m_data->id, QVariantList() << value, DatabaseFields::Rating);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->rating       = value;
     m_data->ratingCached = true;
 }
@@ -1666,7 +1891,7 @@ void ImageInfo::setDateTime(const QDateTime& dateTime)
 
     CoreDbAccess().db()->changeImageInformation(m_data->id, QVariantList() << dateTime, DatabaseFields::CreationDate);
 
-    ImageInfoWriteLocker lock;
+    ImageInfoWriteLocker lock(m_data);
     m_data->creationDate       = dateTime;
     m_data->creationDateCached = true;
 }
@@ -1859,7 +2084,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
     ImageInfo::DatabaseFieldsHashRaw cachedHash;
     // consolidate to one ReadLocker. In particular, the shallow copy of the QHash must be done under protection
     {
-        ImageInfoReadLocker lock;
+        ImageInfoReadLocker lock(m_data);
         cachedVideoMetadata = m_data->videoMetadataCached;
         cachedImageMetadata = m_data->imageMetadataCached;
         cachedHash = m_data->databaseFieldsHashRaw;
@@ -1874,7 +2099,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
         {
             const QVariantList fieldValues = CoreDbAccess().db()->getVideoMetadata(m_data->id, missingVideoMetadata);
 
-            ImageInfoWriteLocker lock;
+            ImageInfoWriteLocker lock(m_data);
             if (fieldValues.isEmpty())
             {
                 m_data.constCastData()->hasVideoMetadata = false;
@@ -1908,7 +2133,7 @@ ImageInfo::DatabaseFieldsHashRaw ImageInfo::getDatabaseFieldsRaw(const DatabaseF
         {
             const QVariantList fieldValues = CoreDbAccess().db()->getImageMetadata(m_data->id, missingImageMetadata);
 
-            ImageInfoWriteLocker lock;
+            ImageInfoWriteLocker lock(m_data);
             if (fieldValues.isEmpty())
             {
                 m_data.constCastData()->hasImageMetadata = false;
@@ -226,6 +226,7 @@ void ImageInfoCache::invalidate()
     {
         if ((*it)->isReferenced())
         {
+            ImageInfoWriteLocker dataLock(*it);
             (*it)->invalid = true;
             (*it)->id = -1;
         }
@@ -241,14 +242,17 @@ void ImageInfoCache::invalidate()
 
 void ImageInfoCache::slotImageChanged(const ImageChangeset& changeset)
 {
-    ImageInfoWriteLocker lock;
+    // The cache itself is not changed, only the fields of the data objects
+    ImageInfoReadLocker lock;
 
     foreach(const qlonglong& imageId, changeset.ids())
     {
-        QHash<qlonglong, ImageInfoData*>::iterator it = m_infos.find(imageId);
+        QHash<qlonglong, ImageInfoData*>::const_iterator it = m_infos.constFind(imageId);
 
-        if (it != m_infos.end())
+        if (it != m_infos.constEnd())
         {
+            ImageInfoWriteLocker dataLock(*it);
+
             // invalidate the relevant field. It will be lazy-loaded at first access.
             DatabaseFields::Set changes = changeset.changes();
 
@@ -342,14 +346,15 @@ void ImageInfoCache::slotImageTagChanged(const ImageTagChangeset& changeset)
         return;
     }
 
-    ImageInfoWriteLocker lock;
+    ImageInfoReadLocker lock;
 
     foreach(const qlonglong& imageId, changeset.ids())
     {
-        QHash<qlonglong, ImageInfoData*>::iterator it = m_infos.find(imageId);
+        QHash<qlonglong, ImageInfoData*>::const_iterator it = m_infos.constFind(imageId);
 
-        if (it != m_infos.end())
+        if (it != m_infos.constEnd())
         {
+            ImageInfoWriteLocker dataLock(*it);
             (*it)->tagIdsCached     = false;
             (*it)->colorLabelCached = false;
             (*it)->pickLabelCached  = false;
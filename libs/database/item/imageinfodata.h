@@ -45,6 +45,19 @@
 namespace Digikam
 {
 
+class ImageInfoData;
+
+/**
+ * The locking of ImageInfo data is split in two levels:
+ *
+ * - m_lock protects the ImageInfoCache and the identity of each ImageInfoData,
+ *   that is id, albumId, albumRootId and name.
+ * - The lazily loaded fields and their "cached" flags of an ImageInfoData are protected
+ *   by one of m_dataLocks, chosen by the address of the data object. Thus, threads storing
+ *   fields of different images rarely wait for each other, and never for the cache.
+ *
+ * When both are needed, m_lock must be acquired first.
+ */
 class ImageInfoStatic
 {
 public:
@@ -54,16 +67,31 @@ public:
 
     static ImageInfoCache* cache();
 
+    static QReadWriteLock* dataLock(const ImageInfoData* const data)
+    {
+        return &m_instance->m_dataLocks[(reinterpret_cast<quintptr>(data) >> 4) % DataLockCount];
+    }
+
 public:
 
+    enum
+    {
+        DataLockCount = 64
+    };
+
     ImageInfoCache          m_cache;
     QReadWriteLock          m_lock;
+    QReadWriteLock          m_dataLocks[DataLockCount];
 
     static ImageInfoStatic* m_instance;
 };
 
 // -----------------------------------------------------------------------------------
 
+/**
+ * Without argument, locks the cache and the identity fields.
+ * With a data object, locks the other fields of this object only.
+ */
 class ImageInfoReadLocker : public QReadLocker
 {
 public:
@@ -72,6 +100,11 @@ public:
         : QReadLocker(&ImageInfoStatic::m_instance->m_lock)
     {
     }
+
+    explicit ImageInfoReadLocker(const ImageInfoData* const data)
+        : QReadLocker(ImageInfoStatic::dataLock(data))
+    {
+    }
 };
 
 // -----------------------------------------------------------------------------------
@@ -84,6 +117,11 @@ public:
         : QWriteLocker(&ImageInfoStatic::m_instance->m_lock)
     {
     }
+
+    explicit ImageInfoWriteLocker(const ImageInfoData* const data)
+        : QWriteLocker(ImageInfoStatic::dataLock(data))
+    {
+    }
 };
 
 // -----------------------------------------------------------------------------------
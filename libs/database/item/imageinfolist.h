@@ -31,6 +31,7 @@
 // Local includes
 
 #include "imageinfo.h"
+#include "coredbfields.h"
 #include "digikam_export.h"
 #include "digikam_config.h"
 
@@ -61,6 +62,15 @@ public:
     void loadGroupImageIds() const;
     void loadTagIds() const;
 
+    /**
+     * Loads the given fields of all items which do not have them cached yet,
+     * using a few set-based queries instead of one query per item and field.
+     * Supported are FileSize, Category and ModificationDate from Images,
+     * Rating, CreationDate, Width, Height and Format from ImageInformation,
+     * and the color and pick labels. Other fields are ignored.
+     */
+    void loadFields(const DatabaseFields::Set& fields) const;
+
     bool static namefileLessThan(const ImageInfo& d1, const ImageInfo& d2);
 
     /**
@@ -37,6 +37,7 @@
 // Qt includes
 
 #include <QFile>
+#include <QHash>
 #include <QFileInfo>
 #include <QDataStream>
 #include <QRegExp>
@@ -54,6 +55,7 @@
 #include "dmetadata.h"
 #include "haariface.h"
 #include "dbenginesqlquery.h"
+#include "dbenginesqlcursor.h"
 #include "tagscache.h"
 #include "imagetagpair.h"
 #include "dbjobsthread.h"
@@ -74,10 +76,8 @@ uint qHash(const ImageListerRecord& key)
  * If the value fits, we pass it. If it does not, we pass -1,
  * and the receiver shall get the full number itself
  */
-static inline int toInt32BitSafe(const QList<QVariant>::const_iterator& it)
+static inline int toInt32BitSafe(qlonglong v)
 {
-    qlonglong v = (*it).toLongLong();
-
     if (v > std::numeric_limits<int>::max() || v < 0)
     {
         return -1;
@@ -85,6 +85,56 @@ static inline int toInt32BitSafe(const QList<QVariant>::const_iterator& it)
     return (int)v;
 }
 
+static inline int toInt32BitSafe(const QList<QVariant>::const_iterator& it)
+{
+    return toInt32BitSafe((*it).toLongLong());
+}
+
+/**
+ * Reads the columns common to most listing queries from the current row of the cursor:
+ * Images.id, Images.name, Images.album, [Albums.albumRoot,] ImageInformation.rating, Images.category,
+ * ImageInformation.format, ImageInformation.creationDate, Images.modificationDate, Images.fileSize,
+ * ImageInformation.width, ImageInformation.height
+ * Returns the index of the next column.
+ */
+static int readRecord(const DbEngineSqlCursor& cursor, ImageListerRecord& record, bool withAlbumRoot)
+{
+    int column               = 0;
+
+    record.imageID           = cursor.toLongLong(column++);
+    record.name              = cursor.toString(column++);
+    record.albumID           = cursor.toInt(column++);
+
+    if (withAlbumRoot)
+    {
+        record.albumRootID   = cursor.toInt(column++);
+    }
+
+    record.rating            = cursor.toInt(column++);
+    record.category          = (DatabaseItem::Category)cursor.toInt(column++);
+    record.format            = cursor.toString(column++);
+    record.creationDate      = cursor.toDateTime(column++);
+    record.modificationDate  = cursor.toDateTime(column++);
+    record.fileSize          = toInt32BitSafe(cursor.toLongLong(column++));
+    const int width          = cursor.toInt(column++);
+    const int height         = cursor.toInt(column++);
+    record.imageSize         = QSize(width, height);
+
+    return column;
+}
+
+/**
+ * Delivers the records read in one query to the receiver. Called without the database lock,
+ * as receivers may take their time, or access the database themselves.
+ */
+static void deliverRecords(ImageListerReceiver* const receiver, const QList<ImageListerRecord>& records)
+{
+    foreach(const ImageListerRecord& record, records)
+    {
+        receiver->receive(record);
+    }
+}
+
 // ---------------------------------------------------------------------------------
 
 class ImageLister::Private
@@ -99,6 +149,12 @@ public:
         allowExtraValues        = false;
     }
 
+    /// Number of ids listed with one query by listFromIdList(), below the bound values limit of SQLite
+    enum
+    {
+        IdListChunkSize = 900
+    };
+
     bool recursive;
     bool listOnlyAvailableImages;
     bool allowExtraValues;
@@ -192,8 +248,6 @@ void ImageLister::listAlbum(ImageListerReceiver* const receiver, int albumRootId
         albumIds << albumId;
     }
 
-    QList<QVariant> values;
-
     QString query = QString::fromUtf8("SELECT DISTINCT Images.id, Images.name, Images.album, "
                     "       ImageInformation.rating, Images.category, "
                     "       ImageInformation.format, ImageInformation.creationDate, "
@@ -214,58 +268,50 @@ void ImageLister::listAlbum(ImageListerReceiver* const receiver, int albumRootId
             QList<QVariant> ids =  (albumIds.size() <= maxParams) ? albumIds : albumIds.mid(i, maxParams);
             i                  += ids.count();
 
-            QList<QVariant> v;
-            CoreDbAccess  access;
-            q += QString::fromUtf8("Images.album IN (");
-            access.db()->addBoundValuePlaceholders(q, ids.size());
-            q += QString::fromUtf8(");");
-            access.backend()->execSql(q, ids, &v);
+            QList<ImageListerRecord> records;
+
+            {
+                CoreDbAccess  access;
+                q += QString::fromUtf8("Images.album IN (");
+                access.db()->addBoundValuePlaceholders(q, ids.size());
+                q += QString::fromUtf8(");");
+
+                DbEngineSqlCursor cursor = access.backend()->execCursor(q, ids);
+
+                while (cursor.next())
+                {
+                    ImageListerRecord record;
+                    readRecord(cursor, record, false);
+                    record.albumRootID = albumRootId;
+
+                    records << record;
+                }
+            }
 
-            values += v;
+            deliverRecords(receiver, records);
         }
     }
     else
     {
-        CoreDbAccess access;
-        query += QString::fromUtf8("Images.album = ?;");
-        access.backend()->execSql(query, albumIds, &values);
-    }
+        QList<ImageListerRecord> records;
 
-    int width, height;
+        {
+            CoreDbAccess access;
+            query += QString::fromUtf8("Images.album = ?;");
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record;
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.modificationDate  = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
+            DbEngineSqlCursor cursor = access.backend()->execCursor(query, albumIds);
 
-        record.imageSize         = QSize(width, height);
+            while (cursor.next())
+            {
+                ImageListerRecord record;
+                readRecord(cursor, record, false);
+                record.albumRootID = albumRootId;
 
-        record.albumRootID = albumRootId;
+                records << record;
+            }
+        }
 
-        receiver->receive(record);
+        deliverRecords(receiver, records);
     }
 }
 
@@ -383,129 +429,96 @@ void ImageLister::listFaces(ImageListerReceiver* const receiver, int personId)
 
 void ImageLister::listDateRange(ImageListerReceiver* const receiver, const QDate& startDate, const QDate& endDate)
 {
-    QList<QVariant> values;
+    QSet<int>                albumRoots = albumRootsToList();
+    QList<ImageListerRecord> records;
 
     {
-        CoreDbAccess access;
-        access.backend()->execSql(QString::fromUtf8("SELECT DISTINCT Images.id, Images.name, Images.album, "
-                                          "       Albums.albumRoot, "
-                                          "       ImageInformation.rating, Images.category, "
-                                          "       ImageInformation.format, ImageInformation.creationDate, "
-                                          "       Images.modificationDate, Images.fileSize, "
-                                          "       ImageInformation.width, ImageInformation.height "
-                                          " FROM Images "
-                                          "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                                          "       INNER JOIN Albums ON Albums.id=Images.album "
-                                          " WHERE Images.status=1 "
-                                          "   AND ImageInformation.creationDate < ? "
-                                          "   AND ImageInformation.creationDate >= ? "
-                                          " ORDER BY Images.album;"),
-                                  QDateTime(endDate).toString(Qt::ISODate),
-                                  QDateTime(startDate).toString(Qt::ISODate),
-                                  &values);
-    }
-
-    QSet<int> albumRoots = albumRootsToList();
-    int       width, height;
-
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record;
-
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.modificationDate  = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
-
-        if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
+        CoreDbAccess      access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(QString::fromUtf8(
+                                       "SELECT DISTINCT Images.id, Images.name, Images.album, "
+                                       "       Albums.albumRoot, "
+                                       "       ImageInformation.rating, Images.category, "
+                                       "       ImageInformation.format, ImageInformation.creationDate, "
+                                       "       Images.modificationDate, Images.fileSize, "
+                                       "       ImageInformation.width, ImageInformation.height "
+                                       " FROM Images "
+                                       "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
+                                       "       INNER JOIN Albums ON Albums.id=Images.album "
+                                       " WHERE Images.status=1 "
+                                       "   AND ImageInformation.creationDate < ? "
+                                       "   AND ImageInformation.creationDate >= ? "
+                                       " ORDER BY Images.album;"),
+                                       QList<QVariant>() << QDateTime(endDate).toString(Qt::ISODate)
+                                                         << QDateTime(startDate).toString(Qt::ISODate));
+
+        while (cursor.next())
         {
-            continue;
-        }
+            ImageListerRecord record;
+            readRecord(cursor, record, true);
 
-        record.imageSize         = QSize(width, height);
+            if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
+            {
+                continue;
+            }
 
-        receiver->receive(record);
+            records << record;
+        }
     }
+
+    deliverRecords(receiver, records);
 }
 
 void ImageLister::listAreaRange(ImageListerReceiver* const receiver, double lat1, double lat2, double lon1, double lon2)
 {
-    QList<QVariant> values;
     QList<QVariant> boundValues;
     boundValues << lat1 << lat2 << lon1 << lon2;
 
     qCDebug(DIGIKAM_DATABASE_LOG) << "Listing area" << lat1 << lat2 << lon1 << lon2;
 
-    CoreDbAccess access;
-
-    access.backend()->execSql(QString::fromUtf8("SELECT DISTINCT Images.id, "
-                                      "       Albums.albumRoot, ImageInformation.rating, ImageInformation.creationDate, "
-                                      "       ImagePositions.latitudeNumber, ImagePositions.longitudeNumber "
-                                      " FROM Images "
-                                      "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                                      "       INNER JOIN Albums ON Albums.id=Images.album "
-                                      "       INNER JOIN ImagePositions   ON Images.id=ImagePositions.imageid "
-                                      " WHERE Images.status=1 "
-                                      "   AND (ImagePositions.latitudeNumber>? AND ImagePositions.latitudeNumber<?) "
-                                      "   AND (ImagePositions.longitudeNumber>? AND ImagePositions.longitudeNumber<?);"),
-                              boundValues,
-                              &values);
+    QSet<int>                albumRoots = albumRootsToList();
+    QList<ImageListerRecord> records;
+    int                      results    = 0;
 
+    {
+        CoreDbAccess access;
 
-    qCDebug(DIGIKAM_DATABASE_LOG) << "Results:" << values.size() / 14;
-
-    QSet<int> albumRoots = albumRootsToList();
-    double    lat, lon;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(QString::fromUtf8(
+                                       "SELECT DISTINCT Images.id, "
+                                       "       Albums.albumRoot, ImageInformation.rating, ImageInformation.creationDate, "
+                                       "       ImagePositions.latitudeNumber, ImagePositions.longitudeNumber "
+                                       " FROM Images "
+                                       "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
+                                       "       INNER JOIN Albums ON Albums.id=Images.album "
+                                       "       INNER JOIN ImagePositions   ON Images.id=ImagePositions.imageid "
+                                       " WHERE Images.status=1 "
+                                       "   AND (ImagePositions.latitudeNumber>? AND ImagePositions.latitudeNumber<?) "
+                                       "   AND (ImagePositions.longitudeNumber>? AND ImagePositions.longitudeNumber<?);"),
+                                       boundValues);
+
+        while (cursor.next())
+        {
+            ImageListerRecord record(d->allowExtraValues ? ImageListerRecord::ExtraValueFormat : ImageListerRecord::TraditionalFormat);
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record(d->allowExtraValues ? ImageListerRecord::ExtraValueFormat : ImageListerRecord::TraditionalFormat);
+            record.imageID           = cursor.toLongLong(0);
+            record.albumRootID       = cursor.toInt(1);
+            record.rating            = cursor.toInt(2);
+            record.creationDate      = cursor.value(3).toDateTime();
+            ++results;
 
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
+            if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
+            {
+                continue;
+            }
 
-        record.rating            = (*it).toInt();
-        ++it;
-        record.creationDate      = (*it).toDateTime();
-        ++it;
-        lat                      = (*it).toDouble();
-        ++it;
-        lon                      = (*it).toDouble();
-        ++it;
+            record.extraValues       << cursor.toDouble(4) << cursor.toDouble(5);
 
-        if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
-        {
-            continue;
+            records << record;
         }
+    }
 
-        record.extraValues       << lat << lon;
+    deliverRecords(receiver, records);
 
-        receiver->receive(record);
-    }
+    qCDebug(DIGIKAM_DATABASE_LOG) << "Results:" << results;
 }
 
 void ImageLister::listSearch(ImageListerReceiver* const receiver, const QString& xml, int limit, qlonglong referenceImageId)
@@ -516,9 +529,7 @@ void ImageLister::listSearch(ImageListerReceiver* const receiver, const QString&
     }
 
     QList<QVariant> boundValues;
-    QList<QVariant> values;
     QString sqlQuery;
-    QString errMsg;
 
     // query head
     sqlQuery = QString::fromUtf8(
@@ -554,84 +565,58 @@ void ImageLister::listSearch(ImageListerReceiver* const receiver, const QString&
 
     qCDebug(DIGIKAM_DATABASE_LOG) << "Search query:\n" << sqlQuery << "\n" << boundValues;
 
-    bool executionSuccess;
+    QSet<int>                albumRoots = albumRootsToList();
+    QList<ImageListerRecord> records;
+    QString                  errMsg;
+    bool                     executionSuccess;
+    int                      results    = 0;
+
     {
-        CoreDbAccess access;
-        executionSuccess = access.backend()->execSql(sqlQuery, boundValues, &values);
+        CoreDbAccess      access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(sqlQuery, boundValues);
+        executionSuccess         = cursor.isValid();
 
         if (!executionSuccess)
         {
             errMsg = access.backend()->lastError();
         }
-    }
-
-    if (!executionSuccess)
-    {
-        receiver->error(errMsg);
-        return;
-    }
-
-    qCDebug(DIGIKAM_DATABASE_LOG) << "Search result:" << values.size();
 
-    QSet<int> albumRoots = albumRootsToList();
-    int       width, height;
-    double    lat,lon;
+        while (cursor.next())
+        {
+            ImageListerRecord record;
 
-    CoreDbAccess access;
+            const int column = readRecord(cursor, record, true);
+            const double lat = cursor.toDouble(column);
+            const double lon = cursor.toDouble(column + 1);
+            ++results;
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record;
+            record.currentSimilarity                 = access.db()->getImageProperty(record.imageID,QLatin1String("similarityTo_") +
+                                                       QString::number(referenceImageId)).toDouble();
+            record.currentFuzzySearchReferenceImage  = referenceImageId;
 
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.modificationDate  = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
-        lat                      = (*it).toDouble();
-        ++it;
-        lon                      = (*it).toDouble();
-        ++it;
+            if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
+            {
+                continue;
+            }
 
-        record.currentSimilarity                 = access.db()->getImageProperty(record.imageID,QLatin1String("similarityTo_") +
-                                                   QString::number(referenceImageId)).toDouble();
-        record.currentFuzzySearchReferenceImage  = referenceImageId;
+            if (!hooks.checkPosition(lat, lon))
+            {
+                continue;
+            }
 
-        if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
-        {
-            continue;
+            records << record;
         }
+    }
 
-        if (!hooks.checkPosition(lat, lon))
-        {
-            continue;
-        }
+    if (!executionSuccess)
+    {
+        receiver->error(errMsg);
+        return;
+    }
 
-        record.imageSize         = QSize(width, height);
+    deliverRecords(receiver, records);
 
-        receiver->receive(record);
-    }
+    qCDebug(DIGIKAM_DATABASE_LOG) << "Search result:" << results;
 }
 
 void ImageLister::listImageTagPropertySearch(ImageListerReceiver* const receiver, const QString& xml)
@@ -642,9 +627,7 @@ void ImageLister::listImageTagPropertySearch(ImageListerReceiver* const receiver
     }
 
     QList<QVariant> boundValues;
-    QList<QVariant> values;
     QString sqlQuery;
-    QString errMsg;
 
     // Currently, for optimization, this does not allow a general-purpose search,
     // ImageMetadata and ImagePositions are not joined and hooks are ignored.
@@ -673,94 +656,69 @@ void ImageLister::listImageTagPropertySearch(ImageListerReceiver* const receiver
 
     qCDebug(DIGIKAM_DATABASE_LOG) << "Search query:\n" << sqlQuery << "\n" << boundValues;
 
-    bool executionSuccess;
+    QSet<int>                albumRoots = albumRootsToList();
+    QList<ImageListerRecord> records;
+    QString                  errMsg;
+    bool                     executionSuccess;
+    int                      results    = 0;
+
     {
-        CoreDbAccess access;
-        executionSuccess = access.backend()->execSql(sqlQuery, boundValues, &values);
+        CoreDbAccess      access;
+        DbEngineSqlCursor cursor = access.backend()->execCursor(sqlQuery, boundValues);
+        executionSuccess         = cursor.isValid();
 
         if (!executionSuccess)
         {
             errMsg = access.backend()->lastError();
         }
-    }
 
-    if (!executionSuccess)
-    {
-        receiver->error(errMsg);
-        return;
-    }
-
-    qCDebug(DIGIKAM_DATABASE_LOG) << "Search result:" << values.size();
-
-    QSet<int> albumRoots = albumRootsToList();
-
-    int width, height;
+        while (cursor.next())
+        {
+            ImageListerRecord record(d->allowExtraValues ? ImageListerRecord::ExtraValueFormat : ImageListerRecord::TraditionalFormat);
 
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record(d->allowExtraValues ? ImageListerRecord::ExtraValueFormat : ImageListerRecord::TraditionalFormat);
+            const int column         = readRecord(cursor, record, true);
+            // sync the following order with the places where it's read, e.g., FaceTagsIface
+            QVariant value           = cursor.value(column);
+            QVariant property        = cursor.value(column + 1);
+            QVariant tagId           = cursor.value(column + 2);
+            ++results;
 
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.modificationDate  = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
-        // sync the following order with the places where it's read, e.g., FaceTagsIface
-        QVariant value           = (*it);
-        ++it;
-        QVariant property        = (*it);
-        ++it;
-        QVariant tagId           = (*it);
-        ++it;
-
-        // If the property is the autodetected person, get the original image tag properties
-        if (property.toString().compare(ImageTagPropertyName::autodetectedPerson()) == 0)
-        {
-            // If we split the value by ',' we must have the segments tagId, property, region
-            // Set the values.
-            QStringList values = value.toString().split(QLatin1Char(','));
+            // If the property is the autodetected person, get the original image tag properties
+            if (property.toString().compare(ImageTagPropertyName::autodetectedPerson()) == 0)
+            {
+                // If we split the value by ',' we must have the segments tagId, property, region
+                // Set the values.
+                QStringList values = value.toString().split(QLatin1Char(','));
+
+                if (values.size() == 3)
+                {
+                    value    = values.at(2);
+                    property = values.at(1);
+                    tagId    = values.at(0);
+                }
+            }
+            record.extraValues << value;
+            record.extraValues << property;
+            record.extraValues << tagId;
 
-            if (values.size() == 3)
+            if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
             {
-                value    = values.at(2);
-                property = values.at(1);
-                tagId    = values.at(0);
+                continue;
             }
-        }
-        record.extraValues << value;
-        record.extraValues << property;
-        record.extraValues << tagId;
 
-        if (d->listOnlyAvailableImages && !albumRoots.contains(record.albumRootID))
-        {
-            continue;
+            records << record;
         }
+    }
 
-        record.imageSize         = QSize(width, height);
-
-        receiver->receive(record);
+    if (!executionSuccess)
+    {
+        receiver->error(errMsg);
+        return;
     }
+
+    deliverRecords(receiver, records);
+
+    qCDebug(DIGIKAM_DATABASE_LOG) << "Search result:" << results;
 }
 
 void ImageLister::listHaarSearch(ImageListerReceiver* const receiver, const QString& xml)
@@ -972,105 +930,71 @@ void ImageLister::listFromHaarSearch(ImageListerReceiver* const receiver, const
 
 void ImageLister::listFromIdList(ImageListerReceiver* const receiver, const QList<qlonglong>& imageIds)
 {
-    QList<QVariant> values;
-    QString         errMsg;
-    bool            executionSuccess = true;
+    // The ids are listed in chunks with one "IN (...)" query each. The database lock is released
+    // between the chunks and the records of each chunk are passed to the receiver at once,
+    // so that parts sending receivers can deliver the first results early.
 
+    for (int start = 0 ; start < imageIds.size() ; start += Private::IdListChunkSize)
     {
-/*
-        // Unfortunately, we need to convert to QVariant
-        QList<QVariant> variantIdList;
+        const QList<qlonglong>              chunk = imageIds.mid(start, Private::IdListChunkSize);
+        QList<QVariant>                     boundValues;
+        QHash<qlonglong, ImageListerRecord> records;
+        QString                             errMsg;
+        bool                                executionSuccess;
 
-        foreach(const qlonglong& id, imageIds)
+        foreach(const qlonglong& id, chunk)
         {
-            variantIdList << id;
+            boundValues << id;
         }
 
-        CoreDbAccess access;
-        QSqlQuery query = access.backend()->prepareQuery(QString::fromUtf8(
-                    "SELECT DISTINCT Images.id, Images.name, Images.album, "
-                    "       ImageInformation.rating, ImageInformation.creationDate, "
-                    "       Images.modificationDate, Images.fileSize, "
-                    "       ImageInformation.width, ImageInformation.height "
-                    " FROM Images "
-                    "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                    " WHERE Images.id = ?;"));
-
-        query.addBindValue(variantIdList);
-        executionSuccess = query.execBatch
-*/
-        CoreDbAccess access;
-        DbEngineSqlQuery query = access.backend()->prepareQuery(QString::fromUtf8(
-                             "SELECT DISTINCT Images.id, Images.name, Images.album, "
-                             "       Albums.albumRoot, "
-                             "       ImageInformation.rating, Images.category, "
-                             "       ImageInformation.format, ImageInformation.creationDate, "
-                             "       Images.modificationDate, Images.fileSize, "
-                             "       ImageInformation.width, ImageInformation.height "
-                             " FROM Images "
-                             "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
-                             "       LEFT JOIN Albums ON Albums.id=Images.album "
-                             " WHERE Images.status=1 AND Images.id = ?;"));
-
-        foreach(const qlonglong& id, imageIds)
         {
-            query.bindValue(0, id);
-            executionSuccess = access.backend()->exec(query);
+            CoreDbAccess access;
+            QString      sql = QString::fromUtf8(
+                                 "SELECT DISTINCT Images.id, Images.name, Images.album, "
+                                 "       Albums.albumRoot, "
+                                 "       ImageInformation.rating, Images.category, "
+                                 "       ImageInformation.format, ImageInformation.creationDate, "
+                                 "       Images.modificationDate, Images.fileSize, "
+                                 "       ImageInformation.width, ImageInformation.height "
+                                 " FROM Images "
+                                 "       LEFT JOIN ImageInformation ON Images.id=ImageInformation.imageid "
+                                 "       LEFT JOIN Albums ON Albums.id=Images.album "
+                                 " WHERE Images.status=1 AND Images.id IN (");
+            access.db()->addBoundValuePlaceholders(sql, chunk.size());
+            sql += QString::fromUtf8(");");
+
+            DbEngineSqlCursor cursor = access.backend()->execCursor(sql, boundValues);
+            executionSuccess         = cursor.isValid();
 
             if (!executionSuccess)
             {
                 errMsg = access.backend()->lastError();
-                break;
             }
 
-            // append results to list
-            values << access.backend()->readToList(query);
+            while (cursor.next())
+            {
+                ImageListerRecord record;
+                readRecord(cursor, record, true);
+                records.insert(record.imageID, record);
+            }
         }
 
-    }
-
-    if (!executionSuccess)
-    {
-        receiver->error(errMsg);
-        return;
-    }
-
-    int width, height;
-
-    for (QList<QVariant>::const_iterator it = values.constBegin(); it != values.constEnd();)
-    {
-        ImageListerRecord record;
-
-        record.imageID           = (*it).toLongLong();
-        ++it;
-        record.name              = (*it).toString();
-        ++it;
-        record.albumID           = (*it).toInt();
-        ++it;
-        record.albumRootID       = (*it).toInt();
-        ++it;
-        record.rating            = (*it).toInt();
-        ++it;
-        record.category          = (DatabaseItem::Category)(*it).toInt();
-        ++it;
-        record.format            = (*it).toString();
-        ++it;
-        record.creationDate      = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.modificationDate  = (*it).isNull() ? QDateTime()
-                                   : QDateTime::fromString((*it).toString(), Qt::ISODate);
-        ++it;
-        record.fileSize          = toInt32BitSafe(it);
-        ++it;
-        width                    = (*it).toInt();
-        ++it;
-        height                   = (*it).toInt();
-        ++it;
+        if (!executionSuccess)
+        {
+            receiver->error(errMsg);
+            return;
+        }
 
-        record.imageSize         = QSize(width, height);
+        // The database returns the rows in any order, keep the order of the given ids.
+        foreach(const qlonglong& id, chunk)
+        {
+            QHash<qlonglong, ImageListerRecord>::const_iterator it = records.constFind(id);
 
-        receiver->receive(record);
+            if (it != records.constEnd())
+            {
+                receiver->receive(it.value());
+            }
+        }
     }
 }
 
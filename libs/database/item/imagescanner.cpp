@@ -45,6 +45,7 @@
 #include "imagecomments.h"
 #include "imagecopyright.h"
 #include "imageextendedproperties.h"
+#include "imagehashcache.h"
 #include "imagehistorygraph.h"
 #include "metadatasettings.h"
 #include "tagregion.h"
@@ -129,6 +130,66 @@ public:
 
 // ---------------------------------------------------------------------------
 
+class ImageScannerBulkCommit::Private
+{
+public:
+
+    Private()
+        : count(0)
+    {
+    }
+
+public:
+
+    typedef QPair<QList<qlonglong>, QList<QVariantList> > Rows;
+
+    /// ImageInformation rows, grouped by the written fields
+    QMap<int, Rows> imageInformation;
+    Rows            imageMetadata;
+    int             count;
+};
+
+ImageScannerBulkCommit::ImageScannerBulkCommit()
+    : d(new Private)
+{
+}
+
+ImageScannerBulkCommit::~ImageScannerBulkCommit()
+{
+    write();
+    delete d;
+}
+
+bool ImageScannerBulkCommit::isEmpty() const
+{
+    return (d->count == 0);
+}
+
+void ImageScannerBulkCommit::write()
+{
+    if (isEmpty())
+    {
+        return;
+    }
+
+    CoreDbAccess access;
+
+    for (QMap<int, Private::Rows>::const_iterator it = d->imageInformation.constBegin() ;
+         it != d->imageInformation.constEnd() ; ++it)
+    {
+        access.db()->addImageInformation(it.value().first, it.value().second,
+                                         (DatabaseFields::ImageInformation)it.key());
+    }
+
+    access.db()->addImageMetadata(d->imageMetadata.first, d->imageMetadata.second);
+
+    d->imageInformation.clear();
+    d->imageMetadata = Private::Rows();
+    d->count         = 0;
+}
+
+// ---------------------------------------------------------------------------
+
 class ImageScanner::Private
 {
 public:
@@ -138,7 +199,9 @@ public:
           hasMetadata(false),
           loadedFromDisk(false),
           scanMode(ModifiedScan),
-          hasHistoryToResolve(false)
+          hasHistoryToResolve(false),
+          uniqueHashVersion(0),
+          hashCache(0)
     {
         time.start();
     }
@@ -158,6 +221,10 @@ public:
 
     bool                   hasHistoryToResolve;
 
+    /// 0 if the version must be read from the database
+    int                    uniqueHashVersion;
+    ImageHashCache*        hashCache;
+
     ImageScannerCommit     commit;
 
     QTime                  time;
@@ -208,7 +275,7 @@ void ImageScanner::setCategory(DatabaseItem::Category category)
     d->scanInfo.category = category;
 }
 
-void ImageScanner::commit()
+void ImageScanner::commit(ImageScannerBulkCommit* const bulk)
 {
     qCDebug(DIGIKAM_DATABASE_LOG) << "Scanning took" << d->time.restart() << "ms";
 
@@ -226,18 +293,24 @@ void ImageScanner::commit()
 
     if (d->commit.copyImageAttributesId != -1)
     {
+        // the source may be one of the items still buffered
+        if (bulk)
+        {
+            bulk->write();
+        }
+
         commitCopyImageAttributes();
         return;
     }
 
     if (d->commit.commitImageInformation)
     {
-        commitImageInformation();
+        commitImageInformation(bulk);
     }
 
     if (d->commit.commitImageMetadata)
     {
-        commitImageMetadata();
+        commitImageMetadata(bulk);
     }
     else if (d->commit.commitVideoMetadata)
     {
@@ -605,9 +678,16 @@ void ImageScanner::scanImageInformation()
           << d->img.originalColorModel();
 }
 
-void ImageScanner::commitImageInformation()
+void ImageScanner::commitImageInformation(ImageScannerBulkCommit* const bulk)
 {
-    if (d->scanMode == NewScan)
+    if (d->scanMode == NewScan && bulk)
+    {
+        ImageScannerBulkCommit::Private::Rows& rows = bulk->d->imageInformation[(int)d->commit.imageInformationFields];
+        rows.first  << d->scanInfo.id;
+        rows.second << d->commit.imageInformationInfos;
+        bulk->d->count++;
+    }
+    else if (d->scanMode == NewScan)
     {
         CoreDbAccess().db()->addImageInformation(d->scanInfo.id,
                                                  d->commit.imageInformationInfos,
@@ -669,8 +749,16 @@ void ImageScanner::scanImageMetadata()
     }
 }
 
-void ImageScanner::commitImageMetadata()
+void ImageScanner::commitImageMetadata(ImageScannerBulkCommit* const bulk)
 {
+    if (d->scanMode == NewScan && bulk)
+    {
+        bulk->d->imageMetadata.first  << d->scanInfo.id;
+        bulk->d->imageMetadata.second << d->commit.imageMetadataInfos;
+        bulk->d->count++;
+        return;
+    }
+
     CoreDbAccess().db()->addImageMetadata(d->scanInfo.id, d->commit.imageMetadataInfos);
 }
 
@@ -1588,23 +1676,64 @@ void ImageScanner::loadFromDisk()
     }
 }
 
+void ImageScanner::setUniqueHashVersion(int version)
+{
+    d->uniqueHashVersion = version;
+}
+
+void ImageScanner::setHashCache(ImageHashCache* const cache)
+{
+    d->hashCache = cache;
+}
+
 QString ImageScanner::uniqueHash() const
 {
+    const bool hashV2 = d->uniqueHashVersion ? (d->uniqueHashVersion == 2)
+                                             : CoreDbAccess().db()->isUniqueHashV2();
+
+    // The cache holds version 2 hashes, which only depend on the file content.
+    ImageHashCache::FileId fileId;
+
+    if (hashV2 && d->hashCache)
+    {
+        fileId             = ImageHashCache::FileId::fromFile(d->fileInfo.filePath());
+        const QString hash = d->hashCache->find(fileId);
+
+        if (!hash.isEmpty())
+        {
+            if (d->scanInfo.category == DatabaseItem::Image)
+            {
+                d->img.setAttribute(QLatin1String("uniqueHashV2"), hash.toUtf8());
+            }
+
+            return hash;
+        }
+    }
+
+    QString hash;
+
     // the QByteArray is an ASCII hex string
     if (d->scanInfo.category == DatabaseItem::Image)
     {
-        if (CoreDbAccess().db()->isUniqueHashV2())
-            return QString::fromUtf8(d->img.getUniqueHashV2());
+        if (hashV2)
+            hash = QString::fromUtf8(d->img.getUniqueHashV2());
         else
-            return QString::fromUtf8(d->img.getUniqueHash());
+            hash = QString::fromUtf8(d->img.getUniqueHash());
     }
     else
     {
-        if (CoreDbAccess().db()->isUniqueHashV2())
-            return QString::fromUtf8(DImg::getUniqueHashV2(d->fileInfo.filePath()));
+        if (hashV2)
+            hash = QString::fromUtf8(DImg::getUniqueHashV2(d->fileInfo.filePath()));
         else
-            return QString::fromUtf8(DImg::getUniqueHash(d->fileInfo.filePath()));
+            hash = QString::fromUtf8(DImg::getUniqueHash(d->fileInfo.filePath()));
     }
+
+    if (hashV2 && d->hashCache)
+    {
+        d->hashCache->insert(fileId, hash);
+    }
+
+    return hash;
 }
 
 QString ImageScanner::detectImageFormat() const
@@ -40,6 +40,44 @@
 namespace Digikam
 {
 
+class ImageHashCache;
+class ImageScanner;
+
+/**
+ * Collects the database writes of many ImageScanner::commit() calls for new items
+ * and writes them with multi-row statements. Use it inside a CoreDbOperationGroup
+ * or CoreDbTransaction, so that all data is written in one transaction.
+ * Only the groups every new item has (image information and metadata) are buffered,
+ * everything else is written immediately by the scanner.
+ */
+class DIGIKAM_DATABASE_EXPORT ImageScannerBulkCommit
+{
+public:
+
+    ImageScannerBulkCommit();
+
+    /**
+     * Writes all data still buffered.
+     */
+    ~ImageScannerBulkCommit();
+
+    /**
+     * Writes the buffered data to the database and clears the buffer.
+     */
+    void write();
+
+    bool isEmpty() const;
+
+private:
+
+    friend class ImageScanner;
+
+    class Private;
+    Private* const d;
+};
+
+// ---------------------------------------------------------------------------
+
 class DIGIKAM_DATABASE_EXPORT ImageScanner
 {
 
@@ -79,8 +117,10 @@ public:
      * Commits the scanned information to the database.
      * You must call this after scanning was done for any changes to take effect.
      * Only this method will perform write operations to the database.
+     * If bulk is given, the data of a new item is partly buffered in bulk
+     * and written by ImageScannerBulkCommit::write().
      */
-    void commit();
+    void commit(ImageScannerBulkCommit* const bulk = 0);
 
     /**
      * Returns the image id of the scanned file, if (yet) available.
@@ -153,6 +193,20 @@ public:
      */
     void loadFromDisk();
 
+    /**
+     * Tell the scanner which version of the unique hash is used by the database.
+     * Then loadFromDisk() does not access the database, so that it can be
+     * called from another thread while the database is locked.
+     */
+    void setUniqueHashVersion(int version);
+
+    /**
+     * Take the unique hash from the cache if the file is unchanged since it was hashed,
+     * and record newly computed hashes in the cache. The cache must outlive the scanner.
+     * Not to be used for rescans which are requested because the hash shall be computed again.
+     */
+    void setHashCache(ImageHashCache* const cache);
+
     /**
      * Returns a suitable creation date from file system information.
      * Use this as a fallback if metadata is not available.
@@ -242,9 +296,9 @@ protected:
     void scanFile(ScanMode mode);
 
     void scanImageInformation();
-    void commitImageInformation();
+    void commitImageInformation(ImageScannerBulkCommit* const bulk = 0);
     void scanImageMetadata();
-    void commitImageMetadata();
+    void commitImageMetadata(ImageScannerBulkCommit* const bulk = 0);
     void scanImagePosition();
     void commitImagePosition();
     void scanImageComments();
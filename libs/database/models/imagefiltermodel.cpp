@@ -259,6 +259,16 @@ void ImageFilterModel::setDirectSourceImageModel(ImageModel* sourceModel)
         d->imageModel->unsetPreprocessor(d);
         disconnect(d->imageModel, SIGNAL(modelReset()),
                    this, SLOT(slotModelReset()));
+
+        disconnect(d->imageModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                   d, SLOT(sourceRowsInserted(QModelIndex,int,int)));
+
+        disconnect(d->imageModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                   d, SLOT(sourceRowsRemoved(QModelIndex,int,int)));
+
+        disconnect(d->imageModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                   d, SLOT(sourceDataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
         slotModelReset();
     }
 
@@ -283,6 +293,18 @@ void ImageFilterModel::setDirectSourceImageModel(ImageModel* sourceModel)
         connect(d->imageModel, SIGNAL(modelReset()),
                 this, SLOT(slotModelReset()));
 
+        // The sort keys follow the rows of the source model. Connected before
+        // setSourceModel(), so they are up to date when the proxy sorts new rows.
+
+        connect(d->imageModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+                d, SLOT(sourceRowsInserted(QModelIndex,int,int)));
+
+        connect(d->imageModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+                d, SLOT(sourceRowsRemoved(QModelIndex,int,int)));
+
+        connect(d->imageModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                d, SLOT(sourceDataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
         connect(d->imageModel, SIGNAL(imageChange(ImageChangeset,QItemSelection)),
                 this, SLOT(slotImageChange(ImageChangeset)));
 
@@ -419,7 +441,9 @@ void ImageFilterModel::setImageFilterSettings(const ImageFilterSettings& setting
         d->needPrepareComments = settings.isFilteringByText();
         d->needPrepareTags     = settings.isFilteringByTags();
         d->needPrepareGroups   = true;
-        d->needPrepare         = d->needPrepareComments || d->needPrepareTags || d->needPrepareGroups;
+        d->updatePrepareFields();
+        d->needPrepare         = d->needPrepareComments || d->needPrepareTags ||
+                                 d->needPrepareGroups   || d->needPrepareFields;
 
         d->hasOneMatch         = false;
         d->hasOneMatchForText  = false;
@@ -541,6 +565,9 @@ void ImageFilterModel::slotModelReset()
         d->hasOneMatch        = false;
         d->hasOneMatchForText = false;
     }
+
+    d->sortKeys.clear();
+    d->groupLeaderSortKeys.clear();
     d->filterResults.clear();
 }
 
@@ -638,13 +665,16 @@ void ImageFilterModelPreparer::process(ImageFilterModelTodoPackage package)
     }
 
     // get thread-local copy
-    bool needPrepareTags, needPrepareComments, needPrepareGroups;
+    bool needPrepareTags, needPrepareComments, needPrepareGroups, needPrepareFields;
+    DatabaseFields::Set prepareFields;
     QList<ImageFilterModelPrepareHook*> prepareHooks;
     {
         QMutexLocker lock(&d->mutex);
         needPrepareTags     = d->needPrepareTags;
         needPrepareComments = d->needPrepareComments;
         needPrepareGroups   = d->needPrepareGroups;
+        needPrepareFields   = d->needPrepareFields;
+        prepareFields       = d->prepareFields;
         prepareHooks        = d->prepareHooks;
     }
 
@@ -668,11 +698,18 @@ void ImageFilterModelPreparer::process(ImageFilterModelTodoPackage package)
     // reimplement ImageInfoList to ImageInfoVector (internally with templates?)
     ImageInfoList infoList;
 
-    if (needPrepareTags || needPrepareGroups)
+    if (needPrepareTags || needPrepareGroups || needPrepareFields)
     {
         infoList = package.infos.toList();
     }
 
+    // Load the fields used by the sort and filter settings with a few queries,
+    // instead of one query per item when they are first accessed.
+    if (needPrepareFields)
+    {
+        infoList.loadFields(prepareFields);
+    }
+
     if (needPrepareTags)
     {
         infoList.loadTagIds();
@@ -779,6 +816,23 @@ void ImageFilterModel::setImageSortSettings(const ImageSortSettings& sorter)
 {
     Q_D(ImageFilterModel);
     d->sorter = sorter;
+
+    {
+        QMutexLocker lock(&d->mutex);
+        d->updatePrepareFields();
+        d->needPrepare = d->needPrepareComments || d->needPrepareTags ||
+                         d->needPrepareGroups   || d->needPrepareFields;
+    }
+
+    // Sorting happens right now, so the items already in the model
+    // get their fields here rather than through the preparer.
+    if (d->imageModel)
+    {
+        ImageInfoList(d->imageModel->imageInfos()).loadFields(d->sorter.watchFlags());
+    }
+
+    d->rebuildSortKeys();
+
     setCategorizedModel(d->sorter.categorizationMode != ImageSortSettings::NoCategories);
     invalidate();
 }
@@ -833,6 +887,22 @@ int ImageFilterModel::compareCategories(const QModelIndex& left, const QModelInd
         return -1;
     }
 
+    if (d->sorter.categorizationMode == ImageSortSettings::CategoryByFormat)
+    {
+        // Compared on the sort keys. Other modes may be reimplemented in compareInfosCategories().
+        d->ensureSortKeys();
+        const ImageSortKey& leftKey  = d->sortKey(left);
+        const ImageSortKey& rightKey = d->sortKey(right);
+
+        if (leftKey.groupImageId == -1 && rightKey.groupImageId == -1)
+        {
+            return d->sorter.compareCategories(leftKey, rightKey);
+        }
+
+        return d->sorter.compareCategories(leftKey.groupImageId  == -1 ? leftKey  : d->groupLeaderSortKey(leftKey.groupImageId),
+                                           rightKey.groupImageId == -1 ? rightKey : d->groupLeaderSortKey(rightKey.groupImageId));
+    }
+
     const ImageInfo& leftInfo  = d->imageModel->imageInfoRef(left);
     const ImageInfo& rightInfo = d->imageModel->imageInfoRef(right);
 
@@ -859,39 +929,37 @@ bool ImageFilterModel::subSortLessThan(const QModelIndex& left, const QModelInde
         return false;
     }
 
-    const ImageInfo& leftInfo  = d->imageModel->imageInfoRef(left);
-    const ImageInfo& rightInfo = d->imageModel->imageInfoRef(right);
+    // Compare the precomputed sort keys, not the ImageInfos
+    d->ensureSortKeys();
+    const ImageSortKey& leftKey  = d->sortKey(left);
+    const ImageSortKey& rightKey = d->sortKey(right);
 
-    if (leftInfo == rightInfo)
+    if (leftKey.id == rightKey.id)
     {
         return d->sorter.lessThan(left.data(ImageModel::ExtraDataRole), right.data(ImageModel::ExtraDataRole));
     }
 
-    // Check grouping
-    qlonglong leftGroupImageId = leftInfo.groupImageId();
-    qlonglong rightGroupImageId = rightInfo.groupImageId();
-
     // Either no grouping (-1), or same group image, or same image
-    if (leftGroupImageId == rightGroupImageId)
+    if (leftKey.groupImageId == rightKey.groupImageId)
     {
-        return infosLessThan(leftInfo, rightInfo);
+        return d->sorter.lessThan(leftKey, rightKey);
     }
 
    // We have grouping to handle
 
     // Is one grouped on the other? Sort behind leader.
-    if (leftGroupImageId == rightInfo.id())
+    if (leftKey.groupImageId == rightKey.id)
     {
         return false;
     }
-    if (rightGroupImageId == leftInfo.id())
+    if (rightKey.groupImageId == leftKey.id)
     {
         return true;
     }
 
     // Use the group leader for sorting
-    return infosLessThan(leftGroupImageId  == -1 ? leftInfo  : ImageInfo(leftGroupImageId),
-                         rightGroupImageId == -1 ? rightInfo : ImageInfo(rightGroupImageId));
+    return d->sorter.lessThan(leftKey.groupImageId  == -1 ? leftKey  : d->groupLeaderSortKey(leftKey.groupImageId),
+                              rightKey.groupImageId == -1 ? rightKey : d->groupLeaderSortKey(rightKey.groupImageId));
 }
 
 int ImageFilterModel::compareInfosCategories(const ImageInfo& left, const ImageInfo& right) const
@@ -999,14 +1067,21 @@ void ImageFilterModel::slotImageChange(const ImageChangeset& changeset)
         return;
     }
 
+    // is one of the values affected that we filter or sort by?
+    DatabaseFields::Set set = changeset.changes();
+
+    // the sort keys hold the old values, even if resorting is already scheduled
+    if ((set & d->sorter.watchFlags()) || (set & DatabaseFields::ImageRelations))
+    {
+        d->invalidateSortKeys(changeset.ids());
+    }
+
     // already scheduled to re-filter?
     if (d->updateFilterTimer->isActive())
     {
         return;
     }
 
-    // is one of the values affected that we filter or sort by?
-    DatabaseFields::Set set = changeset.changes();
     bool sortAffected       = (set & d->sorter.watchFlags());
     bool filterAffected     = (set & d->filter.watchFlags()) || (set & d->groupFilter.watchFlags());
 
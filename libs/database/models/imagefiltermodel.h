@@ -243,6 +243,10 @@ protected:
 
     virtual bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
 
+    /** Both compare precomputed ImageSortKeys, which are built for all items when the
+     *  sort settings change, and for new or changed items on first use.
+     *  Categories by album are compared with compareInfosCategories().
+     */
     virtual int  compareCategories(const QModelIndex& left, const QModelIndex& right) const;
     virtual bool subSortLessThan(const QModelIndex& left, const QModelIndex& right) const;
     //virtual int  categoryCount(const ImageInfo& info) const;
@@ -254,6 +258,7 @@ protected:
     virtual int compareInfosCategories(const ImageInfo& left, const ImageInfo& right) const;
 
     /** Reimplement to customize sorting. Do not take categories into account here.
+     *  subSortLessThan() does not call this method, reimplement it as well.
      */
     virtual bool infosLessThan(const ImageInfo& left, const ImageInfo& right) const;
 
@@ -27,10 +27,17 @@
 
 #include "imagefiltermodelpriv.h"
 
+// Qt includes
+
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrent>
+
 // Local includes
 
 #include "digikam_debug.h"
 #include "imagefiltermodelthreads.h"
+#include "imagemodel.h"
 
 namespace Digikam
 {
@@ -47,6 +54,7 @@ ImageFilterModel::ImageFilterModelPrivate::ImageFilterModelPrivate()
     needPrepareComments   = false;
     needPrepareTags       = false;
     needPrepareGroups     = false;
+    needPrepareFields     = false;
     preparer              = 0;
     filterer              = 0;
     hasOneMatch           = false;
@@ -120,6 +128,174 @@ void ImageFilterModel::ImageFilterModelPrivate::setupWorkers()
             this, SLOT(packageDiscarded(ImageFilterModelTodoPackage)));
 }
 
+void ImageFilterModel::ImageFilterModelPrivate::updatePrepareFields()
+{
+    DatabaseFields::Set fields = filter.watchFlags();
+    fields.setFields(sorter.watchFlags());
+
+    // Only the fields which ImageInfoList::loadFields() can load in bulk
+
+    prepareFields.initialize();
+    prepareFields     = fields.getImages() & (DatabaseFields::Category         |
+                                              DatabaseFields::ModificationDate |
+                                              DatabaseFields::FileSize);
+    prepareFields    |= fields.getImageInformation() & (DatabaseFields::Rating       |
+                                                        DatabaseFields::CreationDate |
+                                                        DatabaseFields::Width        |
+                                                        DatabaseFields::Height       |
+                                                        DatabaseFields::Format       |
+                                                        DatabaseFields::ColorLabel   |
+                                                        DatabaseFields::PickLabel);
+    needPrepareFields = prepareFields.hasFieldsFromImages() || prepareFields.hasFieldsFromImageInformation();
+}
+
+/** Below this number of items, sort keys are computed in the calling thread only.
+ */
+const int ParallelSortKeysThreshold = 10000;
+
+static void computeSortKeys(const ImageSortSettings& sorter, const QList<ImageInfo>& infos,
+                            ImageSortKey* const keys, int begin, int end)
+{
+    // QCollator is not thread-safe, each worker uses its own ones
+    const QCollator sortCollator     = sorter.sortCollator();
+    const QCollator categoryCollator = sorter.categoryCollator();
+
+    for (int i = begin ; i < end ; ++i)
+    {
+        keys[i] = sorter.sortKey(infos.at(i), sortCollator, categoryCollator);
+    }
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::rebuildSortKeys()
+{
+    sortCollator     = sorter.sortCollator();
+    categoryCollator = sorter.categoryCollator();
+    groupLeaderSortKeys.clear();
+    sortKeys.clear();
+
+    if (!imageModel)
+    {
+        return;
+    }
+
+    const QList<ImageInfo> infos = imageModel->imageInfos();
+    sortKeys.resize(infos.size());
+    ImageSortKey* const keys = sortKeys.data();
+
+    const int workers = (infos.size() < ParallelSortKeysThreshold) ? 1 : qMax(1, QThread::idealThreadCount());
+    const int part    = (infos.size() + workers - 1) / workers;
+    QList<QFuture<void> > tasks;
+
+    // The calling thread takes the first part.
+
+    for (int i = 1 ; i < workers ; ++i)
+    {
+        tasks << QtConcurrent::run(computeSortKeys, sorter, infos, keys,
+                                   qMin(i * part, infos.size()), qMin((i + 1) * part, infos.size()));
+    }
+
+    computeSortKeys(sorter, infos, keys, 0, qMin(part, infos.size()));
+
+    foreach(QFuture<void> t, tasks)
+    {
+        t.waitForFinished();
+    }
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::invalidateSortKeys(const QList<qlonglong>& ids)
+{
+    if (!imageModel)
+    {
+        return;
+    }
+
+    foreach(const qlonglong& id, ids)
+    {
+        foreach(const QModelIndex& index, imageModel->indexesForImageId(id))
+        {
+            if (index.row() < sortKeys.size())
+            {
+                sortKeys[index.row()] = ImageSortKey();
+            }
+        }
+    }
+
+    // Any of them may lead a group
+    groupLeaderSortKeys.clear();
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::ensureSortKeys() const
+{
+    const int rows = imageModel->rowCount();
+
+    if (sortKeys.size() != rows)
+    {
+        sortKeys.resize(rows);
+    }
+}
+
+const ImageSortKey& ImageFilterModel::ImageFilterModelPrivate::sortKey(const QModelIndex& sourceIndex) const
+{
+    ImageSortKey& key = sortKeys[sourceIndex.row()];
+
+    if (key.isNull())
+    {
+        key = sorter.sortKey(imageModel->imageInfoRef(sourceIndex), sortCollator, categoryCollator);
+    }
+
+    return key;
+}
+
+ImageSortKey ImageFilterModel::ImageFilterModelPrivate::groupLeaderSortKey(qlonglong id) const
+{
+    QHash<qlonglong, ImageSortKey>::const_iterator it = groupLeaderSortKeys.constFind(id);
+
+    if (it != groupLeaderSortKeys.constEnd())
+    {
+        return it.value();
+    }
+
+    const ImageSortKey key = sorter.sortKey(ImageInfo(id), sortCollator, categoryCollator);
+    groupLeaderSortKeys.insert(id, key);
+
+    return key;
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::sourceRowsInserted(const QModelIndex& parent, int start, int end)
+{
+    if (parent.isValid() || start > sortKeys.size())
+    {
+        return;
+    }
+
+    sortKeys.insert(start, end - start + 1, ImageSortKey());
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::sourceRowsRemoved(const QModelIndex& parent, int start, int end)
+{
+    if (parent.isValid() || start >= sortKeys.size())
+    {
+        return;
+    }
+
+    sortKeys.remove(start, qMin(end, sortKeys.size() - 1) - start + 1);
+}
+
+void ImageFilterModel::ImageFilterModelPrivate::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight,
+                                                                  const QVector<int>& roles)
+{
+    // Changes of single roles, as thumbnails, do not touch the sorted values
+    if (!roles.isEmpty())
+    {
+        return;
+    }
+
+    for (int row = topLeft.row() ; row <= bottomRight.row() && row < sortKeys.size() ; ++row)
+    {
+        sortKeys[row] = ImageSortKey();
+    }
+}
+
 void ImageFilterModel::ImageFilterModelPrivate::infosToProcess(const QList<ImageInfo>& infos)
 {
     infosToProcess(infos, QList<QVariant>(), false);
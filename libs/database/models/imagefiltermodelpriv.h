@@ -26,16 +26,19 @@
 
 // Qt includes
 
+#include <QCollator>
 #include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QSet>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
 #include <QWaitCondition>
 
 // Local includes
 
+#include "coredbfields.h"
 #include "imageinfo.h"
 #include "imagefiltermodel.h"
 
@@ -90,6 +93,39 @@ public:
     void infosToProcess(const QList<ImageInfo>& infos);
     void infosToProcess(const QList<ImageInfo>& infos, const QList<QVariant>& extraValues, bool forReAdd = true);
 
+    /**
+     * Computes the database fields needed by the current filter and sort settings
+     * which the preparer shall load in bulk. Call with the mutex locked.
+     */
+    void updatePrepareFields();
+
+    /**
+     * Computes the sort keys of all items of the image model for the current sort settings.
+     * Large models are processed in parallel.
+     */
+    void rebuildSortKeys();
+
+    /**
+     * Discards the sort keys of the given items, which are recomputed on next use.
+     */
+    void invalidateSortKeys(const QList<qlonglong>& ids);
+
+    /**
+     * Make sure that the sort keys cover all rows of the image model.
+     * Call before taking references with sortKey().
+     */
+    void ensureSortKeys() const;
+
+    /**
+     * Returns the sort key of the source index, computing it if needed.
+     */
+    const ImageSortKey& sortKey(const QModelIndex& sourceIndex) const;
+
+    /**
+     * Returns the sort key of a group leader, which needs not be contained in the model.
+     */
+    ImageSortKey groupLeaderSortKey(qlonglong id) const;
+
 public:
 
     ImageFilterModel*                   q;
@@ -113,6 +149,8 @@ public:
     bool                                needPrepareComments;
     bool                                needPrepareTags;
     bool                                needPrepareGroups;
+    bool                                needPrepareFields;
+    DatabaseFields::Set                 prepareFields;
 
     QMutex                              mutex;
     ImageFilterSettings                 filterCopy;
@@ -127,6 +165,12 @@ public:
 
     QList<ImageFilterModelPrepareHook*> prepareHooks;
 
+    /// Sort keys by source row, a null key is computed on next use
+    mutable QVector<ImageSortKey>           sortKeys;
+    mutable QHash<qlonglong, ImageSortKey>  groupLeaderSortKeys;
+    QCollator                               sortCollator;
+    QCollator                               categoryCollator;
+
 /*
     QHash<int, QSet<qlonglong> >        categoryCountHashInt;
     QHash<QString, QSet<qlonglong> >    categoryCountHashString;
@@ -146,6 +190,10 @@ public Q_SLOTS:
     void packageFinished(const ImageFilterModelTodoPackage& package);
     void packageDiscarded(const ImageFilterModelTodoPackage& package);
 
+    void sourceRowsInserted(const QModelIndex& parent, int start, int end);
+    void sourceRowsRemoved(const QModelIndex& parent, int start, int end);
+    void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+
 Q_SIGNALS:
 
     void packageToPrepare(const ImageFilterModelTodoPackage& package);
@@ -24,6 +24,10 @@
 
 #include "imagesortsettings.h"
 
+// C++ includes
+
+#include <limits>
+
 // Qt includes
 
 #include <QDateTime>
@@ -37,6 +41,45 @@
 namespace Digikam
 {
 
+namespace
+{
+
+QCollatorSortKey nullCollatorSortKey()
+{
+    static const QCollatorSortKey key = QCollator().sortKey(QString());
+    return key;
+}
+
+qint64 dateTimeSortValue(const QDateTime& dateTime)
+{
+    // Invalid dates sort before all valid dates
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+} // namespace
+
+ImageSortKey::ImageSortKey()
+    : id(-1),
+      groupImageId(-1),
+      fileSize(0),
+      creationDate(0),
+      modificationDate(0),
+      pixels(0),
+      similarity(0.0),
+      albumId(-1),
+      rating(0),
+      aspectRatio(0),
+      versioned(false),
+      hasPathKey(false),
+      hasFormatKey(false),
+      nameKey(nullCollatorSortKey()),
+      pathKey(nullCollatorSortKey()),
+      formatKey(nullCollatorSortKey())
+{
+}
+
+// -----------------------------------------------------------------------------------
+
 ImageSortSettings::ImageSortSettings()
 {
     categorizationMode             = NoCategories;
@@ -292,6 +335,181 @@ int ImageSortSettings::compare(const ImageInfo& left, const ImageInfo& right, So
     }
 }
 
+QCollator ImageSortSettings::sortCollator() const
+{
+    QCollator collator;
+    collator.setNumericMode(strTypeNatural);
+    collator.setCaseSensitivity(sortCaseSensitivity);
+    return collator;
+}
+
+QCollator ImageSortSettings::categoryCollator() const
+{
+    QCollator collator;
+    collator.setNumericMode(strTypeNatural);
+    collator.setCaseSensitivity(categorizationCaseSensitivity);
+    return collator;
+}
+
+ImageSortKey ImageSortSettings::sortKey(const ImageInfo& info, const QCollator& sortCollator,
+                                        const QCollator& categoryCollator) const
+{
+    ImageSortKey key;
+
+    if (info.isNull())
+    {
+        return key;
+    }
+
+    const QString name    = info.name();
+    const QSize size      = info.dimensions();
+
+    key.info              = info;
+    key.id                = info.id();
+    key.groupImageId      = info.groupImageId();
+    key.fileSize          = info.fileSize();
+    key.creationDate      = dateTimeSortValue(info.dateTime());
+    key.modificationDate  = dateTimeSortValue(info.modDateTime());
+    key.pixels            = (qint64)size.width() * size.height();
+    key.aspectRatio       = (double(size.width()) / double(size.height())) * 1000000;
+    key.similarity        = (key.id == info.currentReferenceImage()) ? 1.1 : info.currentSimilarity();
+    key.albumId           = info.albumId();
+    key.rating            = info.rating();
+    key.versioned         = name.contains(QLatin1String("_v"), Qt::CaseInsensitive);
+    key.nameKey           = sortCollator.sortKey(name);
+
+    if (sortRole == SortByFilePath)
+    {
+        key.pathKey       = sortCollator.sortKey(info.filePath());
+        key.hasPathKey    = true;
+    }
+
+    if (categorizationMode == CategoryByFormat)
+    {
+        key.formatKey     = categoryCollator.sortKey(info.format());
+        key.hasFormatKey  = true;
+    }
+
+    return key;
+}
+
+int ImageSortSettings::compareCategories(const ImageSortKey& left, const ImageSortKey& right) const
+{
+    switch (categorizationMode)
+    {
+        case CategoryByAlbum:
+        {
+            if (left.albumId == right.albumId)
+            {
+                return 0;
+            }
+
+            return lessThanByOrder(left.albumId, right.albumId, currentCategorizationSortOrder) ? -1 : 1;
+        }
+        case CategoryByFormat:
+        {
+            if (!left.hasFormatKey || !right.hasFormatKey)
+            {
+                return compareCategories(left.info, right.info);
+            }
+
+            return compareByOrder(left.formatKey.compare(right.formatKey), currentCategorizationSortOrder);
+        }
+        default:
+            return 0;
+    }
+}
+
+bool ImageSortSettings::lessThan(const ImageSortKey& left, const ImageSortKey& right) const
+{
+    // Same hierarchy of sort roles as lessThan() for ImageInfos
+    int result = compare(left, right, sortRole);
+
+    if (result != 0)
+    {
+        return result < 0;
+    }
+
+    if (left.id == right.id)
+    {
+        return false;
+    }
+
+    if ( (result = compare(left, right, SortByFileName)) != 0)
+    {
+        return result < 0;
+    }
+
+    if ( (result = compare(left, right, SortByCreationDate)) != 0)
+    {
+        return result < 0;
+    }
+
+    if ( (result = compare(left, right, SortByModificationDate)) != 0)
+    {
+        return result < 0;
+    }
+
+    if ( (result = compare(left, right, SortByFilePath)) != 0)
+    {
+        return result < 0;
+    }
+
+    if ( (result = compare(left, right, SortByFileSize)) != 0)
+    {
+        return result < 0;
+    }
+
+    if ( (result = compare(left, right, SortBySimilarity)) != 0)
+    {
+        return result < 0;
+    }
+
+    return false;
+}
+
+int ImageSortSettings::compare(const ImageSortKey& left, const ImageSortKey& right, SortRole role) const
+{
+    switch (role)
+    {
+        case SortByFileName:
+        {
+            if (left.versioned || right.versioned)
+            {
+                // The collation ignores punctuation for pairs of versioned names, see compare() for ImageInfos
+                return compare(left.info, right.info, SortByFileName);
+            }
+
+            return compareByOrder(left.nameKey.compare(right.nameKey), currentSortOrder);
+        }
+        case SortByFilePath:
+        {
+            if (!left.hasPathKey || !right.hasPathKey)
+            {
+                return compare(left.info, right.info, SortByFilePath);
+            }
+
+            return compareByOrder(left.pathKey.compare(right.pathKey), currentSortOrder);
+        }
+        case SortByFileSize:
+            return compareByOrder(left.fileSize, right.fileSize, currentSortOrder);
+        case SortByModificationDate:
+            return compareByOrder(left.modificationDate, right.modificationDate, currentSortOrder);
+        case SortByCreationDate:
+            return compareByOrder(left.creationDate, right.creationDate, currentSortOrder);
+        case SortByRating:
+            return - compareByOrder(left.rating, right.rating, currentSortOrder);
+        case SortByImageSize:
+            return compareByOrder(left.pixels, right.pixels, currentSortOrder);
+        case SortByAspectRatio:
+            return compareByOrder(left.aspectRatio, right.aspectRatio, currentSortOrder);
+        case SortBySimilarity:
+            return compareByOrder(left.similarity, right.similarity, currentSortOrder);
+        default:
+            return 1;
+    }
+}
+
 bool ImageSortSettings::lessThan(const QVariant& left, const QVariant& right) const
 {
     if (left.type() != right.type())
@@ -35,17 +35,55 @@
 // Local includes
 
 #include "digikam_export.h"
+#include "imageinfo.h"
 
 namespace Digikam
 {
 
-class ImageInfo;
-
 namespace DatabaseFields
 {
     class Set;
 }
 
+/** The values of an item which ImageSortSettings compares, computed once,
+ *  so that comparing two items needs no locking, no database access and no
+ *  string collation. Created by ImageSortSettings::sortKey().
+ */
+class DIGIKAM_DATABASE_EXPORT ImageSortKey
+{
+public:
+
+    ImageSortKey();
+
+    bool isNull() const
+    {
+        return info.isNull();
+    }
+
+public:
+
+    ImageInfo        info;
+    qlonglong        id;
+    qlonglong        groupImageId;
+    qlonglong        fileSize;
+    qint64           creationDate;
+    qint64           modificationDate;
+    qint64           pixels;
+    double           similarity;
+    int              albumId;
+    int              rating;
+    int              aspectRatio;
+    bool             versioned;
+    bool             hasPathKey;
+    bool             hasFormatKey;
+
+    QCollatorSortKey nameKey;
+    QCollatorSortKey pathKey;
+    QCollatorSortKey formatKey;
+};
+
+// -----------------------------------------------------------------------------------
+
 class DIGIKAM_DATABASE_EXPORT ImageSortSettings
 {
 public:
@@ -137,6 +175,26 @@ public:
 
     int compare(const ImageInfo& left, const ImageInfo& right, SortRole sortRole) const;
 
+    /// --- Sort keys ---
+
+    /** Returns the collators used for sort keys: for file names and paths,
+     *  and for categories. Do not use one collator in several threads.
+     */
+    QCollator sortCollator()     const;
+    QCollator categoryCollator() const;
+
+    /** Returns the sort key of info for these settings. The collation keys of the
+     *  file path and of the format are only computed if the settings use them.
+     */
+    ImageSortKey sortKey(const ImageInfo& info, const QCollator& sortCollator,
+                         const QCollator& categoryCollator) const;
+
+    /** The same as the methods above for ImageInfos, on keys created with these settings.
+     */
+    int  compareCategories(const ImageSortKey& left, const ImageSortKey& right) const;
+    bool lessThan(const ImageSortKey& left, const ImageSortKey& right)          const;
+    int  compare(const ImageSortKey& left, const ImageSortKey& right, SortRole sortRole) const;
+
     // --- ---
 
     static Qt::SortOrder defaultSortOrderForCategorizationMode(CategorizationMode mode);
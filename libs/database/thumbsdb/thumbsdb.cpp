@@ -29,6 +29,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QSet>
 
 // Local includes
 
@@ -49,9 +50,30 @@ public:
     {
     }
 
+    /// Number of values bound to one query of the grouped lookups, below the limit of SQLite
+    enum
+    {
+        MaxBoundValues = 500
+    };
+
+    static QString placeholders(int count);
+
     ThumbsDbBackend* db;
 };
 
+QString ThumbsDb::Private::placeholders(int count)
+{
+    QString list;
+    list.reserve(count * 2);
+
+    for (int i = 0 ; i < count ; ++i)
+    {
+        list += (i == 0) ? QLatin1String("?") : QLatin1String(",?");
+    }
+
+    return list;
+}
+
 ThumbsDb::ThumbsDb(ThumbsDbBackend* const backend)
     : d(new Private)
 {
@@ -193,6 +215,134 @@ ThumbsDbInfo ThumbsDb::findByFilePath(const QString& path, const QString& unique
     }
 }
 
+static void fillThumbnailInfo(const DbEngineSqlCursor& cursor, int column, ThumbsDbInfo& info)
+{
+    info.id               = cursor.toInt(column);
+    info.type             = (DatabaseThumbnail::Type)cursor.toInt(column + 1);
+    info.modificationDate = cursor.toDateTime(column + 2);
+    info.orientationHint  = cursor.toInt(column + 3);
+    info.data             = cursor.value(column + 4).toByteArray();
+}
+
+QHash<QPair<QString, qlonglong>, ThumbsDbInfo> ThumbsDb::findByHashes(const QList<QPair<QString, qlonglong> >& hashesAndSizes)
+{
+    typedef QPair<QString, qlonglong> HashAndSize;
+
+    QHash<HashAndSize, ThumbsDbInfo> infos;
+    QSet<HashAndSize>                wanted;
+    QSet<QString>                    hashSet;
+
+    foreach(const HashAndSize& hashAndSize, hashesAndSizes)
+    {
+        wanted  << hashAndSize;
+        hashSet << hashAndSize.first;
+    }
+
+    const QList<QString> hashes = hashSet.toList();
+
+    for (int i = 0 ; i < hashes.size() ; i += Private::MaxBoundValues)
+    {
+        const QList<QString> chunk = hashes.mid(i, Private::MaxBoundValues);
+        QList<QVariant> boundValues;
+
+        foreach(const QString& hash, chunk)
+        {
+            boundValues << hash;
+        }
+
+        DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT uniqueHash, fileSize, "
+                                                                       "       id, type, modificationDate, orientationHint, data "
+                                                                       "FROM UniqueHashes "
+                                                                       "   INNER JOIN Thumbnails ON thumbId = id "
+                                                                       "WHERE uniqueHash IN (%1);")
+                                                     .arg(Private::placeholders(chunk.size())),
+                                                     boundValues);
+
+        while (cursor.next())
+        {
+            const HashAndSize key(cursor.toString(0), cursor.toLongLong(1));
+
+            if (wanted.contains(key))
+            {
+                fillThumbnailInfo(cursor, 2, infos[key]);
+            }
+        }
+    }
+
+    return infos;
+}
+
+QHash<QString, ThumbsDbInfo> ThumbsDb::findByFilePaths(const QHash<QString, QString>& pathsAndHashes)
+{
+    QHash<QString, ThumbsDbInfo> infos;
+    const QList<QString> paths = pathsAndHashes.keys();
+
+    for (int i = 0 ; i < paths.size() ; i += Private::MaxBoundValues)
+    {
+        const QList<QString> chunk = paths.mid(i, Private::MaxBoundValues);
+        QList<QVariant> boundValues;
+
+        foreach(const QString& path, chunk)
+        {
+            boundValues << path;
+        }
+
+        QHash<QString, ThumbsDbInfo> found;
+        QList<QVariant>              thumbIds;
+
+        {
+            DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT path, "
+                                                                           "       id, type, modificationDate, orientationHint, data "
+                                                                           "FROM FilePaths "
+                                                                           "   INNER JOIN Thumbnails ON thumbId = id "
+                                                                           "WHERE path IN (%1);")
+                                                         .arg(Private::placeholders(chunk.size())),
+                                                         boundValues);
+
+            while (cursor.next())
+            {
+                ThumbsDbInfo& info = found[cursor.toString(0)];
+                fillThumbnailInfo(cursor, 1, info);
+                thumbIds << info.id;
+            }
+        }
+
+        if (found.isEmpty())
+        {
+            continue;
+        }
+
+        // double check that thumbnails are not referenced by a different hash, as in findByFilePath()
+        QMultiHash<int, QString> hashesOfThumbs;
+
+        {
+            DbEngineSqlCursor cursor = d->db->execCursor(QString::fromUtf8("SELECT thumbId, uniqueHash FROM UniqueHashes "
+                                                                           "WHERE thumbId IN (%1);")
+                                                         .arg(Private::placeholders(thumbIds.size())),
+                                                         thumbIds);
+
+            while (cursor.next())
+            {
+                hashesOfThumbs.insert(cursor.toInt(0), cursor.toString(1));
+            }
+        }
+
+        for (QHash<QString, ThumbsDbInfo>::const_iterator it = found.constBegin() ; it != found.constEnd() ; ++it)
+        {
+            const QString uniqueHash = pathsAndHashes.value(it.key());
+
+            if (uniqueHash.isNull()                      ||
+                !hashesOfThumbs.contains(it.value().id)  ||
+                hashesOfThumbs.contains(it.value().id, uniqueHash))
+            {
+                infos.insert(it.key(), it.value());
+            }
+        }
+    }
+
+    return infos;
+}
+
 ThumbsDbInfo ThumbsDb::findByCustomIdentifier(const QString& id)
 {
     QList<QVariant> values;
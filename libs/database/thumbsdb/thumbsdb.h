@@ -102,6 +102,18 @@ public:
      */
     ThumbsDbInfo findByFilePath(const QString& path, const QString& uniqueHash);
 
+    /** Looks up the thumbnails of several files at once, with a few set-based queries.
+     *  The result is keyed by the uniqueHash + fileSize pairs; pairs without
+     *  thumbnail are not contained.
+     */
+    QHash<QPair<QString, qlonglong>, ThumbsDbInfo> findByHashes(const QList<QPair<QString, qlonglong> >& hashesAndSizes);
+
+    /** Looks up the thumbnails of several file paths at once. The given hash maps each
+     *  path to the uniqueHash which you have, which is checked as with findByFilePath(path, uniqueHash).
+     *  Paths without thumbnail are not contained in the result.
+     */
+    QHash<QString, ThumbsDbInfo> findByFilePaths(const QHash<QString, QString>& pathsAndHashes);
+
     /** Returns the thumbnail ids of all thumbnails in the database.
      */
     QList<int> findAll();
@@ -146,6 +146,17 @@ public:
     DImageHistory           imageHistory;
 };
 
+namespace DImgScale
+{
+
+/** True if the smooth scaling is built with the SSE2 kernels to scale down. They can be
+ *  disabled to compare with the scalar kernels. For benchmarks and tests only: not thread-safe.
+ */
+DIGIKAM_EXPORT bool sse2KernelsAvailable();
+DIGIKAM_EXPORT void setSSE2KernelsEnabled(bool enabled);
+
+}  // namespace DImgScale
+
 }  // namespace Digikam
 
 #endif // DIMGPRIVATE_H
@@ -47,6 +47,13 @@ extern "C"
 #include <cstdlib>
 #include <cstdio>
 
+// Qt includes
+
+#include <QList>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
+
 // Local includes
 
 #include "digikam_debug.h"
@@ -56,6 +63,13 @@ extern "C"
 typedef uint64_t ullong;
 typedef int64_t  llong;
 
+// SSE2 is part of all x86-64 CPUs and is used unconditionally when the compiler targets it.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define DIMGSCALE_USE_SSE2
+#   include <emmintrin.h>
+#endif
+
 namespace Digikam
 {
 
@@ -155,6 +169,32 @@ void dimgScaleAARGB16(DImgScaleInfo* const isi, ullong* const dest,
                       int dxx, int dyy, int dw, int dh,
                       int dow, int sow,
                       int clip_dx, int clip_dy, int clip_dw, int clip_dh);
+
+// Area sampling of any image, by bands of destination rows processed in parallel
+void dimgScaleAA(DImgScaleInfo* const isi, uchar* const dest,
+                 bool sixteenBit, bool hasAlpha,
+                 int dxx, int dyy, int dw, int dh,
+                 int dow, int sow,
+                 int clip_dx, int clip_dy, int clip_dw, int clip_dh,
+                 qint64 sourcePixels);
+
+#ifdef DIMGSCALE_USE_SSE2
+
+// Cleared by setSSE2KernelsEnabled(), to compare with the scalar kernels
+static bool useSSE2Kernels = true;
+
+// Scaling down both ways, with the four channels of a pixel computed at once
+void dimgScaleAADownSSE2(DImgScaleInfo* const isi, uint* const dest,
+                         int dyy, int dow, int sow,
+                         int x_begin, int x_end, int y_begin, int y_end,
+                         bool hasAlpha);
+
+void dimgScaleAADown16SSE2(DImgScaleInfo* const isi, ullong* const dest,
+                           int dyy, int dow, int sow,
+                           int x_begin, int x_end, int y_begin, int y_end,
+                           bool hasAlpha);
+
+#endif // DIMGSCALE_USE_SSE2
 }
 
 using namespace DImgScale;
@@ -229,36 +269,10 @@ DImg DImg::smoothScaleClipped(int dw, int dh, int clipx, int clipy, int clipw, i
 
     DImg buffer(*this, clipw, cliph);
 
-    if (sixteenBit())
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                              0, 0, dw, dh, clipw, w,
-                              clipx, clipy, clipw, cliph);
-        }
-        else
-        {
-            dimgScaleAARGB16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                             0, 0, dw, dh, clipw, w,
-                             clipx, clipy, clipw, cliph);
-        }
-    }
-    else
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA(scaleinfo, reinterpret_cast<uint*>(buffer.bits()),
-                            0, 0, dw, dh, clipw, w,
-                            clipx, clipy, clipw, cliph);
-        }
-        else
-        {
-            dimgScaleAARGB(scaleinfo, reinterpret_cast<uint*>(buffer.bits()),
-                           0, 0, dw, dh, clipw, w,
-                           clipx, clipy, clipw, cliph);
-        }
-    }
+    dimgScaleAA(scaleinfo, buffer.bits(), sixteenBit(), hasAlpha(),
+                0, 0, dw, dh, clipw, w,
+                clipx, clipy, clipw, cliph,
+                (qint64)w * h);
 
     delete scaleinfo;
 
@@ -336,46 +350,13 @@ DImg DImg::smoothScaleSection(int sx, int sy,
 
     DImg buffer(*this, dw, dh);
 
-    if (sixteenBit())
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                              ((sx * dw) / sw),
-                              ((sy * dh) / sh),
-                              dw, dh,
-                              dw, w);
-        }
-        else
-        {
-            dimgScaleAARGB16(scaleinfo, reinterpret_cast<ullong*>(buffer.bits()),
-                             ((sx * dw) / sw),
-                             ((sy * dh) / sh),
-                             dw, dh,
-                             dw, w);
-        }
-    }
-    else
-    {
-        if (hasAlpha())
-        {
-            dimgScaleAARGBA(scaleinfo,
-                            reinterpret_cast<uint*>(buffer.bits()),
-                            ((sx * dw) / sw),
-                            ((sy * dh) / sh),
-                            dw, dh,
-                            dw, w);
-        }
-        else
-        {
-            dimgScaleAARGB(scaleinfo,
-                           reinterpret_cast<uint*>(buffer.bits()),
-                           ((sx * dw) / sw),
-                           ((sy * dh) / sh),
-                           dw, dh,
-                           dw, w);
-        }
-    }
+    dimgScaleAA(scaleinfo, buffer.bits(), sixteenBit(), hasAlpha(),
+                ((sx * dw) / sw),
+                ((sy * dh) / sh),
+                dw, dh,
+                dw, w,
+                0, 0, dw, dh,
+                (qint64)sw * sh);
 
     delete scaleinfo;
 
@@ -995,6 +976,14 @@ void DImgScale::dimgScaleAARGBA(DImgScaleInfo* const isi, uint* const dest,
     /* if we're scaling down horizontally & vertically */
     else
     {
+#ifdef DIMGSCALE_USE_SSE2
+        if (useSSE2Kernels)
+        {
+            dimgScaleAADownSSE2(isi, dest, dyy, dow, sow, x_begin, x_end, y_begin, y_end, true);
+            return;
+        }
+#endif
+
         /*\ 'Correct' version, with math units prepared for MMXification:
         |*|  The operation 'b = (b * c) >> 16' translates to pmulhw,
         |*|  so the operation 'b = (b * c) >> d' would translate to
@@ -1438,6 +1427,14 @@ void DImgScale::dimgScaleAARGB(DImgScaleInfo* const isi, uint* const dest,
     /* if we're scaling down horizontally & vertically */
     else
     {
+#ifdef DIMGSCALE_USE_SSE2
+        if (useSSE2Kernels)
+        {
+            dimgScaleAADownSSE2(isi, dest, dyy, dow, sow, x_begin, x_end, y_begin, y_end, false);
+            return;
+        }
+#endif
+
         /*\ 'Correct' version, with math units prepared for MMXification \*/
         int Cx, Cy, i, j;
         uint* pix=0;
@@ -1865,6 +1862,14 @@ void DImgScale::dimgScaleAARGB16(DImgScaleInfo* const isi, ullong* const dest,
     // if we're scaling down horizontally & vertically
     else
     {
+#ifdef DIMGSCALE_USE_SSE2
+        if (useSSE2Kernels)
+        {
+            dimgScaleAADown16SSE2(isi, dest, dyy, dow, sow, x_begin, x_end, y_begin, y_end, false);
+            return;
+        }
+#endif
+
         // 'Correct' version, with math units prepared for MMXification
         int Cx, Cy, i, j;
         ullong* pix=0;
@@ -2317,6 +2322,14 @@ void DImgScale::dimgScaleAARGBA16(DImgScaleInfo* const isi, ullong* const dest,
     /* if we're scaling down horizontally & vertically */
     else
     {
+#ifdef DIMGSCALE_USE_SSE2
+        if (useSSE2Kernels)
+        {
+            dimgScaleAADown16SSE2(isi, dest, dyy, dow, sow, x_begin, x_end, y_begin, y_end, true);
+            return;
+        }
+#endif
+
         /*\ 'Correct' version, with math units prepared for MMXification:
         |*|  The operation 'b = (b * c) >> 16' translates to pmulhw,
         |*|  so the operation 'b = (b * c) >> d' would translate to
@@ -2445,4 +2458,295 @@ void DImgScale::dimgScaleAARGBA16(DImgScaleInfo* const isi, ullong* const dest,
     }
 }
 
+bool DImgScale::sse2KernelsAvailable()
+{
+#ifdef DIMGSCALE_USE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DImgScale::setSSE2KernelsEnabled(bool enabled)
+{
+#ifdef DIMGSCALE_USE_SSE2
+    useSSE2Kernels = enabled;
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+/** Dispatch the area sampling to the kernel of the image format.
+ *  The destination rows are cut in bands which are scaled concurrently: a band is the same
+ *  call of the kernel with a smaller vertical clip, so the result does not depend on the
+ *  number of bands. The scale info tables are only read, and are shared by all bands.
+ *  The calling thread scales the last band itself.
+ */
+void DImgScale::dimgScaleAA(DImgScaleInfo* const isi, uchar* const dest,
+                            bool sixteenBit, bool hasAlpha,
+                            int dxx, int dyy, int dw, int dh,
+                            int dow, int sow,
+                            int clip_dx, int clip_dy, int clip_dw, int clip_dh,
+                            qint64 sourcePixels)
+{
+    // Below this amount of pixels to read or write, the thread overhead is not worth it.
+    const qint64 minPixelsPerBand = 128 * 1024;
+    // Keep bands higher than a few rows, for the source cache lines to be reused.
+    const int    minRowsPerBand   = 8;
+
+    const qint64 work             = qMax(sourcePixels, (qint64)clip_dw * clip_dh);
+    int          bands            = QThreadPool::globalInstance()->maxThreadCount();
+    bands                         = (int)qMin((qint64)bands, work / minPixelsPerBand);
+    bands                         = qMin(bands, clip_dh / minRowsPerBand);
+    bands                         = qMax(bands, 1);
+
+    const int bytesDepth          = sixteenBit ? 8 : 4;
+
+    auto scaleBand = [=](int band)
+    {
+        const int first   = clip_dy + (int)((qint64)clip_dh * band       / bands);
+        const int last    = clip_dy + (int)((qint64)clip_dh * (band + 1) / bands);
+        uchar* const bptr = dest + (size_t)(first - clip_dy) * dow * bytesDepth;
+
+        if (last <= first)
+        {
+            return;
+        }
+
+        if (sixteenBit)
+        {
+            if (hasAlpha)
+            {
+                dimgScaleAARGBA16(isi, reinterpret_cast<ullong*>(bptr), dxx, dyy, dw, dh, dow, sow,
+                                  clip_dx, first, clip_dw, last - first);
+            }
+            else
+            {
+                dimgScaleAARGB16(isi, reinterpret_cast<ullong*>(bptr), dxx, dyy, dw, dh, dow, sow,
+                                 clip_dx, first, clip_dw, last - first);
+            }
+        }
+        else
+        {
+            if (hasAlpha)
+            {
+                dimgScaleAARGBA(isi, reinterpret_cast<uint*>(bptr), dxx, dyy, dw, dh, dow, sow,
+                                clip_dx, first, clip_dw, last - first);
+            }
+            else
+            {
+                dimgScaleAARGB(isi, reinterpret_cast<uint*>(bptr), dxx, dyy, dw, dh, dow, sow,
+                               clip_dx, first, clip_dw, last - first);
+            }
+        }
+    };
+
+    QList <QFuture<void> > tasks;
+
+    for (int band = 0 ; band < bands - 1 ; ++band)
+    {
+        tasks.append(QtConcurrent::run([scaleBand, band]() { scaleBand(band); }));
+    }
+
+    scaleBand(bands - 1);
+
+    foreach(QFuture<void> t, tasks)
+        t.waitForFinished();
+}
+
+#ifdef DIMGSCALE_USE_SSE2
+
+/** The SSE2 kernels below perform exactly the integer operations of the scalar code for
+ *  scaling down both ways, on the four channels of a pixel at once, so their result is identical.
+ *  In 8 bits, all products fit in 16x16 bits multiplications: the weights are at most 1 << 14,
+ *  the channel values at most 255, and the horizontal sums at most 255 << 5.
+ *  In 16 bits, the products are computed on 64 bits lanes, two channels per register.
+ */
+
+static inline __m128i dimgLoadPixelSSE2(const uint* const pix)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)*pix), zero), zero);
+}
+
+/// Weighted sum of a run of source pixels: the horizontal part of the area sampling
+static inline __m128i dimgSumRowSSE2(const uint* pix, int xap, int Cx)
+{
+    const __m128i cx = _mm_set1_epi32(Cx);
+    __m128i rx       = _mm_srai_epi32(_mm_madd_epi16(dimgLoadPixelSSE2(pix), _mm_set1_epi32(xap)), 9);
+    int i;
+
+    ++pix;
+
+    for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+    {
+        rx = _mm_add_epi32(rx, _mm_srai_epi32(_mm_madd_epi16(dimgLoadPixelSSE2(pix), cx), 9));
+        ++pix;
+    }
+
+    if (i > 0)
+    {
+        rx = _mm_add_epi32(rx, _mm_srai_epi32(_mm_madd_epi16(dimgLoadPixelSSE2(pix), _mm_set1_epi32(i)), 9));
+    }
+
+    return rx;
+}
+
+void DImgScale::dimgScaleAADownSSE2(DImgScaleInfo* const isi, uint* const dest,
+                                    int dyy, int dow, int sow,
+                                    int x_begin, int x_end, int y_begin, int y_end,
+                                    bool hasAlpha)
+{
+    uint** ypoints     = isi->ypoints;
+    int* xpoints       = isi->xpoints;
+    int* xapoints      = isi->xapoints;
+    int* yapoints      = isi->yapoints;
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const uint opaque  = hasAlpha ? 0 : 0xFF000000;
+    int x, y, j;
+
+    for (y = y_begin; y < y_end; ++y)
+    {
+        const int Cy       = YAP >> 16;
+        const int yap      = YAP & 0xffff;
+        const __m128i cy   = _mm_set1_epi32(Cy);
+        const __m128i vyap = _mm_set1_epi32(yap);
+        uint* dptr         = dest + (y - y_begin) * dow;
+
+        for (x = x_begin; x < x_end; ++x)
+        {
+            const int Cx  = XAP >> 16;
+            const int xap = XAP & 0xffff;
+            uint* sptr    = ypoints[dyy + y] + xpoints[x];
+            __m128i rx    = dimgSumRowSSE2(sptr, xap, Cx);
+            __m128i r     = _mm_srai_epi32(_mm_madd_epi16(rx, vyap), 14);
+            sptr         += sow;
+
+            for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+            {
+                rx    = dimgSumRowSSE2(sptr, xap, Cx);
+                r     = _mm_add_epi32(r, _mm_srai_epi32(_mm_madd_epi16(rx, cy), 14));
+                sptr += sow;
+            }
+
+            if (j > 0)
+            {
+                rx = dimgSumRowSSE2(sptr, xap, Cx);
+                r  = _mm_add_epi32(r, _mm_srai_epi32(_mm_madd_epi16(rx, _mm_set1_epi32(j)), 14));
+            }
+
+            // Keep the low byte of each channel, as the scalar assignment to uchar does.
+            r       = _mm_and_si128(_mm_srai_epi32(r, 5), mask);
+            r       = _mm_packus_epi16(_mm_packs_epi32(r, r), r);
+            *dptr++ = (uint)_mm_cvtsi128_si32(r) | opaque;
+        }
+    }
+}
+
+static inline void dimgLoadPixel16SSE2(const ullong* const pix, __m128i& bg, __m128i& ra)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v    = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix)), zero);
+    bg                 = _mm_unpacklo_epi32(v, zero);
+    ra                 = _mm_unpackhi_epi32(v, zero);
+}
+
+static inline void dimgAddWeighted16SSE2(__m128i& sbg, __m128i& sra, __m128i bg, __m128i ra,
+                                         __m128i weight, int shift)
+{
+    sbg = _mm_add_epi64(sbg, _mm_srli_epi64(_mm_mul_epu32(bg, weight), shift));
+    sra = _mm_add_epi64(sra, _mm_srli_epi64(_mm_mul_epu32(ra, weight), shift));
+}
+
+/// Weighted sum of a run of source pixels: the horizontal part of the area sampling
+static inline void dimgSumRow16SSE2(const ullong* pix, int xap, int Cx, __m128i& rbg, __m128i& rra)
+{
+    const __m128i cx = _mm_set1_epi32(Cx);
+    __m128i bg, ra;
+    int i;
+
+    rbg = _mm_setzero_si128();
+    rra = _mm_setzero_si128();
+    dimgLoadPixel16SSE2(pix, bg, ra);
+    dimgAddWeighted16SSE2(rbg, rra, bg, ra, _mm_set1_epi32(xap), 9);
+    ++pix;
+
+    for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+    {
+        dimgLoadPixel16SSE2(pix, bg, ra);
+        dimgAddWeighted16SSE2(rbg, rra, bg, ra, cx, 9);
+        ++pix;
+    }
+
+    if (i > 0)
+    {
+        dimgLoadPixel16SSE2(pix, bg, ra);
+        dimgAddWeighted16SSE2(rbg, rra, bg, ra, _mm_set1_epi32(i), 9);
+    }
+}
+
+void DImgScale::dimgScaleAADown16SSE2(DImgScaleInfo* const isi, ullong* const dest,
+                                      int dyy, int dow, int sow,
+                                      int x_begin, int x_end, int y_begin, int y_end,
+                                      bool hasAlpha)
+{
+    ullong** ypoints    = isi->ypoints16;
+    int* xpoints        = isi->xpoints;
+    int* xapoints       = isi->xapoints;
+    int* yapoints       = isi->yapoints;
+    const ullong opaque = hasAlpha ? 0 : 0xFFFF000000000000ULL;
+    int x, y, j;
+
+    for (y = y_begin; y < y_end; ++y)
+    {
+        const int Cy       = YAP >> 16;
+        const int yap      = YAP & 0xffff;
+        const __m128i cy   = _mm_set1_epi32(Cy);
+        const __m128i vyap = _mm_set1_epi32(yap);
+        ullong* dptr       = dest + (y - y_begin) * dow;
+
+        for (x = x_begin; x < x_end; ++x)
+        {
+            const int Cx  = XAP >> 16;
+            const int xap = XAP & 0xffff;
+            ullong* sptr  = ypoints[dyy + y] + xpoints[x];
+            __m128i rbg   = _mm_setzero_si128();
+            __m128i rra   = _mm_setzero_si128();
+            __m128i xbg, xra;
+
+            dimgSumRow16SSE2(sptr, xap, Cx, xbg, xra);
+            dimgAddWeighted16SSE2(rbg, rra, xbg, xra, vyap, 14);
+            sptr += sow;
+
+            for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+            {
+                dimgSumRow16SSE2(sptr, xap, Cx, xbg, xra);
+                dimgAddWeighted16SSE2(rbg, rra, xbg, xra, cy, 14);
+                sptr += sow;
+            }
+
+            if (j > 0)
+            {
+                dimgSumRow16SSE2(sptr, xap, Cx, xbg, xra);
+                dimgAddWeighted16SSE2(rbg, rra, xbg, xra, _mm_set1_epi32(j), 14);
+            }
+
+            // Gather the low 16 bits of the four 64 bits results, as the scalar assignment to ushort does.
+            rbg = _mm_shuffle_epi32(_mm_srli_epi64(rbg, 5), _MM_SHUFFLE(3, 1, 2, 0));
+            rra = _mm_shuffle_epi32(_mm_srli_epi64(rra, 5), _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i r = _mm_unpacklo_epi64(rbg, rra);
+            r         = _mm_shufflelo_epi16(r, _MM_SHUFFLE(3, 1, 2, 0));
+            r         = _mm_shufflehi_epi16(r, _MM_SHUFFLE(3, 1, 2, 0));
+            r         = _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 1, 2, 0));
+
+            ullong pixel;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&pixel), r);
+            *dptr++ = pixel | opaque;
+        }
+    }
+}
+
+#endif // DIMGSCALE_USE_SSE2
+
 }  // namespace Digikam
@@ -142,7 +142,17 @@ void AutoLevelsFilter::autoLevelsCorrectionImage()
     // Apply the lut to the image.
     if (runningFlag())
     {
-        levels->levelsLutProcess(data, desData.data(), w, h);
+        uchar* const destBits = desData.data();
+        ImageLevels* const lvl = levels.data();
+        const int lineSize     = w * m_orgImage.bytesDepth();
+
+        runMultithreaded(0, h,
+            [lvl, data, destBits, w, lineSize](int start, int stop)
+            {
+                lvl->levelsLutProcess(data + (size_t)start * lineSize, destBits + (size_t)start * lineSize, w, stop - start);
+            },
+            60, 70);
+
         postProgress(70);
     }
 
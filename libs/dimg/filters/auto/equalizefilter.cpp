@@ -85,8 +85,7 @@ void EqualizeFilter::equalizeImage()
     }
 
     struct double_packet  high, low, intensity;
-   int          i;
-    int                   progress;
+    int                   i;
 
     // Create an histogram of the reference image.
     QScopedPointer<ImageHistogram> histogram(new ImageHistogram(m_refImage));
@@ -143,44 +142,59 @@ void EqualizeFilter::equalizeImage()
                                             (map[i].alpha - low.alpha)) / (high.alpha - low.alpha));
     }
 
-    uchar* data     = m_orgImage.bits();
-    int w           = m_orgImage.width();
-    int h           = m_orgImage.height();
-    bool sixteenBit = m_orgImage.sixteenBit();
-    int size        = w * h;
+    // Apply results to image. Each pixel only depends on itself, so ranges of pixels are processed in parallel.
 
-    // Apply results to image.
+    Args prm;
+    prm.data        = m_orgImage.bits();
+    prm.sixteenBit  = m_orgImage.sixteenBit();
+    prm.low         = low;
+    prm.high        = high;
+    prm.equalizeMap = equalize_map.data();
+
+    runMultithreaded(0, m_orgImage.width() * m_orgImage.height(),
+        [this, &prm](int start, int stop)
+        {
+            Args chunkPrm  = prm;
+            chunkPrm.start = start;
+            chunkPrm.stop  = stop;
+            equalizeImageMultithreaded(chunkPrm);
+        },
+        0, 100);
+}
+
+void EqualizeFilter::equalizeImageMultithreaded(const Args& prm)
+{
     // TODO magic number 257
-    if (!sixteenBit)        // 8 bits image.
+    if (!prm.sixteenBit)        // 8 bits image.
     {
         uchar  red, green, blue, alpha;
-        uchar* ptr = data;
+        uchar* ptr = prm.data + prm.start * 4;
 
-        for (i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
             alpha = ptr[3];
 
-            if (low.red != high.red)
+            if (prm.low.red != prm.high.red)
             {
-                red = (equalize_map[red].red) / 257;
+                red = (prm.equalizeMap[red].red) / 257;
             }
 
-            if (low.green != high.green)
+            if (prm.low.green != prm.high.green)
             {
-                green = (equalize_map[green].green) / 257;
+                green = (prm.equalizeMap[green].green) / 257;
             }
 
-            if (low.blue != high.blue)
+            if (prm.low.blue != prm.high.blue)
             {
-                blue = (equalize_map[blue].blue) / 257;
+                blue = (prm.equalizeMap[blue].blue) / 257;
             }
 
-            if (low.alpha != high.alpha)
+            if (prm.low.alpha != prm.high.alpha)
             {
-                alpha = (equalize_map[alpha].alpha) / 257;
+                alpha = (prm.equalizeMap[alpha].alpha) / 257;
             }
 
             ptr[0] = blue;
@@ -188,45 +202,38 @@ void EqualizeFilter::equalizeImage()
             ptr[2] = red;
             ptr[3] = alpha;
             ptr   += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else               // 16 bits image.
     {
         unsigned short  red, green, blue, alpha;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(data);
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(prm.data) + prm.start * 4;
 
-        for (i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
             alpha = ptr[3];
 
-            if (low.red != high.red)
+            if (prm.low.red != prm.high.red)
             {
-                red = (equalize_map[red].red) / 257;
+                red = (prm.equalizeMap[red].red) / 257;
             }
 
-            if (low.green != high.green)
+            if (prm.low.green != prm.high.green)
             {
-                green = (equalize_map[green].green) / 257;
+                green = (prm.equalizeMap[green].green) / 257;
             }
 
-            if (low.blue != high.blue)
+            if (prm.low.blue != prm.high.blue)
             {
-                blue = (equalize_map[blue].blue) / 257;
+                blue = (prm.equalizeMap[blue].blue) / 257;
             }
 
-            if (low.alpha != high.alpha)
+            if (prm.low.alpha != prm.high.alpha)
             {
-                alpha = (equalize_map[alpha].alpha) / 257;
+                alpha = (prm.equalizeMap[alpha].alpha) / 257;
             }
 
             ptr[0] = blue;
@@ -234,13 +241,6 @@ void EqualizeFilter::equalizeImage()
             ptr[2] = red;
             ptr[3] = alpha;
             ptr   += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
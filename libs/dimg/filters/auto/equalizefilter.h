@@ -95,6 +95,21 @@ private:
         unsigned int alpha;
     };
 
+    struct Args
+    {
+        uint          start;
+        uint          stop;
+        uchar*        data;
+        bool          sixteenBit;
+        double_packet low;
+        double_packet high;
+        int_packet*   equalizeMap;
+    };
+
+    void equalizeImageMultithreaded(const Args& prm);
+
+private:
+
     DImg m_refImage;
 };
 
@@ -28,6 +28,10 @@
 #include <cstdio>
 #include <cmath>
 
+// Qt includes
+
+#include <QMutex>
+
 // Local includes
 
 #include "dimg.h"
@@ -87,51 +91,103 @@ void NormalizeFilter::normalizeImage()
     NormalizeParam param;
     param.lut = new unsigned short[segments];
 
-    // Find min. and max. values.
+    // Find min. and max. values. Each range of pixels is searched in parallel, then the results are merged.
+
+    param.min = segments - 1;
+    param.max = 0;
+
+    QMutex lock;
+    uchar* const refBits = m_refImage.bits();
+
+    runMultithreaded(0, m_refImage.width() * m_refImage.height(),
+        [this, refBits, sixteenBit, segments, &param, &lock](int start, int stop)
+        {
+            double chunkMin = segments - 1;
+            double chunkMax = 0;
+            findMinMaxMultithreaded(start, stop, refBits, sixteenBit, chunkMin, chunkMax);
+
+            QMutexLocker locker(&lock);
+            param.min = qMin(param.min, chunkMin);
+            param.max = qMax(param.max, chunkMax);
+        },
+        0, 50);
+
+    // Calculate LUT.
+
+    if (runningFlag())
+    {
+        unsigned short range = (unsigned short)(param.max - param.min);
+
+        if (range != 0)
+        {
+            for (int x = (int)param.min ; x <= (int)param.max ; ++x)
+            {
+                param.lut[x] = (unsigned short)((segments - 1) * (x - param.min) / range);
+            }
+        }
+        else
+        {
+            param.lut[(int)param.min] = (unsigned short)param.min;
+        }
+    }
+
+    // Apply LUT to image.
+
+    uchar* const data               = m_orgImage.bits();
+    const unsigned short* const lut = param.lut;
+
+    runMultithreaded(0, m_orgImage.width() * m_orgImage.height(),
+        [this, data, sixteenBit, lut](int start, int stop)
+        {
+            normalizeImageMultithreaded(start, stop, data, sixteenBit, lut);
+        },
+        50, 100);
 
-    param.min    = segments - 1;
-    param.max    = 0;
-    uint refSize = m_refImage.width() * m_refImage.height();
+    delete [] param.lut;
+}
 
+void NormalizeFilter::findMinMaxMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBit,
+                                              double& chunkMin, double& chunkMax)
+{
     if (!sixteenBit)        // 8 bits image.
     {
         uchar  red, green, blue;
-        uchar* ptr = m_refImage.bits();
+        uchar* ptr = bits + start * 4;
 
-        for (uint i = 0 ; runningFlag() && (i < refSize) ; ++i)
+        for (uint i = start ; runningFlag() && (i < stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
 
-            if (red < param.min)
+            if (red < chunkMin)
             {
-                param.min = red;
+                chunkMin = red;
             }
 
-            if (red > param.max)
+            if (red > chunkMax)
             {
-                param.max = red;
+                chunkMax = red;
             }
 
-            if (green < param.min)
+            if (green < chunkMin)
             {
-                param.min = green;
+                chunkMin = green;
             }
 
-            if (green > param.max)
+            if (green > chunkMax)
             {
-                param.max = green;
+                chunkMax = green;
             }
 
-            if (blue < param.min)
+            if (blue < chunkMin)
             {
-                param.min = blue;
+                chunkMin = blue;
             }
 
-            if (blue > param.max)
+            if (blue > chunkMax)
             {
-                param.max = blue;
+                chunkMax = blue;
             }
 
             ptr += 4;
@@ -140,127 +196,88 @@ void NormalizeFilter::normalizeImage()
     else                    // 16 bits image.
     {
         unsigned short  red, green, blue;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(m_refImage.bits());
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(bits) + start * 4;
 
-        for (uint i = 0 ; runningFlag() && (i < refSize) ; ++i)
+        for (uint i = start ; runningFlag() && (i < stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
 
-            if (red < param.min)
+            if (red < chunkMin)
             {
-                param.min = red;
+                chunkMin = red;
             }
 
-            if (red > param.max)
+            if (red > chunkMax)
             {
-                param.max = red;
+                chunkMax = red;
             }
 
-            if (green < param.min)
+            if (green < chunkMin)
             {
-                param.min = green;
+                chunkMin = green;
             }
 
-            if (green > param.max)
+            if (green > chunkMax)
             {
-                param.max = green;
+                chunkMax = green;
             }
 
-            if (blue < param.min)
+            if (blue < chunkMin)
             {
-                param.min = blue;
+                chunkMin = blue;
             }
 
-            if (blue > param.max)
+            if (blue > chunkMax)
             {
-                param.max = blue;
+                chunkMax = blue;
             }
 
             ptr += 4;
         }
     }
+}
 
-    // Calculate LUT.
-
-    if (runningFlag())
-    {
-        unsigned short range = (unsigned short)(param.max - param.min);
-
-        if (range != 0)
-        {
-            for (int x = (int)param.min ; x <= (int)param.max ; ++x)
-            {
-                param.lut[x] = (unsigned short)((segments - 1) * (x - param.min) / range);
-            }
-        }
-        else
-        {
-            param.lut[(int)param.min] = (unsigned short)param.min;
-        }
-    }
-
-    uchar* data = m_orgImage.bits();
-    int w       = m_orgImage.width();
-    int h       = m_orgImage.height();
-    uint size   = w * h;
-
-    // Apply LUT to image.
-    int progress = 0;
-
+void NormalizeFilter::normalizeImageMultithreaded(uint start, uint stop, uchar* const data, bool sixteenBit,
+                                                  const unsigned short* const lut)
+{
     if (!sixteenBit)        // 8 bits image.
     {
         uchar  red, green, blue;
-        uchar* ptr = data;
+        uchar* ptr = data + start * 4;
 
-        for (uint i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = start ; runningFlag() && (i < stop) ; ++i)
         {
             blue   = ptr[0];
             green  = ptr[1];
             red    = ptr[2];
 
-            ptr[0] = param.lut[blue];
-            ptr[1] = param.lut[green];
-            ptr[2] = param.lut[red];
+            ptr[0] = lut[blue];
+            ptr[1] = lut[green];
+            ptr[2] = lut[red];
 
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else                    // 16 bits image.
     {
         unsigned short  red, green, blue;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(data);
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(data) + start * 4;
 
-        for (uint i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = start ; runningFlag() && (i < stop) ; ++i)
         {
             blue   = ptr[0];
             green  = ptr[1];
             red    = ptr[2];
 
-            ptr[0] = param.lut[blue];
-            ptr[1] = param.lut[green];
-            ptr[2] = param.lut[red];
+            ptr[0] = lut[blue];
+            ptr[1] = lut[green];
+            ptr[2] = lut[red];
 
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
-
-    delete [] param.lut;
 }
 
 FilterAction NormalizeFilter::filterAction()
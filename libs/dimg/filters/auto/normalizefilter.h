@@ -76,6 +76,10 @@ private:
 
     void filterImage();
     void normalizeImage();
+    void findMinMaxMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBit,
+                                 double& chunkMin, double& chunkMax);
+    void normalizeImageMultithreaded(uint start, uint stop, uchar* const data, bool sixteenBit,
+                                     const unsigned short* const lut);
 
 private:
 
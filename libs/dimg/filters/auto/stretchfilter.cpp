@@ -79,8 +79,7 @@ void StretchFilter::stretchContrastImage()
 
     struct double_packet high, low, intensity;
     long long            number_pixels;
-   long        i;
-    int                  progress;
+    long                 i;
     unsigned long        threshold_intensity;
 
     // Create an histogram of the reference image.
@@ -337,45 +336,59 @@ void StretchFilter::stretchContrastImage()
         }
     }
 
-    // Apply result to image.
+    // Apply result to image. Each pixel only depends on itself, so ranges of pixels are processed in parallel.
 
-    uchar* data     = m_orgImage.bits();
-    int w           = m_orgImage.width();
-    int h           = m_orgImage.height();
-    bool sixteenBit = m_orgImage.sixteenBit();
-    int size        = w * h;
+    Args prm;
+    prm.data         = m_orgImage.bits();
+    prm.sixteenBit   = m_orgImage.sixteenBit();
+    prm.low          = low;
+    prm.high         = high;
+    prm.normalizeMap = normalize_map.data();
 
+    runMultithreaded(0, m_orgImage.width() * m_orgImage.height(),
+        [this, &prm](int start, int stop)
+        {
+            Args chunkPrm  = prm;
+            chunkPrm.start = start;
+            chunkPrm.stop  = stop;
+            stretchContrastImageMultithreaded(chunkPrm);
+        },
+        0, 100);
+}
+
+void StretchFilter::stretchContrastImageMultithreaded(const Args& prm)
+{
     // TODO magic number 257
-    if (!sixteenBit)        // 8 bits image.
+    if (!prm.sixteenBit)        // 8 bits image.
     {
         uchar  red, green, blue, alpha;
-        uchar* ptr = data;
+        uchar* ptr = prm.data + prm.start * 4;
 
-        for (i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
             alpha = ptr[3];
 
-            if (low.red != high.red)
+            if (prm.low.red != prm.high.red)
             {
-                red = (normalize_map[red].red) / 257;
+                red = (prm.normalizeMap[red].red) / 257;
             }
 
-            if (low.green != high.green)
+            if (prm.low.green != prm.high.green)
             {
-                green = (normalize_map[green].green) / 257;
+                green = (prm.normalizeMap[green].green) / 257;
             }
 
-            if (low.blue != high.blue)
+            if (prm.low.blue != prm.high.blue)
             {
-                blue = (normalize_map[blue].blue) / 257;
+                blue = (prm.normalizeMap[blue].blue) / 257;
             }
 
-            if (low.alpha != high.alpha)
+            if (prm.low.alpha != prm.high.alpha)
             {
-                alpha = (normalize_map[alpha].alpha) / 257;
+                alpha = (prm.normalizeMap[alpha].alpha) / 257;
             }
 
             ptr[0] = blue;
@@ -383,45 +396,38 @@ void StretchFilter::stretchContrastImage()
             ptr[2] = red;
             ptr[3] = alpha;
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else               // 16 bits image.
     {
         unsigned short  red, green, blue, alpha;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(data);
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(prm.data) + prm.start * 4;
 
-        for (i = 0 ; runningFlag() && (i < size) ; ++i)
+        for (uint i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
             red   = ptr[2];
             alpha = ptr[3];
 
-            if (low.red != high.red)
+            if (prm.low.red != prm.high.red)
             {
-                red = (normalize_map[red].red) / 257;
+                red = (prm.normalizeMap[red].red) / 257;
             }
 
-            if (low.green != high.green)
+            if (prm.low.green != prm.high.green)
             {
-                green = (normalize_map[green].green) / 257;
+                green = (prm.normalizeMap[green].green) / 257;
             }
 
-            if (low.blue != high.blue)
+            if (prm.low.blue != prm.high.blue)
             {
-                blue = (normalize_map[blue].blue) / 257;
+                blue = (prm.normalizeMap[blue].blue) / 257;
             }
 
-            if (low.alpha != high.alpha)
+            if (prm.low.alpha != prm.high.alpha)
             {
-                alpha = (normalize_map[alpha].alpha) / 257;
+                alpha = (prm.normalizeMap[alpha].alpha) / 257;
             }
 
             ptr[0] = blue;
@@ -429,13 +435,6 @@ void StretchFilter::stretchContrastImage()
             ptr[2] = red;
             ptr[3] = alpha;
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
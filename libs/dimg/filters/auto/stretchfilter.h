@@ -96,6 +96,21 @@ private:
         unsigned int alpha;
     };
 
+    struct Args
+    {
+        uint          start;
+        uint          stop;
+        uchar*        data;
+        bool          sixteenBit;
+        double_packet low;
+        double_packet high;
+        int_packet*   normalizeMap;
+    };
+
+    void stretchContrastImageMultithreaded(const Args& prm);
+
+private:
+
     DImg m_refImage;
 };
 
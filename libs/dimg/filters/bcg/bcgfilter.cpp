@@ -225,14 +225,23 @@ void BCGFilter::applyBCG(uchar* const bits, uint width, uint height, bool sixtee
         return;
     }
 
-    uint size = width * height;
-    int  progress;
+    // Each pixel only depends on itself, so the image is processed by ranges of pixels in parallel.
 
+    runMultithreaded(0, width * height,
+        [this, bits, sixteenBits](int start, int stop)
+        {
+            applyBCGMultithreaded(start, stop, bits, sixteenBits);
+        },
+        0, 100);
+}
+
+void BCGFilter::applyBCGMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBits)
+{
     if (!sixteenBits)                    // 8 bits image.
     {
-        uchar* data = bits;
+        uchar* data = bits + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < size); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             switch (d->settings.channel)
             {
@@ -256,20 +265,13 @@ void BCGFilter::applyBCG(uchar* const bits, uint width, uint height, bool sixtee
             }
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else                                        // 16 bits image.
     {
-        ushort* data = reinterpret_cast<ushort*>(bits);
+        ushort* data = reinterpret_cast<ushort*>(bits) + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < size); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             switch (d->settings.channel)
             {
@@ -293,16 +295,8 @@ void BCGFilter::applyBCG(uchar* const bits, uint width, uint height, bool sixtee
             }
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
-
 }
 
 }  // namespace Digikam
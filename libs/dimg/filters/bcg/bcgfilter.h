@@ -88,6 +88,7 @@ private:
     void setContrast(double val);
     void applyBCG(DImg& image);
     void applyBCG(uchar* const bits, uint width, uint height, bool sixteenBits);
+    void applyBCGMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBits);
 
 private:
 
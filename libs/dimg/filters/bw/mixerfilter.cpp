@@ -59,15 +59,6 @@ void MixerFilter::filterImage()
 {
     m_destImage.putImageData(m_orgImage.bits());
 
-    uchar* bits     = m_destImage.bits();
-    uint width      = m_destImage.width();
-    uint height     = m_destImage.height();
-    bool sixteenBit = m_destImage.sixteenBit();
-
-    uint size = width * height;
-    int  progress;
-
-   uint i;
     double   rnorm = 1;    // red channel normalizer use in RGB mode.
     double   mnorm = 1;    // monochrome normalizer used in Monochrome mode.
 
@@ -87,12 +78,35 @@ void MixerFilter::filterImage()
     double bnorm = CalculateNorm(m_settings.blueRedGain, m_settings.blueGreenGain,
                                  m_settings.blueBlueGain, m_settings.bPreserveLum);
 
-    if (!sixteenBit)        // 8 bits image.
+    Args prm;
+    prm.bits       = m_destImage.bits();
+    prm.sixteenBit = m_destImage.sixteenBit();
+    prm.rnorm      = rnorm;
+    prm.gnorm      = gnorm;
+    prm.bnorm      = bnorm;
+    prm.mnorm      = mnorm;
+
+    runMultithreaded(0, m_destImage.width() * m_destImage.height(),
+        [this, &prm](int start, int stop)
+        {
+            Args chunkPrm  = prm;
+            chunkPrm.start = start;
+            chunkPrm.stop  = stop;
+            mixerMultithreaded(chunkPrm);
+        },
+        0, 100);
+}
+
+void MixerFilter::mixerMultithreaded(const Args& prm)
+{
+    uint i;
+
+    if (!prm.sixteenBit)        // 8 bits image.
     {
         uchar  nGray, red, green, blue;
-        uchar* ptr = bits;
+        uchar* ptr = prm.bits + prm.start * 4;
 
-        for (i = 0 ; i < size ; ++i)
+        for (i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
@@ -102,38 +116,31 @@ void MixerFilter::filterImage()
             {
                 nGray = MixPixel(m_settings.blackRedGain, m_settings.blackGreenGain, m_settings.blackBlueGain,
                                  (unsigned short)red, (unsigned short)green, (unsigned short)blue,
-                                 sixteenBit, mnorm);
+                                 prm.sixteenBit, prm.mnorm);
                 ptr[0] = ptr[1] = ptr[2] = nGray;
             }
             else
             {
                 ptr[0] = (uchar)MixPixel(m_settings.blueRedGain, m_settings.blueGreenGain, m_settings.blueBlueGain,
                                          (unsigned short)red, (unsigned short)green, (unsigned short)blue,
-                                         sixteenBit, bnorm);
+                                         prm.sixteenBit, prm.bnorm);
                 ptr[1] = (uchar)MixPixel(m_settings.greenRedGain, m_settings.greenGreenGain, m_settings.greenBlueGain,
                                          (unsigned short)red, (unsigned short)green, (unsigned short)blue,
-                                         sixteenBit, gnorm);
+                                         prm.sixteenBit, prm.gnorm);
                 ptr[2] = (uchar)MixPixel(m_settings.redRedGain, m_settings.redGreenGain, m_settings.redBlueGain,
                                          (unsigned short)red, (unsigned short)green, (unsigned short)blue,
-                                         sixteenBit, rnorm);
+                                         prm.sixteenBit, prm.rnorm);
             }
 
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else               // 16 bits image.
     {
         unsigned short  nGray, red, green, blue;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(bits);
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(prm.bits) + prm.start * 4;
 
-        for (i = 0 ; i < size ; ++i)
+        for (i = prm.start ; runningFlag() && (i < prm.stop) ; ++i)
         {
             blue  = ptr[0];
             green = ptr[1];
@@ -142,27 +149,20 @@ void MixerFilter::filterImage()
             if (m_settings.bMonochrome)
             {
                 nGray = MixPixel(m_settings.blackRedGain, m_settings.blackGreenGain, m_settings.blackBlueGain,
-                                 red, green, blue, sixteenBit, mnorm);
+                                 red, green, blue, prm.sixteenBit, prm.mnorm);
                 ptr[0] = ptr[1] = ptr[2] = nGray;
             }
             else
             {
                 ptr[0] = MixPixel(m_settings.blueRedGain, m_settings.blueGreenGain, m_settings.blueBlueGain,
-                                  red, green, blue, sixteenBit, bnorm);
+                                  red, green, blue, prm.sixteenBit, prm.bnorm);
                 ptr[1] = MixPixel(m_settings.greenRedGain, m_settings.greenGreenGain, m_settings.greenBlueGain,
-                                  red, green, blue, sixteenBit, gnorm);
+                                  red, green, blue, prm.sixteenBit, prm.gnorm);
                 ptr[2] = MixPixel(m_settings.redRedGain, m_settings.redGreenGain, m_settings.redBlueGain,
-                                  red, green, blue, sixteenBit, rnorm);
+                                  red, green, blue, prm.sixteenBit, prm.rnorm);
             }
 
             ptr += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
@@ -124,9 +124,24 @@ public:
     virtual FilterAction    filterAction();
     void                    readParameters(const FilterAction& action);
 
+private:
+
+    struct Args
+    {
+        uint   start;
+        uint   stop;
+        uchar* bits;
+        bool   sixteenBit;
+        double rnorm;
+        double gnorm;
+        double bnorm;
+        double mnorm;
+    };
+
 private:
 
     void filterImage();
+    void mixerMultithreaded(const Args& prm);
 
     inline double CalculateNorm(double RedGain, double GreenGain, double BlueGain, bool bPreserveLum);
 
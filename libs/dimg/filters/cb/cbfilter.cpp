@@ -236,16 +236,26 @@ void CBFilter::applyCBFilter(DImg& image, double r, double g, double b, double a
         return;
     }
 
-    uint size = image.width() * image.height();
-    int  progress;
-
     adjustRGB(r, g, b, a, image.sixteenBit());
 
-    if (!image.sixteenBit())                    // 8 bits image.
+    uchar* const bits       = image.bits();
+    const bool   sixteenBit = image.sixteenBit();
+
+    runMultithreaded(0, image.width() * image.height(),
+        [this, bits, sixteenBit](int start, int stop)
+        {
+            applyCBFilterMultithreaded(start, stop, bits, sixteenBit);
+        },
+        0, 100);
+}
+
+void CBFilter::applyCBFilterMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBit)
+{
+    if (!sixteenBit)                    // 8 bits image.
     {
-        uchar* data = (uchar*) image.bits();
+        uchar* data = bits + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < size); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             data[0] = d->blueMap[data[0]];
             data[1] = d->greenMap[data[1]];
@@ -253,20 +263,13 @@ void CBFilter::applyCBFilter(DImg& image, double r, double g, double b, double a
             data[3] = d->alphaMap[data[3]];
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else                                        // 16 bits image.
     {
-        ushort* data = reinterpret_cast<ushort*>(image.bits());
+        ushort* data = reinterpret_cast<ushort*>(bits) + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < size); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             data[0] = d->blueMap16[data[0]];
             data[1] = d->greenMap16[data[1]];
@@ -274,13 +277,6 @@ void CBFilter::applyCBFilter(DImg& image, double r, double g, double b, double a
             data[3] = d->alphaMap16[data[3]];
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
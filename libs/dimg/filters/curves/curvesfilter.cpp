@@ -83,7 +83,20 @@ void CurvesFilter::filterImage()
     curves.curvesLutSetup(AlphaChannel);
     postProgress(75);
 
-    curves.curvesLutProcess(m_orgImage.bits(), m_destImage.bits(), m_orgImage.width(), m_orgImage.height());
+    // The LUT is only read while processing, so ranges of rows are processed in parallel.
+
+    uchar* const srcBits  = m_orgImage.bits();
+    uchar* const destBits = m_destImage.bits();
+    const int    width    = m_orgImage.width();
+    const int    lineSize = width * m_orgImage.bytesDepth();
+
+    runMultithreaded(0, m_orgImage.height(),
+        [&curves, srcBits, destBits, width, lineSize](int start, int stop)
+        {
+            curves.curvesLutProcess(srcBits + (size_t)start * lineSize, destBits + (size_t)start * lineSize, width, stop - start);
+        },
+        75, 100);
+
     postProgress(100);
 }
 
@@ -28,7 +28,10 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QMutex>
+#include <QAtomicInt>
 #include <QThreadPool>
+#include <QtConcurrent>
 
 // Local includes
 
@@ -37,6 +40,55 @@
 namespace Digikam
 {
 
+class DImgThreadedFilter::MultithreadedChunks
+{
+public:
+
+    /** Number of chunks per CPU core. Enough to balance uneven costs,
+     *  few enough to keep the scheduling overhead negligible.
+     */
+    enum
+    {
+        ChunksPerCore = 8
+    };
+
+public:
+
+    MultithreadedChunks(int start, int stop, const std::function<void (int, int)>& func,
+                        int progressBegin, int progressEnd)
+        : func(func),
+          start(start),
+          stop(stop),
+          progressBegin(progressBegin),
+          progressSpan(progressEnd - progressBegin),
+          lastProgress(progressBegin)
+    {
+        const int nbCore = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+        const int parts  = nbCore * ChunksPerCore;
+        chunkSize        = qMax(1, (stop - start + parts - 1) / parts);
+        chunkCount       = (stop - start + chunkSize - 1) / chunkSize;
+        threadCount      = qMin(nbCore, chunkCount);
+    }
+
+public:
+
+    const std::function<void (int, int)>& func;
+
+    int        start;
+    int        stop;
+    int        chunkSize;
+    int        chunkCount;
+    int        threadCount;
+
+    QAtomicInt nextChunk;
+    QAtomicInt doneChunks;
+
+    int        progressBegin;
+    int        progressSpan;
+    int        lastProgress;
+    QMutex     progressMutex;
+};
+
 DImgThreadedFilter::DImgThreadedFilter(QObject* const parent, const QString& name)
     : DynamicThread(parent)
 {
@@ -263,6 +315,65 @@ int DImgThreadedFilter::modulateProgress(int progress)
     return m_progressBegin + (int)((double)progress * (double)m_progressSpan / 100.0);
 }
 
+void DImgThreadedFilter::runMultithreaded(int start, int stop, const std::function<void (int, int)>& func,
+                                          int progressBegin, int progressEnd)
+{
+    if (stop <= start)
+    {
+        return;
+    }
+
+    MultithreadedChunks chunks(start, stop, func, progressBegin, progressEnd);
+    QList <QFuture<void> > tasks;
+
+    for (int i = 1 ; i < chunks.threadCount ; ++i)
+    {
+        tasks.append(QtConcurrent::run(this,
+                                       &DImgThreadedFilter::processChunks,
+                                       &chunks
+                                      ));
+    }
+
+    processChunks(&chunks);
+
+    foreach(QFuture<void> t, tasks)
+        t.waitForFinished();
+}
+
+void DImgThreadedFilter::processChunks(MultithreadedChunks* const chunks)
+{
+    while (runningFlag())
+    {
+        const int chunk = chunks->nextChunk.fetchAndAddOrdered(1);
+
+        if (chunk >= chunks->chunkCount)
+        {
+            break;
+        }
+
+        const int first = chunks->start + chunk * chunks->chunkSize;
+        const int last  = qMin(first + chunks->chunkSize, chunks->stop);
+
+        chunks->func(first, last);
+
+        const int done  = chunks->doneChunks.fetchAndAddOrdered(1) + 1;
+
+        if (chunks->progressSpan > 0)
+        {
+            const int progress = chunks->progressBegin +
+                                 (int)((qint64)chunks->progressSpan * done / chunks->chunkCount);
+
+            QMutexLocker lock(&chunks->progressMutex);
+
+            if (progress > chunks->lastProgress)
+            {
+                chunks->lastProgress = progress;
+                postProgress(progress);
+            }
+        }
+    }
+}
+
 bool DImgThreadedFilter::parametersSuccessfullyRead() const
 {
     return true;
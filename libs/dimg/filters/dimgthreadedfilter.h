@@ -25,6 +25,10 @@
 #ifndef DIMGTHREADEDFILTER_H
 #define DIMGTHREADEDFILTER_H
 
+// C++ includes
+
+#include <functional>
+
 // KDE includes
 
 #include <klocalizedstring.h>
@@ -95,6 +99,8 @@ public:
      *  To be sure that all vlaues will be processed, in case of CPU core division give rest, the last step compensate
      *  the difference.
      *  See Blur filter loop implementation for exemple to see how to use this method with QtConcurrents API.
+     *  Note: with uneven costs per row or column, the slowest step bounds the computation time.
+     *  Prefer runMultithreaded() which balances the load dynamically.
      */
     QList<int> multithreadedSteps(int stop, int start=0) const;
 
@@ -186,6 +192,19 @@ protected:
      */
     void postProgress(int progress);
 
+    /** Process the range [start,stop[ of rows or columns in parallel.
+     *  The range is cut in small chunks, several per CPU core. The worker threads pick up the
+     *  next pending chunk as soon as they are idle, so a slow part of the image does not leave
+     *  the other cores waiting. The calling thread takes part in the computation.
+     *  func(chunkStart, chunkStop) is called for each chunk, possibly concurrently with other
+     *  chunks, and must only write data belonging to its own chunk.
+     *  No new chunk is started once the filter has been canceled.
+     *  If progressBegin < progressEnd, the progress of the processed chunks is posted in this span.
+     *  The method returns when all started chunks are finished.
+     */
+    void runMultithreaded(int start, int stop, const std::function<void (int, int)>& func,
+                          int progressBegin = 0, int progressEnd = 0);
+
 protected:
 
     /**
@@ -225,6 +244,13 @@ protected:
     void initMaster();
     virtual void prepareDestImage();
 
+private:
+
+    class MultithreadedChunks;
+    void processChunks(MultithreadedChunks* const chunks);
+
+protected:
+
     /**
      * Convenience class to spare the few repeating lines of code
      */
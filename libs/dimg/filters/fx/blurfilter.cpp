@@ -27,9 +27,7 @@
 
 // Qt includes
 
-#include <QtConcurrent>
 #include <QtMath>
-#include <QMutex>
 
 // Local includes
 
@@ -44,14 +42,10 @@ public:
 
     Private()
     {
-        globalProgress = 0;
         radius         = 3;
     }
 
     int    radius;
-    int    globalProgress;
-
-    QMutex lock;
 };
 
 BlurFilter::BlurFilter(QObject* const parent)
@@ -92,8 +86,6 @@ void BlurFilter::blurMultithreaded(uint start, uint stop)
     int  height      = m_orgImage.height();
     int  width       = m_orgImage.width();
     int  radius      = d->radius;
-    int  oldProgress = 0;
-    int  progress    = 0;
     uint a, r, g, b;
     int  mx;
     int  my;
@@ -211,17 +203,6 @@ void BlurFilter::blurMultithreaded(uint start, uint stop)
         {
             qCDebug(DIGIKAM_DIMG_LOG) << "Radius too small...";
         }
-
-        progress = (int)( ( (double)y * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (stop-start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 
     delete [] as;
@@ -239,20 +220,12 @@ void BlurFilter::filterImage()
         return;
     }
 
-    QList<int> vals = multithreadedSteps(m_orgImage.height());
-    QList <QFuture<void> > tasks;
-
-    for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-    {
-        tasks.append(QtConcurrent::run(this,
-                                       &BlurFilter::blurMultithreaded,
-                                       vals[j],
-                                       vals[j+1]
-                                      ));
-    }
-
-    foreach(QFuture<void> t, tasks)
-        t.waitForFinished();
+    runMultithreaded(0, m_orgImage.height(),
+                     [this](int start, int stop)
+                     {
+                         blurMultithreaded(start, stop);
+                     },
+                     0, 100);
 }
 
 FilterAction BlurFilter::filterAction()
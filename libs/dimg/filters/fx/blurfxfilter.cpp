@@ -37,7 +37,6 @@
 // Qt includes
 
 #include <QDateTime>
-#include <QtConcurrent>
 #include <QtMath>
 
 // Local includes
@@ -140,6 +139,46 @@ void BlurFXFilter::filterImage()
     }
 }
 
+void BlurFXFilter::rowsMultithreaded(void (BlurFXFilter::*worker)(const Args&), const Args& prm,
+                                     int xMin, int xMax, int yMin, int yMax,
+                                     int progressBegin, int progressEnd)
+{
+    runMultithreaded(yMin, yMax,
+                     [this, worker, &prm, xMin, xMax](int start, int stop)
+                     {
+                         Args rowPrm  = prm;
+                         rowPrm.start = xMin;
+                         rowPrm.stop  = xMax;
+
+                         for (int h = start ; runningFlag() && (h < stop) ; ++h)
+                         {
+                             rowPrm.h = h;
+                             (this->*worker)(rowPrm);
+                         }
+                     },
+                     progressBegin, progressEnd);
+}
+
+void BlurFXFilter::columnsMultithreaded(void (BlurFXFilter::*worker)(const Args&), const Args& prm,
+                                        int yMin, int yMax, int xMin, int xMax,
+                                        int progressBegin, int progressEnd)
+{
+    runMultithreaded(xMin, xMax,
+                     [this, worker, &prm, yMin, yMax](int start, int stop)
+                     {
+                         Args columnPrm  = prm;
+                         columnPrm.start = yMin;
+                         columnPrm.stop  = yMax;
+
+                         for (int w = start ; runningFlag() && (w < stop) ; ++w)
+                         {
+                             columnPrm.w = w;
+                             (this->*worker)(columnPrm);
+                         }
+                     },
+                     progressBegin, progressEnd);
+}
+
 void BlurFXFilter::zoomBlurMultithreaded(const Args& prm)
 {
     int nh, nw;
@@ -235,8 +274,6 @@ void BlurFXFilter::zoomBlur(DImg* const orgImage, DImg* const destImage, int X,
         return;
     }
 
-    int progress;
-
     // We working on full image.
     int xMin = 0;
     int xMax = orgImage->width();
@@ -252,9 +289,6 @@ void BlurFXFilter::zoomBlur(DImg* const orgImage, DImg* const destImage, int X,
         yMax = pArea.y() + pArea.height();
     }
 
-    QList<int> vals = multithreadedSteps(xMax, xMin);
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -263,30 +297,9 @@ void BlurFXFilter::zoomBlur(DImg* const orgImage, DImg* const destImage, int X,
     prm.Distance  = Distance;
 
     // we have reached the main loop
-    for (int h = yMin; runningFlag() && (h < yMax); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::zoomBlurMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)(h - yMin) * 100.0) / (yMax - yMin));
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::zoomBlurMultithreaded, prm,
+                      xMin, xMax, yMin, yMax,
+                      0, 100);
 }
 
 void BlurFXFilter::radialBlurMultithreaded(const Args& prm)
@@ -391,8 +404,6 @@ void BlurFXFilter::radialBlur(DImg* const orgImage, DImg* const destImage, int X
         return;
     }
 
-    int progress;
-
     // We working on full image.
     int xMin = 0;
     int xMax = orgImage->width();
@@ -408,9 +419,6 @@ void BlurFXFilter::radialBlur(DImg* const orgImage, DImg* const destImage, int X
         yMax = pArea.y() + pArea.height();
     }
 
-    QList<int> vals = multithreadedSteps(xMax, xMin);
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -420,30 +428,9 @@ void BlurFXFilter::radialBlur(DImg* const orgImage, DImg* const destImage, int X
 
     // we have reached the main loop
 
-    for (int h = yMin; runningFlag() && (h < yMax); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::radialBlurMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)(h - yMin) * 100.0) / (yMax - yMin));
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::radialBlurMultithreaded, prm,
+                      xMin, xMax, yMin, yMax,
+                      0, 100);
 }
 
 /* Function to apply the farBlur effect backported from ImageProcessing version 2
@@ -578,8 +565,6 @@ void BlurFXFilter::motionBlur(DImg* const orgImage, DImg* const destImage, int D
         return;
     }
 
-    int progress;
-
     // we try to avoid division by 0 (zero)
     if (Angle == 0.0)
     {
@@ -603,9 +588,6 @@ void BlurFXFilter::motionBlur(DImg* const orgImage, DImg* const destImage, int D
         lpYArray[i] = lround((double)(i - Distance) * nAngY);
     }
 
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -616,30 +598,9 @@ void BlurFXFilter::motionBlur(DImg* const orgImage, DImg* const destImage, int D
 
     // we have reached the main loop
 
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::motionBlurMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::motionBlurMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void BlurFXFilter::softenerBlurMultithreaded(const Args& prm)
@@ -745,41 +706,15 @@ void BlurFXFilter::softenerBlurMultithreaded(const Args& prm)
  */
 void BlurFXFilter::softenerBlur(DImg* const orgImage, DImg* const destImage)
 {
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
 
     // we have reached the main loop
 
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::softenerBlurMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::softenerBlurMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void BlurFXFilter::shakeBlurStage1Multithreaded(const Args& prm)
@@ -865,17 +800,12 @@ void BlurFXFilter::shakeBlurStage2Multithreaded(const Args& prm)
  */
 void BlurFXFilter::shakeBlur(DImg* const orgImage, DImg* const destImage, int Distance)
 {
-    int progress;
-
     int numBytes = orgImage->numBytes();
     QScopedArrayPointer<uchar> layer1(new uchar[numBytes]);
     QScopedArrayPointer<uchar> layer2(new uchar[numBytes]);
     QScopedArrayPointer<uchar> layer3(new uchar[numBytes]);
     QScopedArrayPointer<uchar> layer4(new uchar[numBytes]);
 
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -887,57 +817,13 @@ void BlurFXFilter::shakeBlur(DImg* const orgImage, DImg* const destImage, int Di
 
     // we have reached the main loop
 
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::shakeBlurStage1Multithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 50.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
-
-    tasks.clear();
-
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::shakeBlurStage2Multithreaded,
-                                           prm
-                                          ));
-        }
+    rowsMultithreaded(&BlurFXFilter::shakeBlurStage1Multithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 50);
 
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(50.0 + ((double)h * 50.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::shakeBlurStage2Multithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      50, 100);
 }
 
 void BlurFXFilter::focusBlurMultithreaded(const Args& prm)
@@ -1033,8 +919,6 @@ void BlurFXFilter::focusBlur(DImg* const orgImage, DImg* const destImage,
                              int X, int Y, int BlurRadius, int BlendRadius,
                              bool bInversed, const QRect& pArea)
 {
-    int progress;
-
     // We working on full image.
     int xMin = 0;
     int xMax = orgImage->width();
@@ -1084,9 +968,6 @@ void BlurFXFilter::focusBlur(DImg* const orgImage, DImg* const destImage,
 
     // Blending results.
 
-    QList<int> vals = multithreadedSteps(xMax, xMin);
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage    = orgImage;
     prm.destImage   = destImage;
@@ -1097,30 +978,9 @@ void BlurFXFilter::focusBlur(DImg* const orgImage, DImg* const destImage,
 
     // we have reached the main loop
 
-    for (int h = yMin; runningFlag() && (h < yMax); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::focusBlurMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(80.0 + ((double)(h - yMin) * 20.0) / (yMax - yMin));
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::focusBlurMultithreaded, prm,
+                      xMin, xMax, yMin, yMax,
+                      80, 100);
 }
 
 void BlurFXFilter::smartBlurStage1Multithreaded(const Args& prm)
@@ -1285,7 +1145,6 @@ void BlurFXFilter::smartBlur(DImg* const orgImage, DImg* const destImage, int Ra
         return;
     }
 
-    int progress;
     int StrengthRange = Strength;
 
     if (orgImage->sixteenBit())
@@ -1299,10 +1158,6 @@ void BlurFXFilter::smartBlur(DImg* const orgImage, DImg* const destImage, int Ra
 
     memcpy(pBlur.data(), orgImage->bits(), orgImage->numBytes());
 
-    QList<int> valsw = multithreadedSteps(orgImage->width());
-    QList<int> valsh = multithreadedSteps(orgImage->height());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage      = orgImage;
     prm.destImage     = destImage;
@@ -1312,59 +1167,15 @@ void BlurFXFilter::smartBlur(DImg* const orgImage, DImg* const destImage, int Ra
 
     // we have reached the main loop
 
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < valsw.count()-1) ; ++j)
-        {
-            prm.start = valsw[j];
-            prm.stop  = valsw[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::smartBlurStage1Multithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 50.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::smartBlurStage1Multithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 50);
 
     // we have reached the second part of main loop
 
-    tasks.clear();
-
-    for (uint w = 0; runningFlag() && (w < orgImage->width()); ++w)
-    {
-        for (int j = 0 ; runningFlag() && (j < valsh.count()-1) ; ++j)
-        {
-            prm.start = valsh[j];
-            prm.stop  = valsh[j+1];
-            prm.w     = w;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::smartBlurStage2Multithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(50.0 + ((double)w * 50.0) / orgImage->width());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    columnsMultithreaded(&BlurFXFilter::smartBlurStage2Multithreaded, prm,
+                         0, orgImage->height(), 0, orgImage->width(),
+                         50, 100);
 }
 
 // NOTE: there is no gain to parallelize this method due to non re-entrancy of RandomColor()
@@ -1458,9 +1269,15 @@ void BlurFXFilter::mosaicMultithreaded(const Args& prm)
 
         // now, we fill the mosaic's rectangle with the center pixel color
 
-        for (uint subw = w; runningFlag() && (subw <= w + prm.SizeW); ++subw)
+        // The next tiles overwrite their first row and column anyway: stop before them,
+        // so that tiles processed concurrently never write the same pixels. The last tile
+        // of the slice stops before the first tile of the next slice.
+
+        const uint stopw = qMin(w + prm.SizeW, prm.stop);
+
+        for (uint subw = w; runningFlag() && (subw < stopw); ++subw)
         {
-            for (uint subh = prm.h; runningFlag() && (subh <= prm.h + prm.SizeH); ++subh)
+            for (uint subh = prm.h; runningFlag() && (subh < prm.h + prm.SizeH); ++subh)
             {
                 // if is inside...
                 if (IsInside(Width, Height, subw, subh))
@@ -1491,8 +1308,6 @@ void BlurFXFilter::mosaicMultithreaded(const Args& prm)
  */
 void BlurFXFilter::mosaic(DImg* const orgImage, DImg* const destImage, int SizeW, int SizeH)
 {
-    int progress;
-
     // we need to check for valid values
     if (SizeW < 1)
     {
@@ -1509,9 +1324,6 @@ void BlurFXFilter::mosaic(DImg* const orgImage, DImg* const destImage, int SizeW
         return;
     }
 
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -1519,31 +1331,31 @@ void BlurFXFilter::mosaic(DImg* const orgImage, DImg* const destImage, int SizeW
     prm.SizeH     = SizeH;
 
     // this loop will never look for transparent colors
-
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); h += SizeH)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::mosaicMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    // Each row of mosaic tiles only writes its own rows, so the tile rows are processed in parallel.
+    // The tiles of a row start at the beginning of each slice of the width, as they always did,
+    // so that the rendering of the filter does not change.
+
+    const QList<int> vals = multithreadedSteps(orgImage->width());
+    const int tileRows    = (orgImage->height() + SizeH - 1) / SizeH;
+
+    runMultithreaded(0, tileRows,
+                     [this, prm, &vals](int start, int stop)
+                     {
+                         Args rowPrm = prm;
+
+                         for (int row = start ; runningFlag() && (row < stop) ; ++row)
+                         {
+                             rowPrm.h = row * rowPrm.SizeH;
+
+                             for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
+                             {
+                                 rowPrm.start = vals[j];
+                                 rowPrm.stop  = vals[j+1];
+                                 mosaicMultithreaded(rowPrm);
+                             }
+                         }
+                     },
+                     0, 100);
 }
 
 /* Function to get a color in a matrix with a determined size
@@ -1825,7 +1637,6 @@ void BlurFXFilter::MakeConvolution(DImg* const orgImage, DImg* const destImage,
         return;
     }
 
-    int progress;
     int nKernelWidth = Radius * 2 + 1;
     int range = orgImage->sixteenBit() ? 65536 : 256;
 
@@ -1847,10 +1658,6 @@ void BlurFXFilter::MakeConvolution(DImg* const orgImage, DImg* const destImage,
         }
     }
 
-    QList<int> valsw = multithreadedSteps(orgImage->width());
-    QList<int> valsh = multithreadedSteps(orgImage->height());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -1861,59 +1668,15 @@ void BlurFXFilter::MakeConvolution(DImg* const orgImage, DImg* const destImage,
 
     // Now, we enter in the first loop
 
-    for (uint h = 0; runningFlag() && (h < orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < valsw.count()-1) ; ++j)
-        {
-            prm.start = valsw[j];
-            prm.stop  = valsw[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::MakeConvolutionStage1Multithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 50.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&BlurFXFilter::MakeConvolutionStage1Multithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 50);
 
     // We enter in the second main loop
 
-    tasks.clear();
-
-    for (uint w = 0; runningFlag() && (w < orgImage->width()); ++w)
-    {
-        for (int j = 0 ; runningFlag() && (j < valsh.count()-1) ; ++j)
-        {
-            prm.start = valsh[j];
-            prm.stop  = valsh[j+1];
-            prm.w     = w;
-            tasks.append(QtConcurrent::run(this,
-                                           &BlurFXFilter::MakeConvolutionStage2Multithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(50.0 + ((double)w * 50.0) / orgImage->width());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    columnsMultithreaded(&BlurFXFilter::MakeConvolutionStage2Multithreaded, prm,
+                         0, orgImage->height(), 0, orgImage->width(),
+                         50, 100);
 
     // now, we must free memory
     Free2DArray(arrMult, nKernelWidth);
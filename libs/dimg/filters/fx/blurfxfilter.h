@@ -170,6 +170,20 @@ private:
 
 private:
 
+    /** Call the worker for each row of [yMin,yMax[, with the columns range [xMin,xMax[.
+     *  The rows are processed in parallel, and must be independent from each other.
+     */
+    void rowsMultithreaded(void (BlurFXFilter::*worker)(const Args&), const Args& prm,
+                           int xMin, int xMax, int yMin, int yMax,
+                           int progressBegin, int progressEnd);
+
+    /** Call the worker for each column of [xMin,xMax[, with the rows range [yMin,yMax[.
+     *  The columns are processed in parallel, and must be independent from each other.
+     */
+    void columnsMultithreaded(void (BlurFXFilter::*worker)(const Args&), const Args& prm,
+                              int yMin, int yMax, int xMin, int xMax,
+                              int progressBegin, int progressEnd);
+
     void MakeConvolution(DImg* const orgImage, DImg* const destImage, int Radius, int Kernel[]);
     void MakeConvolutionStage1Multithreaded(const Args& prm);
     void MakeConvolutionStage2Multithreaded(const Args& prm);
@@ -31,11 +31,6 @@
 
 #include <cmath>
 
-// Qt includes
-
-#include <QtConcurrent>
-#include <QMutex>
-
 // Local includes
 
 #include "dimg.h"
@@ -54,16 +49,12 @@ public:
 
     Private()
     {
-        globalProgress = 0;
         pencil         = 5.0;
         smooth         = 10.0;
     }
 
     double pencil;
     double smooth;
-    int    globalProgress;
-
-    QMutex lock;
 };
 
 CharcoalFilter::CharcoalFilter(QObject* const parent)
@@ -186,7 +177,7 @@ void CharcoalFilter::filterImage()
 
 void CharcoalFilter::convolveImageMultithreaded(uint start, uint stop, double* normal_kernel, double kernelWidth)
 {
-    int     mx, my, sx, sy, mcx, mcy, oldProgress=0, progress=0;
+    int     mx, my, sx, sy, mcx, mcy;
     double  red, green, blue, alpha;
     double* k = 0;
 
@@ -235,17 +226,6 @@ void CharcoalFilter::convolveImageMultithreaded(uint start, uint stop, double* n
                          (int)(blue / 257UL), (int)(alpha / 257UL), sixteenBit);
             color.setPixel((ddata + x * ddepth + (width * y * ddepth)));
         }
-
-        progress = (int)( ( (double)y * (80.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (stop-start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 }
 
@@ -290,22 +270,14 @@ bool CharcoalFilter::convolveImage(const unsigned int order, const double* kerne
 
     // --------------------------------------------------------
 
-    QList<int> vals = multithreadedSteps(m_orgImage.height());
-    QList <QFuture<void> > tasks;
-
-    for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-    {
-        tasks.append(QtConcurrent::run(this,
-                                       &CharcoalFilter::convolveImageMultithreaded,
-                                       vals[j],
-                                       vals[j+1],
-                                       normal_kernel.data(),
-                                       kernelWidth
-                                      ));
-    }
+    double* const kernelData = normal_kernel.data();
 
-    foreach(QFuture<void> t, tasks)
-        t.waitForFinished();
+    runMultithreaded(0, m_orgImage.height(),
+                     [this, kernelData, kernelWidth](int start, int stop)
+                     {
+                         convolveImageMultithreaded(start, stop, kernelData, kernelWidth);
+                     },
+                     0, 80);
 
     return true;
 }
@@ -38,8 +38,8 @@
 
 #include <QDateTime>
 #include <QSize>
-#include <QMutex>
-#include <QtConcurrent>
+#include <QPoint>
+#include <QVector>
 #include <QtMath>
 
 // Local includes
@@ -62,7 +62,6 @@ public:
         iteration      = 0;
         effectType     = 0;
         randomSeed     = 0;
-        globalProgress = 0;
     }
 
     bool                   antiAlias;
@@ -74,10 +73,8 @@ public:
 
     RandomNumberGenerator generator;
 
-    int                   globalProgress;
-
-    QMutex                lock;
-    QMutex                lock2;   // RandomNumberGenerator is not re-entrant (dixit Boost lib)
+    QList<int>            tileTops;     // Top row of each row of tiles, in drawing order.
+    QVector<QPoint>       tileOffsets;  // Random offset of each tile, by rows of tiles.
 };
 
 DistortionFXFilter::DistortionFXFilter(QObject* const parent)
@@ -181,6 +178,46 @@ void DistortionFXFilter::filterImage()
     }
 }
 
+void DistortionFXFilter::rowsMultithreaded(void (DistortionFXFilter::*worker)(const Args&), const Args& prm,
+                                           int xMin, int xMax, int yMin, int yMax,
+                                           int progressBegin, int progressEnd)
+{
+    runMultithreaded(yMin, yMax,
+                     [this, worker, &prm, xMin, xMax](int start, int stop)
+                     {
+                         Args rowPrm  = prm;
+                         rowPrm.start = xMin;
+                         rowPrm.stop  = xMax;
+
+                         for (int h = start ; runningFlag() && (h < stop) ; ++h)
+                         {
+                             rowPrm.h = h;
+                             (this->*worker)(rowPrm);
+                         }
+                     },
+                     progressBegin, progressEnd);
+}
+
+void DistortionFXFilter::columnsMultithreaded(void (DistortionFXFilter::*worker)(const Args&), const Args& prm,
+                                              int yMin, int yMax, int xMin, int xMax,
+                                              int progressBegin, int progressEnd)
+{
+    runMultithreaded(xMin, xMax,
+                     [this, worker, &prm, yMin, yMax](int start, int stop)
+                     {
+                         Args columnPrm  = prm;
+                         columnPrm.start = yMin;
+                         columnPrm.stop  = yMax;
+
+                         for (int w = start ; runningFlag() && (w < stop) ; ++w)
+                         {
+                             columnPrm.w = w;
+                             (this->*worker)(columnPrm);
+                         }
+                     },
+                     progressBegin, progressEnd);
+}
+
 void DistortionFXFilter::fisheyeMultithreaded(const Args& prm)
 {
     int Width       = prm.orgImage->width();
@@ -270,11 +307,6 @@ void DistortionFXFilter::fisheye(DImg* orgImage, DImg* destImage, double Coeff,
         return;
     }
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -283,30 +315,9 @@ void DistortionFXFilter::fisheye(DImg* orgImage, DImg* destImage, double Coeff,
 
     // main loop
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::fisheyeMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)(h) * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::fisheyeMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::twirlMultithreaded(const Args& prm)
@@ -397,11 +408,6 @@ void DistortionFXFilter::twirl(DImg* orgImage, DImg* destImage, int dist, bool A
         return;
     }
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -410,30 +416,9 @@ void DistortionFXFilter::twirl(DImg* orgImage, DImg* destImage, int dist, bool A
 
     // main loop
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::twirlMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::twirlMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::cilindricalMultithreaded(const Args& prm)
@@ -525,14 +510,9 @@ void DistortionFXFilter::cilindrical(DImg* orgImage, DImg* destImage, double Coe
         return;
     }
 
-    int progress;
-
     // initial copy
     memcpy(destImage->bits(), orgImage->bits(), orgImage->numBytes());
 
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage   = orgImage;
     prm.destImage  = destImage;
@@ -543,30 +523,9 @@ void DistortionFXFilter::cilindrical(DImg* orgImage, DImg* destImage, double Coe
 
     // main loop
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::cilindricalMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::cilindricalMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::multipleCornersMultithreaded(const Args& prm)
@@ -627,11 +586,6 @@ void DistortionFXFilter::multipleCorners(DImg* orgImage, DImg* destImage, int Fa
         return;
     }
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -640,35 +594,14 @@ void DistortionFXFilter::multipleCorners(DImg* orgImage, DImg* destImage, int Fa
 
     // main loop
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::multipleCornersMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::multipleCornersMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::wavesHorizontalMultithreaded(const Args& prm)
 {
-    int oldProgress=0, progress=0, tx;
+    int tx;
 
     for (int h = prm.start; runningFlag() && (h < prm.stop); ++h)
     {
@@ -680,24 +613,12 @@ void DistortionFXFilter::wavesHorizontalMultithreaded(const Args& prm)
             prm.destImage->bitBltImage(prm.orgImage, prm.orgImage->width() - tx, h,  tx, 1,  0, h);
             prm.destImage->bitBltImage(prm.orgImage, 0, h, prm.orgImage->width() - (prm.orgImage->width() - 2 * prm.Amplitude + tx), 1,  prm.orgImage->width() + tx, h);
         }
-
-        // Update the progress bar in dialog.
-        progress = (int)( ( (double)h * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (prm.stop - prm.start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 }
 
 void DistortionFXFilter::wavesVerticalMultithreaded(const Args& prm)
 {
-    int oldProgress=0, progress=0, ty;
+    int ty;
 
     for (int w = prm.start; runningFlag() && (w < prm.stop); ++w)
     {
@@ -709,18 +630,6 @@ void DistortionFXFilter::wavesVerticalMultithreaded(const Args& prm)
             prm.destImage->bitBltImage(prm.orgImage, w, prm.orgImage->height() - ty,  1, ty,  w, 0);
             prm.destImage->bitBltImage(prm.orgImage, w, 0,  1, prm.orgImage->height() - (prm.orgImage->height() - 2 * prm.Amplitude + ty),  w, prm.orgImage->height() + ty);
         }
-
-        // Update the progress bar in dialog.
-        progress = (int)( ( (double)w * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (prm.stop - prm.start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 }
 
@@ -760,39 +669,27 @@ void DistortionFXFilter::waves(DImg* orgImage, DImg* destImage,
 
     if (Direction)        // Horizontal
     {
-        QList<int> vals = multithreadedSteps(orgImage->height());
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::wavesHorizontalMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, orgImage->height(),
+                         [this, &prm](int start, int stop)
+                         {
+                             Args rowsPrm  = prm;
+                             rowsPrm.start = start;
+                             rowsPrm.stop  = stop;
+                             wavesHorizontalMultithreaded(rowsPrm);
+                         },
+                         0, 100);
     }
     else
     {
-        QList<int> vals = multithreadedSteps(orgImage->width());
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::wavesVerticalMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, orgImage->width(),
+                         [this, &prm](int start, int stop)
+                         {
+                             Args columnsPrm  = prm;
+                             columnsPrm.start = start;
+                             columnsPrm.stop  = stop;
+                             wavesVerticalMultithreaded(columnsPrm);
+                         },
+                         0, 100);
     }
 }
 
@@ -864,11 +761,6 @@ void DistortionFXFilter::blockWaves(DImg* orgImage, DImg* destImage,
         Frequency = 0;
     }
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->height());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -876,30 +768,9 @@ void DistortionFXFilter::blockWaves(DImg* orgImage, DImg* destImage,
     prm.Frequency = Frequency;
     prm.Amplitude = Amplitude;
 
-    for (int w = 0; runningFlag() && (w < (int)orgImage->width()); ++w)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.w     = w;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::blockWavesMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)w * 100.0) / orgImage->width());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    columnsMultithreaded(&DistortionFXFilter::blockWavesMultithreaded, prm,
+                         0, orgImage->height(), 0, orgImage->width(),
+                         0, 100);
 }
 
 void DistortionFXFilter::circularWavesMultithreaded(const Args& prm)
@@ -966,11 +837,6 @@ void DistortionFXFilter::circularWaves(DImg* orgImage, DImg* destImage, int X, i
         Frequency = 0.0;
     }
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -982,30 +848,9 @@ void DistortionFXFilter::circularWaves(DImg* orgImage, DImg* destImage, int X, i
     prm.Y         = Y;
     prm.AntiAlias = AntiAlias;
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::circularWavesMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::circularWavesMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::polarCoordinatesMultithreaded(const Args& prm)
@@ -1080,11 +925,6 @@ void DistortionFXFilter::polarCoordinatesMultithreaded(const Args& prm)
  */
 void DistortionFXFilter::polarCoordinates(DImg* orgImage, DImg* destImage, bool Type, bool AntiAlias)
 {
-    int progress;
-
-    QList<int> vals = multithreadedSteps(orgImage->width());
-    QList <QFuture<void> > tasks;
-
     Args prm;
     prm.orgImage  = orgImage;
     prm.destImage = destImage;
@@ -1093,57 +933,40 @@ void DistortionFXFilter::polarCoordinates(DImg* orgImage, DImg* destImage, bool
 
     // main loop
 
-    for (int h = 0; runningFlag() && (h < (int)orgImage->height()); ++h)
-    {
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.h     = h;
-            tasks.append(QtConcurrent::run(this,
-                                           &DistortionFXFilter::polarCoordinatesMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)h * 100.0) / orgImage->height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    rowsMultithreaded(&DistortionFXFilter::polarCoordinatesMultithreaded, prm,
+                      0, orgImage->width(), 0, orgImage->height(),
+                      0, 100);
 }
 
 void DistortionFXFilter::tileMultithreaded(const Args& prm)
 {
-    int tx, ty, progress=0, oldProgress=0;
+    // Draw all tiles in order, clipped to the destination rows [start,stop[: each pixel
+    // gets the last tile drawn over it, as when all the tiles are drawn one after the other.
+
+    const int columns = (prm.orgImage->width() + prm.WSize - 1) / prm.WSize;
 
-    for (int h = prm.start; runningFlag() && (h < prm.stop); h += prm.HSize)
+    for (int row = 0; runningFlag() && (row < d->tileTops.count()); ++row)
     {
-        for (int w = 0; runningFlag() && (w < (int)prm.orgImage->width()); w += prm.WSize)
+        const int h = d->tileTops[row];
+
+        // The tiles of this row are moved by Random / 2 rows at most.
+        if ((h + prm.HSize + prm.Random / 2 <= prm.start) || (h - prm.Random / 2 >= prm.stop))
         {
-            d->lock2.lock();
-            tx = d->generator.number(-prm.Random / 2, prm.Random / 2);
-            ty = d->generator.number(-prm.Random / 2, prm.Random / 2);
-            d->lock2.unlock();
-            prm.destImage->bitBltImage(prm.orgImage, w, h, prm.WSize, prm.HSize, w + tx, h + ty);
+            continue;
         }
 
-        // Update the progress bar in dialog.
-        progress = (int)( ( (double)h * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (prm.stop - prm.start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
+        for (int col = 0; runningFlag() && (col < columns); ++col)
         {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
+            const int    w      = col * prm.WSize;
+            const QPoint offset = d->tileOffsets[row * columns + col];
+            const int    top    = qMax(h + offset.y(), prm.start);
+            const int    bottom = qMin(h + offset.y() + prm.HSize, prm.stop);
+
+            if (top < bottom)
+            {
+                prm.destImage->bitBltImage(prm.orgImage, w, top - offset.y(), prm.WSize, bottom - top,
+                                           w + offset.x(), top);
+            }
         }
     }
 }
@@ -1189,21 +1012,44 @@ void DistortionFXFilter::tile(DImg* orgImage, DImg* destImage,
 
     d->generator.seed(d->randomSeed);
 
-    QList<int> vals = multithreadedSteps(orgImage->height());
-    QList <QFuture<void> > tasks;
+    // The rows of tiles start at the beginning of each slice of the height, and the random
+    // offsets are drawn slice by slice, as they always were, so that the rendering of the
+    // filter does not change. The offsets are drawn first, then the destination rows are
+    // processed in parallel.
 
-    for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
+    const QList<int> vals = multithreadedSteps(orgImage->height());
+    const int columns     = (orgImage->width() + WSize - 1) / WSize;
+
+    d->tileTops.clear();
+    d->tileOffsets.clear();
+
+    for (int j = 0 ; j < vals.count()-1 ; ++j)
     {
-        prm.start = vals[j];
-        prm.stop  = vals[j+1];
-        tasks.append(QtConcurrent::run(this,
-                                       &DistortionFXFilter::tileMultithreaded,
-                                       prm
-                                      ));
+        for (int h = vals[j] ; h < vals[j+1] ; h += HSize)
+        {
+            d->tileTops << h;
+
+            for (int col = 0 ; col < columns ; ++col)
+            {
+                const int tx = d->generator.number(-Random / 2, Random / 2);
+                const int ty = d->generator.number(-Random / 2, Random / 2);
+                d->tileOffsets << QPoint(tx, ty);
+            }
+        }
     }
 
-    foreach(QFuture<void> t, tasks)
-        t.waitForFinished();
+    runMultithreaded(0, orgImage->height(),
+                     [this, &prm](int start, int stop)
+                     {
+                         Args rowsPrm  = prm;
+                         rowsPrm.start = start;
+                         rowsPrm.stop  = stop;
+                         tileMultithreaded(rowsPrm);
+                     },
+                     0, 100);
+
+    d->tileTops.clear();
+    d->tileOffsets.clear();
 }
 
 /*
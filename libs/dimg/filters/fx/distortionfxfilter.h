@@ -134,6 +134,20 @@ private:
 
     void filterImage();
 
+    /** Call the worker for each row of [yMin,yMax[, with the columns range [xMin,xMax[.
+     *  The rows are processed in parallel, and must be independent from each other.
+     */
+    void rowsMultithreaded(void (DistortionFXFilter::*worker)(const Args&), const Args& prm,
+                           int xMin, int xMax, int yMin, int yMax,
+                           int progressBegin, int progressEnd);
+
+    /** Call the worker for each column of [xMin,xMax[, with the rows range [yMin,yMax[.
+     *  The columns are processed in parallel, and must be independent from each other.
+     */
+    void columnsMultithreaded(void (DistortionFXFilter::*worker)(const Args&), const Args& prm,
+                              int yMin, int yMax, int xMin, int xMax,
+                              int progressBegin, int progressEnd);
+
     // Backported from ImageProcessing version 2
     void fisheye(DImg* orgImage, DImg* destImage, double Coeff, bool AntiAlias=true);
     void fisheyeMultithreaded(const Args& prm);
@@ -36,7 +36,6 @@
 // Qt includes
 
 #include <QtMath>
-#include <QtConcurrent>
 
 // Local includes
 
@@ -78,6 +77,7 @@ void EmbossFilter::embossMultithreaded(uint start, uint stop, uint h, double Dep
     int Height        = m_orgImage.height();
     bool sixteenBit   = m_orgImage.sixteenBit();
     int bytesDepth    = m_orgImage.bytesDepth();
+    uchar* const Data = m_orgImage.bits();
     uchar* const Bits = m_destImage.bits();
 
     int    red, green, blue, gray;
@@ -89,8 +89,10 @@ void EmbossFilter::embossMultithreaded(uint start, uint stop, uint h, double Dep
         offset      = getOffset(Width, w, h, bytesDepth);
         offsetOther = getOffset(Width, w + Lim_Max(w, 1, Width), h + Lim_Max(h, 1, Height), bytesDepth);
 
-        color.setColor(Bits + offset, sixteenBit);
-        colorOther.setColor(Bits + offsetOther, sixteenBit);
+        // Read from the original: the neighbor pixel is not yet processed in scan order,
+        // and the rows do not depend on each other.
+        color.setColor(Data + offset, sixteenBit);
+        colorOther.setColor(Data + offsetOther, sixteenBit);
 
         if (sixteenBit)
         {
@@ -124,35 +126,15 @@ void EmbossFilter::filterImage()
 
     double Depth = m_depth / 10.0;
 
-    int progress;
-
-    QList<int> vals = multithreadedSteps(m_orgImage.width());
-
-    for (uint h = 0 ; runningFlag() && (h < m_orgImage.height()) ; ++h)
-    {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &EmbossFilter::embossMultithreaded,
-                                           vals[j],
-                                           vals[j+1],
-                                           h,
-                                           Depth
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        progress = (int)(((double)h * 100.0) / m_orgImage.height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    runMultithreaded(0, m_orgImage.height(),
+                     [this, Depth](int start, int stop)
+                     {
+                         for (int h = start ; runningFlag() && (h < stop) ; ++h)
+                         {
+                             embossMultithreaded(0, m_orgImage.width(), h, Depth);
+                         }
+                     },
+                     0, 100);
 }
 
 /** Function to limit the max and min values defined by the developer.
@@ -32,7 +32,6 @@
 
 // Qt includes
 
-#include <QtConcurrent>
 #include <QMutex>
 
 // Local includes
@@ -52,8 +51,7 @@ public:
         div(0.0),
         leadLumaNoise(1.0),
         leadChromaBlueNoise(1.0),
-        leadChromaRedNoise(1.0),
-        globalProgress(0)
+        leadChromaRedNoise(1.0)
     {
     }
 
@@ -73,9 +71,6 @@ public:
 
     RandomNumberGenerator generator;
 
-    int                   globalProgress;
-
-    QMutex                lock;
     QMutex                lock2; // RandomNumberGenerator is not re-entrant (dixit Boost lib)
 };
 
@@ -123,7 +118,7 @@ void FilmGrainFilter::filmgrainMultithreaded(uint start, uint stop)
     // generated with Gaussian or Poisson noise generator.
 
     DColor refCol, matCol;
-    uint    progress=0, oldProgress=0, posX, posY;
+    uint    posX, posY;
 
     // Reference point noise adjustements.
     double refLumaNoise       = 0.0, refLumaRange       = 0.0;
@@ -135,7 +130,6 @@ void FilmGrainFilter::filmgrainMultithreaded(uint start, uint stop)
     double matChromaBlueNoise = 0.0, matChromaBlueRange = 0.0;
     double matChromaRedNoise  = 0.0, matChromaRedRange  = 0.0;
 
-    uint   width  = m_orgImage.width();
     uint   height = m_orgImage.height();
 
     for (uint x = start ; runningFlag() && (x < stop) ; x += d->settings.grainSize)
@@ -157,7 +151,8 @@ void FilmGrainFilter::filmgrainMultithreaded(uint start, uint stop)
                     posX = x + zx;
                     posY = y + zy;
 
-                    if (posX < width && posY < height)
+                    // A matrix stops at the end of the slice, which the next slice starts with.
+                    if (posX < stop && posY < height)
                     {
                         matCol = m_orgImage.getPixelColor(posX, posY);
 
@@ -207,17 +202,6 @@ void FilmGrainFilter::filmgrainMultithreaded(uint start, uint stop)
                 }
             }
         }
-
-        progress = (int)( ( (double)x * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (stop-start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 }
 
@@ -245,20 +229,33 @@ void FilmGrainFilter::filterImage()
 
     d->generator.seed(1); // noise will always be the same
 
-    QList<int> vals = multithreadedSteps(m_orgImage.width());
-    QList <QFuture<void> > tasks;
+    // The columns of grain matrices start at the beginning of each slice of the width, as they
+    // always did, so that the rendering of the filter does not change. The columns are
+    // processed in parallel, in the same order as before with a single thread.
+
+    const int grainSize   = qMax(1, d->settings.grainSize);
+    const QList<int> vals = multithreadedSteps(m_orgImage.width());
+    QList<int>       columnStarts;
+    QList<int>       columnStops;
 
-    for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
+    for (int j = 0 ; j < vals.count()-1 ; ++j)
     {
-        tasks.append(QtConcurrent::run(this,
-                                       &FilmGrainFilter::filmgrainMultithreaded,
-                                       vals[j],
-                                       vals[j+1]
-                                      ));
+        for (int x = vals[j] ; x < vals[j+1] ; x += grainSize)
+        {
+            columnStarts << x;
+            columnStops  << vals[j+1];
+        }
     }
 
-    foreach(QFuture<void> t, tasks)
-        t.waitForFinished();
+    runMultithreaded(0, columnStarts.count(),
+                     [this, grainSize, &columnStarts, &columnStops](int start, int stop)
+                     {
+                         for (int i = start ; runningFlag() && (i < stop) ; ++i)
+                         {
+                             filmgrainMultithreaded(columnStarts[i], qMin(columnStarts[i] + grainSize, columnStops[i]));
+                         }
+                     },
+                     0, 100);
 }
 
 /** This method compute lead noise of reference matrix point used to similate graininess size
@@ -33,11 +33,6 @@
 #include <cmath>
 #include <cstdlib>
 
-// Qt includes
-
-#include <QtConcurrent>
-#include <QMutex>
-
 // Local includes
 
 #include "dimg.h"
@@ -51,17 +46,12 @@ public:
 
     Private() :
         brushSize(1),
-        smoothness(30),
-        globalProgress(0)
+        smoothness(30)
     {
     }
 
     int    brushSize;
     int    smoothness;
-
-    int    globalProgress;
-
-    QMutex lock;
 };
 
 OilPaintFilter::OilPaintFilter(QObject* const parent)
@@ -105,7 +95,6 @@ void OilPaintFilter::oilPaintImageMultithreaded(uint start, uint stop)
     memset(averageColorG.data(),  0, sizeof(uint)*(d->smoothness + 1));
     memset(averageColorB.data(),  0, sizeof(uint)*(d->smoothness + 1));
 
-    int    oldProgress=0, progress=0;
     DColor mostFrequentColor;
 
     mostFrequentColor.setSixteenBit(m_orgImage.sixteenBit());
@@ -121,36 +110,17 @@ void OilPaintFilter::oilPaintImageMultithreaded(uint start, uint stop)
             dptr              = dest + w2 * m_orgImage.bytesDepth() + (m_orgImage.width() * h2 * m_orgImage.bytesDepth());
             mostFrequentColor.setPixel(dptr);
         }
-
-        progress = (int)( ( (double)h2 * (100.0 / QThreadPool::globalInstance()->maxThreadCount()) ) / (stop-start));
-
-        if ((progress % 5 == 0) && (progress > oldProgress))
-        {
-            d->lock.lock();
-            oldProgress       = progress;
-            d->globalProgress += 5;
-            postProgress(d->globalProgress);
-            d->lock.unlock();
-        }
     }
 }
 
 void OilPaintFilter::filterImage()
 {
-    QList<int> vals = multithreadedSteps(m_orgImage.height());
-    QList <QFuture<void> > tasks;
-
-    for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-    {
-        tasks.append(QtConcurrent::run(this,
-                                       &OilPaintFilter::oilPaintImageMultithreaded,
-                                       vals[j],
-                                       vals[j+1]
-                                      ));
-    }
-
-    foreach(QFuture<void> t, tasks)
-        t.waitForFinished();
+    runMultithreaded(0, m_orgImage.height(),
+                     [this](int start, int stop)
+                     {
+                         oilPaintImageMultithreaded(start, stop);
+                     },
+                     0, 100);
 }
 
 /** Function to determine the most frequent color in a matrix
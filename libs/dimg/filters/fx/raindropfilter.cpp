@@ -37,7 +37,7 @@
 #include <QDateTime>
 #include <QRect>
 #include <QtMath>
-#include <QtConcurrent>
+#include <QMutex>
 
 // Local includes
 
@@ -215,8 +215,6 @@ void RainDropFilter::rainDropsImage(DImg* const orgImage, DImg* const destImage,
 
     // Randomize.
 
-    QList<int> vals = multithreadedSteps(10000);
-
     Args prm;
     prm.orgImage    = orgImage;
     prm.destImage   = destImage;
@@ -226,23 +224,24 @@ void RainDropFilter::rainDropsImage(DImg* const orgImage, DImg* const destImage,
     prm.bLimitRange = bLimitRange;
     prm.pStatusBits = pStatusBits.data();
 
-    for (int i = 0; runningFlag() && (i < Amount); ++i)
-    {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start        = vals[j];
-            prm.stop         = vals[j+1];
+    // Each round places one drop per slice of the 10000 random attempts, as the rendering
+    // of the filter has always done. The slices are scheduled like any other range.
 
-            tasks.append(QtConcurrent::run(this,
-                                           &RainDropFilter::rainDropsImageMultithreaded,
-                                           prm
-                                          ));
-        }
+    const QList<int> vals = multithreadedSteps(10000);
 
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+    for (int i = 0; runningFlag() && (i < Amount); ++i)
+    {
+        runMultithreaded(0, vals.count() - 1,
+                         [this, &prm, &vals](int start, int stop)
+                         {
+                             for (int j = start ; j < stop ; ++j)
+                             {
+                                 Args slicePrm  = prm;
+                                 slicePrm.start = vals[j];
+                                 slicePrm.stop  = vals[j+1];
+                                 rainDropsImageMultithreaded(slicePrm);
+                             }
+                         });
 
         postProgress((int)(progressMin + ((double)(i) *
                                           (double)(progressMax - progressMin)) / (double)Amount));
@@ -237,18 +237,28 @@ void HSLFilter::applyHSL(DImg& image)
         return;
     }
 
-    bool   sixteenBit     = image.sixteenBit();
-    uint   numberOfPixels = image.numPixels();
-    int    progress;
+    uchar* const bits       = image.bits();
+    const bool   sixteenBit = image.sixteenBit();
+
+    runMultithreaded(0, image.numPixels(),
+        [this, bits, sixteenBit](int start, int stop)
+        {
+            applyHSLMultithreaded(start, stop, bits, sixteenBit);
+        },
+        0, 100);
+}
+
+void HSLFilter::applyHSLMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBit)
+{
     int    hue, sat, lig;
     double vib = d->settings.vibrance;
     DColor color;
 
     if (sixteenBit)                   // 16 bits image.
     {
-        unsigned short* data = reinterpret_cast<unsigned short*>(image.bits());
+        unsigned short* data = reinterpret_cast<unsigned short*>(bits) + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < numberOfPixels); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             color = DColor(data[2], data[1], data[0], 0, sixteenBit);
 
@@ -263,20 +273,13 @@ void HSLFilter::applyHSL(DImg& image)
             data[0] = color.blue();
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / numberOfPixels);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else                                      // 8 bits image.
     {
-        uchar* data = image.bits();
+        uchar* data = bits + start * 4;
 
-        for (uint i = 0; runningFlag() && (i < numberOfPixels); ++i)
+        for (uint i = start; runningFlag() && (i < stop); ++i)
         {
             color = DColor(data[2], data[1], data[0], 0, sixteenBit);
 
@@ -291,13 +294,6 @@ void HSLFilter::applyHSL(DImg& image)
             data[0] = color.blue();
 
             data += 4;
-
-            progress = (int)(((double)i * 100.0) / numberOfPixels);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
@@ -107,6 +107,7 @@ private:
     void setSaturation(double val);
     void setLightness(double val);
     void applyHSL(DImg& image);
+    void applyHSLMultithreaded(uint start, uint stop, uchar* const bits, bool sixteenBit);
     int  vibranceBias(double sat, double hue, double vib, bool sixteenbit);
 
 private:
@@ -28,10 +28,18 @@
 
 // Qt includes
 
+#include <QAtomicInt>
 #include <QDataStream>
 #include <QFile>
+#include <QFuture>
 #include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
 #include <QVarLengthArray>
+#include <QVector>
+#include <QtConcurrent>
 
 // KDE includes
 
@@ -83,8 +91,162 @@ public:
     int        proofIntent;
 };
 
+// --------------------------------------------------------------------------------------------
+
+/** Process-wide cache of compiled lcms transforms, keyed by their description.
+ *  Building a transform means parsing the profiles and compiling the pipeline, which is
+ *  repeated for all images sharing the same profiles when browsing.
+ *  A transform is checked out by acquire() for the exclusive use of one thread,
+ *  and given back by release(). Only idle transforms are kept, evicting the least recently used ones.
+ */
+class TransformCache
+{
+public:
+
+    enum
+    {
+        /// Maximum number of idle transforms kept
+        MaxIdleTransforms = 16
+    };
+
+public:
+
+    TransformCache()
+        : hits(0),
+          misses(0)
+    {
+    }
+
+    ~TransformCache()
+    {
+        foreach (const Entry& entry, idle)
+        {
+            LcmsLock lock;
+            dkCmsDeleteTransform(entry.handle);
+        }
+    }
+
+    /** Returns an idle transform for the description, or a new one. Returns 0 on failure.
+     */
+    cmsHTRANSFORM acquire(const TransformDescription& description)
+    {
+        if (isCacheable(description))
+        {
+            QMutexLocker locker(&mutex);
+
+            for (int i = 0 ; i < idle.size() ; ++i)
+            {
+                if (idle.at(i).description == description)
+                {
+                    ++hits;
+                    return idle.takeAt(i).handle;
+                }
+            }
+
+            ++misses;
+        }
+
+        return create(description);
+    }
+
+    /** Gives back a transform obtained from acquire() for the same description.
+     */
+    void release(const TransformDescription& description, cmsHTRANSFORM handle)
+    {
+        if (!handle)
+        {
+            return;
+        }
+
+        if (isCacheable(description))
+        {
+            QMutexLocker locker(&mutex);
+
+            Entry entry;
+            entry.description = description;
+            entry.handle      = handle;
+            idle.prepend(entry);
+
+            if (idle.size() <= MaxIdleTransforms)
+            {
+                return;
+            }
+
+            handle = idle.takeLast().handle;
+        }
+
+        LcmsLock lock;
+        dkCmsDeleteTransform(handle);
+    }
+
+public:
+
+    QMutex     mutex;
+    QAtomicInt hits;
+    QAtomicInt misses;
+
+private:
+
+    /** The gamut check alarm color is global lcms state, not part of the description:
+     *  such transforms are never shared.
+     */
+    static bool isCacheable(const TransformDescription& description)
+    {
+        return !(description.transformFlags & cmsFLAGS_GAMUTCHECK);
+    }
+
+    static cmsHTRANSFORM create(const TransformDescription& description)
+    {
+        LcmsLock lock;
+
+        if (description.proofProfile.isNull())
+        {
+            return dkCmsCreateTransform(description.inputProfile,
+                                        description.inputFormat,
+                                        description.outputProfile,
+                                        description.outputFormat,
+                                        description.intent,
+                                        description.transformFlags);
+        }
+
+        return dkCmsCreateProofingTransform(description.inputProfile,
+                                            description.inputFormat,
+                                            description.outputProfile,
+                                            description.outputFormat,
+                                            description.proofProfile,
+                                            description.intent,
+                                            description.proofIntent,
+                                            description.transformFlags);
+    }
+
+private:
+
+    class Entry
+    {
+    public:
+
+        TransformDescription description;
+        cmsHTRANSFORM        handle;
+    };
+
+    /// Most recently released first
+    QList<Entry> idle;
+};
+
+Q_GLOBAL_STATIC(TransformCache, transformCache)
+
+// --------------------------------------------------------------------------------------------
+
 class IccTransform::Private : public QSharedData
 {
+public:
+
+    enum
+    {
+        /// Minimal number of pixels worth an additional thread, and its own transform, in transform()
+        MinPixelsPerThread = 512 * 1024
+    };
+
 public:
 
     Private()
@@ -134,14 +296,35 @@ public:
         close();
     }
 
+    /** Returns an lcms transform for the description, proofing if a proof profile is set,
+     *  from the process-wide cache if possible. Returns 0 on failure.
+     */
+    static cmsHTRANSFORM acquireHandle(const TransformDescription& description)
+    {
+        return transformCache->acquire(description);
+    }
+
+    /** Give back a transform obtained from acquireHandle().
+     */
+    static void releaseHandle(const TransformDescription& description, cmsHTRANSFORM handle)
+    {
+        if (transformCache.isDestroyed())
+        {
+            LcmsLock lock;
+            dkCmsDeleteTransform(handle);
+            return;
+        }
+
+        transformCache->release(description, handle);
+    }
+
     void close()
     {
         if (handle)
         {
+            releaseHandle(currentDescription, handle);
+            handle             = 0;
             currentDescription = TransformDescription();
-            LcmsLock lock;
-            dkCmsDeleteTransform(handle);
-            handle = 0;
         }
     }
 
@@ -227,6 +410,16 @@ IccTransform::~IccTransform()
     // close() is done in ~Private
 }
 
+int IccTransform::transformCacheHits()
+{
+    return transformCache->hits.load();
+}
+
+int IccTransform::transformCacheMisses()
+{
+    return transformCache->misses.load();
+}
+
 void IccTransform::init()
 {
     LcmsLock lock;
@@ -526,14 +719,7 @@ bool IccTransform::open(TransformDescription& description)
     }
 
     d->currentDescription = description;
-
-    LcmsLock lock;
-    d->handle = dkCmsCreateTransform(description.inputProfile,
-                                     description.inputFormat,
-                                     description.outputProfile,
-                                     description.outputFormat,
-                                     description.intent,
-                                     description.transformFlags);
+    d->handle             = Private::acquireHandle(description);
 
     if (!d->handle)
     {
@@ -559,16 +745,7 @@ bool IccTransform::openProofing(TransformDescription& description)
     }
 
     d->currentDescription = description;
-
-    LcmsLock lock;
-    d->handle = dkCmsCreateProofingTransform(description.inputProfile,
-                                             description.inputFormat,
-                                             description.outputProfile,
-                                             description.outputFormat,
-                                             description.proofProfile,
-                                             description.intent,
-                                             description.proofIntent,
-                                             description.transformFlags);
+    d->handle             = Private::acquireHandle(description);
 
     if (!d->handle)
     {
@@ -648,7 +825,11 @@ bool IccTransform::apply(DImg& image, DImgLoaderObserver* const observer)
         observer->progressInfo(&image, 0.1F);
     }
 
-    transform(image, description, observer);
+    if (!transform(image, description, observer))
+    {
+        // Cancelled: the image is only partly converted, it is not in the output profile
+        return false;
+    }
 
     if (!d->doNotEmbed)
     {
@@ -694,62 +875,119 @@ bool IccTransform::apply(QImage& qimage)
     return true;
 }
 
-void IccTransform::transform(DImg& image, const TransformDescription& description, DImgLoaderObserver* const observer)
+bool IccTransform::transform(DImg& image, const TransformDescription& description, DImgLoaderObserver* const observer)
 {
     const int bytesDepth    = image.bytesDepth();
-    const int pixels        = image.width() * image.height();
+    const int width         = image.width();
+    const int height        = image.height();
+    const int pixels        = width * height;
     // convert ten scanlines in a batch
-    const int pixelsPerStep = image.width() * 10;
-    uchar* data             = image.bits();
+    const int linesPerStep  = 10;
+    const int steps         = (height + linesPerStep - 1) / linesPerStep;
+    uchar* const data       = image.bits();
+
+    // The batches are shared dynamically between the threads. An lcms transform must not be used
+    // concurrently, so each thread gets its own one, and no global lock is needed while converting.
+    // The calling thread uses the main transform and is the only one to talk to the observer.
+
+    const int maxThreads    = qMin(QThreadPool::globalInstance()->maxThreadCount(), steps);
+    const int threads       = qBound(1, pixels / Private::MinPixelsPerThread, qMax(1, maxThreads));
+
+    QVector<cmsHTRANSFORM> handles;
+    handles << d->handle;
+
+    for (int i = 1 ; i < threads ; ++i)
+    {
+        cmsHTRANSFORM handle = Private::acquireHandle(description);
+
+        if (!handle)
+        {
+            break;
+        }
+
+        handles << handle;
+    }
 
     // see dimgloader.cpp, granularity().
     int granularity         = 1;
 
     if (observer)
     {
-        granularity = (int)((pixels / (20 * 0.9)) / observer->granularity());
+        granularity = qMax(1, (int)((steps / (20 * 0.9)) / observer->granularity()));
     }
 
-    int checkPoint = pixels;
-
     // it is safe to use the same input and output buffer if the format is the same
-    if (description.inputFormat == description.outputFormat)
+    const bool inPlace      = (description.inputFormat == description.outputFormat);
+
+    QAtomicInt nextStep(0);
+    QAtomicInt doneSteps(0);
+    QAtomicInt cancel(0);
+
+    auto convert = [&](cmsHTRANSFORM handle, bool reporting)
     {
-        for (int p = pixels; p > 0; p -= pixelsPerStep)
+        QVarLengthArray<uchar> buffer(inPlace ? 1 : width * linesPerStep * bytesDepth);
+        int checkPoint = granularity;
+        int step;
+
+        while (!cancel.load() && (step = nextStep.fetchAndAddOrdered(1)) < steps)
         {
-            int pixelsThisStep =  qMin(p, pixelsPerStep);
-            int size           =  pixelsThisStep * bytesDepth;
-            LcmsLock lock;
-            dkCmsDoTransform(d->handle, data, data, pixelsThisStep);
-            data               += size;
+            const int line           = step * linesPerStep;
+            const int pixelsThisStep = qMin(linesPerStep, height - line) * width;
+            uchar* const ptr         = data + (size_t)line * width * bytesDepth;
 
-            if (observer && p <= checkPoint)
+            if (inPlace)
             {
-                checkPoint -= granularity;
-                observer->progressInfo(&image, 0.1 + 0.9 * (1.0 - float(p) / float(pixels)));
+                dkCmsDoTransform(handle, ptr, ptr, pixelsThisStep);
+            }
+            else
+            {
+                memcpy(buffer.data(), ptr, pixelsThisStep * bytesDepth);
+                dkCmsDoTransform(handle, buffer.data(), ptr, pixelsThisStep);
             }
-        }
-    }
-    else
-    {
-        QVarLengthArray<uchar> buffer(pixelsPerStep * bytesDepth);
 
-        for (int p = pixels; p > 0; p -= pixelsPerStep)
-        {
-            int pixelsThisStep  = qMin(p, pixelsPerStep);
-            int size            = pixelsThisStep * bytesDepth;
-            LcmsLock lock;
-            memcpy(buffer.data(), data, size);
-            dkCmsDoTransform(d->handle, buffer.data(), data, pixelsThisStep);
-            data               += size;
+            const int done = doneSteps.fetchAndAddOrdered(1) + 1;
 
-            if (observer && p <= checkPoint)
+            if (reporting && done >= checkPoint)
             {
-                checkPoint -= granularity;
-                observer->progressInfo(&image, 0.1 + 0.9 * (1.0 - float(p) / float(pixels)));
+                checkPoint = done + granularity;
+
+                if (!observer->continueQuery(&image))
+                {
+                    cancel.store(1);
+                    break;
+                }
+
+                observer->progressInfo(&image, 0.1 + 0.9 * (float(done) / float(steps)));
             }
         }
+    };
+
+    QList<QFuture<void> > tasks;
+
+    for (int i = 1 ; i < handles.size() ; ++i)
+    {
+        cmsHTRANSFORM handle = handles.at(i);
+
+        tasks.append(QtConcurrent::run([&convert, handle]()
+            {
+                convert(handle, false);
+            }
+        ));
     }
+
+    convert(d->handle, (observer != 0));
+
+    foreach (QFuture<void> t, tasks)
+    {
+        t.waitForFinished();
+    }
+
+    for (int i = 1 ; i < handles.size() ; ++i)
+    {
+        Private::releaseHandle(description, handles.at(i));
+    }
+
+    return (doneSteps.load() == steps);
 }
 
 void IccTransform::transform(QImage& image, const TransformDescription&)
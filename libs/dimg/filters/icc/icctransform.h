@@ -68,6 +68,8 @@ public:
     /**
      * Apply this transform with the set profiles and options to the image.
      * Optionally pass an observer to get progress information.
+     * Returns false if the transform failed or was cancelled by the observer;
+     * the profile and the attributes of the image are then not changed.
      */
     bool apply(DImg& image, DImgLoaderObserver* const observer = 0);
 
@@ -144,6 +146,12 @@ public:
     /// Initialize LittleCMS library
     static void init();
 
+    /** Number of lcms transforms reused from, respectively newly built for, the process-wide cache
+     *  since application start.
+     */
+    static int transformCacheHits();
+    static int transformCacheMisses();
+
 private:
 
     bool checkProfiles();
@@ -152,7 +160,8 @@ private:
     TransformDescription getDescription(const QImage& image);
     bool open(TransformDescription& description);
     bool openProofing(TransformDescription& description);
-    void transform(DImg& img, const TransformDescription&, DImgLoaderObserver* const observer = 0);
+    /// Returns false if the observer cancelled the transform, leaving the image partly converted
+    bool transform(DImg& img, const TransformDescription&, DImgLoaderObserver* const observer = 0);
     void transform(QImage& img, const TransformDescription&);
 
 public:
@@ -30,7 +30,6 @@
 // Qt includes
 
 #include <QtMath>
-#include <QtConcurrent>
 
 // Local includes
 
@@ -318,8 +317,7 @@ void LocalContrastFilter::processRgbImage(float* const img, int sizex, int sizey
 
     postProgress(40);
 
-    QList<int> vals = multithreadedSteps(size);
-    int         pos  = 0;
+    int pos = 0;
 
     for (int nstage = 0 ; runningFlag() && (nstage < TONEMAPPING_MAX_STAGES) ; ++nstage)
     {
@@ -341,21 +339,13 @@ void LocalContrastFilter::processRgbImage(float* const img, int sizex, int sizey
 
             inplaceBlur(blurimage.data(), sizex, sizey, d->par.getBlur(nstage));
 
-            QList <QFuture<void> > tasks;
-
-            for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-            {
-                tasks.append(QtConcurrent::run(this,
-                                               &LocalContrastFilter::blurMultithreaded,
-                                               vals[j],
-                                               vals[j+1],
-                                               img,
-                                               blurimage.data()
-                                              ));
-            }
+            float* const blurData = blurimage.data();
 
-            foreach(QFuture<void> t, tasks)
-                t.waitForFinished();
+            runMultithreaded(0, size,
+                [this, img, blurData](int start, int stop)
+                {
+                    blurMultithreaded(start, stop, img, blurData);
+                });
         }
 
         postProgress(50 + nstage * 5);
@@ -366,21 +356,13 @@ void LocalContrastFilter::processRgbImage(float* const img, int sizex, int sizey
         qCDebug(DIGIKAM_DIMG_LOG) << "highSaturation : " << d->par.highSaturation;
         qCDebug(DIGIKAM_DIMG_LOG) << "lowSaturation : "  << d->par.lowSaturation;
 
-        QList <QFuture<void> > tasks;
+        float* const srcData = srcimg.data();
 
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &LocalContrastFilter::saturationMultithreaded,
-                                           vals[j],
-                                           vals[j+1],
-                                           img,
-                                           srcimg.data()
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, size,
+            [this, img, srcData](int start, int stop)
+            {
+                saturationMultithreaded(start, stop, img, srcData);
+            });
     }
 
     postProgress(70);
@@ -460,40 +442,25 @@ void LocalContrastFilter::inplaceBlur(float* const data, int sizex, int sizey, f
     prm.blur            = blur;
     prm.denormal_remove = (float)(1e-15);
 
-    QList<int> valsx = multithreadedSteps(prm.sizex);
-    QList<int> valsy = multithreadedSteps(prm.sizey);
-
     for (uint stage = 0 ; runningFlag() && (stage < 2) ; ++stage)
     {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < valsy.count()-1) ; ++j)
-        {
-            prm.start = valsy[j];
-            prm.stop  = valsy[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                           &LocalContrastFilter::inplaceBlurYMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        tasks.clear();
-
-        for (int j = 0 ; runningFlag() && (j < valsx.count()-1) ; ++j)
-        {
-            prm.start = valsx[j];
-            prm.stop  = valsx[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                           &LocalContrastFilter::inplaceBlurXMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, prm.sizey,
+            [this, &prm](int start, int stop)
+            {
+                Args chunkPrm  = prm;
+                chunkPrm.start = start;
+                chunkPrm.stop  = stop;
+                inplaceBlurYMultithreaded(chunkPrm);
+            });
+
+        runMultithreaded(0, prm.sizex,
+            [this, &prm](int start, int stop)
+            {
+                Args chunkPrm  = prm;
+                chunkPrm.start = start;
+                chunkPrm.stop  = stop;
+                inplaceBlurXMultithreaded(chunkPrm);
+            });
     }
 }
 
@@ -25,7 +25,6 @@
 #include <QByteArray>
 #include <QCheckBox>
 #include <QString>
-#include <QtConcurrent>
 
 // Local includes
 
@@ -233,26 +232,18 @@ void LensFunFilter::filterImage()
                               << m_orgImage.width()  << ", "
                               << m_orgImage.height() << ")";
 
-    QList<int> vals = multithreadedSteps(m_destImage.height());
-
     // Stage 1: Chromatic Aberation Corrections
 
     if (d->iface->settings().filterCCA)
     {
         m_orgImage.prepareSubPixelAccess(); // init lanczos kernel
 
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &LensFunFilter::filterCCAMultithreaded,
-                                           vals[j],
-                                           vals[j+1]));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, m_destImage.height(),
+                         [this](int start, int stop)
+                         {
+                             filterCCAMultithreaded(start, stop);
+                         },
+                         0, 30);
 
         qCDebug(DIGIKAM_DIMG_LOG) << "Chromatic Aberation Corrections applied.";
     }
@@ -263,18 +254,12 @@ void LensFunFilter::filterImage()
 
     if (d->iface->settings().filterVIG)
     {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &LensFunFilter::filterVIGMultithreaded,
-                                           vals[j],
-                                           vals[j+1]));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, m_destImage.height(),
+                         [this](int start, int stop)
+                         {
+                             filterVIGMultithreaded(start, stop);
+                         },
+                         30, 60);
 
         qCDebug(DIGIKAM_DIMG_LOG) << "Vignetting and Color Corrections applied.";
     }
@@ -295,18 +280,12 @@ void LensFunFilter::filterImage()
 
         m_destImage.prepareSubPixelAccess(); // init lanczos kernel
 
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &LensFunFilter::filterDSTMultithreaded,
-                                           vals[j],
-                                           vals[j+1]));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, m_destImage.height(),
+                         [this](int start, int stop)
+                         {
+                             filterDSTMultithreaded(start, stop);
+                         },
+                         60, 90);
 
         qCDebug(DIGIKAM_DIMG_LOG) << "Distortion and Geometry Corrections applied.";
 
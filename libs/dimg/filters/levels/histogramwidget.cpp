@@ -67,10 +67,17 @@ public:
         HistogramNone = 0,        // No current histogram values calculation.
         HistogramDataLoading,     // The image is being loaded
         HistogramStarted,         // Histogram values calculation started.
+        HistogramApproximated,    // Approximate histogram shown while the exact values calculation runs.
         HistogramCompleted,       // Histogram values calculation completed.
         HistogramFailed           // Histogram values calculation failed.
     };
 
+    enum
+    {
+        /// Above this number of pixels, an approximate histogram is shown first
+        ApproximationThreshold = 4 * ImageHistogram::ApproximationPixels
+    };
+
 public:
 
     Private()
@@ -87,6 +94,8 @@ public:
           scaleType(LogScaleHistogram),
           imageHistogram(0),
           selectionHistogram(0),
+          imageApproximation(0),
+          selectionApproximation(0),
           xmin(0),
           xminOrg(0),
           xmax(0),
@@ -115,6 +124,8 @@ public:
     HistogramScale                   scaleType;              // Scale to use for drawing
     ImageHistogram*                  imageHistogram;         // Full image
     ImageHistogram*                  selectionHistogram;     // Image selection
+    ImageHistogram*                  imageApproximation;     // Approximate full image, shown first for large images
+    ImageHistogram*                  selectionApproximation; // Approximate image selection, shown first for large selections
 
     // Current selection information.
     double                           xmin;
@@ -145,6 +156,8 @@ HistogramWidget::~HistogramWidget()
 
     delete d->imageHistogram;
     delete d->selectionHistogram;
+    delete d->imageApproximation;
+    delete d->selectionApproximation;
     delete d;
 }
 
@@ -173,6 +186,12 @@ void HistogramWidget::connectHistogram(const ImageHistogram* const histogram)
             this, SLOT(slotCalculationFinished(bool)));
 }
 
+void HistogramWidget::connectApproximation(const ImageHistogram* const histogram)
+{
+    connect(histogram, SIGNAL(calculationFinished(bool)),
+            this, SLOT(slotApproximationFinished(bool)));
+}
+
 void HistogramWidget::updateData(const DImg& img, const DImg& sel, bool showProgress)
 {
     d->showProgress = showProgress;
@@ -191,7 +210,9 @@ void HistogramWidget::updateData(const DImg& img, const DImg& sel, bool showProg
     {
         // do not delete main histogram if only the selection is reset
         delete d->imageHistogram;
-        d->imageHistogram = 0;
+        d->imageHistogram     = 0;
+        delete d->imageApproximation;
+        d->imageApproximation = 0;
     }
 
     // Calc new histogram data
@@ -199,15 +220,29 @@ void HistogramWidget::updateData(const DImg& img, const DImg& sel, bool showProg
     {
         d->imageHistogram = new ImageHistogram(img);
         connectHistogram(d->imageHistogram);
+
+        if (img.numPixels() > Private::ApproximationThreshold)
+        {
+            d->imageApproximation = new ImageHistogram(img, ImageHistogram::ApproximationPixels);
+            connectApproximation(d->imageApproximation);
+        }
     }
 
     delete d->selectionHistogram;
-    d->selectionHistogram = 0;
+    d->selectionHistogram     = 0;
+    delete d->selectionApproximation;
+    d->selectionApproximation = 0;
 
     if (!sel.isNull())
     {
         d->selectionHistogram = new ImageHistogram(sel);
         connectHistogram(d->selectionHistogram);
+
+        if (sel.numPixels() > Private::ApproximationThreshold)
+        {
+            d->selectionApproximation = new ImageHistogram(sel, ImageHistogram::ApproximationPixels);
+            connectApproximation(d->selectionApproximation);
+        }
     }
     else
     {
@@ -221,6 +256,15 @@ void HistogramWidget::updateData(const DImg& img, const DImg& sel, bool showProg
 
     if (histo)
     {
+        // For large images, an approximate histogram is computed in its own thread, in a few
+        // milliseconds, and shown until the exact values are available.
+        ImageHistogram* const approx = currentApproximation();
+
+        if (approx)
+        {
+            approx->calculateInThread();
+        }
+
         histo->calculateInThread();
     }
     else
@@ -267,10 +311,17 @@ void HistogramWidget::setRenderingType(HistogramRenderingType type)
             // still computing, or need to start it?
             if (nowUsedHistogram->isCalculating())
             {
-                setState(HistogramWidget::Private::HistogramStarted);
+                setCalculationStarted();
             }
             else
             {
+                ImageHistogram* const approx = currentApproximation();
+
+                if (approx && !approx->isValid() && !approx->isCalculating())
+                {
+                    approx->calculateInThread();
+                }
+
                 nowUsedHistogram->calculateInThread();
             }
         }
@@ -298,6 +349,32 @@ ImageHistogram* HistogramWidget::currentHistogram() const
     }
 }
 
+ImageHistogram* HistogramWidget::currentApproximation() const
+{
+    if (d->renderingType == ImageSelectionHistogram && d->selectionHistogram)
+    {
+        return d->selectionApproximation;
+    }
+    else
+    {
+        return d->imageApproximation;
+    }
+}
+
+void HistogramWidget::setCalculationStarted()
+{
+    ImageHistogram* const approx = currentApproximation();
+
+    if (approx && approx->isValid())
+    {
+        setState(HistogramWidget::Private::HistogramApproximated);
+    }
+    else
+    {
+        setState(HistogramWidget::Private::HistogramStarted);
+    }
+}
+
 void HistogramWidget::reset()
 {
     d->histogramPainter->disableHistogramGuide();
@@ -348,6 +425,15 @@ void HistogramWidget::setState(int state)
             break;
         }
 
+        case HistogramWidget::Private::HistogramApproximated:
+        {
+            // No animation over the approximate histogram, but the user shall know that it will change.
+            d->animation->stop();
+            setCursor(Qt::BusyCursor);
+            update();
+            break;
+        }
+
         case HistogramWidget::Private::HistogramCompleted:
         {
             notifyValuesChanged();
@@ -364,9 +450,13 @@ void HistogramWidget::setState(int state)
 
             // Remove old histogram data from memory.
             delete d->imageHistogram;
-            d->imageHistogram     = 0;
+            d->imageHistogram         = 0;
             delete d->selectionHistogram;
-            d->selectionHistogram = 0;
+            d->selectionHistogram     = 0;
+            delete d->imageApproximation;
+            d->imageApproximation     = 0;
+            delete d->selectionApproximation;
+            d->selectionApproximation = 0;
 
             stopWaitingAnimation();
             update();
@@ -383,7 +473,7 @@ void HistogramWidget::slotCalculationAboutToStart()
         return;
     }
 
-    setState(HistogramWidget::Private::HistogramStarted);
+    setCalculationStarted();
 }
 
 void HistogramWidget::slotCalculationFinished(bool success)
@@ -404,6 +494,21 @@ void HistogramWidget::slotCalculationFinished(bool success)
     }
 }
 
+void HistogramWidget::slotApproximationFinished(bool success)
+{
+    // only react to the approximation of the histogram that the user is currently waiting for,
+    // if the exact values are still being computed. A failed approximation is not shown.
+    if (QObject::sender() != currentApproximation())
+    {
+        return;
+    }
+
+    if (success && d->state == HistogramWidget::Private::HistogramStarted)
+    {
+        setState(HistogramWidget::Private::HistogramApproximated);
+    }
+}
+
 void HistogramWidget::setDataLoading()
 {
     setState(HistogramWidget::Private::HistogramDataLoading);
@@ -426,6 +531,16 @@ void HistogramWidget::stopHistogramComputation()
         d->selectionHistogram->stopCalculation();
     }
 
+    if (d->imageApproximation)
+    {
+        d->imageApproximation->stopCalculation();
+    }
+
+    if (d->selectionApproximation)
+    {
+        d->selectionApproximation->stopCalculation();
+    }
+
     stopWaitingAnimation();
 }
 
@@ -531,6 +646,12 @@ void HistogramWidget::paintEvent(QPaintEvent*)
         histogram = d->imageHistogram;
     }
 
+    // Exact values are not yet available: render the approximate histogram.
+    if (d->state == HistogramWidget::Private::HistogramApproximated)
+    {
+        histogram = currentApproximation();
+    }
+
     if (!histogram)
     {
         return;
@@ -113,6 +113,7 @@ protected Q_SLOTS:
 
     void slotCalculationAboutToStart();
     void slotCalculationFinished(bool success);
+    void slotApproximationFinished(bool success);
 
 protected:
 
@@ -125,8 +126,11 @@ private:
 
     void notifyValuesChanged();
     void connectHistogram(const ImageHistogram* const histogram);
+    void connectApproximation(const ImageHistogram* const histogram);
     void setup(int w, int h, bool selectMode, bool statisticsVisible);
     void setState(int state);
+    void setCalculationStarted();
+    ImageHistogram* currentApproximation() const;
     void startWaitingAnimation();
     void stopWaitingAnimation();
 
@@ -32,6 +32,11 @@
 // Qt includes
 
 #include <QObject>
+#include <QList>
+#include <QVector>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 // Local includes
 
@@ -59,6 +64,28 @@ public:
         double alpha;
     };
 
+    /** Layout of the partial histograms counted by each thread: ChannelsCount
+     *  consecutive counters per segment.
+     */
+    enum PartialChannel
+    {
+        Value = 0,
+        Red,
+        Green,
+        Blue,
+        Alpha,
+        ChannelsCount
+    };
+
+    enum
+    {
+        /// Minimal number of pixels worth a thread of the computation
+        MinPixelsPerBand = 256 * 1024,
+
+        /// Memory for all partial histograms. A partial histogram of a 16 bits image takes 1.25 MB.
+        MaxPartialsBytes = 8 * 1024 * 1024
+    };
+
 public:
 
     Private()
@@ -66,6 +93,50 @@ public:
         histogram     = 0;
         histoSegments = 0;
         valid         = false;
+        approximate   = false;
+        step          = 1;
+    }
+
+    /** Number of rows and columns of img which are counted.
+     */
+    uint sampledRows() const
+    {
+        return (img.height() + step - 1) / step;
+    }
+
+    uint sampledColumns() const
+    {
+        return (img.width() + step - 1) / step;
+    }
+
+    /** Count the sampled pixels of the sampled row y in the partial histogram bins.
+     */
+    template <typename T>
+    void countRow(const T* const data, uint y, uint* const bins) const
+    {
+        const uint width = img.width();
+        const T*   ptr   = data + (size_t)y * step * width * 4;
+        const T*   end   = ptr + (size_t)width * 4;
+        const uint inc   = step * 4;
+        T          max;
+
+        for ( ; ptr < end ; ptr += inc)
+        {
+            const T blue  = ptr[0];
+            const T green = ptr[1];
+            const T red   = ptr[2];
+            const T alpha = ptr[3];
+
+            bins[blue  * ChannelsCount + Blue]++;
+            bins[green * ChannelsCount + Green]++;
+            bins[red   * ChannelsCount + Red]++;
+            bins[alpha * ChannelsCount + Alpha]++;
+
+            max = (blue > green) ? blue : green;
+            max = (red  > max)   ? red  : max;
+
+            bins[max * ChannelsCount + Value]++;
+        }
     }
 
 public:
@@ -76,6 +147,12 @@ public:
     /** Image information.*/
     DImg                  img;
 
+    /** True if the histogram is computed from a subsampling of img.*/
+    bool                  approximate;
+
+    /** Only one pixel out of step, in both directions, of img is counted.*/
+    uint                  step;
+
     /** Numbers of histogram segments depending of image bytes depth*/
     int                   histoSegments;
 };
@@ -90,6 +167,21 @@ ImageHistogram::ImageHistogram(const DImg& img, QObject* const parent)
     d->histoSegments = d->img.sixteenBit() ? NUM_SEGMENTS_16BIT : NUM_SEGMENTS_8BIT;
 }
 
+ImageHistogram::ImageHistogram(const DImg& img, int approximationPixels, QObject* const parent)
+    : DynamicThread(parent), d(new Private)
+{
+    d->img           = img;
+    d->histoSegments = d->img.sixteenBit() ? NUM_SEGMENTS_16BIT : NUM_SEGMENTS_8BIT;
+    d->approximate   = true;
+
+    if (!img.isNull())
+    {
+        // Count only the pixels of a regular grid, as a nearest neighbour preview would do.
+        // Contrary to a smooth scaled preview, the distribution of the values is not narrowed.
+        d->step = qMax(1U, (uint)ceil(sqrt((double)img.numPixels() / qMax(1, approximationPixels))));
+    }
+}
+
 ImageHistogram::~ImageHistogram()
 {
     stopCalculation();
@@ -143,6 +235,11 @@ bool ImageHistogram::isValid() const
     return d->valid;
 }
 
+bool ImageHistogram::isApproximate() const
+{
+    return d->approximate;
+}
+
 bool ImageHistogram::isCalculating() const
 {
     return isRunning();
@@ -171,9 +268,6 @@ void ImageHistogram::calculate()
         return;
     }
 
-    uint i;
-    int  max;
-
     emit calculationStarted();
 
     if (!d->histogram)
@@ -188,75 +282,94 @@ void ImageHistogram::calculate()
         return;
     }
 
-    memset(d->histogram, 0, d->histoSegments * sizeof(struct Private::double_packet));
+    // The sampled rows are split in bands. Each band is counted in its own partial histogram,
+    // so that no synchronization is needed while counting. The partial histograms are summed at end.
 
-    if (isSixteenBit())         // 16 bits image.
-    {
-        unsigned short blue, green, red, alpha;
-        unsigned short* const data = reinterpret_cast<unsigned short*>(d->img.bits());
+    const uint   rows         = d->sampledRows();
+    const qint64 pixels       = (qint64)rows * d->sampledColumns();
+    const qint64 partialBytes = (qint64)d->histoSegments * Private::ChannelsCount * sizeof(uint);
+    const qint64 maxBands     = qMin(qMin((qint64)QThreadPool::globalInstance()->maxThreadCount(),
+                                          pixels / Private::MinPixelsPerBand),
+                                     Private::MaxPartialsBytes / partialBytes);
+    const uint   bands        = (uint)qBound((qint64)1, maxBands, (qint64)qMax(rows, 1U));
 
-        // count here instead of inside the loop, because d is not optimized because it's not defined in the header
-        const uint count = d->img.width() * d->img.height() * 4;
-        for (i = 0 ; runningFlag() && (i < count) ; i += 4)
-        {
-            blue  = data[i    ];
-            green = data[i + 1];
-            red   = data[i + 2];
-            alpha = data[i + 3];
+    QVector<uint> partials(bands * d->histoSegments * Private::ChannelsCount, 0);
 
-            d->histogram[blue].blue++;
-            d->histogram[green].green++;
-            d->histogram[red].red++;
-            d->histogram[alpha].alpha++;
+    QList<QFuture<void> > tasks;
 
-            max = (blue > green) ? blue : green;
+    for (uint j = 0 ; j < bands ; ++j)
+    {
+        const uint start = (uint)((qint64)rows * j       / bands);
+        const uint stop  = (uint)((qint64)rows * (j + 1) / bands);
+        uint* const bins = partials.data() + j * d->histoSegments * Private::ChannelsCount;
 
-            if (red > max)
-            {
-                d->histogram[red].value++;
-            }
-            else
-            {
-                d->histogram[max].value++;
-            }
+        if (j == bands - 1)
+        {
+            // The last band is counted in the calling thread.
+            calculateMultithreaded(start, stop, bins);
+        }
+        else
+        {
+            tasks.append(QtConcurrent::run([this, start, stop, bins]()
+                {
+                    calculateMultithreaded(start, stop, bins);
+                }
+            ));
         }
     }
-    else                                  // 8 bits images.
+
+    foreach (QFuture<void> t, tasks)
     {
-        uchar blue, green, red, alpha;
-        const uchar* const data = d->img.bits();
+        t.waitForFinished();
+    }
 
-        // count here instead of inside the loop, because d is not optimized because it's not defined in the header
-        const uint count = d->img.width() * d->img.height() * 4;
-        for (i = 0 ; runningFlag() && (i < count) ; i += 4)
-        {
-            blue  = data[i    ];
-            green = data[i + 1];
-            red   = data[i + 2];
-            alpha = data[i + 3];
+    if (!runningFlag())
+    {
+        return;
+    }
 
-            d->histogram[blue].blue++;
-            d->histogram[green].green++;
-            d->histogram[red].red++;
-            d->histogram[alpha].alpha++;
+    // Counts are integers: the sum is exact, whatever the number of bands.
+    // An approximate histogram is scaled to the size of the whole image.
 
-            max = (blue > green) ? blue : green;
+    const double scale = pixels ? (double)d->img.numPixels() / (double)pixels : 1.0;
 
-            if (red > max)
-            {
-                d->histogram[red].value++;
-            }
-            else
-            {
-                d->histogram[max].value++;
-            }
+    for (int i = 0 ; i < d->histoSegments ; ++i)
+    {
+        quint64 value = 0, red = 0, green = 0, blue = 0, alpha = 0;
+
+        for (uint j = 0 ; j < bands ; ++j)
+        {
+            const uint* const bin = partials.constData() + (j * d->histoSegments + i) * Private::ChannelsCount;
+            value                += bin[Private::Value];
+            red                  += bin[Private::Red];
+            green                += bin[Private::Green];
+            blue                 += bin[Private::Blue];
+            alpha                += bin[Private::Alpha];
         }
+
+        d->histogram[i].value = value * scale;
+        d->histogram[i].red   = red   * scale;
+        d->histogram[i].green = green * scale;
+        d->histogram[i].blue  = blue  * scale;
+        d->histogram[i].alpha = alpha * scale;
     }
 
-    if (runningFlag())
+    d->valid = true;
+    emit calculationFinished(true);
+}
+
+void ImageHistogram::calculateMultithreaded(uint start, uint stop, uint* const bins)
+{
+    for (uint y = start ; runningFlag() && (y < stop) ; ++y)
     {
-        d->valid = true;
-        emit calculationFinished(true);
+        if (d->img.sixteenBit())
+        {
+            d->countRow(reinterpret_cast<const unsigned short*>(d->img.bits()), y, bins);
+        }
+        else
+        {
+            d->countRow(d->img.bits(), y, bins);
+        }
     }
 }
 
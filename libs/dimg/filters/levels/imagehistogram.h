@@ -45,9 +45,25 @@ class DIGIKAM_EXPORT ImageHistogram : public DynamicThread
 {
     Q_OBJECT
 
+public:
+
+    enum
+    {
+        /// Number of pixels counted, at least, by an approximate histogram of the widgets
+        ApproximationPixels = 512 * 512
+    };
+
 public:
 
     explicit ImageHistogram(const DImg& img, QObject* const parent = 0);
+
+    /** Constructor of an approximate histogram of img, fast to compute: only the pixels of
+     *  a regular grid of img, about approximationPixels pixels, are counted.
+     *  Values are scaled to the size of img, so that statistics are comparable with the exact histogram.
+     *  The widgets get the image data only, without its cached preview: the grid stands for the
+     *  preview, and unlike a smooth scaled preview, does not blend the values of the pixels.
+     */
+    ImageHistogram(const DImg& img, int approximationPixels, QObject* const parent = 0);
     ~ImageHistogram();
 
     /** Started computation: synchronous or threaded */
@@ -59,8 +75,9 @@ public:
     bool isCalculating()  const;
 
     /** Methods to access the histogram data.*/
-    bool   isSixteenBit() const;
-    bool   isValid()      const;
+    bool   isSixteenBit()  const;
+    bool   isValid()       const;
+    bool   isApproximate() const;
 
     double getCount(int channel, int start, int end)   const;
     double getMean(int channel, int start, int end)    const;
@@ -85,6 +102,13 @@ protected:
 
     virtual void run();
 
+private:
+
+    /** Count the sampled rows start to stop of the image in the partial histogram bins.
+     *  Can be called concurrently on distinct bins.
+     */
+    void calculateMultithreaded(uint start, uint stop, uint* const bins);
+
 private:
 
     class Private;
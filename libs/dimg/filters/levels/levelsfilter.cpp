@@ -85,7 +85,20 @@ void LevelsFilter::filterImage()
     levels.levelsLutSetup(AlphaChannel);
     postProgress(80);
 
-    levels.levelsLutProcess(m_orgImage.bits(), m_destImage.bits(), m_orgImage.width(), m_orgImage.height());
+    // The LUT is only read while processing, so ranges of rows are processed in parallel.
+
+    uchar* const srcBits  = m_orgImage.bits();
+    uchar* const destBits = m_destImage.bits();
+    const int    width    = m_orgImage.width();
+    const int    lineSize = width * m_orgImage.bytesDepth();
+
+    runMultithreaded(0, m_orgImage.height(),
+        [&levels, srcBits, destBits, width, lineSize](int start, int stop)
+        {
+            levels.levelsLutProcess(srcBits + (size_t)start * lineSize, destBits + (size_t)start * lineSize, width, stop - start);
+        },
+        80, 90);
+
     postProgress(90);
 }
 
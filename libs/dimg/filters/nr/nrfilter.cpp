@@ -32,7 +32,7 @@
 
 // Qt includes
 
-#include <QtConcurrent>
+#include <QVector>
 
 // Local includes
 
@@ -376,8 +376,13 @@ void NRFilter::waveletDenoise(float* fimg[3], unsigned int width, unsigned int h
 
     QScopedArrayPointer<float> temp(new float[qMax(width, height)]);
 
-    QList<int> vals = multithreadedSteps(size);
-    QList <QFuture<void> > tasks;
+    // The stdev sums are accumulated in parts of a fixed size, summed in the order of the parts,
+    // so that the result does not depend on the scheduling of the threads.
+
+    const uint      partSize = 64 * 1024;
+    const int       parts    = (size + partSize - 1) / partSize;
+    QVector<double> partStdev(parts * 5);
+    QVector<uint>   partSamples(parts * 5);
 
     Args prm;
     prm.thold     = &thold;
@@ -420,43 +425,52 @@ void NRFilter::waveletDenoise(float* fimg[3], unsigned int width, unsigned int h
         stdev[0]   = stdev[1]   = stdev[2]   = stdev[3]   = stdev[4]   = 0.0;
         samples[0] = samples[1] = samples[2] = samples[3] = samples[4] = 0;
 
-        // calculate stdevs for all intensities
+        // calculate stdevs for all intensities.
+
+        partStdev.fill(0.0);
+        partSamples.fill(0);
 
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
+        runMultithreaded(0, parts,
+            [this, &prm, &partStdev, &partSamples, partSize, size](int start, int stop)
+            {
+                for (int part = start ; part < stop ; ++part)
+                {
+                    Args partPrm    = prm;
+                    partPrm.start   = part * partSize;
+                    partPrm.stop    = qMin((part + 1) * partSize, size);
+                    partPrm.stdev   = partStdev.data()   + part * 5;
+                    partPrm.samples = partSamples.data() + part * 5;
+                    calculteStdevMultithreaded(partPrm);
+                }
+            });
+
+        for (int part = 0 ; part < parts ; ++part)
         {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                        &NRFilter::calculteStdevMultithreaded,
-                                        prm
-                                        ));
+            for (int i = 0 ; i < 5 ; ++i)
+            {
+                stdev[i]   += partStdev[part * 5 + i];
+                samples[i] += partSamples[part * 5 + i];
+            }
         }
 
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
         stdev[0] = sqrt(stdev[0] / (samples[0] + 1));
         stdev[1] = sqrt(stdev[1] / (samples[1] + 1));
         stdev[2] = sqrt(stdev[2] / (samples[2] + 1));
         stdev[3] = sqrt(stdev[3] / (samples[3] + 1));
         stdev[4] = sqrt(stdev[4] / (samples[4] + 1));
 
-        // do thresholding
+        // do thresholding. The threshold is computed per pixel, so each chunk uses its own variable.
 
-        tasks.clear();
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            tasks.append(QtConcurrent::run(this,
-                                        &NRFilter::thresholdingMultithreaded,
-                                        prm
-                                        ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
+        runMultithreaded(0, size,
+            [this, &prm, &thold](int start, int stop)
+            {
+                float chunkThold = thold;
+                Args  chunkPrm   = prm;
+                chunkPrm.start   = start;
+                chunkPrm.stop    = stop;
+                chunkPrm.thold   = &chunkThold;
+                thresholdingMultithreaded(chunkPrm);
+            });
 
         hpass = lpass;
     }
@@ -29,10 +29,6 @@
 
 #include <cmath>
 
-// Qt includes
-
-#include <QtConcurrent>
-
 // Local includes
 
 #include "dimg.h"
@@ -310,36 +306,15 @@ void RefocusFilter::convolveImageMultithreaded(uint start, uint stop, uint y1, c
 
 void RefocusFilter::convolveImage(const Args& prm)
 {
-    int progress;
-
-    QList<int> vals = multithreadedSteps(prm.width);
-
-    for (int y1 = 0; runningFlag() && (y1 < prm.height); ++y1)
-    {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &RefocusFilter::convolveImageMultithreaded,
-                                           vals[j],
-                                           vals[j+1],
-                                           y1,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        // Update the progress bar in dialog.
-        progress = (int)(((double)y1 * 100.0) / prm.height);
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    runMultithreaded(0, prm.height,
+                     [this, &prm](int start, int stop)
+                     {
+                         for (int y1 = start ; runningFlag() && (y1 < stop) ; ++y1)
+                         {
+                             convolveImageMultithreaded(0, prm.width, y1, prm);
+                         }
+                     },
+                     0, 100);
 }
 
 FilterAction RefocusFilter::filterAction()
@@ -35,10 +35,6 @@
 #include <cmath>
 #include <cstdlib>
 
-// Qt includes
-
-#include <QtConcurrent>
-
 // Local includes
 
 #include "digikam_debug.h"
@@ -192,8 +188,6 @@ void SharpenFilter::convolveImageMultithreaded(const Args& prm)
 
 bool SharpenFilter::convolveImage(const unsigned int order, const double* const kernel)
 {
-    uint    y;
-    int     progress;
     long    i;
     double  normalize = 0.0;
 
@@ -233,34 +227,21 @@ bool SharpenFilter::convolveImage(const unsigned int order, const double* const
     }
 
     prm.normal_kernel = normal_kernel.data();
-    QList<int> vals = multithreadedSteps(m_destImage.width());
-
-    for (y = 0 ; runningFlag() && (y < m_destImage.height()) ; ++y)
-    {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            prm.start = vals[j];
-            prm.stop  = vals[j+1];
-            prm.y     = y;
-
-            tasks.append(QtConcurrent::run(this,
-                                           &SharpenFilter::convolveImageMultithreaded,
-                                           prm
-                                          ));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        progress = (int)(((double)y * 100.0) / m_destImage.height());
 
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    runMultithreaded(0, m_destImage.height(),
+                     [this, &prm](int start, int stop)
+                     {
+                         Args rowPrm  = prm;
+                         rowPrm.start = 0;
+                         rowPrm.stop  = m_destImage.width();
+
+                         for (int y = start ; runningFlag() && (y < stop) ; ++y)
+                         {
+                             rowPrm.y = y;
+                             convolveImageMultithreaded(rowPrm);
+                         }
+                     },
+                     0, 100);
 
     return true;
 }
@@ -33,10 +33,6 @@
 #include <cmath>
 #include <cstdlib>
 
-// Qt includes
-
-#include <QtConcurrent>
-
 // Local includes
 
 #include "dimg.h"
@@ -176,8 +172,6 @@ void UnsharpMaskFilter::unsharpMaskMultithreaded(uint start, uint stop, uint y)
 
 void UnsharpMaskFilter::filterImage()
 {
-    int progress;
-
     if (m_orgImage.isNull())
     {
         qCWarning(DIGIKAM_DIMG_LOG) << "No image data available!";
@@ -186,31 +180,15 @@ void UnsharpMaskFilter::filterImage()
 
     BlurFilter(this, m_orgImage, m_destImage, 0, 10, (int)(m_radius*10.0));
 
-    QList<int> vals = multithreadedSteps(m_destImage.width());
-
-    for (uint y = 0 ; runningFlag() && (y < m_destImage.height()) ; ++y)
-    {
-        QList <QFuture<void> > tasks;
-
-        for (int j = 0 ; runningFlag() && (j < vals.count()-1) ; ++j)
-        {
-            tasks.append(QtConcurrent::run(this,
-                                           &UnsharpMaskFilter::unsharpMaskMultithreaded,
-                                           vals[j],
-                                           vals[j+1],
-                                           y));
-        }
-
-        foreach(QFuture<void> t, tasks)
-            t.waitForFinished();
-
-        progress = (int)(10.0 + ((double)y * 90.0) / m_destImage.height());
-
-        if (progress % 5 == 0)
-        {
-            postProgress(progress);
-        }
-    }
+    runMultithreaded(0, m_destImage.height(),
+                     [this](int start, int stop)
+                     {
+                         for (int y = start ; runningFlag() && (y < stop) ; ++y)
+                         {
+                             unsharpMaskMultithreaded(0, m_destImage.width(), y);
+                         }
+                     },
+                     10, 100);
 }
 
 FilterAction UnsharpMaskFilter::filterAction()
@@ -419,16 +419,24 @@ void WBFilter::setLUTv()
 
 void WBFilter::adjustWhiteBalance(uchar* const data, int width, int height, bool sixteenBit)
 {
-    uint size = (uint)(width * height);
+    runMultithreaded(0, width * height,
+        [this, data, sixteenBit](int start, int stop)
+        {
+            adjustWhiteBalanceMultithreaded(start, stop, data, sixteenBit);
+        },
+        0, 100);
+}
+
+void WBFilter::adjustWhiteBalanceMultithreaded(uint start, uint stop, uchar* const data, bool sixteenBit)
+{
     uint i, j;
-    int  progress;
 
     if (!sixteenBit)        // 8 bits image.
     {
         uchar  red, green, blue;
-        uchar* ptr = data;
+        uchar* ptr = data + start * 4;
 
-        for (j = 0 ; runningFlag() && (j < size) ; ++j)
+        for (j = start ; runningFlag() && (j < stop) ; ++j)
         {
             int v, rv[3];
 
@@ -453,21 +461,14 @@ void WBFilter::adjustWhiteBalance(uchar* const data, int width, int height, bool
             ptr[1] = (uchar)pixelColor(rv[1], i, v);
             ptr[2] = (uchar)pixelColor(rv[2], i, v);
             ptr    += 4;
-
-            progress = (int)(((double)j * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
     else               // 16 bits image.
     {
         unsigned short  red, green, blue;
-        unsigned short* ptr = reinterpret_cast<unsigned short*>(data);
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(data) + start * 4;
 
-        for (j = 0 ; runningFlag() && (j < size) ; ++j)
+        for (j = start ; runningFlag() && (j < stop) ; ++j)
         {
             int v, rv[3];
 
@@ -492,13 +493,6 @@ void WBFilter::adjustWhiteBalance(uchar* const data, int width, int height, bool
             ptr[1] = pixelColor(rv[1], i, v);
             ptr[2] = pixelColor(rv[2], i, v);
             ptr    += 4;
-
-            progress = (int)(((double)j * 100.0) / size);
-
-            if (progress % 5 == 0)
-            {
-                postProgress(progress);
-            }
         }
     }
 }
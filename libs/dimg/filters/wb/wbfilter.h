@@ -99,6 +99,7 @@ private:
     void setRGBmult();
     void setLUTv();
     void adjustWhiteBalance(uchar* const data, int width, int height, bool sixteenBit);
+    void adjustWhiteBalanceMultithreaded(uint start, uint stop, uchar* const data, bool sixteenBit);
     inline unsigned short pixelColor(int colorMult, int index, int value);
 
     static void setRGBmult(double& temperature, double& green, float& mr, float& mg, float& mb);
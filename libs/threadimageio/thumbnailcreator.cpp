@@ -37,6 +37,7 @@
 #include <QUrl>
 #include <QUrlQuery>
 #include <QTemporaryFile>
+#include <QStandardPaths>
 
 // KDE includes
 
@@ -61,6 +62,7 @@
 #include "thumbsdbaccess.h"
 #include "thumbsdb.h"
 #include "thumbsdbbackend.h"
+#include "thumbnailpackstore.h"
 #include "thumbnailsize.h"
 
 #ifdef Q_OS_WIN
@@ -130,6 +132,24 @@ int ThumbnailCreator::Private::storageSize() const
     }
 }
 
+QString ThumbnailCreator::Private::packLocation() const
+{
+    if (!ThumbsDbAccess::isInitialized())
+    {
+        return QString();
+    }
+
+    // One set of packs per thumbnail database, which stays the authoritative store
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           QLatin1String("/digikam/thumbnailpacks/")                               +
+           QString::fromLatin1(ThumbsDbAccess::parameters().hash());
+}
+
+bool ThumbnailCreator::Private::isFresh(const PrefetchedEntry& entry) const
+{
+    return (prefetchClock.elapsed() - entry.second < PrefetchLifetime);
+}
+
 void ThumbnailCreator::setThumbnailSize(int thumbnailSize)
 {
     d->thumbnailSize = thumbnailSize;
@@ -243,7 +263,18 @@ QImage ThumbnailCreator::load(const ThumbnailIdentifier& identifier, const QRect
             }
             else
             {
-                image = loadFromDatabase(info);
+                image = loadFromPack(info);
+
+                if (image.isNull())
+                {
+                    resolvePrefetch();
+                    image = loadFromDatabase(info);
+
+                    if (!image.isNull())
+                    {
+                        storeInPack(info, image);
+                    }
+                }
             }
 
             break;
@@ -269,6 +300,7 @@ QImage ThumbnailCreator::load(const ThumbnailIdentifier& identifier, const QRect
             {
                 case ThumbnailDatabase:
                     storeInDatabase(info, image);
+                    storeInPack(info, image);
                     break;
                 case FreeDesktopStandard:
 
@@ -417,6 +449,7 @@ void ThumbnailCreator::store(const QString& path, const QImage& i, const QRect&
             if (!isInDatabase(info))
             {
                 storeInDatabase(info, image);
+                storeInPack(info, image);
             }
 
             break;
@@ -867,23 +900,57 @@ void ThumbnailCreator::storeInDatabase(const ThumbnailInfo& info, const Thumbnai
 
 ThumbsDbInfo ThumbnailCreator::loadThumbsDbInfo(const ThumbnailInfo& info) const
 {
-    ThumbsDbAccess access;
-    ThumbsDbInfo   dbInfo;
+    ThumbsDbInfo dbInfo;
 
     // Custom identifier takes precedence
     if (!info.customIdentifier.isEmpty())
     {
+        ThumbsDbAccess access;
         dbInfo = access.db()->findByCustomIdentifier(info.customIdentifier);
     }
     else
     {
-        if (!info.uniqueHash.isEmpty())
+        Private* const p    = d->prefetchOwner;
+        bool prefetchedHash = false;
+        bool prefetchedPath = false;
+
         {
+            QMutexLocker lock(&p->prefetchMutex);
+            const QPair<QString, qlonglong> key(info.uniqueHash, info.fileSize);
+
+            if (!info.uniqueHash.isEmpty() && p->prefetchedByHash.contains(key))
+            {
+                const Private::PrefetchedEntry entry = p->prefetchedByHash.take(key);
+
+                if (p->isFresh(entry))
+                {
+                    dbInfo         = entry.first;
+                    prefetchedHash = true;
+                }
+            }
+
+            if (dbInfo.data.isNull() && (prefetchedHash || info.uniqueHash.isEmpty()) &&
+                p->prefetchedByPath.contains(info.filePath))
+            {
+                const Private::PrefetchedEntry entry = p->prefetchedByPath.take(info.filePath);
+
+                if (p->isFresh(entry))
+                {
+                    dbInfo         = entry.first;
+                    prefetchedPath = true;
+                }
+            }
+        }
+
+        if (!info.uniqueHash.isEmpty() && !prefetchedHash)
+        {
+            ThumbsDbAccess access;
             dbInfo = access.db()->findByHash(info.uniqueHash, info.fileSize);
         }
 
-        if (dbInfo.data.isNull() && !info.filePath.isEmpty())
+        if (dbInfo.data.isNull() && !info.filePath.isEmpty() && !prefetchedPath)
         {
+            ThumbsDbAccess access;
             dbInfo = access.db()->findByFilePath(info.filePath, info.uniqueHash);
         }
     }
@@ -894,6 +961,154 @@ ThumbsDbInfo ThumbnailCreator::loadThumbsDbInfo(const ThumbnailInfo& info) const
     return dbInfo;
 }
 
+void ThumbnailCreator::prefetch(const QList<ThumbnailIdentifier>& identifiers) const
+{
+    if (d->thumbnailStorage != ThumbnailDatabase)
+    {
+        return;
+    }
+
+    Private* const p = d->prefetchOwner;
+    QMutexLocker lock(&p->prefetchMutex);
+    p->prefetchQueue << identifiers;
+}
+
+void ThumbnailCreator::cancelPrefetch() const
+{
+    Private* const p = d->prefetchOwner;
+    QMutexLocker lock(&p->prefetchMutex);
+    p->prefetchQueue.clear();
+    p->prefetchedByHash.clear();
+    p->prefetchedByPath.clear();
+}
+
+void ThumbnailCreator::sharePrefetch(const ThumbnailCreator& other)
+{
+    d->prefetchOwner = other.d->prefetchOwner;
+}
+
+void ThumbnailCreator::resolvePrefetch() const
+{
+    Private* const p = d->prefetchOwner;
+    QList<ThumbnailIdentifier> identifiers;
+
+    {
+        QMutexLocker lock(&p->prefetchMutex);
+        identifiers.swap(p->prefetchQueue);
+    }
+
+    if (identifiers.isEmpty())
+    {
+        return;
+    }
+
+    QList<ThumbnailInfo>               infos;
+    QList<QPair<QString, qlonglong> >  hashes;
+
+    foreach(const ThumbnailIdentifier& identifier, identifiers)
+    {
+        ThumbnailInfo info = makeThumbnailInfo(identifier, QRect());
+
+        // Thumbnails in the packs are served without the database
+        if (!loadFromPack(info).isNull())
+        {
+            continue;
+        }
+
+        if (!info.uniqueHash.isEmpty())
+        {
+            hashes << qMakePair(info.uniqueHash, info.fileSize);
+        }
+
+        infos << info;
+    }
+
+    if (infos.isEmpty())
+    {
+        return;
+    }
+
+    QHash<QPair<QString, qlonglong>, ThumbsDbInfo> byHash;
+    QHash<QString, ThumbsDbInfo>                   byPath;
+    QHash<QString, QString>                        paths;
+
+    {
+        ThumbsDbAccess access;
+
+        if (!hashes.isEmpty())
+        {
+            byHash = access.db()->findByHashes(hashes);
+        }
+
+        foreach(const ThumbnailInfo& info, infos)
+        {
+            // as in loadThumbsDbInfo(), fall back to the file path
+            if (!info.filePath.isEmpty() &&
+                (info.uniqueHash.isEmpty() || !byHash.contains(qMakePair(info.uniqueHash, info.fileSize))))
+            {
+                paths.insert(info.filePath, info.uniqueHash);
+            }
+        }
+
+        if (!paths.isEmpty())
+        {
+            byPath = access.db()->findByFilePaths(paths);
+        }
+    }
+
+    QMutexLocker lock(&p->prefetchMutex);
+
+    // Entries of previous groups which were not taken in time will never be used
+
+    for (QHash<QPair<QString, qlonglong>, Private::PrefetchedEntry>::iterator it = p->prefetchedByHash.begin() ;
+         it != p->prefetchedByHash.end() ; )
+    {
+        if (p->isFresh(it.value()))
+        {
+            ++it;
+        }
+        else
+        {
+            it = p->prefetchedByHash.erase(it);
+        }
+    }
+
+    for (QHash<QString, Private::PrefetchedEntry>::iterator it = p->prefetchedByPath.begin() ;
+         it != p->prefetchedByPath.end() ; )
+    {
+        if (p->isFresh(it.value()))
+        {
+            ++it;
+        }
+        else
+        {
+            it = p->prefetchedByPath.erase(it);
+        }
+    }
+
+    if (p->prefetchedByHash.size() + p->prefetchedByPath.size() > Private::MaxPrefetched)
+    {
+        p->prefetchedByHash.clear();
+        p->prefetchedByPath.clear();
+    }
+
+    const qint64 now = p->prefetchClock.elapsed();
+
+    foreach(const ThumbnailInfo& info, infos)
+    {
+        if (!info.uniqueHash.isEmpty())
+        {
+            const QPair<QString, qlonglong> key(info.uniqueHash, info.fileSize);
+            p->prefetchedByHash.insert(key, qMakePair(byHash.value(key), now));
+        }
+
+        if (paths.contains(info.filePath))
+        {
+            p->prefetchedByPath.insert(info.filePath, qMakePair(byPath.value(info.filePath), now));
+        }
+    }
+}
+
 bool ThumbnailCreator::isInDatabase(const ThumbnailInfo& info) const
 {
     ThumbsDbInfo dbInfo = loadThumbsDbInfo(info);
@@ -974,26 +1189,69 @@ ThumbnailImage ThumbnailCreator::loadFromDatabase(const ThumbnailInfo& info) con
         }
     }
 
+    image.exifOrientation = storedOrientation(info, dbInfo.orientationHint);
+
+    return image;
+}
+
+int ThumbnailCreator::storedOrientation(const ThumbnailInfo& info, int storedHint) const
+{
     // Give priority to main database's rotation flag
     // NOTE: Breaks rotation of RAWs which do not contain JPEG previews
-    image.exifOrientation = info.orientationHint;
+    int orientation = info.orientationHint;
 
-    if (image.exifOrientation == DMetadata::ORIENTATION_UNSPECIFIED &&
+    if (orientation == DMetadata::ORIENTATION_UNSPECIFIED &&
         !info.filePath.isEmpty() && LoadSaveThread::infoProvider())
     {
-        image.exifOrientation = LoadSaveThread::infoProvider()->orientationHint(info.filePath);
+        orientation = LoadSaveThread::infoProvider()->orientationHint(info.filePath);
+    }
+
+    if (orientation == DMetadata::ORIENTATION_UNSPECIFIED)
+    {
+        orientation = storedHint;
     }
 
-    if (image.exifOrientation == DMetadata::ORIENTATION_UNSPECIFIED)
+    return orientation;
+}
+
+ThumbnailImage ThumbnailCreator::loadFromPack(const ThumbnailInfo& info) const
+{
+    // Only thumbnails identified by content are cached in the packs
+    if (info.uniqueHash.isEmpty() || !info.customIdentifier.isEmpty())
+    {
+        return ThumbnailImage();
+    }
+
+    ThumbnailImage image;
+    int storedHint = DMetadata::ORIENTATION_UNSPECIFIED;
+    image.qimage   = ThumbnailPackStore::instance()->find(d->packLocation(), info.uniqueHash, info.fileSize,
+                                                          d->storageSize(), info.modificationDate, &storedHint);
+
+    if (!image.isNull())
     {
-        image.exifOrientation = dbInfo.orientationHint;
+        image.exifOrientation = storedOrientation(info, storedHint);
     }
 
     return image;
 }
 
+void ThumbnailCreator::storeInPack(const ThumbnailInfo& info, const ThumbnailImage& image) const
+{
+    if (info.uniqueHash.isEmpty() || !info.customIdentifier.isEmpty())
+    {
+        return;
+    }
+
+    // Thumbnails from the database may be larger than the size bucket of the pack
+    ThumbnailPackStore::instance()->insert(d->packLocation(), info.uniqueHash, info.fileSize, d->storageSize(),
+                                           info.modificationDate, image.exifOrientation,
+                                           scaleForStorage(image.qimage));
+}
+
 void ThumbnailCreator::deleteFromDatabase(const ThumbnailInfo& info) const
 {
+    ThumbnailPackStore::instance()->remove(d->packLocation(), info.uniqueHash, info.fileSize);
+
     ThumbsDbAccess access;
     BdEngineBackend::QueryState lastQueryState=BdEngineBackend::ConnectionError;
 
@@ -88,6 +88,28 @@ public:
     void pregenerate(const ThumbnailIdentifier& identifier) const;
     void pregenerateDetail(const ThumbnailIdentifier& identifier, const QRect& detailRect) const;
 
+    /**
+     * Announces a group of thumbnails which are about to be loaded.
+     * With the thumbnail database, the next call to load() looks up the entries of the whole
+     * group with a few set-based queries, and the following calls take them from there
+     * instead of querying the database for each thumbnail. Can be called from any thread.
+     */
+    void prefetch(const QList<ThumbnailIdentifier>& identifiers) const;
+
+    /**
+     * Drops the announced groups and the database entries looked up for them,
+     * when their loading is cancelled. Entries not taken are also dropped after
+     * a few seconds, as the database may have changed meanwhile.
+     */
+    void cancelPrefetch() const;
+
+    /**
+     * Makes this creator take the database entries of the groups announced
+     * to the given creator, which must outlive this one. Used to share one
+     * grouped lookup among the creators of several worker threads.
+     */
+    void sharePrefetch(const ThumbnailCreator& other);
+
     /**
      * Sets the thumbnail size. This is the maximum size of the QImage
      * returned by load.
@@ -195,9 +217,14 @@ private:
 
     void storeInDatabase(const ThumbnailInfo& info, const ThumbnailImage& image) const;
     ThumbsDbInfo loadThumbsDbInfo(const ThumbnailInfo& info) const;
+    void resolvePrefetch() const;
     ThumbnailImage loadFromDatabase(const ThumbnailInfo& info) const;
     bool isInDatabase(const ThumbnailInfo& info) const;
     void deleteFromDatabase(const ThumbnailInfo& info) const;
+    int  storedOrientation(const ThumbnailInfo& info, int storedHint) const;
+
+    ThumbnailImage loadFromPack(const ThumbnailInfo& info) const;
+    void storeInPack(const ThumbnailInfo& info, const ThumbnailImage& image) const;
 
     void storeFreedesktop(const ThumbnailInfo& info, const ThumbnailImage& image) const;
     ThumbnailImage loadFreedesktop(const ThumbnailInfo& info) const;
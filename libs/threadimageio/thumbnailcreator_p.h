@@ -26,9 +26,18 @@
 #ifndef DIGIKAMTHUMBNAILCREATORPRIV_H
 #define DIGIKAMTHUMBNAILCREATORPRIV_H
 
+// Qt includes
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+
 // Local includes
 
 #include "dmetadata.h"
+#include "thumbsdb.h"
 
 namespace Digikam
 {
@@ -75,6 +84,9 @@ public:
         // Used internaly as PNG metadata. Do not use i18n.
         digiKamFingerPrint                        = QLatin1String("Digikam Thumbnail Generator");
 
+        prefetchOwner                             = this;
+        prefetchClock.start();
+
         fastRawSettings.optimizeTimeLoading();
         fastRawSettings.rawPrm.halfSizeColorImage = true;
         fastRawSettings.rawPrm.sixteenBitsImage   = false;
@@ -100,9 +112,38 @@ public:
     DRawDecoding                    rawSettings;
     DRawDecoding                    fastRawSettings;
 
+    /// A database entry looked up for a prefetched identifier, with the time of the lookup on prefetchClock.
+    /// A null entry records that there is no thumbnail in the database.
+    typedef QPair<ThumbsDbInfo, qint64> PrefetchedEntry;
+
+    /// Identifiers announced by prefetch(), and the database entries looked up for them.
+    QMutex                                            prefetchMutex;
+    QList<ThumbnailIdentifier>                        prefetchQueue;
+    QHash<QPair<QString, qlonglong>, PrefetchedEntry> prefetchedByHash;
+    QHash<QString, PrefetchedEntry>                   prefetchedByPath;
+    QElapsedTimer                                     prefetchClock;
+
+    /// The Private holding the prefetch members above which are in use, this or one shared from another creator
+    Private*                                          prefetchOwner;
+
+public:
+
+    enum
+    {
+        /// Entries not taken when a new group is looked up are dropped above this number
+        MaxPrefetched    = 1000,
+
+        /// Entries older than this, in ms, are not used: the database may have changed meanwhile
+        PrefetchLifetime = 5000
+    };
+
 public:
 
     int                             storageSize() const;
+    QString                         packLocation() const;
+
+    /// True if the entry was looked up recently enough to be used. Call with prefetchMutex locked.
+    bool                            isFresh(const PrefetchedEntry& entry) const;
 };
 
 }  // namespace Digikam
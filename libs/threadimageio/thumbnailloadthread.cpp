@@ -35,6 +35,10 @@
 #include <QIcon>
 #include <QMimeType>
 #include <QMimeDatabase>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 // KDE includes
 
@@ -121,6 +125,7 @@ public:
         sendSurrogate      = true;
         notifiedForResults = false;
         creator            = 0;
+        workersStopped     = false;
 
 #ifdef HAVE_MEDIAPLAYER
         videoThumbs        = 0;
@@ -147,19 +152,77 @@ public:
 
     QList<LoadingDescription>          lastDescriptions;
 
+    /// The decode workers run the tasks next in the queue, each with one of the idle creators.
+    /// workerKeys are the cache keys handed to the workers and not yet finished,
+    /// workerTasks the tasks the workers are running right now,
+    /// currentKey is the cache key of the task run by the thread itself.
+    QThreadPool                        workerPool;
+    QMutex                             workerMutex;
+    QWaitCondition                     workerCondVar;
+    QSet<QString>                      workerKeys;
+    QList<ThumbnailLoadingTask*>       workerTasks;
+    QString                            currentKey;
+    QList<ThumbnailCreator*>           idleCreators;
+    bool                               workersStopped;
+
 public:
 
+    ThumbnailCreator*         createCreator() const;
+
     LoadingDescription        createLoadingDescription(const ThumbnailIdentifier& identifier, int size, bool setLastDescription = true);
     LoadingDescription        createLoadingDescription(const ThumbnailIdentifier& identifier, int size,
                                                        const QRect& detailRect, bool setLastDescription = true);
     bool                      checkDescription(const LoadingDescription& description);
     QList<LoadingDescription> makeDescriptions(const QList<ThumbnailIdentifier>& identifiers, int size);
     QList<LoadingDescription> makeDescriptions(const QList<QPair<ThumbnailIdentifier, QRect> >& idsAndRects, int size);
+    void                      prefetch(const QList<LoadingDescription>& descriptions);
+    void                      stopWorkerTasks(const QList<LoadingDescription>& keep = QList<LoadingDescription>());
     bool                      hasHighlightingBorder() const;
     int                       pixmapSizeForThumbnailSize(int thumbnailSize) const;
     int                       thumbnailSizeForPixmapSize(int pixmapSize) const;
 };
 
+ThumbnailCreator* ThumbnailLoadThread::Private::createCreator() const
+{
+    ThumbnailCreator* const workerCreator = new ThumbnailCreator(static_d->storageMethod);
+
+    if (static_d->provider)
+    {
+        workerCreator->setThumbnailInfoProvider(static_d->provider);
+    }
+
+    workerCreator->setOnlyLargeThumbnails(true);
+    workerCreator->setRemoveAlphaChannel(true);
+    workerCreator->sharePrefetch(*creator);
+
+    return workerCreator;
+}
+
+// -------------------------------------------------------------------
+
+class ThumbnailDecodeWorker : public QRunnable
+{
+public:
+
+    ThumbnailDecodeWorker(ThumbnailLoadThread* const thread, const LoadingDescription& description)
+        : m_thread(thread),
+          m_description(description)
+    {
+    }
+
+    virtual void run()
+    {
+        m_thread->runDecodeWorker(m_description);
+    }
+
+private:
+
+    ThumbnailLoadThread* const m_thread;
+    const LoadingDescription   m_description;
+};
+
+// -------------------------------------------------------------------
+
 Q_GLOBAL_STATIC(ThumbnailLoadThread, defaultIconViewObject)
 Q_GLOBAL_STATIC(ThumbnailLoadThread, defaultObject)
 Q_GLOBAL_STATIC(ThumbnailLoadThread, defaultThumbBarObject)
@@ -179,6 +242,9 @@ ThumbnailLoadThread::ThumbnailLoadThread(QObject* const parent)
     d->creator->setOnlyLargeThumbnails(true);
     d->creator->setRemoveAlphaChannel(true);
 
+    // The thread itself keeps running the tasks in order, the workers create the next ones meanwhile
+    d->workerPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+
     connect(this, SIGNAL(thumbnailsAvailable()),
             this, SLOT(slotThumbnailsAvailable()));
 
@@ -201,12 +267,20 @@ ThumbnailLoadThread::ThumbnailLoadThread(QObject* const parent)
 
 ThumbnailLoadThread::~ThumbnailLoadThread()
 {
+    {
+        QMutexLocker lock(&d->workerMutex);
+        d->workersStopped = true;
+    }
+
+    d->stopWorkerTasks();
     shutDown();
+    d->workerPool.waitForDone();
 
 #ifdef HAVE_MEDIAPLAYER
     delete d->videoThumbs;
 #endif
 
+    qDeleteAll(d->idleCreators);
     delete d->creator;
     delete d;
 }
@@ -311,6 +385,127 @@ ThumbnailCreator* ThumbnailLoadThread::thumbnailCreator() const
     return d->creator;
 }
 
+void ThumbnailLoadThread::stopAllTasks()
+{
+    ManagedLoadSaveThread::stopAllTasks();
+    d->stopWorkerTasks();
+    d->creator->cancelPrefetch();
+}
+
+void ThumbnailLoadThread::startDecodeWorkers(const LoadingDescription& current)
+{
+    const QString currentKey = current.cacheKey();
+
+    {
+        QMutexLocker workerLock(&d->workerMutex);
+        d->currentKey = currentKey;
+    }
+
+    dispatchDecodeWorkers();
+
+    if (current.previewParameters.onlyPregenerate())
+    {
+        // Loading is shared in the LoadingCache, but pregenerating is not:
+        // do not create the same thumbnail in the database twice.
+        QMutexLocker workerLock(&d->workerMutex);
+
+        while (d->workerKeys.contains(currentKey))
+        {
+            d->workerCondVar.wait(&d->workerMutex);
+        }
+    }
+}
+
+void ThumbnailLoadThread::dispatchDecodeWorkers()
+{
+    QList<LoadingDescription> descriptions;
+
+    {
+        QMutexLocker lock(threadMutex());
+        QMutexLocker workerLock(&d->workerMutex);
+
+        if (d->workersStopped)
+        {
+            return;
+        }
+
+        // Take the next tasks in the order of the queue, which keeps visible items first
+        for (int i = 0 ; i < m_todo.size() && d->workerKeys.size() < d->workerPool.maxThreadCount() ; ++i)
+        {
+            ThumbnailLoadingTask* const task = dynamic_cast<ThumbnailLoadingTask*>(m_todo.at(i));
+
+            if (!task || task->status() == LoadingTask::LoadingTaskStatusStopping)
+            {
+                continue;
+            }
+
+            const QString key = task->loadingDescription().cacheKey();
+
+            if (key == d->currentKey || d->workerKeys.contains(key))
+            {
+                continue;
+            }
+
+            d->workerKeys << key;
+            descriptions  << task->loadingDescription();
+        }
+    }
+
+    foreach(const LoadingDescription& description, descriptions)
+    {
+        d->workerPool.start(new ThumbnailDecodeWorker(this, description));
+    }
+}
+
+void ThumbnailLoadThread::runDecodeWorker(const LoadingDescription& description)
+{
+    ThumbnailCreator* workerCreator = 0;
+
+    {
+        QMutexLocker lock(&d->workerMutex);
+
+        if (!d->idleCreators.isEmpty())
+        {
+            workerCreator = d->idleCreators.takeLast();
+        }
+    }
+
+    if (!workerCreator)
+    {
+        workerCreator = d->createCreator();
+    }
+
+    {
+        ThumbnailLoadingTask task(this, description, workerCreator);
+
+        {
+            QMutexLocker lock(&d->workerMutex);
+
+            if (d->workersStopped)
+            {
+                task.setStatus(LoadingTask::LoadingTaskStatusStopping);
+            }
+
+            d->workerTasks << &task;
+        }
+
+        task.execute();
+
+        QMutexLocker lock(&d->workerMutex);
+        d->workerTasks.removeOne(&task);
+    }
+
+    {
+        QMutexLocker lock(&d->workerMutex);
+        d->idleCreators << workerCreator;
+        d->workerKeys.remove(description.cacheKey());
+        d->workerCondVar.wakeAll();
+    }
+
+    // continue with the next queued task, unless the queue is empty or the thread is stopped meanwhile
+    dispatchDecodeWorkers();
+}
+
 int ThumbnailLoadThread::thumbnailToPixmapSize(int size) const
 {
     return d->pixmapSizeForThumbnailSize(size);
@@ -462,6 +657,41 @@ QList<LoadingDescription> ThumbnailLoadThread::Private::makeDescriptions(const Q
     return descriptions;
 }
 
+void ThumbnailLoadThread::Private::prefetch(const QList<LoadingDescription>& descriptions)
+{
+    // The tasks of the group find their database entries looked up together
+    QList<ThumbnailIdentifier> identifiers;
+
+    foreach(const LoadingDescription& description, descriptions)
+    {
+        identifiers << description.thumbnailIdentifier();
+    }
+
+    creator->prefetch(identifiers);
+}
+
+void ThumbnailLoadThread::Private::stopWorkerTasks(const QList<LoadingDescription>& keep)
+{
+    // The tasks in the queue are not touched: a stopped worker only gives up creating
+    // a thumbnail ahead, the task of the thread still creates it when it comes to it.
+    QSet<QString> keepKeys;
+
+    foreach(const LoadingDescription& description, keep)
+    {
+        keepKeys << description.cacheKey();
+    }
+
+    QMutexLocker lock(&workerMutex);
+
+    foreach(ThumbnailLoadingTask* const task, workerTasks)
+    {
+        if (!keepKeys.contains(task->loadingDescription().cacheKey()))
+        {
+            task->setStatus(LoadingTask::LoadingTaskStatusStopping);
+        }
+    }
+}
+
 QList<LoadingDescription> ThumbnailLoadThread::Private::makeDescriptions(const QList<QPair<ThumbnailIdentifier, QRect> >& identifiersAndRects, int size)
 {
     QList<LoadingDescription> descriptions;
@@ -577,7 +807,11 @@ void ThumbnailLoadThread::findGroup(QList<ThumbnailIdentifier>& identifiers, int
     }
 
     QList<LoadingDescription> descriptions = d->makeDescriptions(identifiers, size);
+    d->prefetch(descriptions);
     ManagedLoadSaveThread::prependThumbnailGroup(descriptions);
+
+    // The new group replaces the previous one: the workers shall get to it without delay
+    d->stopWorkerTasks(descriptions);
 }
 
 // --- Detail thumbnails ---
@@ -616,6 +850,9 @@ void ThumbnailLoadThread::findGroup(const QList<QPair<ThumbnailIdentifier, QRect
 
     QList<LoadingDescription> descriptions = d->makeDescriptions(idsAndRects, size);
     ManagedLoadSaveThread::prependThumbnailGroup(descriptions);
+
+    // The new group replaces the previous one: the workers shall get to it without delay
+    d->stopWorkerTasks(descriptions);
 }
 
 // --- Preloading ---
@@ -648,6 +885,7 @@ void ThumbnailLoadThread::preloadGroup(QList<ThumbnailIdentifier>& identifiers,
     }
 
     QList<LoadingDescription> descriptions = d->makeDescriptions(identifiers, size);
+    d->prefetch(descriptions);
     ManagedLoadSaveThread::preloadThumbnailGroup(descriptions);
 }
 
@@ -229,6 +229,11 @@ public:
      */
     static void deleteThumbnail(const QString& filePath);
 
+    /**
+     * Stops all tasks, and drops the database entries looked up for the groups announced so far.
+     */
+    virtual void stopAllTasks();
+
 Q_SIGNALS:
 
     // See LoadSaveThread for a QImage-based thumbnailLoaded() signal.
@@ -251,6 +256,18 @@ private:
     bool checkSize(int size);
     QPixmap surrogatePixmap(const LoadingDescription& loadingDescription);
 
+    /**
+     * Called by the thread when starting the task for current: hands the next queued tasks
+     * to the decode workers, up to the size of their pool. If a worker is pregenerating
+     * the same thumbnail as current, waits until it has finished.
+     */
+    void startDecodeWorkers(const LoadingDescription& current);
+    void dispatchDecodeWorkers();
+    void runDecodeWorker(const LoadingDescription& description);
+
+    friend class ThumbnailLoadingTask;
+    friend class ThumbnailDecodeWorker;
+
 Q_SIGNALS:
 
     // For internal use
@@ -0,0 +1,835 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : memory-mapped pack files of decoded thumbnails
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "thumbnailpackstore.h"
+
+// C++ includes
+
+#include <cstring>
+#include <limits>
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QLockFile>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+// Local includes
+
+#include "digikam_debug.h"
+
+namespace Digikam
+{
+
+/**
+ * Layout of a pack file: a 16 bytes file header, followed by records.
+ * Each record is a RecordHeader, the key, and the pixel data, each part
+ * starting at a 16 bytes boundary. The header of a record is written last,
+ * so that a pack truncated by a crash ends at the last complete record.
+ * Packs grow in steps of zero-filled space, which ends the scan.
+ * Pack files are a local cache and use native byte order.
+ *
+ * The mappings are only read. All data is written with checked file writes,
+ * so that a full disk fails a write instead of faulting on a mapped page.
+ * The writer of a pack holds a lock file next to it; a pack whose lock can
+ * be taken is not written by any running process, it can be continued or pruned.
+ *
+ * Each image handed out holds a reference to the file of its pack, so that the
+ * mapping stays valid as long as the image exists, even if the pack was pruned.
+ */
+class ThumbnailPackStore::Private
+{
+public:
+
+    enum
+    {
+        PackHeaderSize  = 16,
+        RecordMagic     = 0x44545052,           // "DTPR"
+        MaxPackSize     = 128 * 1024 * 1024,
+        GrowSize        = 32 * 1024 * 1024,
+        MaxPackCount    = 16,
+        RefreshInterval = 2000                  // ms
+    };
+
+    struct RecordHeader
+    {
+        quint32 magic;
+        quint32 recordSize;
+        qint64  modificationDate;
+        qint32  orientationHint;
+        qint32  width;                          // 0 for a record removing the entry
+        qint32  height;
+        qint32  bytesPerLine;
+        qint32  format;
+        quint32 keyLength;
+    };
+
+    class Pack
+    {
+    public:
+
+        Pack()
+          : data(0),
+            size(0),
+            end(PackHeaderSize)
+        {
+        }
+
+        QSharedPointer<QFile> file;             // unmapped when the last image of the pack is gone
+        uchar*                data;
+        qint64                size;             // mapped size
+        qint64                end;              // end of the last scanned record
+    };
+
+    class Location
+    {
+    public:
+
+        Location()
+          : pack(-1),
+            offset(0)
+        {
+        }
+
+        Location(int pack, qint64 offset)
+          : pack(pack),
+            offset(offset)
+        {
+        }
+
+        int    pack;
+        qint64 offset;
+    };
+
+public:
+
+    Private()
+        : writePack(-1),
+          appendOffset(0),
+          writeFile(0),
+          writeLock(0),
+          writeFailed(false)
+    {
+    }
+
+    ~Private()
+    {
+        close();
+    }
+
+    static QByteArray makeKey(const QString& uniqueHash, qlonglong fileSize, int storageSize);
+    static QByteArray keyPrefix(const QString& uniqueHash, qlonglong fileSize);
+    static qint64     timeStamp(const QDateTime& date);
+    static qint64     aligned(qint64 size);
+    static QLockFile* lockPack(const QString& filePath);
+    static void       releasePackFile(void* info);
+
+    void ensureOpen(const QString& path);
+    void open(const QString& path);
+    void close();
+    void refresh();
+    bool addPack(const QString& filePath);
+    void dropOldestPacks(int count);
+    void removePack(int index);
+    bool remapPack(int index);
+    void scanPack(int index);
+    bool takeWritePack(int index, QLockFile* const lock, qint64 recordSize);
+    void releaseWritePack();
+    bool growWritePack(qint64 size);
+    bool prepareWritePack(qint64 recordSize);
+    bool writeAt(qint64 offset, const char* const data, qint64 size);
+    void append(const QByteArray& key, qint64 modificationDate, int orientationHint, const QImage* const image);
+
+public:
+
+    static const char           packMagic[PackHeaderSize + 1];
+
+    QReadWriteLock              lock;
+    QString                     location;
+    QList<Pack>                 packs;
+    QHash<QByteArray, Location> index;
+    QElapsedTimer               refreshTimer;
+
+    /// The pack this process appends to, opened for writing and locked
+    int                         writePack;
+    qint64                      appendOffset;
+    QFile*                      writeFile;
+    QLockFile*                  writeLock;
+
+    /// Set after a failed write, typically a full disk. Nothing more is written to this location.
+    bool                        writeFailed;
+};
+
+const char ThumbnailPackStore::Private::packMagic[PackHeaderSize + 1] = "digiKamThumbPk01";
+
+QByteArray ThumbnailPackStore::Private::makeKey(const QString& uniqueHash, qlonglong fileSize, int storageSize)
+{
+    return keyPrefix(uniqueHash, fileSize) + QByteArray::number(storageSize);
+}
+
+QByteArray ThumbnailPackStore::Private::keyPrefix(const QString& uniqueHash, qlonglong fileSize)
+{
+    return uniqueHash.toLatin1() + '-' + QByteArray::number(fileSize) + '-';
+}
+
+qint64 ThumbnailPackStore::Private::timeStamp(const QDateTime& date)
+{
+    // An invalid date sorts before any valid one, as with QDateTime
+    return date.isValid() ? date.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+qint64 ThumbnailPackStore::Private::aligned(qint64 size)
+{
+    return ((size + 15) & ~qint64(15));
+}
+
+QLockFile* ThumbnailPackStore::Private::lockPack(const QString& filePath)
+{
+    QLockFile* const lock = new QLockFile(filePath + QLatin1String(".lock"));
+
+    // Never stale by age: the lock is only given up when its process is gone
+    lock->setStaleLockTime(0);
+
+    if (!lock->tryLock(0))
+    {
+        delete lock;
+        return 0;
+    }
+
+    return lock;
+}
+
+void ThumbnailPackStore::Private::releasePackFile(void* info)
+{
+    delete static_cast<QSharedPointer<QFile>*>(info);
+}
+
+void ThumbnailPackStore::Private::ensureOpen(const QString& path)
+{
+    {
+        QReadLocker locker(&lock);
+
+        if (location == path && !refreshTimer.hasExpired(RefreshInterval))
+        {
+            return;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+
+    if (location != path)
+    {
+        open(path);
+    }
+    else if (refreshTimer.hasExpired(RefreshInterval))
+    {
+        refresh();
+    }
+}
+
+void ThumbnailPackStore::Private::open(const QString& path)
+{
+    close();
+    location    = path;
+    writeFailed = false;
+    refreshTimer.start();
+
+    QDir dir(path);
+
+    if (!dir.mkpath(QLatin1String(".")))
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot create thumbnail pack directory" << path;
+        return;
+    }
+
+    foreach(const QString& name, dir.entryList(QStringList() << QLatin1String("*.pack"), QDir::Files, QDir::Name))
+    {
+        addPack(dir.filePath(name));
+    }
+
+    dropOldestPacks(MaxPackCount);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Thumbnail packs:" << packs.size() << "files," << index.size() << "thumbnails";
+}
+
+void ThumbnailPackStore::Private::close()
+{
+    releaseWritePack();
+
+    // The files stay mapped as long as images handed out reference them
+    packs.clear();
+    index.clear();
+    location.clear();
+}
+
+void ThumbnailPackStore::Private::refresh()
+{
+    refreshTimer.start();
+
+    // Pick up what other processes appended, including their removals, and their new packs
+
+    QSet<QString> known;
+
+    for (int i = 0 ; i < packs.size() ; ++i)
+    {
+        known << packs.at(i).file->fileName();
+
+        // Records are also appended in space which is already mapped
+
+        if (i != writePack)
+        {
+            remapPack(i);
+            scanPack(i);
+        }
+    }
+
+    QDir dir(location);
+
+    foreach(const QString& name, dir.entryList(QStringList() << QLatin1String("*.pack"), QDir::Files, QDir::Name))
+    {
+        const QString filePath = dir.filePath(name);
+
+        if (!known.contains(filePath))
+        {
+            addPack(filePath);
+        }
+    }
+}
+
+bool ThumbnailPackStore::Private::addPack(const QString& filePath)
+{
+    QSharedPointer<QFile> file(new QFile(filePath));
+    Pack pack;
+
+    if (file->open(QIODevice::ReadOnly))
+    {
+        pack.size = file->size();
+        pack.data = file->map(0, pack.size);
+    }
+
+    if (!pack.data || pack.size < PackHeaderSize || memcmp(pack.data, packMagic, PackHeaderSize) != 0)
+    {
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Ignoring invalid thumbnail pack" << filePath;
+        return false;
+    }
+
+    pack.file = file;
+    packs << pack;
+    scanPack(packs.size() - 1);
+
+    return true;
+}
+
+void ThumbnailPackStore::Private::dropOldestPacks(int count)
+{
+    // Pack names sort chronologically. Drop the oldest ones, their thumbnails are still in the database.
+    // A pack still written by a running process is kept.
+
+    QStringList names;
+
+    foreach(const Pack& pack, packs)
+    {
+        names << pack.file->fileName();
+    }
+
+    names.sort();
+
+    foreach(const QString& filePath, names)
+    {
+        if (packs.size() <= count)
+        {
+            break;
+        }
+
+        int i = 0;
+
+        while (packs.at(i).file->fileName() != filePath)
+        {
+            ++i;
+        }
+
+        if (i == writePack)
+        {
+            continue;
+        }
+
+        QLockFile* const lock = lockPack(filePath);
+
+        if (!lock)
+        {
+            continue;
+        }
+
+        if (QFile::remove(filePath))
+        {
+            removePack(i);
+        }
+
+        lock->unlock();
+        delete lock;
+    }
+}
+
+void ThumbnailPackStore::Private::removePack(int i)
+{
+    QHash<QByteArray, Location>::iterator it = index.begin();
+
+    while (it != index.end())
+    {
+        if (it->pack == i)
+        {
+            it = index.erase(it);
+            continue;
+        }
+
+        if (it->pack > i)
+        {
+            --it->pack;
+        }
+
+        ++it;
+    }
+
+    if (writePack > i)
+    {
+        --writePack;
+    }
+
+    packs.removeAt(i);
+}
+
+bool ThumbnailPackStore::Private::remapPack(int i)
+{
+    Pack& pack        = packs[i];
+    const qint64 size = pack.file->size();
+
+    if (size <= pack.size)
+    {
+        return false;
+    }
+
+    // The previous mapping is kept by the file: images handed out may still reference it
+
+    uchar* const data = pack.file->map(0, size);
+
+    if (!data)
+    {
+        return false;
+    }
+
+    pack.data = data;
+    pack.size = size;
+
+    return true;
+}
+
+void ThumbnailPackStore::Private::scanPack(int i)
+{
+    Pack& pack    = packs[i];
+    qint64 offset = pack.end;
+    RecordHeader header;
+
+    while (offset + (qint64)sizeof(RecordHeader) <= pack.size)
+    {
+        memcpy(&header, pack.data + offset, sizeof(RecordHeader));
+
+        const qint64 dataOffset = aligned(sizeof(RecordHeader) + header.keyLength);
+
+        if (header.magic != RecordMagic                                                        ||
+            header.recordSize % 16 || offset + header.recordSize > pack.size                   ||
+            header.width < 0 || header.height < 0 || header.bytesPerLine < 4 * header.width    ||
+            dataOffset + (qint64)header.bytesPerLine * header.height > header.recordSize)
+        {
+            // zero-filled tail, truncated record, or a record not yet completely written
+            break;
+        }
+
+        const QByteArray key((const char*)pack.data + offset + sizeof(RecordHeader), header.keyLength);
+
+        if (header.width == 0)
+        {
+            index.remove(key);
+        }
+        else
+        {
+            index.insert(key, Location(i, offset));
+        }
+
+        offset += header.recordSize;
+    }
+
+    pack.end = offset;
+}
+
+bool ThumbnailPackStore::Private::takeWritePack(int i, QLockFile* const lock, qint64 recordSize)
+{
+    QFile* const file = new QFile(packs.at(i).file->fileName());
+
+    if (!file->open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+    {
+        delete file;
+        lock->unlock();
+        delete lock;
+        return false;
+    }
+
+    writePack = i;
+    writeFile = file;
+    writeLock = lock;
+
+    // Records appended by the previous writer since the last scan
+
+    remapPack(i);
+    scanPack(i);
+    appendOffset = packs.at(i).end;
+
+    if (appendOffset + recordSize > MaxPackSize || !growWritePack(appendOffset + recordSize))
+    {
+        releaseWritePack();
+        return false;
+    }
+
+    return true;
+}
+
+void ThumbnailPackStore::Private::releaseWritePack()
+{
+    delete writeFile;
+    writeFile = 0;
+
+    if (writeLock)
+    {
+        writeLock->unlock();
+        delete writeLock;
+        writeLock = 0;
+    }
+
+    writePack    = -1;
+    appendOffset = 0;
+}
+
+bool ThumbnailPackStore::Private::growWritePack(qint64 size)
+{
+    if (size <= packs.at(writePack).size)
+    {
+        return true;
+    }
+
+    // Zeros are written, not only reserved by a resize: the space is allocated now,
+    // or the write fails. A sparse file could fault later on a mapped page.
+
+    const qint64 newSize = qMin((qint64)MaxPackSize, (size + GrowSize - 1) / GrowSize * GrowSize);
+    const QByteArray zeros(1024 * 1024, '\0');
+    qint64 fileSize      = writeFile->size();
+
+    while (fileSize < newSize)
+    {
+        const qint64 length = qMin((qint64)zeros.size(), newSize - fileSize);
+
+        if (!writeAt(fileSize, zeros.constData(), length))
+        {
+            return false;
+        }
+
+        fileSize += length;
+    }
+
+    return (remapPack(writePack) || packs.at(writePack).size >= size);
+}
+
+bool ThumbnailPackStore::Private::prepareWritePack(qint64 recordSize)
+{
+    if (writeFailed || recordSize > MaxPackSize - PackHeaderSize)
+    {
+        return false;
+    }
+
+    if (writePack != -1)
+    {
+        if (appendOffset + recordSize <= MaxPackSize)
+        {
+            return growWritePack(appendOffset + recordSize);
+        }
+
+        releaseWritePack();
+    }
+
+    // Continue the newest pack with some space left which is not written by a running process,
+    // typically the one of the previous session
+
+    for (int i = packs.size() - 1 ; i >= 0 ; --i)
+    {
+        if (packs.at(i).end + recordSize > MaxPackSize)
+        {
+            continue;
+        }
+
+        QLockFile* const lock = lockPack(packs.at(i).file->fileName());
+
+        if (lock && takeWritePack(i, lock, recordSize))
+        {
+            return true;
+        }
+    }
+
+    // Start a new pack, replacing the oldest one when there are too many
+
+    dropOldestPacks(MaxPackCount - 1);
+
+    const QString name     = QString::fromLatin1("%1-%2.pack")
+                             .arg(QDateTime::currentMSecsSinceEpoch(), 13, 10, QLatin1Char('0'))
+                             .arg(QCoreApplication::applicationPid());
+    const QString filePath = QDir(location).filePath(name);
+    QLockFile* const lock  = lockPack(filePath);
+
+    if (lock)
+    {
+        QFile file(filePath);
+        const bool created = (file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+                              file.write(packMagic, PackHeaderSize) == PackHeaderSize && file.flush());
+        file.close();
+
+        if (created && addPack(filePath))
+        {
+            // takeWritePack() releases the lock on failure
+            if (takeWritePack(packs.size() - 1, lock, recordSize))
+            {
+                return true;
+            }
+        }
+        else
+        {
+            lock->unlock();
+            delete lock;
+        }
+    }
+
+    qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot create thumbnail pack" << filePath;
+    writeFailed = true;
+
+    return false;
+}
+
+bool ThumbnailPackStore::Private::writeAt(qint64 offset, const char* const data, qint64 size)
+{
+    if (!writeFile->seek(offset) || writeFile->write(data, size) != size)
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write thumbnail pack" << writeFile->fileName()
+                                       << writeFile->errorString();
+        writeFailed = true;
+        return false;
+    }
+
+    return true;
+}
+
+void ThumbnailPackStore::Private::append(const QByteArray& key, qint64 modificationDate,
+                                         int orientationHint, const QImage* const image)
+{
+    const qint64  dataOffset = aligned(sizeof(RecordHeader) + key.size());
+    const qint64  dataSize   = image ? (qint64)image->bytesPerLine() * image->height() : 0;
+    const qint64  recordSize = aligned(dataOffset + dataSize);
+
+    if (!prepareWritePack(recordSize))
+    {
+        return;
+    }
+
+    RecordHeader header;
+    header.magic            = RecordMagic;
+    header.recordSize       = (quint32)recordSize;
+    header.modificationDate = modificationDate;
+    header.orientationHint  = orientationHint;
+    header.width            = image ? image->width()        : 0;
+    header.height           = image ? image->height()       : 0;
+    header.bytesPerLine     = image ? image->bytesPerLine() : 0;
+    header.format           = image ? image->format()       : QImage::Format_Invalid;
+    header.keyLength        = key.size();
+
+    if (!writeAt(appendOffset + sizeof(RecordHeader), key.constData(), key.size())                  ||
+        (image && !writeAt(appendOffset + dataOffset, (const char*)image->constBits(), dataSize))  ||
+        !writeAt(appendOffset, (const char*)&header, sizeof(RecordHeader)))
+    {
+        releaseWritePack();
+        return;
+    }
+
+    if (image)
+    {
+        index.insert(key, Location(writePack, appendOffset));
+    }
+    else
+    {
+        index.remove(key);
+    }
+
+    appendOffset         += recordSize;
+    packs[writePack].end  = appendOffset;
+}
+
+// -----------------------------------------------------------------------------------------------
+
+class ThumbnailPackStoreCreator
+{
+public:
+
+    ThumbnailPackStore object;
+};
+
+Q_GLOBAL_STATIC(ThumbnailPackStoreCreator, creator)
+
+// -----------------------------------------------------------------------------------------------
+
+ThumbnailPackStore* ThumbnailPackStore::instance()
+{
+    return &creator->object;
+}
+
+ThumbnailPackStore::ThumbnailPackStore()
+    : d(new Private)
+{
+}
+
+ThumbnailPackStore::~ThumbnailPackStore()
+{
+    delete d;
+}
+
+QImage ThumbnailPackStore::find(const QString& location, const QString& uniqueHash, qlonglong fileSize, int storageSize,
+                                const QDateTime& modificationDate, int* const orientationHint)
+{
+    if (location.isEmpty() || uniqueHash.isEmpty())
+    {
+        return QImage();
+    }
+
+    d->ensureOpen(location);
+
+    const QByteArray key = Private::makeKey(uniqueHash, fileSize, storageSize);
+    QReadLocker locker(&d->lock);
+
+    if (d->location != location)
+    {
+        return QImage();
+    }
+
+    QHash<QByteArray, Private::Location>::const_iterator it = d->index.constFind(key);
+
+    if (it == d->index.constEnd())
+    {
+        return QImage();
+    }
+
+    const uchar* const record = d->packs.at(it->pack).data + it->offset;
+    Private::RecordHeader header;
+    memcpy(&header, record, sizeof(Private::RecordHeader));
+
+    if (modificationDate.isValid() && header.modificationDate < Private::timeStamp(modificationDate))
+    {
+        return QImage();
+    }
+
+    if (header.format != QImage::Format_RGB32 && header.format != QImage::Format_ARGB32)
+    {
+        return QImage();
+    }
+
+    if (orientationHint)
+    {
+        *orientationHint = header.orientationHint;
+    }
+
+    // The image references the mapped pages, which stay mapped as long as the image exists.
+    return QImage(record + Private::aligned(sizeof(Private::RecordHeader) + header.keyLength),
+                  header.width, header.height, header.bytesPerLine, (QImage::Format)header.format,
+                  &Private::releasePackFile, new QSharedPointer<QFile>(d->packs.at(it->pack).file));
+}
+
+void ThumbnailPackStore::insert(const QString& location, const QString& uniqueHash, qlonglong fileSize, int storageSize,
+                                const QDateTime& modificationDate, int orientationHint, const QImage& image)
+{
+    if (location.isEmpty() || uniqueHash.isEmpty() || image.isNull())
+    {
+        return;
+    }
+
+    const QImage pixels = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32
+                                                                        : QImage::Format_RGB32);
+    const QByteArray key = Private::makeKey(uniqueHash, fileSize, storageSize);
+
+    d->ensureOpen(location);
+
+    QWriteLocker locker(&d->lock);
+
+    if (d->location != location)
+    {
+        return;
+    }
+
+    d->append(key, Private::timeStamp(modificationDate), orientationHint, &pixels);
+}
+
+void ThumbnailPackStore::remove(const QString& location, const QString& uniqueHash, qlonglong fileSize)
+{
+    if (location.isEmpty() || uniqueHash.isEmpty())
+    {
+        return;
+    }
+
+    const QByteArray prefix = Private::keyPrefix(uniqueHash, fileSize);
+
+    d->ensureOpen(location);
+
+    QWriteLocker locker(&d->lock);
+
+    if (d->location != location)
+    {
+        return;
+    }
+
+    QList<QByteArray> keys;
+
+    for (QHash<QByteArray, Private::Location>::const_iterator it = d->index.constBegin() ;
+         it != d->index.constEnd() ; ++it)
+    {
+        if (it.key().startsWith(prefix))
+        {
+            keys << it.key();
+        }
+    }
+
+    foreach(const QByteArray& key, keys)
+    {
+        d->append(key, 0, 0, 0);
+    }
+}
+
+} // namespace Digikam
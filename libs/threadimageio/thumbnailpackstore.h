@@ -0,0 +1,96 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : memory-mapped pack files of decoded thumbnails
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef THUMBNAIL_PACK_STORE_H
+#define THUMBNAIL_PACK_STORE_H
+
+// Qt includes
+
+#include <QString>
+#include <QDateTime>
+#include <QImage>
+
+namespace Digikam
+{
+
+/**
+ * A persistent cache of decoded thumbnails in front of the thumbnail database.
+ *
+ * Thumbnails are appended as raw 32 bit pixels to pack files, which are memory-mapped
+ * for reading. A thumbnail is identified by the uniqueHash + fileSize pair of the
+ * original file and by the storage size bucket, so a cached thumbnail is returned
+ * as a QImage referencing the mapped pages, without any SQL or decoding.
+ * The pages stay mapped as long as such an image exists.
+ *
+ * Pack files are only ever appended to; an entry is replaced or removed by appending
+ * a newer record. A pack is written by one process at a time, which continues the
+ * pack of a previous session as long as it has space left. Records appended by
+ * other processes are picked up periodically. When a new pack is started and the
+ * cache has reached its number of packs, the oldest pack not written by a running
+ * process is dropped with all its entries, so the cache never takes more than
+ * this number of full packs. The thumbnail database stays the authoritative store:
+ * any miss must be served from there.
+ */
+class ThumbnailPackStore
+{
+public:
+
+    static ThumbnailPackStore* instance();
+
+    /**
+     * Returns the cached thumbnail, or a null image if there is none,
+     * or if it is older than modificationDate.
+     * The location is the cache directory to use, normally derived from the
+     * thumbnail database parameters. The returned image shares the mapped memory.
+     */
+    QImage find(const QString& location, const QString& uniqueHash, qlonglong fileSize, int storageSize,
+                const QDateTime& modificationDate, int* const orientationHint);
+
+    /**
+     * Appends the thumbnail to the pack written by this process, replacing any previous entry.
+     * Nothing is cached if writing fails, for example on a full disk.
+     */
+    void insert(const QString& location, const QString& uniqueHash, qlonglong fileSize, int storageSize,
+                const QDateTime& modificationDate, int orientationHint, const QImage& image);
+
+    /**
+     * Removes the entries of all storage sizes for the given file.
+     */
+    void remove(const QString& location, const QString& uniqueHash, qlonglong fileSize);
+
+private:
+
+    ThumbnailPackStore();
+    ~ThumbnailPackStore();
+
+    friend class ThumbnailPackStoreCreator;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // THUMBNAIL_PACK_STORE_H
@@ -57,6 +57,16 @@ ThumbnailLoadingTask::ThumbnailLoadingTask(LoadSaveThread* const thread, const L
     // Not a clean but pragmatic solution.
     ThumbnailLoadThread* const thumbThread = static_cast<ThumbnailLoadThread*>(thread);
     m_creator                              = thumbThread->thumbnailCreator();
+    m_worker                               = false;
+}
+
+ThumbnailLoadingTask::ThumbnailLoadingTask(LoadSaveThread* const thread, const LoadingDescription& description,
+                                           ThumbnailCreator* const creator)
+    : SharedLoadingTask(thread, description, LoadSaveThread::AccessModeRead,
+                        LoadingTaskStatusLoading),
+      m_creator(creator),
+      m_worker(true)
+{
 }
 
 void ThumbnailLoadingTask::execute()
@@ -66,6 +76,14 @@ void ThumbnailLoadingTask::execute()
         return;
     }
 
+    if (!m_worker)
+    {
+        // Hand the next queued tasks to the decode workers, and wait
+        // if one of them is right now working on this thumbnail
+        ThumbnailLoadThread* const thumbThread = static_cast<ThumbnailLoadThread*>(m_thread);
+        thumbThread->startDecodeWorkers(m_loadingDescription);
+    }
+
     if (m_loadingDescription.previewParameters.onlyPregenerate())
     {
         setupCreator();
@@ -83,7 +101,11 @@ void ThumbnailLoadingTask::execute()
                 break;
         }
 
-        m_thread->taskHasFinished();
+        if (!m_worker)
+        {
+            m_thread->taskHasFinished();
+        }
+
         // do not emit any signal
         return;
     }
@@ -97,6 +119,11 @@ void ThumbnailLoadingTask::execute()
 
         if (cachedImage)
         {
+            if (m_worker)
+            {
+                return;
+            }
+
             m_qimage = QImage(*cachedImage);
         }
 
@@ -107,6 +134,13 @@ void ThumbnailLoadingTask::execute()
             // do not wait on other loading processes?
             //m_usedProcess = cache->retrieveLoadingProcess(m_loadingDescription.cacheKey());
 
+            if (m_usedProcess && m_worker)
+            {
+                // the thumbnail is already being created, nothing to do for a worker
+                m_usedProcess = 0;
+                return;
+            }
+
             if (m_usedProcess)
             {
                 // Other process is right now loading this image.
@@ -217,12 +251,23 @@ void ThumbnailLoadingTask::execute()
         m_usedProcess = 0;
     }
 
+    if (m_worker)
+    {
+        // the task of the thread finds the thumbnail in the cache, or waits as a listener
+        return;
+    }
+
     // again: following the golden rule to avoid deadlocks, do this when CacheLock is not held
     postProcess();
     m_thread->taskHasFinished();
     m_thread->thumbnailLoaded(m_loadingDescription, m_qimage);
 }
 
+bool ThumbnailLoadingTask::querySendNotifyEvent()
+{
+    return (!m_worker && SharedLoadingTask::querySendNotifyEvent());
+}
+
 void ThumbnailLoadingTask::setupCreator()
 {
     m_creator->setThumbnailSize(m_loadingDescription.previewParameters.size);
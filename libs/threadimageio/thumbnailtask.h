@@ -44,9 +44,18 @@ public:
 
     ThumbnailLoadingTask(LoadSaveThread* const thread, const LoadingDescription& description);
 
+    /**
+     * Creates a task run by a decode worker of the thread, with a creator of its own.
+     * The task only creates the thumbnail and puts it into the LoadingCache, where
+     * the task of the thread takes it from. It sends no notifications.
+     */
+    ThumbnailLoadingTask(LoadSaveThread* const thread, const LoadingDescription& description,
+                         ThumbnailCreator* const creator);
+
     virtual void execute();
     virtual void setResult(const LoadingDescription& loadingDescription, const QImage& qimage);
     virtual void postProcess();
+    virtual bool querySendNotifyEvent();
 
 private:
 
@@ -57,6 +66,7 @@ private:
 
     QImage            m_qimage;
     ThumbnailCreator* m_creator;
+    bool              m_worker;
 };
 
 } // namespace Digikam
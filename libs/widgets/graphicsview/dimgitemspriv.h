@@ -71,21 +71,35 @@ protected:
 
 // -------------------------------------------------------------------------------
 
+class DImgTileRenderer;
+
 class DIGIKAM_EXPORT GraphicsDImgItem::GraphicsDImgItemPrivate
 {
 public:
 
     GraphicsDImgItemPrivate()
+        : tileRenderer(0)
     {
     }
 
     void init(GraphicsDImgItem* const q);
 
+    /**
+     * Returns the factor between the pixels rendered and the item coordinates,
+     * which is larger than 1 on high resolution displays.
+     */
+    double scalingRatio(const QSize& completeSize) const;
+
 public:
 
     DImg                  image;
     ImageZoomSettings     zoomSettings;
+
+    /// Used by the reimplementations of paint() in the image editor
     mutable CachedPixmaps cachedPixmaps;
+
+    /// Renders the item in GraphicsDImgItem::paint()
+    DImgTileRenderer*     tileRenderer;
 };
 
 // -------------------------------------------------------------------------------
@@ -0,0 +1,422 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : asynchronous tiled rendering of a DImg at any zoom level
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "dimgtilerenderer.h"
+
+// Qt includes
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPixmap>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+
+// Local includes
+
+#include "dimg.h"
+
+namespace Digikam
+{
+
+class DImgTileKey
+{
+public:
+
+    DImgTileKey(const QSize& scaledSize, const QPoint& tile)
+        : scaledSize(scaledSize),
+          tile(tile)
+    {
+    }
+
+    bool operator==(const DImgTileKey& other) const
+    {
+        return (scaledSize == other.scaledSize && tile == other.tile);
+    }
+
+public:
+
+    QSize  scaledSize;
+    QPoint tile;
+};
+
+inline uint qHash(const DImgTileKey& key)
+{
+    return ::qHash(key.scaledSize.width())        ^ (::qHash(key.scaledSize.height()) << 8) ^
+           (::qHash(key.tile.x()) << 16)          ^ (::qHash(key.tile.y()) << 24);
+}
+
+static QRect tileRect(const QSize& scaledSize, const QPoint& tile)
+{
+    return QRect(tile.x() * DImgTileRenderer::TileSize, tile.y() * DImgTileRenderer::TileSize,
+                 DImgTileRenderer::TileSize, DImgTileRenderer::TileSize).intersected(QRect(QPoint(0, 0), scaledSize));
+}
+
+// -------------------------------------------------------------------------------
+
+class DImgTileJob : public QRunnable
+{
+public:
+
+    /// A job building the pyramid and the preview
+    DImgTileJob(DImgTileRenderer* const renderer, int generation)
+        : m_renderer(renderer),
+          m_generation(generation),
+          m_pyramid(true)
+    {
+    }
+
+    /// A job rendering one tile
+    DImgTileJob(DImgTileRenderer* const renderer, int generation, const QSize& scaledSize, const QPoint& tile)
+        : m_renderer(renderer),
+          m_generation(generation),
+          m_pyramid(false),
+          m_scaledSize(scaledSize),
+          m_tile(tile)
+    {
+    }
+
+    virtual void run()
+    {
+        if (m_pyramid)
+        {
+            m_renderer->buildPyramid(m_generation);
+        }
+        else
+        {
+            m_renderer->renderTile(m_generation, m_scaledSize, m_tile);
+        }
+    }
+
+private:
+
+    DImgTileRenderer* const m_renderer;
+    const int               m_generation;
+    const bool              m_pyramid;
+    const QSize             m_scaledSize;
+    const QPoint            m_tile;
+};
+
+// -------------------------------------------------------------------------------
+
+class DImgTileRenderer::Private
+{
+public:
+
+    enum
+    {
+        // Priorities of the jobs in the pool
+        PrefetchPriority = 0,
+        VisiblePriority  = 1,
+        PyramidPriority  = 2
+    };
+
+public:
+
+    Private()
+        : generation(0),
+          pyramidStarted(false),
+          tiles(64 * 1024)     // in kB
+    {
+    }
+
+    bool isCurrent(int gen) const
+    {
+        return (gen == generation.load());
+    }
+
+public:
+
+    QThreadPool                        pool;
+
+    /// Incremented with each image, the jobs of older images give up
+    QAtomicInt                         generation;
+
+    /// Shared with the jobs. levels[0] is the image, each next level half the size.
+    /// Tile jobs for another size than requestedSize give up.
+    QMutex                             mutex;
+    QList<DImg>                        levels;
+    QSize                              requestedSize;
+
+    /// Used in the GUI thread only
+    QSize                              imageSize;
+    bool                               pyramidStarted;
+    QPixmap                            preview;
+    QSet<DImgTileKey>                  pending;
+    QCache<DImgTileKey, QPixmap>       tiles;
+};
+
+DImgTileRenderer::DImgTileRenderer(QObject* const parent)
+    : QObject(parent),
+      d(new Private)
+{
+    // The GUI thread shall keep one core
+    d->pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+}
+
+DImgTileRenderer::~DImgTileRenderer()
+{
+    d->generation.ref();
+    d->pool.clear();
+    d->pool.waitForDone();
+    delete d;
+}
+
+void DImgTileRenderer::setImage(const DImg& image)
+{
+    d->generation.ref();
+
+    {
+        QMutexLocker lock(&d->mutex);
+        d->levels.clear();
+
+        if (!image.isNull())
+        {
+            d->levels << image;
+        }
+
+        d->requestedSize = QSize();
+    }
+
+    d->imageSize      = image.isNull() ? QSize() : image.size();
+    d->pyramidStarted = false;
+    d->preview        = QPixmap();
+    d->pending.clear();
+    d->tiles.clear();
+}
+
+void DImgTileRenderer::draw(QPainter* const painter, const QRect& scaledRect, const QSize& scaledSize, double ratio)
+{
+    const QRect area = scaledRect.intersected(QRect(QPoint(0, 0), scaledSize));
+
+    if (d->imageSize.isEmpty() || area.isEmpty())
+    {
+        return;
+    }
+
+    if (!d->pyramidStarted)
+    {
+        d->pool.start(new DImgTileJob(this, d->generation.load()), Private::PyramidPriority);
+        d->pyramidStarted = true;
+    }
+
+    {
+        QMutexLocker lock(&d->mutex);
+
+        if (d->requestedSize != scaledSize)
+        {
+            // Queued jobs of the previous zoom level will give up
+            d->requestedSize = scaledSize;
+            d->pending.clear();
+        }
+    }
+
+    const int firstColumn = area.left()   / TileSize;
+    const int lastColumn  = area.right()  / TileSize;
+    const int firstRow    = area.top()    / TileSize;
+    const int lastRow     = area.bottom() / TileSize;
+    bool missing          = false;
+
+    for (int row = firstRow ; row <= lastRow ; ++row)
+    {
+        for (int column = firstColumn ; column <= lastColumn ; ++column)
+        {
+            if (!d->tiles.contains(DImgTileKey(scaledSize, QPoint(column, row))))
+            {
+                requestTile(scaledSize, QPoint(column, row), Private::VisiblePriority);
+                missing = true;
+            }
+        }
+    }
+
+    // Until all tiles arrived, the preview fills the gaps
+
+    if (missing && !d->preview.isNull())
+    {
+        const double previewRatio = double(d->preview.width()) / scaledSize.width();
+
+        painter->drawPixmap(QRectF(area.x() / ratio, area.y() / ratio, area.width() / ratio, area.height() / ratio),
+                            d->preview,
+                            QRectF(area.x()     * previewRatio, area.y()      * previewRatio,
+                                   area.width() * previewRatio, area.height() * previewRatio));
+    }
+
+    for (int row = firstRow ; row <= lastRow ; ++row)
+    {
+        for (int column = firstColumn ; column <= lastColumn ; ++column)
+        {
+            QPixmap* const pix = d->tiles.object(DImgTileKey(scaledSize, QPoint(column, row)));
+
+            if (!pix)
+            {
+                continue;
+            }
+
+            const QRect tile = tileRect(scaledSize, QPoint(column, row));
+            const QRect part = tile.intersected(area);
+
+            painter->drawPixmap(QRectF(part.x() / ratio, part.y() / ratio, part.width() / ratio, part.height() / ratio),
+                                *pix,
+                                QRectF(part.topLeft() - tile.topLeft(), part.size()));
+        }
+    }
+
+    // Prefetch the ring of tiles around the painted area
+
+    const int columns = (scaledSize.width()  - 1) / TileSize;
+    const int rows    = (scaledSize.height() - 1) / TileSize;
+
+    for (int row = qMax(0, firstRow - 1) ; row <= qMin(rows, lastRow + 1) ; ++row)
+    {
+        for (int column = qMax(0, firstColumn - 1) ; column <= qMin(columns, lastColumn + 1) ; ++column)
+        {
+            if (!d->tiles.contains(DImgTileKey(scaledSize, QPoint(column, row))))
+            {
+                requestTile(scaledSize, QPoint(column, row), Private::PrefetchPriority);
+            }
+        }
+    }
+}
+
+void DImgTileRenderer::requestTile(const QSize& scaledSize, const QPoint& tile, int priority)
+{
+    const DImgTileKey key(scaledSize, tile);
+
+    if (d->pending.contains(key))
+    {
+        return;
+    }
+
+    d->pending.insert(key);
+    d->pool.start(new DImgTileJob(this, d->generation.load(), scaledSize, tile), priority);
+}
+
+void DImgTileRenderer::slotPreviewRendered(int generation, const QImage& preview)
+{
+    if (!d->isCurrent(generation))
+    {
+        return;
+    }
+
+    d->preview = QPixmap::fromImage(preview);
+
+    emit signalUpdated(QSize(), QRect());
+}
+
+void DImgTileRenderer::slotTileRendered(int generation, const QSize& scaledSize, const QPoint& tile, const QImage& image)
+{
+    if (!d->isCurrent(generation))
+    {
+        return;
+    }
+
+    d->pending.remove(DImgTileKey(scaledSize, tile));
+
+    if (image.isNull())
+    {
+        return;
+    }
+
+    d->tiles.insert(DImgTileKey(scaledSize, tile), new QPixmap(QPixmap::fromImage(image)),
+                    qMax(1, image.byteCount() / 1024));
+
+    emit signalUpdated(scaledSize, tileRect(scaledSize, tile));
+}
+
+void DImgTileRenderer::buildPyramid(int generation)
+{
+    DImg level;
+
+    {
+        QMutexLocker lock(&d->mutex);
+
+        if (!d->isCurrent(generation) || d->levels.isEmpty())
+        {
+            return;
+        }
+
+        level = d->levels.first();
+    }
+
+    while (qMax(level.width(), level.height()) > (uint)PreviewSize)
+    {
+        level = level.smoothScale(qMax(1u, level.width() / 2), qMax(1u, level.height() / 2));
+
+        QMutexLocker lock(&d->mutex);
+
+        if (!d->isCurrent(generation))
+        {
+            return;
+        }
+
+        d->levels << level;
+    }
+
+    QMetaObject::invokeMethod(this, "slotPreviewRendered", Qt::QueuedConnection,
+                              Q_ARG(int, generation),
+                              Q_ARG(QImage, level.copyQImage()));
+}
+
+void DImgTileRenderer::renderTile(int generation, const QSize& scaledSize, const QPoint& tile)
+{
+    DImg source;
+
+    {
+        QMutexLocker lock(&d->mutex);
+
+        if (!d->isCurrent(generation) || d->requestedSize != scaledSize || d->levels.isEmpty())
+        {
+            return;
+        }
+
+        // The smallest level which is still at least as large as the result
+
+        source = d->levels.first();
+
+        foreach(const DImg& level, d->levels)
+        {
+            if ((int)level.width() >= scaledSize.width() && (int)level.height() >= scaledSize.height())
+            {
+                source = level;
+            }
+        }
+    }
+
+    const QRect rect  = tileRect(scaledSize, tile);
+    const DImg scaled = source.smoothScaleClipped(scaledSize.width(), scaledSize.height(),
+                                                  rect.x(), rect.y(), rect.width(), rect.height());
+
+    QMetaObject::invokeMethod(this, "slotTileRendered", Qt::QueuedConnection,
+                              Q_ARG(int, generation),
+                              Q_ARG(QSize, scaledSize),
+                              Q_ARG(QPoint, tile),
+                              Q_ARG(QImage, scaled.copyQImage()));
+}
+
+} // namespace Digikam
@@ -0,0 +1,117 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : asynchronous tiled rendering of a DImg at any zoom level
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#ifndef DIMG_TILE_RENDERER_H
+#define DIMG_TILE_RENDERER_H
+
+// Qt includes
+
+#include <QObject>
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+
+class QPainter;
+
+namespace Digikam
+{
+
+class DImg;
+
+/**
+ * Renders a DImg scaled to the zoomed size of a graphics item, in tiles of TileSize
+ * pixels which are scaled in a pool of background threads and kept in a bounded cache.
+ *
+ * The scaling starts from a pyramid of the image, each level half the size of the
+ * previous one, so that a tile is computed from the smallest level which is still
+ * larger than the zoomed image. The smallest level serves as a preview: as long as
+ * a tile is missing, its area is drawn from the preview. Tiles around the painted
+ * area are prefetched, so panning mostly finds them ready.
+ *
+ * draw() never scales the image itself, it only paints what is available and requests
+ * the rest. signalUpdated() is emitted when new pixels arrived.
+ */
+class DImgTileRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    enum
+    {
+        TileSize    = 256,
+        PreviewSize = 512
+    };
+
+public:
+
+    explicit DImgTileRenderer(QObject* const parent = 0);
+    ~DImgTileRenderer();
+
+    /**
+     * Sets the image to render. Drops all tiles and pending work.
+     * Nothing is computed before the next draw().
+     * Note: DImg is explicitly shared. The image must not be changed
+     * in place afterwards without calling setImage() again.
+     */
+    void setImage(const DImg& image);
+
+    /**
+     * Paints the region scaledRect of the image scaled to scaledSize.
+     * The painter coordinates are the scaled coordinates divided by ratio.
+     */
+    void draw(QPainter* const painter, const QRect& scaledRect, const QSize& scaledSize, double ratio);
+
+Q_SIGNALS:
+
+    /**
+     * New tiles of the image scaled to scaledSize are available in scaledRect.
+     * If scaledSize is null, the preview arrived and any part may be updated.
+     */
+    void signalUpdated(const QSize& scaledSize, const QRect& scaledRect);
+
+private Q_SLOTS:
+
+    void slotPreviewRendered(int generation, const QImage& preview);
+    void slotTileRendered(int generation, const QSize& scaledSize, const QPoint& tile, const QImage& image);
+
+private:
+
+    void requestTile(const QSize& scaledSize, const QPoint& tile, int priority);
+
+    // Called in the worker threads
+    void buildPyramid(int generation);
+    void renderTile(int generation, const QSize& scaledSize, const QPoint& tile);
+
+    friend class DImgTileJob;
+
+private:
+
+    class Private;
+    Private* const d;
+};
+
+} // namespace Digikam
+
+#endif // DIMG_TILE_RENDERER_H
@@ -36,6 +36,7 @@
 
 #include "digikam_config.h"
 #include "dimg.h"
+#include "dimgtilerenderer.h"
 #include "imagezoomsettings.h"
 
 namespace Digikam
@@ -137,6 +138,45 @@ void GraphicsDImgItem::GraphicsDImgItemPrivate::init(GraphicsDImgItem* const q)
     // This flag is crucial for our performance! Limits redrawing area.
     q->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
     q->setAcceptedMouseButtons(Qt::NoButton);
+
+    // Subclasses call init() again
+    if (!tileRenderer)
+    {
+        tileRenderer = new DImgTileRenderer(q);
+
+        QObject::connect(tileRenderer, SIGNAL(signalUpdated(QSize,QRect)),
+                         q, SLOT(slotTilesUpdated(QSize,QRect)));
+    }
+}
+
+double GraphicsDImgItem::GraphicsDImgItemPrivate::scalingRatio(const QSize& completeSize) const
+{
+    /* For high resolution ("retina") displays, Mac OS X / Qt
+       report only half of the physical resolution in terms of
+       pixels, i.e. every logical pixels corresponds to 2x2
+       physical pixels. However, UI elements and fonts are
+       nevertheless rendered at full resolution, and pixmaps
+       as well, provided their resolution is high enough (that
+       is, higher than the reported, logical resolution).
+
+       To work around this, we render the photos not a logical
+       resolution, but with the photo's full resolution, but
+       at the screen's aspect ratio. When we later draw this
+       high resolution bitmap, it is up to Qt to scale the
+       photo to the true physical resolution.  The ratio
+       computed below is the ratio between the photo and
+       screen resolutions, or equivalently the factor by which
+       we need to increase the pixel size of the rendered
+       pixmap.
+    */
+#ifdef USE_QT_SCALING
+    double xratio = double(image.width()) / completeSize.width();
+    double yratio = double(image.height()) / completeSize.height();
+    return qMax(qMin(xratio, yratio), 1.0);
+#else
+    Q_UNUSED(completeSize);
+    return 1.0;
+#endif
 }
 
 GraphicsDImgItem::~GraphicsDImgItem()
@@ -151,6 +191,7 @@ void GraphicsDImgItem::setImage(const DImg& img)
     d->image = img;
     d->zoomSettings.setImageSize(img.size(), img.originalSize());
     d->cachedPixmaps.clear();
+    d->tileRenderer->setImage(img);
     sizeHasChanged();
     emit imageChanged();
 }
@@ -173,6 +214,9 @@ void GraphicsDImgItem::clearCache()
 {
     Q_D(GraphicsDImgItem);
     d->cachedPixmaps.clear();
+
+    // The image may have been changed in place
+    d->tileRenderer->setImage(d->image);
 }
 
 const ImageZoomSettings* GraphicsDImgItem::zoomSettings() const
@@ -198,64 +242,39 @@ void GraphicsDImgItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*
 {
     Q_D(GraphicsDImgItem);
 
-    QRect   drawRect = option->exposedRect.intersected(boundingRect()).toAlignedRect();
-    QRect   pixSourceRect;
-    QPixmap pix;
-
-    QSize completeSize = boundingRect().size().toSize();
-
-
-    /* For high resolution ("retina") displays, Mac OS X / Qt
-       report only half of the physical resolution in terms of
-       pixels, i.e. every logical pixels corresponds to 2x2
-       physical pixels. However, UI elements and fonts are
-       nevertheless rendered at full resolution, and pixmaps
-       as well, provided their resolution is high enough (that
-       is, higher than the reported, logical resolution).
-
-       To work around this, we render the photos not a logical
-       resolution, but with the photo's full resolution, but
-       at the screen's aspect ratio. When we later draw this
-       high resolution bitmap, it is up to Qt to scale the
-       photo to the true physical resolution.  The ratio
-       computed below is the ratio between the photo and
-       screen resolutions, or equivalently the factor by which
-       we need to increase the pixel size of the rendered
-       pixmap.
-    */
-#ifdef USE_QT_SCALING
-    double xratio = double(d->image.width()) / completeSize.width();
-    double yratio = double(d->image.height()) / completeSize.height();
-    double ratio = qMax(qMin(xratio, yratio), 1.0);
-#else
-    double ratio = 1.0;
-#endif
+    QRect  drawRect       = option->exposedRect.intersected(boundingRect()).toAlignedRect();
+    QSize  completeSize   = boundingRect().size().toSize();
+    double ratio          = d->scalingRatio(completeSize);
 
     QRect  scaledDrawRect = QRectF(ratio*drawRect.x(), ratio*drawRect.y(),
                                    ratio*drawRect.width(), ratio*drawRect.height()).toRect();
 
-    if (d->cachedPixmaps.find(scaledDrawRect, &pix, &pixSourceRect))
+    // scale "as if" scaling to whole image, tile by tile in the background
+    QSize scaledCompleteSize = QSizeF(ratio*completeSize.width(), ratio*completeSize.height()).toSize();
+    d->tileRenderer->draw(painter, scaledDrawRect, scaledCompleteSize, ratio);
+}
+
+void GraphicsDImgItem::slotTilesUpdated(const QSize& scaledSize, const QRect& scaledRect)
+{
+    Q_D(GraphicsDImgItem);
+
+    if (scaledSize.isNull())
     {
-        if (pixSourceRect.isNull())
-        {
-            painter->drawPixmap(drawRect, pix);
-        }
-        else
-        {
-            painter->drawPixmap(drawRect, pix, pixSourceRect);
-        }
+        update();
+        return;
     }
-    else
+
+    QSize  completeSize = boundingRect().size().toSize();
+    double ratio        = d->scalingRatio(completeSize);
+
+    // Tiles of another zoom level only fill the cache
+    if (scaledSize != QSizeF(ratio*completeSize.width(), ratio*completeSize.height()).toSize())
     {
-        // scale "as if" scaling to whole image, but clip output to our exposed region
-        QSize scaledCompleteSize = QSizeF(ratio*completeSize.width(), ratio*completeSize.height()).toSize();
-        DImg scaledImage   = d->image.smoothScaleClipped(scaledCompleteSize.width(), scaledCompleteSize.height(),
-                                                         scaledDrawRect.x(), scaledDrawRect.y(),
-                                                         scaledDrawRect.width(), scaledDrawRect.height());
-        pix                = scaledImage.convertToPixmap();
-        d->cachedPixmaps.insert(scaledDrawRect, pix);
-        painter->drawPixmap(drawRect, pix);
+        return;
     }
+
+    update(QRectF(scaledRect.x() / ratio, scaledRect.y() / ratio,
+                  scaledRect.width() / ratio, scaledRect.height() / ratio));
 }
 
 void GraphicsDImgItem::contextMenuEvent(QGraphicsSceneContextMenuEvent* e)
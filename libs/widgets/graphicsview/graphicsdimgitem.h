@@ -77,6 +77,10 @@ protected:
 
     void contextMenuEvent(QGraphicsSceneContextMenuEvent* e);
 
+private Q_SLOTS:
+
+    void slotTilesUpdated(const QSize& scaledSize, const QRect& scaledRect);
+
 public:
 
     // Declared public because of DImgPreviewItemPrivate.
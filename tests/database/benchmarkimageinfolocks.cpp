@@ -0,0 +1,272 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : a command line tool to benchmark the contention
+ *               between readers and writers of ImageInfo fields
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QThread>
+#include <QTextStream>
+#include <QDebug>
+
+// Local includes
+
+#include "coredbaccess.h"
+#include "dbengineparameters.h"
+#include "imageinfo.h"
+#include "imagelisterrecord.h"
+
+using namespace Digikam;
+
+/** Returns the lister record of a synthetic item. The item does not exist in the database,
+ *  but all fields which the readers access are cached from the record.
+ */
+static ImageListerRecord recordForId(qlonglong id)
+{
+    ImageListerRecord record;
+    record.imageID          = id;
+    record.albumID          = 1 + id / 1000;
+    record.albumRootID      = 1;
+    record.name             = QString::fromLatin1("image%1.jpg").arg(id);
+    record.rating           = id % 6;
+    record.category         = DatabaseItem::Image;
+    record.format           = QLatin1String("JPG");
+    record.creationDate     = QDateTime(QDate(2026, 1, 1)).addSecs(id);
+    record.modificationDate = record.creationDate;
+    record.fileSize         = 1024 * (id % 10000);
+    record.imageSize        = QSize(4000, 3000);
+
+    return record;
+}
+
+/** A thread reading cached fields, as the icon view does when painting,
+ *  or storing the fields of its part of the items, as a lister or scanner does.
+ */
+class BenchmarkThread : public QThread
+{
+public:
+
+    BenchmarkThread(const QList<ImageInfo>& infos, bool writer, QAtomicInt* const stop)
+        : operations(0),
+          maxLatency(0),
+          m_infos(infos),
+          m_writer(writer),
+          m_stop(stop)
+    {
+    }
+
+    void run()
+    {
+        QElapsedTimer timer;
+        qint64        sum = 0;
+
+        while (!m_stop->load())
+        {
+            foreach(const ImageInfo& info, m_infos)
+            {
+                timer.start();
+
+                if (m_writer)
+                {
+                    ImageInfo relisted(recordForId(info.id()));
+                    sum += relisted.rating();
+                }
+                else
+                {
+                    sum += info.rating() + info.fileSize() + info.dimensions().width();
+                    sum += info.dateTime().isValid() ? 1 : 0;
+                }
+
+                maxLatency = qMax(maxLatency, timer.nsecsElapsed());
+                ++operations;
+
+                if (m_stop->load())
+                {
+                    break;
+                }
+            }
+        }
+
+        // Prevent the compiler from dropping the accessors
+        if (sum == -1)
+        {
+            qDebug() << sum;
+        }
+    }
+
+public:
+
+    qint64 operations;
+    qint64 maxLatency;
+
+private:
+
+    QList<ImageInfo> m_infos;
+    bool             m_writer;
+    QAtomicInt*      m_stop;
+};
+
+/** Runs the readers and writers for the given time. Reports the read and write operations
+ *  per second, and the largest latency of a single read in microseconds.
+ */
+static void runBenchmark(const QList<ImageInfo>& infos, int readers, int writers, int seconds,
+                         double* const readsPerSecond, double* const maxReadLatency, double* const writesPerSecond)
+{
+    QAtomicInt              stop(0);
+    QList<BenchmarkThread*> threads;
+
+    for (int i = 0 ; i < readers ; ++i)
+    {
+        threads << new BenchmarkThread(infos, false, &stop);
+    }
+
+    // Each writer works on its own part of the items
+
+    const int part = infos.size() / qMax(writers, 1);
+
+    for (int i = 0 ; i < writers ; ++i)
+    {
+        threads << new BenchmarkThread(infos.mid(i * part, part), true, &stop);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    foreach(BenchmarkThread* const thread, threads)
+    {
+        thread->start();
+    }
+
+    QThread::sleep(seconds);
+    stop.store(1);
+
+    foreach(BenchmarkThread* const thread, threads)
+    {
+        thread->wait();
+    }
+
+    const double elapsed = timer.elapsed() / 1000.0;
+    qint64 reads         = 0;
+    qint64 writes        = 0;
+    qint64 latency       = 0;
+
+    for (int i = 0 ; i < threads.size() ; ++i)
+    {
+        if (i < readers)
+        {
+            reads  += threads.at(i)->operations;
+            latency = qMax(latency, threads.at(i)->maxLatency);
+        }
+        else
+        {
+            writes += threads.at(i)->operations;
+        }
+    }
+
+    qDeleteAll(threads);
+
+    *readsPerSecond  = reads  / elapsed;
+    *writesPerSecond = writes / elapsed;
+    *maxReadLatency  = latency / 1000.0;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QLatin1String("Benchmark the contention between readers and writers of ImageInfo fields.\n"
+                                                   "Run it on different builds to compare locking strategies."));
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption(QLatin1String("items"),   QLatin1String("Number of synthetic items (default 100000)"),  QLatin1String("count")));
+    parser.addOption(QCommandLineOption(QLatin1String("readers"), QLatin1String("Number of reader threads (default 1)"),        QLatin1String("count")));
+    parser.addOption(QCommandLineOption(QLatin1String("writers"), QLatin1String("Maximum number of writer threads (default: cores - 1)"), QLatin1String("count")));
+    parser.addOption(QCommandLineOption(QLatin1String("seconds"), QLatin1String("Duration of each run (default 3)"),            QLatin1String("seconds")));
+    parser.process(app);
+
+    const int items   = parser.isSet(QLatin1String("items"))   ? parser.value(QLatin1String("items")).toInt()   : 100000;
+    const int readers = parser.isSet(QLatin1String("readers")) ? parser.value(QLatin1String("readers")).toInt() : 1;
+    const int writers = parser.isSet(QLatin1String("writers")) ? parser.value(QLatin1String("writers")).toInt()
+                                                               : qMax(1, QThread::idealThreadCount() - 1);
+    const int seconds = parser.isSet(QLatin1String("seconds")) ? parser.value(QLatin1String("seconds")).toInt() : 3;
+
+    // The ImageInfo cache needs a database, an empty one is enough
+
+    const QString dbFile = QDir::tempPath() + QLatin1String("/digikam-benchmarkimageinfolocks.db");
+    QFile::remove(dbFile);
+
+    DbEngineParameters params(QLatin1String("QSQLITE"), dbFile, QLatin1String("QSQLITE"), dbFile);
+    CoreDbAccess::setParameters(params, CoreDbAccess::MainApplication);
+
+    if (!CoreDbAccess::checkReadyForUse(0))
+    {
+        qWarning() << "Cannot create the database" << dbFile;
+        return -1;
+    }
+
+    QList<ImageInfo> infos;
+
+    for (qlonglong id = 1 ; id <= items ; ++id)
+    {
+        infos << ImageInfo(recordForId(id));
+    }
+
+    QTextStream out(stdout);
+    out << items << " items, " << readers << " reader threads, " << seconds << " s per run" << endl;
+    out << "writers\treads/s\tmax read latency (us)\twrites/s" << endl;
+
+    double baseline = 0.0;
+
+    for (int w = 0 ; w <= writers ; w = (w == 0) ? 1 : w * 2)
+    {
+        double readsPerSecond, maxReadLatency, writesPerSecond;
+        runBenchmark(infos, readers, w, seconds, &readsPerSecond, &maxReadLatency, &writesPerSecond);
+
+        if (w == 0)
+        {
+            baseline = readsPerSecond;
+        }
+
+        out << w << "\t" << qRound64(readsPerSecond) << "\t" << maxReadLatency << "\t" << qRound64(writesPerSecond);
+
+        if (w > 0 && baseline > 0.0)
+        {
+            out << "\t(reads at " << qRound(100.0 * readsPerSecond / baseline) << "% of no writer)";
+        }
+
+        out << endl;
+    }
+
+    infos.clear();
+    CoreDbAccess::cleanUpDatabase();
+    QFile::remove(dbFile);
+
+    return 0;
+}
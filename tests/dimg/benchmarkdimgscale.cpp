@@ -0,0 +1,258 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : a command line tool to benchmark DImg smooth scaling
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// C++ includes
+
+#include <cstring>
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QStringList>
+#include <QDebug>
+
+// Local includes
+
+#include "dimg.h"
+#include "dimg_p.h"
+
+using namespace Digikam;
+
+/** Fill the image with a gradient and some noise, so that all channels and all bits
+ *  of the samples are exercised by the scaler.
+ */
+static void fillImage(DImg& img)
+{
+    const uint w = img.width();
+    const uint h = img.height();
+    uint seed    = 12345;
+
+    if (img.sixteenBit())
+    {
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(img.bits());
+
+        for (uint y = 0 ; y < h ; ++y)
+        {
+            for (uint x = 0 ; x < w ; ++x)
+            {
+                seed   = seed * 1103515245 + 12345;
+                ptr[0] = (unsigned short)((x * 65535) / w) ^ (seed >> 20);
+                ptr[1] = (unsigned short)((y * 65535) / h) ^ (seed >> 18);
+                ptr[2] = (unsigned short)(seed >> 16);
+                ptr[3] = 0xFFFF - (unsigned short)(seed >> 24);
+                ptr   += 4;
+            }
+        }
+    }
+    else
+    {
+        uchar* ptr = img.bits();
+
+        for (uint y = 0 ; y < h ; ++y)
+        {
+            for (uint x = 0 ; x < w ; ++x)
+            {
+                seed   = seed * 1103515245 + 12345;
+                ptr[0] = (uchar)((x * 255) / w) ^ (uchar)(seed >> 28);
+                ptr[1] = (uchar)((y * 255) / h) ^ (uchar)(seed >> 26);
+                ptr[2] = (uchar)(seed >> 16);
+                ptr[3] = 0xFF - (uchar)(seed >> 28);
+                ptr   += 4;
+            }
+        }
+    }
+}
+
+/** Returns the best time in ms of some runs of the scaling, and the last result in target.
+ */
+static qint64 timeScale(const DImg& img, const QSize& size, const QRect& section, int runs, DImg& target)
+{
+    qint64 best = -1;
+
+    for (int i = 0 ; i < runs ; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (section.isNull())
+        {
+            target = img.smoothScale(size, Qt::KeepAspectRatio);
+        }
+        else
+        {
+            target = img.smoothScaleSection(section, size);
+        }
+
+        const qint64 elapsed = timer.elapsed();
+        best                 = (best < 0) ? elapsed : qMin(best, elapsed);
+    }
+
+    return best;
+}
+
+/** Compares two scaled images, returns the number of differing samples, and the largest
+ *  difference of a sample in maxDiff. Both images must have the same size and depth.
+ */
+static qint64 compareImages(const DImg& a, const DImg& b, int& maxDiff)
+{
+    maxDiff = 0;
+
+    if ((a.size() != b.size()) || (a.sixteenBit() != b.sixteenBit()))
+    {
+        maxDiff = -1;
+        return -1;
+    }
+
+    const qint64 samples = (qint64)a.width() * a.height() * 4;
+    qint64 differ        = 0;
+
+    for (qint64 i = 0 ; i < samples ; ++i)
+    {
+        const int diff = a.sixteenBit() ? qAbs((int)reinterpret_cast<const unsigned short*>(a.bits())[i] -
+                                               (int)reinterpret_cast<const unsigned short*>(b.bits())[i])
+                                        : qAbs((int)a.bits()[i] - (int)b.bits()[i]);
+
+        if (diff)
+        {
+            ++differ;
+            maxDiff = qMax(maxDiff, diff);
+        }
+    }
+
+    return differ;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int runs = 3;
+
+    if (argc == 2)
+    {
+        runs = qMax(1, QString::fromUtf8(argv[1]).toInt());
+    }
+    else if (argc > 2)
+    {
+        qDebug() << "benchmarkdimgscale - benchmark the DImg smooth scaling kernels on 24 and 50 megapixels images";
+        qDebug() << "Usage: [number of runs]";
+        return -1;
+    }
+
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+    const bool sse2   = DImgScale::sse2KernelsAvailable();
+    bool failed       = false;
+
+    // The SSE2 kernels must give the same result as the scalar kernels: the tolerance is 0.
+
+    qDebug() << "Best of" << runs << "runs, 1 thread compared to" << threads << "threads";
+
+    if (sse2)
+    {
+        qDebug() << "Scalar kernels (old) compared to SSE2 kernels (new), tolerance 0";
+    }
+    else
+    {
+        qDebug() << "SSE2 kernels are not built, only the scalar kernels are measured";
+    }
+
+    const QList<QSize> sources = QList<QSize>() << QSize(6000, 4000)    // 24 MP
+                                                << QSize(8688, 5792);   // 50 MP
+
+    foreach(const QSize& source, sources)
+    {
+        for (int depth = 0 ; depth < 2 ; ++depth)
+        {
+            const bool sixteenBit = (depth == 1);
+            DImg img(source.width(), source.height(), sixteenBit, true);
+            fillImage(img);
+
+            QList<QSize> sizes;
+            QList<QRect> sections;
+            QStringList  names;
+
+            names    << QLatin1String("thumbnail 256");
+            sizes    << QSize(256, 256);
+            sections << QRect();
+
+            names    << QLatin1String("preview 1920");
+            sizes    << QSize(1920, 1920);
+            sections << QRect();
+
+            names    << QLatin1String("half size");
+            sizes    << source / 2;
+            sections << QRect();
+
+            names    << QLatin1String("zoom 200% 1000x1000");
+            sizes    << QSize(2000, 2000);
+            sections << QRect(1000, 1000, 1000, 1000);
+
+            for (int i = 0 ; i < sizes.size() ; ++i)
+            {
+                DImg oldSerial, oldParallel, newSerial, newParallel;
+
+                DImgScale::setSSE2KernelsEnabled(false);
+
+                QThreadPool::globalInstance()->setMaxThreadCount(1);
+                const qint64 oldSerialTime   = timeScale(img, sizes[i], sections[i], runs, oldSerial);
+
+                QThreadPool::globalInstance()->setMaxThreadCount(threads);
+                const qint64 oldParallelTime = timeScale(img, sizes[i], sections[i], runs, oldParallel);
+
+                DImgScale::setSSE2KernelsEnabled(true);
+
+                QThreadPool::globalInstance()->setMaxThreadCount(1);
+                const qint64 newSerialTime   = timeScale(img, sizes[i], sections[i], runs, newSerial);
+
+                QThreadPool::globalInstance()->setMaxThreadCount(threads);
+                const qint64 newParallelTime = timeScale(img, sizes[i], sections[i], runs, newParallel);
+
+                int threadsDiff              = 0;
+                int kernelsDiff              = 0;
+                const qint64 threadsDiffer   = compareImages(oldSerial, oldParallel, threadsDiff);
+                const qint64 kernelsDiffer   = compareImages(oldSerial, newParallel, kernelsDiff);
+
+                qDebug().nospace() << source.width() << "x" << source.height()
+                                   << (sixteenBit ? " 16 bits " : " 8 bits ") << names[i] << ":";
+
+                qDebug().nospace() << "    1 thread:  old " << oldSerialTime << " ms, new "
+                                   << newSerialTime << " ms, speedup "
+                                   << (newSerialTime ? (double)oldSerialTime / newSerialTime : 0.0);
+
+                qDebug().nospace() << "    " << threads << " threads: old " << oldParallelTime << " ms, new "
+                                   << newParallelTime << " ms, speedup "
+                                   << (newParallelTime ? (double)oldSerialTime / newParallelTime : 0.0)
+                                   << " against old 1 thread";
+
+                qDebug().nospace() << "    pixel diff: threads " << threadsDiffer << " samples (max " << threadsDiff
+                                   << "), kernels " << kernelsDiffer << " samples (max " << kernelsDiff << ")";
+
+                failed |= (threadsDiffer != 0) || (kernelsDiffer != 0);
+            }
+        }
+    }
+
+    return (failed ? 1 : 0);
+}
@@ -0,0 +1,418 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : a command line tool to benchmark all DImg filters
+ *               registered in the filter manager, with JSON output
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+// Qt includes
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QDebug>
+
+// Local includes
+
+#include "metaengine.h"
+#include "dimg.h"
+#include "dimgthreadedfilter.h"
+#include "dimgfiltermanager.h"
+
+using namespace Digikam;
+
+/** A reference image of the benchmark, loaded from a file or synthetic.
+ */
+struct BenchmarkImage
+{
+    QString name;
+    DImg    image;
+};
+
+/** Fill the image with a gradient and some noise, so that the filters do not
+ *  run on degenerated data.
+ */
+static void fillImage(DImg& img)
+{
+    const uint w = img.width();
+    const uint h = img.height();
+    uint seed    = 12345;
+
+    if (img.sixteenBit())
+    {
+        unsigned short* ptr = reinterpret_cast<unsigned short*>(img.bits());
+
+        for (uint y = 0 ; y < h ; ++y)
+        {
+            for (uint x = 0 ; x < w ; ++x)
+            {
+                seed   = seed * 1103515245 + 12345;
+                ptr[0] = (unsigned short)((x * 65535) / w) ^ (seed >> 22);
+                ptr[1] = (unsigned short)((y * 65535) / h) ^ (seed >> 22);
+                ptr[2] = (unsigned short)(((x + y) * 65535) / (w + h)) ^ (seed >> 22);
+                ptr[3] = 0xFFFF;
+                ptr   += 4;
+            }
+        }
+    }
+    else
+    {
+        uchar* ptr = img.bits();
+
+        for (uint y = 0 ; y < h ; ++y)
+        {
+            for (uint x = 0 ; x < w ; ++x)
+            {
+                seed   = seed * 1103515245 + 12345;
+                ptr[0] = (uchar)((x * 255) / w) ^ (uchar)(seed >> 30);
+                ptr[1] = (uchar)((y * 255) / h) ^ (uchar)(seed >> 30);
+                ptr[2] = (uchar)(((x + y) * 255) / (w + h)) ^ (uchar)(seed >> 30);
+                ptr[3] = 0xFF;
+                ptr   += 4;
+            }
+        }
+    }
+}
+
+/** Reset the peak resident memory of the process. Only supported on Linux.
+ */
+static void resetPeakMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile file(QLatin1String("/proc/self/clear_refs"));
+
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write("5");
+    }
+#endif
+}
+
+/** Returns the current or the peak resident memory of the process in KiB, or -1 if unknown.
+ */
+static qint64 residentMemory(bool peak)
+{
+#ifdef Q_OS_LINUX
+    QFile file(QLatin1String("/proc/self/status"));
+
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        const QByteArray key = peak ? "VmHWM:" : "VmRSS:";
+
+        foreach (const QByteArray& line, file.readAll().split('\n'))
+        {
+            if (line.startsWith(key))
+            {
+                return line.mid(key.size()).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#else
+    Q_UNUSED(peak);
+#endif
+
+    return -1;
+}
+
+/** Run the filter on the image runs times with the given number of threads.
+ *  Returns the JSON description of the best run, or a null object if the filter cannot be created.
+ */
+static QJsonObject benchmarkFilter(const QString& identifier, int version, const DImg& img,
+                                   int threads, int runs)
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    qint64 best       = -1;
+    qint64 peakMemory = -1;
+
+    for (int i = 0 ; i < runs ; ++i)
+    {
+        QScopedPointer<DImgThreadedFilter> filter(DImgFilterManager::instance()->createFilter(identifier, version));
+
+        if (!filter)
+        {
+            return QJsonObject();
+        }
+
+        const qint64 memoryBefore = residentMemory(false);
+        resetPeakMemory();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        filter->setupFilter(img);
+        filter->startFilterDirectly();
+
+        const qint64 elapsed = timer.elapsed();
+        const qint64 peak    = residentMemory(true);
+        best                 = (best < 0) ? elapsed : qMin(best, elapsed);
+
+        if (peak >= 0 && memoryBefore >= 0)
+        {
+            peakMemory = qMax(peakMemory, peak - memoryBefore);
+        }
+    }
+
+    const double megaPixels = (double)img.numPixels() / 1.0E6;
+
+    QJsonObject result;
+    result[QLatin1String("threads")]          = threads;
+    result[QLatin1String("timeMs")]           = (double)best;
+    result[QLatin1String("megaPixelsPerSec")] = best > 0 ? megaPixels * 1000.0 / best : 0.0;
+    result[QLatin1String("peakMemoryKiB")]    = (double)peakMemory;
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QLatin1String("benchmarkfilters - benchmark all DImg filters registered in the filter manager "
+                                                   "with default settings, on 8 and 16 bits images, with 1 to N threads."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QLatin1String("images"),
+                                 QLatin1String("Reference images. Synthetic images are used if none is given."),
+                                 QLatin1String("[images...]"));
+    parser.addOption(QCommandLineOption(QLatin1String("runs"),
+                                        QLatin1String("Number of runs of each case, the best time is reported (default 3)."),
+                                        QLatin1String("runs"), QLatin1String("3")));
+    parser.addOption(QCommandLineOption(QLatin1String("threads"),
+                                        QLatin1String("Comma separated numbers of threads (default 1, 2, 4... up to all cores)."),
+                                        QLatin1String("threads")));
+    parser.addOption(QCommandLineOption(QLatin1String("sizes"),
+                                        QLatin1String("Comma separated sizes of the synthetic images (default 1920x1080,4000x3000)."),
+                                        QLatin1String("sizes"), QLatin1String("1920x1080,4000x3000")));
+    parser.addOption(QCommandLineOption(QLatin1String("filters"),
+                                        QLatin1String("Comma separated filter identifiers to run (default all)."),
+                                        QLatin1String("filters")));
+    parser.addOption(QCommandLineOption(QLatin1String("output"),
+                                        QLatin1String("File to write the JSON results to (default standard output)."),
+                                        QLatin1String("file")));
+    parser.process(app);
+
+    MetaEngine::initializeExiv2();
+
+    const int runs  = qMax(1, parser.value(QLatin1String("runs")).toInt());
+    const int cores = QThreadPool::globalInstance()->maxThreadCount();
+
+    // Thread counts
+
+    QList<int> threadCounts;
+
+    if (parser.isSet(QLatin1String("threads")))
+    {
+        foreach (const QString& count, parser.value(QLatin1String("threads")).split(QLatin1Char(','), QString::SkipEmptyParts))
+        {
+            threadCounts << qMax(1, count.toInt());
+        }
+    }
+    else
+    {
+        for (int count = 1 ; count < cores ; count *= 2)
+        {
+            threadCounts << count;
+        }
+
+        threadCounts << cores;
+    }
+
+    // Reference images, in 8 and 16 bits
+
+    QList<BenchmarkImage> images;
+
+    foreach (const QString& path, parser.positionalArguments())
+    {
+        DImg img(path);
+
+        if (img.isNull())
+        {
+            qWarning() << "Cannot load" << path;
+            continue;
+        }
+
+        for (int depth = 0 ; depth < 2 ; ++depth)
+        {
+            BenchmarkImage bench;
+            bench.name  = QFileInfo(path).fileName();
+            bench.image = img.copy();
+
+            if (depth == 0)
+            {
+                bench.image.convertToEightBit();
+            }
+            else
+            {
+                bench.image.convertToSixteenBit();
+            }
+
+            images << bench;
+        }
+    }
+
+    if (parser.positionalArguments().isEmpty())
+    {
+        foreach (const QString& size, parser.value(QLatin1String("sizes")).split(QLatin1Char(','), QString::SkipEmptyParts))
+        {
+            const QStringList dimensions = size.split(QLatin1Char('x'));
+
+            if (dimensions.size() != 2 || dimensions[0].toInt() <= 0 || dimensions[1].toInt() <= 0)
+            {
+                qWarning() << "Invalid size" << size;
+                continue;
+            }
+
+            for (int depth = 0 ; depth < 2 ; ++depth)
+            {
+                BenchmarkImage bench;
+                bench.name  = QLatin1String("synthetic");
+                bench.image = DImg(dimensions[0].toInt(), dimensions[1].toInt(), (depth == 1), true);
+                fillImage(bench.image);
+                images << bench;
+            }
+        }
+    }
+
+    if (images.isEmpty())
+    {
+        qWarning() << "No image to process";
+        return -1;
+    }
+
+    // Filters
+
+    DImgFilterManager* const manager = DImgFilterManager::instance();
+    QStringList identifiers          = manager->supportedFilters();
+
+    if (parser.isSet(QLatin1String("filters")))
+    {
+        identifiers = parser.value(QLatin1String("filters")).split(QLatin1Char(','), QString::SkipEmptyParts);
+    }
+
+    identifiers.sort();
+
+    QJsonArray results;
+
+    foreach (const QString& identifier, identifiers)
+    {
+        // RAW conversion needs RAW data, it cannot run on a decoded image.
+        if (!manager->isSupported(identifier) || manager->isRawConversion(identifier))
+        {
+            qWarning() << "Skipping" << identifier;
+            continue;
+        }
+
+        const int version = manager->supportedVersions(identifier).last();
+
+        foreach (const BenchmarkImage& bench, images)
+        {
+            QJsonObject entry;
+            entry[QLatin1String("filter")]     = identifier;
+            entry[QLatin1String("version")]    = version;
+            entry[QLatin1String("name")]       = manager->displayableName(identifier);
+            entry[QLatin1String("image")]      = bench.name;
+            entry[QLatin1String("width")]      = (int)bench.image.width();
+            entry[QLatin1String("height")]     = (int)bench.image.height();
+            entry[QLatin1String("bitsDepth")]  = bench.image.sixteenBit() ? 16 : 8;
+            entry[QLatin1String("megaPixels")] = (double)bench.image.numPixels() / 1.0E6;
+
+            QJsonArray scaling;
+            double     reference = 0.0;
+
+            foreach (int threads, threadCounts)
+            {
+                QJsonObject result = benchmarkFilter(identifier, version, bench.image, threads, runs);
+
+                if (result.isEmpty())
+                {
+                    break;
+                }
+
+                const double time = result[QLatin1String("timeMs")].toDouble();
+
+                if (reference == 0.0)
+                {
+                    reference = time;
+                }
+
+                result[QLatin1String("speedup")] = time > 0.0 ? reference / time : 0.0;
+                scaling.append(result);
+
+                qDebug().nospace() << identifier << " " << bench.name << " " << bench.image.width() << "x"
+                                   << bench.image.height() << (bench.image.sixteenBit() ? " 16 bits, " : " 8 bits, ")
+                                   << threads << " threads: " << time << " ms";
+            }
+
+            if (scaling.isEmpty())
+            {
+                qWarning() << "Cannot create filter" << identifier;
+                break;
+            }
+
+            entry[QLatin1String("runs")] = scaling;
+            results.append(entry);
+        }
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(cores);
+
+    QJsonObject root;
+    root[QLatin1String("benchmark")] = QLatin1String("benchmarkfilters");
+    root[QLatin1String("date")]      = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root[QLatin1String("cpu")]       = QSysInfo::currentCpuArchitecture();
+    root[QLatin1String("cores")]     = cores;
+    root[QLatin1String("runs")]      = runs;
+    root[QLatin1String("results")]   = results;
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if (parser.isSet(QLatin1String("output")))
+    {
+        QFile file(parser.value(QLatin1String("output")));
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qWarning() << "Cannot write to" << file.fileName();
+            return -1;
+        }
+
+        file.write(json);
+    }
+    else
+    {
+        QTextStream(stdout) << json;
+    }
+
+    MetaEngine::cleanupExiv2();
+
+    return 0;
+}
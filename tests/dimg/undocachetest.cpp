@@ -0,0 +1,136 @@
+/* ============================================================
+ *
+ * This file is a part of digiKam project
+ * http://www.digikam.org
+ *
+ * Date        : 2026-10-18
+ * Description : a test for the tiled undo cache of the image editor
+ *
+ * Copyright (C) 2026 by digiKam team
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation;
+ * either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * ============================================================ */
+
+#include "undocachetest.h"
+
+// C++ includes
+
+#include <cstring>
+
+// Qt includes
+
+#include <QStandardPaths>
+#include <QTest>
+
+// Local includes
+
+#include "dimg.h"
+#include "undocache.h"
+
+using namespace Digikam;
+
+QTEST_GUILESS_MAIN(UndoCacheTest)
+
+/** An image with varying pixels, different for each seed.
+ */
+static DImg patternImage(uint width, uint height, bool sixteenBit, int seed)
+{
+    DImg img(width, height, sixteenBit, true);
+    uchar* const bits = img.bits();
+
+    for (uint i = 0 ; i < img.numBytes() ; ++i)
+    {
+        bits[i] = (uchar)((i * 7 + seed * 13 + i / 4093) & 0xFF);
+    }
+
+    return img;
+}
+
+static bool sameBits(const DImg& a, const DImg& b)
+{
+    return (a.width()      == b.width()      &&
+            a.height()     == b.height()     &&
+            a.sixteenBit() == b.sixteenBit() &&
+            memcmp(a.bits(), b.bits(), a.numBytes()) == 0);
+}
+
+void UndoCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void UndoCacheTest::testRoundTrip_data()
+{
+    QTest::addColumn<uint>("width");
+    QTest::addColumn<uint>("height");
+    QTest::addColumn<bool>("sixteenBit");
+
+    QTest::newRow("8 bits")          << 700u << 530u << false;
+    QTest::newRow("16 bits")         << 700u << 530u << true;
+    QTest::newRow("less than tile")  << 17u  << 9u   << false;
+}
+
+void UndoCacheTest::testRoundTrip()
+{
+    QFETCH(uint, width);
+    QFETCH(uint, height);
+    QFETCH(bool, sixteenBit);
+
+    UndoCache cache;
+    const DImg img = patternImage(width, height, sixteenBit, 1);
+
+    QVERIFY(cache.putData(1, img));
+
+    // Without and with an unrelated current image
+    QVERIFY(sameBits(cache.getData(1), img));
+    QVERIFY(sameBits(cache.getData(1, patternImage(width, height, sixteenBit, 2)), img));
+    QVERIFY(sameBits(cache.getData(1, patternImage(width / 2 + 1, height, sixteenBit, 1)), img));
+}
+
+void UndoCacheTest::testRegionChange()
+{
+    UndoCache cache;
+    const DImg before = patternImage(1000, 800, false, 1);
+    DImg after        = before.copy();
+
+    // A tool changing a region across tile boundaries
+    const DImg region = patternImage(300, 200, false, 3);
+    after.bitBltImage(&region, 200, 500);
+
+    QVERIFY(cache.putData(1, before));
+    QVERIFY(cache.putData(2, after));
+
+    QVERIFY(sameBits(cache.getData(1, after),  before));
+    QVERIFY(sameBits(cache.getData(2, before), after));
+    QVERIFY(sameBits(cache.getData(1),         before));
+    QVERIFY(sameBits(cache.getData(2),         after));
+}
+
+void UndoCacheTest::testClearFrom()
+{
+    UndoCache cache;
+    const DImg first  = patternImage(400, 300, false, 1);
+    const DImg second = patternImage(400, 300, false, 2);
+
+    QVERIFY(cache.putData(1, first));
+    QVERIFY(cache.putData(2, second));
+
+    cache.clearFrom(2);
+
+    QVERIFY(cache.getData(2).isNull());
+    QVERIFY(sameBits(cache.getData(1, second), first));
+
+    cache.clear();
+
+    QVERIFY(cache.getData(1).isNull());
+}
@@ -25,17 +25,35 @@
 
 #include "undocache.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QCoreApplication>
-#include <QDataStream>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRect>
+#include <QSet>
+#include <QSharedPointer>
 #include <QStringList>
 #include <QStandardPaths>
 #include <QStorageInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
 
 // Local includes
 
@@ -44,24 +62,413 @@
 namespace Digikam
 {
 
+namespace
+{
+
+const int    TileSize     = 256;
+
+/// Tiles kept in memory before writing the least recently used ones to the cache file
+const qint64 MemoryBudget = 256 * 1024 * 1024;
+
+/// Free disk space left to other applications when writing the cache file
+const qint64 DiskReserve  = 1024 * 1024 * 1024;
+
+QVector<QRect> tileRects(uint width, uint height)
+{
+    QVector<QRect> rects;
+
+    for (uint y = 0 ; y < height ; y += TileSize)
+    {
+        for (uint x = 0 ; x < width ; x += TileSize)
+        {
+            rects << QRect(x, y, qMin((uint)TileSize, width - x), qMin((uint)TileSize, height - y));
+        }
+    }
+
+    return rects;
+}
+
+QByteArray tileHash(const DImg& img, const QRect& rect)
+{
+    const int lineBytes = rect.width() * img.bytesDepth();
+    QCryptographicHash md5(QCryptographicHash::Md5);
+
+    for (int y = rect.top() ; y <= rect.bottom() ; ++y)
+    {
+        md5.addData((const char*)img.scanLine(y) + rect.x() * img.bytesDepth(), lineBytes);
+    }
+
+    return md5.result();
+}
+
+QByteArray tileBytes(const DImg& img, const QRect& rect)
+{
+    const int lineBytes = rect.width() * img.bytesDepth();
+    QByteArray bytes(lineBytes * rect.height(), Qt::Uninitialized);
+    char* dptr          = bytes.data();
+
+    for (int y = rect.top() ; y <= rect.bottom() ; ++y)
+    {
+        memcpy(dptr, img.scanLine(y) + rect.x() * img.bytesDepth(), lineBytes);
+        dptr += lineBytes;
+    }
+
+    return bytes;
+}
+
+bool putTileBytes(DImg& img, const QRect& rect, const QByteArray& bytes)
+{
+    const int lineBytes = rect.width() * img.bytesDepth();
+
+    if (bytes.size() != lineBytes * rect.height())
+    {
+        return false;
+    }
+
+    const char* sptr = bytes.constData();
+
+    for (int y = rect.top() ; y <= rect.bottom() ; ++y)
+    {
+        memcpy(img.scanLine(y) + rect.x() * img.bytesDepth(), sptr, lineBytes);
+        sptr += lineBytes;
+    }
+
+    return true;
+}
+
+/** Calls function for each index in [0, count), split in bands run in parallel.
+ */
+template <typename Function>
+void forEachTile(int count, Function function)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    const int bands = qBound(1, QThread::idealThreadCount(), count);
+
+    auto runBand = [=](int band)
+    {
+        for (int i = count * band / bands ; i < count * (band + 1) / bands ; ++i)
+        {
+            function(i);
+        }
+    };
+
+    QList <QFuture<void> > tasks;
+
+    for (int band = 0 ; band < bands - 1 ; ++band)
+    {
+        tasks.append(QtConcurrent::run([runBand, band]() { runBand(band); }));
+    }
+
+    runBand(bands - 1);
+
+    foreach(QFuture<void> t, tasks)
+        t.waitForFinished();
+}
+
+} // namespace
+
+class UndoCacheTile
+{
+public:
+
+    UndoCacheTile()
+        : fileOffset(-1),
+          fileLength(0),
+          lastUse(0)
+    {
+    }
+
+public:
+
+    QByteArray hash;
+    QByteArray raw;          ///< The copied pixels, until compressed
+    QByteArray compressed;   ///< While in memory
+    qint64     fileOffset;   ///< -1 until written to the cache file
+    int        fileLength;
+    quint64    lastUse;
+};
+
+typedef QSharedPointer<UndoCacheTile> UndoCacheTilePtr;
+typedef QWeakPointer<UndoCacheTile>   UndoCacheTileRef;
+
+class UndoCacheLevel
+{
+public:
+
+    UndoCacheLevel()
+        : width(0),
+          height(0),
+          sixteenBit(false),
+          hasAlpha(false)
+    {
+    }
+
+public:
+
+    uint                      width;
+    uint                      height;
+    bool                      sixteenBit;
+    bool                      hasAlpha;
+    QVector<UndoCacheTilePtr> tiles;
+};
+
+// ---------------------------------------------------------------------------------------
+
 class UndoCache::Private
 {
 public:
 
     Private()
+        : useCounter(0),
+          droppedLevels(0)
     {
     }
 
-    QString cacheFile(int level) const
+    QString cacheFile() const
     {
-        return QString::fromUtf8("%1-%2.bin").arg(cachePrefix).arg(level);
+        return QString::fromUtf8("%1.bin").arg(cachePrefix);
     }
 
-    QString   cacheDir;
-    QString   cachePrefix;
-    QSet<int> cachedLevels;
+    /// Returns the memory used by the compressed tiles of all levels, and these tiles, least recently used first.
+    /// The tiles not compressed yet are not counted: they are compressed and counted soon after.
+    /// Needs the mutex.
+    qint64 usedMemory(QList<UndoCacheTilePtr>* const compressedTiles = 0) const;
+
+    /// Run in the background
+    void   compressTiles(const QList<UndoCacheTilePtr>& tiles);
+    void   limitMemory();
+    void   dropOldestLevels();
+    bool   writeTile(const UndoCacheTilePtr& tile);
+    qint64 allocate(int length);
+
+public:
+
+    QString                        cacheDir;
+    QString                        cachePrefix;
+
+    /// Compresses and writes the tiles, one job after another
+    QThreadPool                    pool;
+
+    /// Guards the levels and the tiles
+    QMutex                         mutex;
+    QMap<int, UndoCacheLevel>      levels;
+    quint64                        useCounter;
+
+    /// The levels below this one were dropped because the cache file could not take their tiles
+    int                            droppedLevels;
+
+    /// Used in the background only. The extents of the cache file in use, by offset.
+    /// An extent is free again as soon as no level and no getData() uses its tile any more.
+    QFile                          writeFile;
+    QMap<qint64, UndoCacheTileRef> fileTiles;
 };
 
+qint64 UndoCache::Private::usedMemory(QList<UndoCacheTilePtr>* const compressedTiles) const
+{
+    QSet<UndoCacheTile*> seen;
+    qint64               used = 0;
+
+    foreach(const UndoCacheLevel& level, levels)
+    {
+        foreach(const UndoCacheTilePtr& tile, level.tiles)
+        {
+            if (seen.contains(tile.data()))
+            {
+                continue;
+            }
+
+            seen.insert(tile.data());
+            used += tile->compressed.size();
+
+            if (compressedTiles && !tile->compressed.isEmpty())
+            {
+                *compressedTiles << tile;
+            }
+        }
+    }
+
+    if (compressedTiles)
+    {
+        std::sort(compressedTiles->begin(), compressedTiles->end(),
+                  [](const UndoCacheTilePtr& a, const UndoCacheTilePtr& b) { return a->lastUse < b->lastUse; });
+    }
+
+    return used;
+}
+
+void UndoCache::Private::compressTiles(const QList<UndoCacheTilePtr>& tiles)
+{
+    QVector<QByteArray> compressed(tiles.size());
+    QByteArray* const   results = compressed.data();
+
+    // Fast zlib compression, lossless
+
+    forEachTile(tiles.size(), [&](int i)
+        {
+            results[i] = qCompress(tiles.at(i)->raw, 1);
+        }
+    );
+
+    {
+        QMutexLocker lock(&mutex);
+
+        for (int i = 0 ; i < tiles.size() ; ++i)
+        {
+            tiles.at(i)->compressed = compressed.at(i);
+            tiles.at(i)->raw        = QByteArray();
+        }
+    }
+
+    limitMemory();
+}
+
+void UndoCache::Private::limitMemory()
+{
+    QList<UndoCacheTilePtr> tiles;
+    qint64                  used;
+
+    {
+        QMutexLocker lock(&mutex);
+        used = usedMemory(&tiles);
+    }
+
+    if (used <= MemoryBudget)
+    {
+        return;
+    }
+
+    // Write the compressed tiles to the cache file, as long as the disk has room
+
+    QStorageInfo info(cacheDir);
+    qint64 diskSpace = info.bytesAvailable() - DiskReserve;
+    bool   failed    = false;
+
+    foreach(const UndoCacheTilePtr& tile, tiles)
+    {
+        if (used <= MemoryBudget)
+        {
+            break;
+        }
+
+        const int length = tile->compressed.size();
+
+        if (length > diskSpace || !writeTile(tile))
+        {
+            qCDebug(DIGIKAM_GENERAL_LOG) << "Cannot write more to the editor cache in" << cacheDir;
+            failed = true;
+            break;
+        }
+
+        used      -= length;
+        diskSpace -= length;
+    }
+
+    // Levels are only given up when the disk cannot take their tiles
+
+    if (failed && used > MemoryBudget)
+    {
+        dropOldestLevels();
+    }
+}
+
+void UndoCache::Private::dropOldestLevels()
+{
+    QMutexLocker lock(&mutex);
+
+    // The most recent level is always kept
+
+    while (levels.size() > 1 && usedMemory() > MemoryBudget)
+    {
+        const int level = levels.firstKey();
+        levels.remove(level);
+        droppedLevels   = level + 1;
+
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Undo level" << level << "dropped, the editor cache is full";
+    }
+}
+
+bool UndoCache::Private::writeTile(const UndoCacheTilePtr& tile)
+{
+    if (!writeFile.isOpen())
+    {
+        writeFile.setFileName(cacheFile());
+
+        if (!writeFile.open(QIODevice::ReadWrite))
+        {
+            qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot open undo cache file" << cacheFile();
+            return false;
+        }
+    }
+
+    QByteArray data;
+
+    {
+        QMutexLocker lock(&mutex);
+        data = tile->compressed;
+    }
+
+    const qint64 offset = allocate(data.size());
+
+    if (!writeFile.seek(offset) || writeFile.write(data) != data.size() || !writeFile.flush())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot write undo cache file" << cacheFile();
+        return false;
+    }
+
+    fileTiles.insert(offset, tile.toWeakRef());
+
+    {
+        QMutexLocker lock(&mutex);
+        tile->fileOffset = offset;
+        tile->fileLength = data.size();
+        tile->compressed = QByteArray();
+    }
+
+    return true;
+}
+
+qint64 UndoCache::Private::allocate(int length)
+{
+    // First fit between the extents still in use, forgetting the free ones on the way
+
+    qint64 end = 0;
+    QMap<qint64, UndoCacheTileRef>::iterator it = fileTiles.begin();
+
+    while (it != fileTiles.end())
+    {
+        const UndoCacheTilePtr tile = it.value().toStrongRef();
+
+        if (!tile)
+        {
+            it = fileTiles.erase(it);
+            continue;
+        }
+
+        if (it.key() - end >= length)
+        {
+            return end;
+        }
+
+        end = it.key() + tile->fileLength;
+        ++it;
+    }
+
+    // Nothing is used behind the last extent: give the space back
+
+    if (writeFile.size() > end)
+    {
+        writeFile.resize(end);
+    }
+
+    return end;
+}
+
+// ---------------------------------------------------------------------------------------
+
 UndoCache::UndoCache()
     : d(new Private)
 {
@@ -71,6 +478,9 @@ UndoCache::UndoCache()
                      .arg(d->cacheDir)
                      .arg(QCoreApplication::applicationPid());
 
+    // The background jobs must keep their order
+    d->pool.setMaxThreadCount(1);
+
     // remove any remnants
     QDir dir(d->cacheDir);
 
@@ -88,83 +498,265 @@ UndoCache::~UndoCache()
 
 void UndoCache::clear()
 {
-    foreach(int level, d->cachedLevels)
     {
-        QFile(d->cacheFile(level)).remove();
+        QMutexLocker lock(&d->mutex);
+        d->levels.clear();
+        d->droppedLevels = 0;
     }
 
-    d->cachedLevels.clear();
+    d->pool.clear();
+    d->pool.waitForDone();
+
+    d->writeFile.close();
+    d->fileTiles.clear();
+    QFile::remove(d->cacheFile());
 }
 
 void UndoCache::clearFrom(int fromLevel)
 {
-    foreach(int level, d->cachedLevels)
+    QMutexLocker lock(&d->mutex);
+
+    foreach(int level, d->levels.keys())
     {
         if (level >= fromLevel)
         {
-            QFile(d->cacheFile(level)).remove();
-            d->cachedLevels.remove(level);
+            d->levels.remove(level);
         }
     }
 }
 
-bool UndoCache::putData(int level, const DImg& img) const
+int UndoCache::droppedLevels() const
 {
-    QFile file(d->cacheFile(level));
-    QStorageInfo info(d->cacheDir);
+    QMutexLocker lock(&d->mutex);
+    return d->droppedLevels;
+}
 
-    qint64 fspace = (info.bytesAvailable()/1024.0/1024.0);
-    qCDebug(DIGIKAM_GENERAL_LOG) << "Free space available in Editor cache [" << d->cacheDir << "] in Mbytes: " << fspace;
+void UndoCache::removeFirstLevels(int count)
+{
+    QMutexLocker lock(&d->mutex);
+    QMap<int, UndoCacheLevel> levels;
 
-    if (file.exists() ||
-        !file.open(QIODevice::WriteOnly) ||
-        fspace < 1024) // Check if free space is over 1 Gb to put data in cache.
+    for (QMap<int, UndoCacheLevel>::const_iterator it = d->levels.constBegin() ; it != d->levels.constEnd() ; ++it)
+    {
+        if (it.key() >= count)
+        {
+            levels.insert(it.key() - count, it.value());
+        }
+    }
+
+    d->levels        = levels;
+    d->droppedLevels = qMax(0, d->droppedLevels - count);
+}
+
+bool UndoCache::putData(int level, const DImg& img) const
+{
+    if (img.isNull())
     {
         return false;
     }
 
-    QDataStream ds(&file);
-    ds << img.width();
-    ds << img.height();
-    ds << img.sixteenBit();
-    ds << img.hasAlpha();
+    UndoCacheLevel data;
+    data.width                 = img.width();
+    data.height                = img.height();
+    data.sixteenBit            = img.sixteenBit();
+    data.hasAlpha              = img.hasAlpha();
+
+    const QVector<QRect> rects = tileRects(data.width, data.height);
+    QVector<QByteArray> hashes(rects.size());
+    QByteArray* const hashPtr  = hashes.data();
+
+    forEachTile(rects.size(), [&](int i)
+        {
+            hashPtr[i] = tileHash(img, rects.at(i));
+        }
+    );
+
+    // Share the tiles with equal content, in any level or position
+
+    QList<UndoCacheTilePtr> newTiles;
+    QVector<int>            newIndexes;
+    data.tiles.resize(rects.size());
+
+    {
+        QMutexLocker lock(&d->mutex);
+        QHash<QByteArray, UndoCacheTilePtr> known;
+
+        foreach(const UndoCacheLevel& other, d->levels)
+        {
+            foreach(const UndoCacheTilePtr& tile, other.tiles)
+            {
+                known.insert(tile->hash, tile);
+            }
+        }
+
+        for (int i = 0 ; i < rects.size() ; ++i)
+        {
+            UndoCacheTilePtr tile = known.value(hashes.at(i));
+
+            if (!tile)
+            {
+                tile       = UndoCacheTilePtr(new UndoCacheTile);
+                tile->hash = hashes.at(i);
+                known.insert(tile->hash, tile);
+                newTiles   << tile;
+                newIndexes << i;
+            }
+
+            data.tiles[i] = tile;
+        }
+    }
+
+    // Copy the pixels now, the image is changed after this call
 
-    QByteArray ba((const char*)img.bits(), img.numBytes());
-    ds << ba;
+    forEachTile(newIndexes.size(), [&](int j)
+        {
+            newTiles.at(j)->raw = tileBytes(img, rects.at(newIndexes.at(j)));
+        }
+    );
 
-    file.close();
+    {
+        QMutexLocker lock(&d->mutex);
+        ++d->useCounter;
 
-    d->cachedLevels << level;
+        foreach(const UndoCacheTilePtr& tile, data.tiles)
+        {
+            tile->lastUse = d->useCounter;
+        }
+
+        d->levels.insert(level, data);
+    }
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << "Undo level" << level << "stores" << newTiles.size()
+                                 << "new tiles of" << rects.size();
+
+    if (!newTiles.isEmpty())
+    {
+        QtConcurrent::run(&d->pool, d, &Private::compressTiles, newTiles);
+    }
 
     return true;
 }
 
-DImg UndoCache::getData(int level) const
+DImg UndoCache::getData(int level, const DImg& current) const
 {
-    int  w          = 0;
-    int  h          = 0;
-    bool sixteenBit = false;
-    bool hasAlpha   = false;
+    UndoCacheLevel data;
 
-    QFile file(d->cacheFile(level));
+    {
+        QMutexLocker lock(&d->mutex);
+
+        if (!d->levels.contains(level))
+        {
+            return DImg();
+        }
 
-    if (!file.open(QIODevice::ReadOnly))
+        data = d->levels.value(level);
+        ++d->useCounter;
+
+        foreach(const UndoCacheTilePtr& tile, data.tiles)
+        {
+            tile->lastUse = d->useCounter;
+        }
+    }
+
+    const QVector<QRect> rects = tileRects(data.width, data.height);
+    QVector<char> fromCurrent(rects.size(), false);
+    DImg img;
+
+    if (!current.isNull()                 &&
+        current.width()      == data.width  &&
+        current.height()     == data.height &&
+        current.sixteenBit() == data.sixteenBit)
     {
-        return DImg();
+        char* const equal = fromCurrent.data();
+
+        forEachTile(rects.size(), [&](int i)
+            {
+                equal[i] = (tileHash(current, rects.at(i)) == data.tiles.at(i)->hash);
+            }
+        );
+
+        img = DImg(data.width, data.height, data.sixteenBit, data.hasAlpha, current.bits(), true);
+    }
+    else
+    {
+        img = DImg(data.width, data.height, data.sixteenBit, data.hasAlpha);
     }
 
-    QDataStream ds(&file);
-    ds >> w;
-    ds >> h;
-    ds >> sixteenBit;
-    ds >> hasAlpha;
+    // Collect the other tiles, from memory or from the cache file
 
-    QByteArray ba;
-    ds >> ba;
+    QVector<QByteArray> bytes(rects.size());
+    QVector<char>       compressed(rects.size(), true);
+    QMap<int, qint64>   toRead;
+    QMap<int, int>      toReadLength;
+
+    {
+        QMutexLocker lock(&d->mutex);
 
-    DImg img(w, h, sixteenBit, hasAlpha, (uchar*)ba.data(), true);
+        for (int i = 0 ; i < rects.size() ; ++i)
+        {
+            if (fromCurrent.at(i))
+            {
+                continue;
+            }
+
+            const UndoCacheTilePtr& tile = data.tiles.at(i);
+
+            if (!tile->raw.isEmpty())
+            {
+                bytes[i]      = tile->raw;
+                compressed[i] = false;
+            }
+            else if (!tile->compressed.isEmpty())
+            {
+                bytes[i]      = tile->compressed;
+            }
+            else
+            {
+                toRead.insert(i, tile->fileOffset);
+                toReadLength.insert(i, tile->fileLength);
+            }
+        }
+    }
 
-    file.close();
+    if (!toRead.isEmpty())
+    {
+        QFile file(d->cacheFile());
+
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return DImg();
+        }
+
+        for (QMap<int, qint64>::const_iterator it = toRead.constBegin() ; it != toRead.constEnd() ; ++it)
+        {
+            file.seek(it.value());
+            bytes[it.key()] = file.read(toReadLength.value(it.key()));
+        }
+
+        file.close();
+    }
+
+    QAtomicInt failures;
+
+    forEachTile(rects.size(), [&](int i)
+        {
+            if (fromCurrent.at(i))
+            {
+                return;
+            }
+
+            if (!putTileBytes(img, rects.at(i), compressed.at(i) ? qUncompress(bytes.at(i)) : bytes.at(i)))
+            {
+                failures.ref();
+            }
+        }
+    );
+
+    if (failures.load())
+    {
+        qCWarning(DIGIKAM_GENERAL_LOG) << "Cannot restore undo level" << level;
+        return DImg();
+    }
 
     return img;
 }
@@ -34,6 +34,18 @@
 namespace Digikam
 {
 
+/**
+ * Stores the image data of the undo levels.
+ *
+ * Each level is split into tiles. A tile equal to the same tile of another level is
+ * shared with it, so a tool changing one region of the image only adds the tiles of
+ * that region. New tiles are copied in putData() and compressed in the background.
+ * All tiles are kept in memory within a budget; beyond it, the least recently used
+ * compressed tiles are written to a cache file in the background, and read back when
+ * needed. The space of tiles no longer used is reused in the cache file. Only if the
+ * cache file cannot take more tiles, the oldest levels are dropped to keep the budget:
+ * getData() returns a null image for them, and droppedLevels() tells how many.
+ */
 class DIGIKAM_EXPORT UndoCache
 {
 
@@ -51,13 +63,23 @@ public:
      */
     void clearFrom(int level);
     /**
-    * Write the image data into a cache file
+     * Returns the number of levels, from level 0, which were dropped to keep the memory budget.
+     */
+    int  droppedLevels() const;
+    /**
+     * Removes the levels below count, and renumbers the next levels from 0.
+     */
+    void removeFirstLevels(int count);
+    /**
+    * Store the image data of the given level. The data is copied before returning.
     */
     bool putData(int level, const DImg& img) const;
     /**
-    * Get the image data from a cache file
+    * Get the image data from a cache file.
+    * Tiles which are equal in current are copied from there rather than decompressed,
+    * so pass the image being edited to restore a level quickly.
     */
-    DImg getData(int level) const;
+    DImg getData(int level, const DImg& current = DImg()) const;
 
 private:
 
@@ -119,10 +119,14 @@ void UndoManager::addAction(UndoAction* const action)
     {
         d->origin++;
     }
+
+    clearUnavailableUndoActions();
 }
 
 void UndoManager::undo()
 {
+    clearUnavailableUndoActions();
+
     if (d->undoActions.isEmpty())
     {
         return;
@@ -147,6 +151,8 @@ void UndoManager::redo()
 
 void UndoManager::rollbackToOrigin()
 {
+    clearUnavailableUndoActions();
+
     if (d->undoActions.isEmpty() || isAtOrigin())
     {
         return;
@@ -356,7 +362,8 @@ void UndoManager::makeSnapshot(int index)
 
 void UndoManager::restoreSnapshot(int index, const UndoMetadataContainer& c)
 {
-    DImg img = d->undoCache->getData(index);
+    // Only the tiles changed since the snapshot are decompressed
+    DImg img = d->undoCache->getData(index, *d->core->getImg());
 
     if (!img.isNull())
     {
@@ -366,7 +373,7 @@ void UndoManager::restoreSnapshot(int index, const UndoMetadataContainer& c)
 
 void UndoManager::getSnapshot(int index, DImg* const img) const
 {
-    DImg data = d->undoCache->getData(index);
+    DImg data = d->undoCache->getData(index, *d->core->getImg());
 
     // Pass ownership of buffer. If data is null, img will be null
     img->putImageData(data.width(), data.height(), data.sixteenBit(), data.hasAlpha(), data.bits(), true);
@@ -493,6 +500,28 @@ void UndoManager::clearRedoActions()
     d->redoActions.clear();
 }
 
+void UndoManager::clearUnavailableUndoActions()
+{
+    // The undo cache drops the oldest snapshots if it runs out of disk space.
+    // The actions before them cannot be undone any more.
+    const int count = qMin(d->undoCache->droppedLevels(), d->undoActions.size());
+
+    if (count <= 0)
+    {
+        return;
+    }
+
+    qDeleteAll(d->undoActions.begin(), d->undoActions.begin() + count);
+    d->undoActions.erase(d->undoActions.begin(), d->undoActions.begin() + count);
+    d->undoCache->removeFirstLevels(count);
+
+    // origin is no longer reachable if it was before the removed actions
+    if (d->origin > d->undoActions.size())
+    {
+        d->origin = INT_MAX;
+    }
+}
+
 bool UndoManager::anyMoreUndo() const
 {
     return !d->undoActions.isEmpty();
@@ -78,6 +78,7 @@ private:
 
     void clearUndoActions();
     void clearRedoActions();
+    void clearUnavailableUndoActions();
     void undoStep(bool saveRedo, bool execute, bool flyingRollback);
     void redoStep(bool execute, bool flyingRollback);
     void makeSnapshot(int index);
@@ -24,6 +24,10 @@
 
 #include "fingerprintsgenerator.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
 #include <QString>
@@ -47,6 +51,14 @@ namespace Digikam
 
 class FingerPrintsGenerator::Private
 {
+public:
+
+    enum
+    {
+        /// Number of processed items between two saves of the checkpoint
+        CheckpointInterval = 100
+    };
+
 public:
 
     Private() :
@@ -61,6 +73,9 @@ public:
 
     AlbumList          albumList;
 
+    /// Identifies the items and options of this run for the checkpoint
+    QString            scope;
+
     MaintenanceThread* thread;
 };
 
@@ -94,6 +109,13 @@ void FingerPrintsGenerator::setUseMultiCoreCPU(bool b)
 
 void FingerPrintsGenerator::slotCancel()
 {
+    // Only a run over all items resumes at a checkpoint. A run over the dirty items
+    // finds the items still to do by itself, including items missed before the checkpoint.
+    if (d->rebuildAll)
+    {
+        setCheckpoint(d->scope, d->thread->lastProcessedImagePath());
+    }
+
     d->thread->cancel();
     MaintenanceTool::slotCancel();
 }
@@ -108,6 +130,7 @@ void FingerPrintsGenerator::slotStart()
     }
 
     QStringList dirty = CoreDbAccess().db()->getDirtyOrMissingFingerprintURLs();
+    d->scope          = QString::number(d->rebuildAll);
 
     // Get all digiKam albums collection pictures path, depending of d->rebuildAll flag.
 
@@ -139,6 +162,16 @@ void FingerPrintsGenerator::slotStart()
         {
             d->allPicturesPath += aPaths;
         }
+
+        d->scope += QString::fromLatin1(" %1").arg((*it)->globalID());
+    }
+
+    // Items are processed in path order: resume after the checkpoint of a cancelled run.
+    std::sort(d->allPicturesPath.begin(), d->allPicturesPath.end());
+
+    if (d->rebuildAll)
+    {
+        skipCheckpointItems(d->scope, d->allPicturesPath);
     }
 
     if (d->allPicturesPath.isEmpty())
@@ -157,10 +190,21 @@ void FingerPrintsGenerator::slotAdvance(const QImage& img)
 {
     setThumbnail(QIcon(QPixmap::fromImage(img)));
     advance(1);
+
+    if (d->rebuildAll && (completedItems() % Private::CheckpointInterval) == 0)
+    {
+        setCheckpoint(d->scope, d->thread->lastProcessedImagePath());
+    }
 }
 
 void FingerPrintsGenerator::slotDone()
 {
+    // The thread also completes when it is cancelled: keep the checkpoint then.
+    if (!canceled())
+    {
+        clearCheckpoint();
+    }
+
     // Switch on scanned for finger-prints flag on digiKam config file.
     KSharedConfig::openConfig()->group(QLatin1String("General Settings")).writeEntry(QLatin1String("Finger Prints Generator First Run"), true);
 
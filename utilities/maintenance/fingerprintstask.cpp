@@ -24,7 +24,9 @@
 #include "fingerprintstask.h"
 
 // Qt includes
+
 #include <QQueue>
+#include <QStringList>
 
 // Local includes
 
@@ -40,6 +42,14 @@ namespace Digikam
 
 class FingerprintsTask::Private
 {
+public:
+
+    enum
+    {
+        /// Number of fingerprints written to the database in one transaction
+        FingerprintsBatchSize = 50
+    };
+
 public:
 
     Private()
@@ -47,7 +57,26 @@ public:
     {
     }
 
+    /** Writes the pending fingerprints, then reports the items as processed.
+     */
+    void commit()
+    {
+        haar.commitIndex();
+
+        foreach(const QString& path, pendingPaths)
+        {
+            data->setImagePathProcessed(path);
+        }
+
+        pendingPaths.clear();
+    }
+
+public:
+
     MaintenanceData* data;
+
+    HaarIface        haar;
+    QStringList      pendingPaths;
 };
 
 // -------------------------------------------------------
@@ -71,11 +100,14 @@ void FingerprintsTask::setMaintenanceData(MaintenanceData* const data)
 
 void FingerprintsTask::run()
 {
+    d->haar.setIndexBatched(true);
+
     // While we have data (using this as check for non-null)
     while (d->data)
     {
         if (m_cancel)
         {
+            d->commit();
             return;
         }
 
@@ -92,15 +124,23 @@ void FingerprintsTask::run()
 
         if (!dimg.isNull())
         {
-            // compute Haar fingerprint and store it to DB
-            HaarIface haarIface;
-            haarIface.indexImage(path, dimg);
+            // compute Haar fingerprint and store it to DB with the next batch
+            d->haar.indexImage(path, dimg);
+        }
+
+        d->pendingPaths << path;
+
+        if (d->pendingPaths.size() >= Private::FingerprintsBatchSize)
+        {
+            d->commit();
         }
 
         QImage qimg = dimg.smoothScale(22, 22, Qt::KeepAspectRatio).copyQImage();
         emit signalFinished(qimg);
     }
 
+    d->commit();
+
     emit signalDone();
 }
 
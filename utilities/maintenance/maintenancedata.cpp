@@ -26,6 +26,7 @@
 // Qt includes
 
 #include <QMutex>
+#include <QPair>
 
 // Local includes
 
@@ -48,6 +49,10 @@ public:
     QList<ImageInfo>              imageInfoList;
     QList<Identity>               identitiesList;
 
+    /// Paths handed out by getImagePath(), in order, with their processed state
+    QList<QPair<QString, bool> >  pathsInProgress;
+    QString                       lastProcessedPath;
+
     QMutex                        lock;
 };
 
@@ -74,6 +79,8 @@ void MaintenanceData::setThumbnailIds(const QList<int>& ids)
 void MaintenanceData::setImagePaths(const QList<QString>& paths)
 {
     d->imagePathList = paths;
+    d->pathsInProgress.clear();
+    d->lastProcessedPath.clear();
 }
 
 void MaintenanceData::setImageInfos(const QList<ImageInfo>& infos)
@@ -122,12 +129,39 @@ QString MaintenanceData::getImagePath() const
     if (!d->imagePathList.isEmpty())
     {
         path = d->imagePathList.takeFirst();
+        d->pathsInProgress << qMakePair(path, false);
     }
 
     d->lock.unlock();
     return path;
 }
 
+void MaintenanceData::setImagePathProcessed(const QString& path)
+{
+    QMutexLocker locker(&d->lock);
+
+    for (int i = 0 ; i < d->pathsInProgress.size() ; ++i)
+    {
+        if (d->pathsInProgress.at(i).first == path)
+        {
+            d->pathsInProgress[i].second = true;
+            break;
+        }
+    }
+
+    while (!d->pathsInProgress.isEmpty() && d->pathsInProgress.first().second)
+    {
+        d->lastProcessedPath = d->pathsInProgress.takeFirst().first;
+    }
+}
+
+QString MaintenanceData::lastProcessedImagePath() const
+{
+    QMutexLocker locker(&d->lock);
+
+    return d->lastProcessedPath;
+}
+
 ImageInfo MaintenanceData::getImageInfo() const
 {
     d->lock.lock();
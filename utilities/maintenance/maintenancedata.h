@@ -53,6 +53,14 @@ public:
     ImageInfo getImageInfo() const;
     Identity  getIdentity() const;
 
+    /** Image paths are handed out in order by getImagePath(). A task reports here
+     *  when it has stored the results of a path. lastProcessedImagePath() returns
+     *  the last path up to which all paths handed out are processed, so that a
+     *  cancelled run can resume after it.
+     */
+    void      setImagePathProcessed(const QString& path);
+    QString   lastProcessedImagePath() const;
+
 private:
 
     class Private;
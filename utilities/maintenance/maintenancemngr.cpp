@@ -244,6 +244,9 @@ void MaintenanceMngr::stage3()
 
         d->thumbsGenerator = new ThumbsGenerator(rebuildAll, list);
         d->thumbsGenerator->setNotificationEnabled(false);
+
+        // Fingerprints are computed in the same pass over the items.
+        d->thumbsGenerator->setFingerprintsGeneration(d->settings.fingerPrints, (d->settings.scanFingerPrints == false));
         d->thumbsGenerator->setUseMultiCoreCPU(d->settings.useMutiCoreCPU);
         d->thumbsGenerator->start();
     }
@@ -257,7 +260,8 @@ void MaintenanceMngr::stage4()
 {
     qCDebug(DIGIKAM_GENERAL_LOG) << "stage4";
 
-    if (d->settings.fingerPrints)
+    // With thumbnails, the fingerprints are already done at stage 3.
+    if (d->settings.fingerPrints && !d->settings.thumbnails)
     {
         bool rebuildAll = (d->settings.scanFingerPrints == false);
         AlbumList list;
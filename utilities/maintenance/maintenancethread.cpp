@@ -23,10 +23,15 @@
 
 #include "maintenancethread.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
 #include <QQueue>
 #include <QMutex>
+#include <QSet>
 
 // Local includes
 
@@ -94,24 +99,31 @@ void MaintenanceThread::syncMetadata(const ImageInfoList& items, MetadataSynchro
     appendJobs(collection);
 }
 
-void MaintenanceThread::generateThumbs(const QStringList& paths)
+void MaintenanceThread::generateThumbs(const QStringList& paths, const QStringList& fingerprintPaths)
 {
     ActionJobCollection collection;
 
-    data->setImagePaths(paths);
+    const QSet<QString> thumbnailSet   = paths.toSet();
+    const QSet<QString> fingerprintSet = fingerprintPaths.toSet();
+    QStringList allPaths               = (thumbnailSet + fingerprintSet).toList();
+    std::sort(allPaths.begin(), allPaths.end());
+
+    data->setImagePaths(allPaths);
 
     for (int i = 1; i <= maximumNumberOfThreads(); i++)
     {
         ThumbsTask* const t = new ThumbsTask();
 
         t->setMaintenanceData(data);
+        t->setThumbnailPaths(thumbnailSet);
+        t->setFingerprintPaths(fingerprintSet);
 
         connect(t, SIGNAL(signalFinished(QImage)),
                 this, SIGNAL(signalAdvance(QImage)));
 
         collection.insert(t, 0);
 
-        qCDebug(DIGIKAM_GENERAL_LOG) << "Creating a thumbnails task for generating thumbnails";
+        qCDebug(DIGIKAM_GENERAL_LOG) << "Creating a thumbnails task for generating thumbnails and fingerprints";
     }
 
     appendJobs(collection);
@@ -288,6 +300,11 @@ void MaintenanceThread::cancel()
     ActionThreadBase::cancel();
 }
 
+QString MaintenanceThread::lastProcessedImagePath() const
+{
+    return data->lastProcessedImagePath();
+}
+
 void MaintenanceThread::slotThreadFinished()
 {
     if (isEmpty())
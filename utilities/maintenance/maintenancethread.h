@@ -51,7 +51,16 @@ public:
     void setUseMultiCore(const bool b);
 
     void syncMetadata(const ImageInfoList& items, MetadataSynchronizer::SyncDirection dir, bool tagsOnly);
-    void generateThumbs(const QStringList& paths);
+    /** Regenerates the thumbnails of paths and computes the fingerprints of fingerprintPaths
+     *  in one pass over the items. The fingerprints are computed from a preview of
+     *  HaarIface::preferredSize(), as with generateFingerprints().
+     *  Items are processed in sorted path order.
+     */
+    void generateThumbs(const QStringList& paths, const QStringList& fingerprintPaths = QStringList());
+
+    /** Computes the fingerprints of paths from a preview of each image, as large as
+     *  HaarIface::preferredSize(). No thumbnail is created. Paths must be sorted.
+     */
     void generateFingerprints(const QStringList& paths);
     void sortByImageQuality(const QStringList& paths, const ImageQualitySettings& quality);
 
@@ -63,6 +72,10 @@ public:
 
     void cancel();
 
+    /** Returns the last path up to which all items of a thumbnails or fingerprints run are stored.
+     */
+    QString lastProcessedImagePath() const;
+
     QString getThumbFingerprintPath();
 
 Q_SIGNALS:
@@ -24,6 +24,10 @@
 
 #include "maintenancetool.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
 #include <QTime>
@@ -32,6 +36,8 @@
 
 // KDE includes
 
+#include <kconfiggroup.h>
+#include <ksharedconfig.h>
 #include <klocalizedstring.h>
 
 // Local includes
@@ -51,6 +57,13 @@ public:
         notification = true;
     }
 
+    static KConfigGroup checkpointGroup()
+    {
+        return KSharedConfig::openConfig()->group(QLatin1String("Maintenance Checkpoints"));
+    }
+
+public:
+
     bool  notification;
     QTime duration;
 };
@@ -73,6 +86,59 @@ void MaintenanceTool::setNotificationEnabled(bool b)
     d->notification = b;
 }
 
+QString MaintenanceTool::checkpoint(const QString& scope) const
+{
+    KConfigGroup group = Private::checkpointGroup();
+
+    if (group.readEntry(id() + QLatin1String(" Scope"), QString()) != scope)
+    {
+        return QString();
+    }
+
+    return group.readEntry(id() + QLatin1String(" Item"), QString());
+}
+
+void MaintenanceTool::setCheckpoint(const QString& scope, const QString& item)
+{
+    if (item.isEmpty())
+    {
+        return;
+    }
+
+    KConfigGroup group = Private::checkpointGroup();
+    group.writeEntry(id() + QLatin1String(" Scope"), scope);
+    group.writeEntry(id() + QLatin1String(" Item"),  item);
+    group.sync();
+}
+
+void MaintenanceTool::clearCheckpoint()
+{
+    KConfigGroup group = Private::checkpointGroup();
+
+    if (group.hasKey(id() + QLatin1String(" Item")))
+    {
+        group.deleteEntry(id() + QLatin1String(" Scope"));
+        group.deleteEntry(id() + QLatin1String(" Item"));
+        group.sync();
+    }
+}
+
+void MaintenanceTool::skipCheckpointItems(const QString& scope, QStringList& sortedItems) const
+{
+    const QString item = checkpoint(scope);
+
+    if (item.isEmpty())
+    {
+        return;
+    }
+
+    QStringList::iterator it = std::upper_bound(sortedItems.begin(), sortedItems.end(), item);
+    const int skipped        = it - sortedItems.begin();
+    sortedItems.erase(sortedItems.begin(), it);
+
+    qCDebug(DIGIKAM_GENERAL_LOG) << id() << "resumes after" << item << ":" << skipped << "items skipped";
+}
+
 void MaintenanceTool::start()
 {
     // We delay start to be sure that eventloop connect signals and slots in top level.
@@ -28,6 +28,7 @@
 // Qt includes
 
 #include <QString>
+#include <QStringList>
 
 // Local includes
 
@@ -65,6 +66,21 @@ public Q_SLOTS:
 
     void start();
 
+protected:
+
+    /** A checkpoint records the last item processed by a run of this tool, so that a run
+     *  which is cancelled can be resumed after this item. The scope identifies the items
+     *  and options of the run: a checkpoint is only returned for the same scope.
+     *  The checkpoint is cleared when the tool is done.
+     */
+    QString checkpoint(const QString& scope) const;
+    void    setCheckpoint(const QString& scope, const QString& item);
+    void    clearCheckpoint();
+
+    /** Removes from a sorted list the items up to the checkpoint of scope, if any.
+     */
+    void    skipCheckpointItems(const QString& scope, QStringList& sortedItems) const;
+
 protected Q_SLOTS:
 
     virtual void slotStart();
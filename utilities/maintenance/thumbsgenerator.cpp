@@ -24,6 +24,10 @@
 
 #include "thumbsgenerator.h"
 
+// C++ includes
+
+#include <algorithm>
+
 // Qt includes
 
 #include <QString>
@@ -31,9 +35,12 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QPixmap>
+#include <QSet>
 
 // KDE includes
 
+#include <kconfiggroup.h>
+#include <ksharedconfig.h>
 #include <klocalizedstring.h>
 
 // Local includes
@@ -54,19 +61,45 @@ namespace Digikam
 
 class ThumbsGenerator::Private
 {
+public:
+
+    enum
+    {
+        /// Number of processed items between two saves of the checkpoint
+        CheckpointInterval = 100
+    };
+
 public:
 
     Private() :
         rebuildAll(true),
+        fingerprints(false),
+        rebuildAllFingerprints(true),
         thread(0)
     {
     }
 
+    /** Only a run over all items resumes at a checkpoint. A run over the missing items
+     *  finds the items still to do by itself, including items missed before the checkpoint.
+     */
+    bool resumable() const
+    {
+        return (rebuildAll || (fingerprints && rebuildAllFingerprints));
+    }
+
+public:
+
     bool               rebuildAll;
+    bool               fingerprints;
+    bool               rebuildAllFingerprints;
 
     AlbumList          albumList;
 
     QStringList        allPicturesPath;
+    QStringList        fingerprintsPath;
+
+    /// Identifies the items and options of this run for the checkpoint
+    QString            scope;
 
     MaintenanceThread* thread;
 };
@@ -112,8 +145,19 @@ void ThumbsGenerator::setUseMultiCoreCPU(bool b)
     d->thread->setUseMultiCore(b);
 }
 
+void ThumbsGenerator::setFingerprintsGeneration(bool enable, bool rebuildAll)
+{
+    d->fingerprints           = enable;
+    d->rebuildAllFingerprints = rebuildAll;
+}
+
 void ThumbsGenerator::slotCancel()
 {
+    if (d->resumable())
+    {
+        setCheckpoint(d->scope, d->thread->lastProcessedImagePath());
+    }
+
     d->thread->cancel();
     MaintenanceTool::slotCancel();
 }
@@ -127,6 +171,12 @@ void ThumbsGenerator::slotStart()
         d->albumList = AlbumManager::instance()->allPAlbums();
     }
 
+    d->scope = QString::fromLatin1("%1 %2 %3").arg(d->rebuildAll)
+                                              .arg(d->fingerprints)
+                                              .arg(d->rebuildAllFingerprints);
+
+    QStringList albumPaths;
+
     for (AlbumList::const_iterator it = d->albumList.constBegin();
          !canceled() && (it != d->albumList.constEnd()); ++it)
     {
@@ -137,59 +187,101 @@ void ThumbsGenerator::slotStart()
 
         if ((*it)->type() == Album::PHYSICAL)
         {
-            d->allPicturesPath += CoreDbAccess().db()->getItemURLsInAlbum((*it)->id());
+            albumPaths += CoreDbAccess().db()->getItemURLsInAlbum((*it)->id());
         }
         else if ((*it)->type() == Album::TAG)
         {
-            d->allPicturesPath += CoreDbAccess().db()->getItemURLsInTag((*it)->id());
+            albumPaths += CoreDbAccess().db()->getItemURLsInTag((*it)->id());
         }
+
+        d->scope += QString::fromLatin1(" %1").arg((*it)->globalID());
     }
 
-    if (!d->rebuildAll)
+    // remove non-image or video files from the list, fingerprints are only computed for images
+    QStringList imagePaths;
+    QStringList::iterator it = albumPaths.begin();
+
+    while (it != albumPaths.end())
     {
-        QHash<QString, int> filePaths = ThumbsDbAccess().db()->getFilePathsWithThumbnail();
-        QStringList::iterator it      = d->allPicturesPath.begin();
+        ImageInfo info = ImageInfo::fromLocalFile(*it);
 
-        while (it != d->allPicturesPath.end())
+        if (info.category() != DatabaseItem::Image &&
+            info.category() != DatabaseItem::Video)
         {
-            if (filePaths.contains(*it))
-            {
-                it = d->allPicturesPath.erase(it);
-            }
-            else
+            it = albumPaths.erase(it);
+        }
+        else
+        {
+            if (info.category() == DatabaseItem::Image)
             {
-                ++it;
+                imagePaths << *it;
             }
+
+            ++it;
         }
     }
 
-    // remove non-image or video files from the list
-    QStringList::iterator it = d->allPicturesPath.begin();
+    if (!d->rebuildAll)
+    {
+        QHash<QString, int> filePaths = ThumbsDbAccess().db()->getFilePathsWithThumbnail();
 
-    while (it != d->allPicturesPath.end())
+        foreach(const QString& path, albumPaths)
+        {
+            if (!filePaths.contains(path))
+            {
+                d->allPicturesPath << path;
+            }
+        }
+    }
+    else
     {
-        ImageInfo info = ImageInfo::fromLocalFile(*it);
+        d->allPicturesPath = albumPaths;
+    }
 
-        if (info.category() != DatabaseItem::Image &&
-            info.category() != DatabaseItem::Video)
+    if (d->fingerprints)
+    {
+        if (!d->rebuildAllFingerprints)
         {
-            it = d->allPicturesPath.erase(it);
+            const QSet<QString> dirty = CoreDbAccess().db()->getDirtyOrMissingFingerprintURLs().toSet();
+
+            foreach(const QString& path, imagePaths)
+            {
+                if (dirty.contains(path))
+                {
+                    d->fingerprintsPath << path;
+                }
+            }
         }
         else
         {
-            ++it;
+            d->fingerprintsPath = imagePaths;
         }
     }
 
-    if (d->allPicturesPath.isEmpty())
+    // Items are processed in path order: resume after the checkpoint of a cancelled run.
+    std::sort(d->allPicturesPath.begin(), d->allPicturesPath.end());
+    std::sort(d->fingerprintsPath.begin(), d->fingerprintsPath.end());
+    if (d->rebuildAll)
+    {
+        skipCheckpointItems(d->scope, d->allPicturesPath);
+    }
+
+    if (d->fingerprints && d->rebuildAllFingerprints)
+    {
+        skipCheckpointItems(d->scope, d->fingerprintsPath);
+    }
+
+    const int total = (d->allPicturesPath.toSet() + d->fingerprintsPath.toSet()).count();
+
+    if (total == 0)
     {
         slotDone();
         return;
     }
 
-    setTotalItems(d->allPicturesPath.count());
+    setTotalItems(total);
 
-    d->thread->generateThumbs(d->allPicturesPath);
+    d->thread->generateThumbs(d->allPicturesPath, d->fingerprintsPath);
     d->thread->start();
 }
 
@@ -197,6 +289,28 @@ void ThumbsGenerator::slotAdvance(const QImage& img)
 {
     setThumbnail(QPixmap::fromImage(img));
     advance(1);
+
+    if (d->resumable() && (completedItems() % Private::CheckpointInterval) == 0)
+    {
+        setCheckpoint(d->scope, d->thread->lastProcessedImagePath());
+    }
+}
+
+void ThumbsGenerator::slotDone()
+{
+    // The thread also completes when it is cancelled: keep the checkpoint then.
+    if (!canceled())
+    {
+        clearCheckpoint();
+    }
+
+    if (d->fingerprints)
+    {
+        // Switch on scanned for finger-prints flag on digiKam config file.
+        KSharedConfig::openConfig()->group(QLatin1String("General Settings")).writeEntry(QLatin1String("Finger Prints Generator First Run"), true);
+    }
+
+    MaintenanceTool::slotDone();
 }
 
 }  // namespace Digikam
@@ -54,6 +54,11 @@ public:
 
     void setUseMultiCoreCPU(bool b);
 
+    /** Also compute the Haar fingerprints of the items, from the thumbnails created in the same run.
+     *  If rebuildAll is false, only the dirty or missing fingerprints are computed.
+     */
+    void setFingerprintsGeneration(bool enable, bool rebuildAll);
+
 private:
 
     void init(const bool rebuildAll);
@@ -61,6 +66,7 @@ private:
 private Q_SLOTS:
 
     void slotStart();
+    void slotDone();
     void slotCancel();
     void slotAdvance(const QImage&);
 
@@ -29,6 +29,9 @@
 // Local includes
 
 #include "digikam_debug.h"
+#include "dimg.h"
+#include "haariface.h"
+#include "previewloadthread.h"
 #include "thumbnailloadthread.h"
 #include "thumbnailsize.h"
 #include "maintenancedata.h"
@@ -38,6 +41,14 @@ namespace Digikam
 
 class ThumbsTask::Private
 {
+public:
+
+    enum
+    {
+        /// Number of fingerprints written to the database in one transaction
+        FingerprintsBatchSize = 50
+    };
+
 public:
 
     Private()
@@ -46,9 +57,31 @@ public:
     {
     }
 
+    /** Writes the pending fingerprints, then reports the items as processed.
+     */
+    void commit()
+    {
+        haar.commitIndex();
+
+        foreach(const QString& path, pendingPaths)
+        {
+            data->setImagePathProcessed(path);
+        }
+
+        pendingPaths.clear();
+    }
+
+public:
+
     ThumbnailImageCatcher* catcher;
 
     MaintenanceData*       data;
+
+    QSet<QString>          thumbnailPaths;
+    QSet<QString>          fingerprintPaths;
+
+    HaarIface              haar;
+    QStringList            pendingPaths;
 };
 
 // -------------------------------------------------------
@@ -80,15 +113,27 @@ void ThumbsTask::setMaintenanceData(MaintenanceData* const data)
     d->data = data;
 }
 
+void ThumbsTask::setThumbnailPaths(const QSet<QString>& paths)
+{
+    d->thumbnailPaths = paths;
+}
+
+void ThumbsTask::setFingerprintPaths(const QSet<QString>& paths)
+{
+    d->fingerprintPaths = paths;
+}
+
 void ThumbsTask::run()
 {
     d->catcher->setActive(true);
+    d->haar.setIndexBatched(true);
 
     // While we have data (using this as check for non-null)
     while (d->data)
     {
         if (m_cancel)
         {
+            d->commit();
             d->catcher->setActive(false);
             d->catcher->thread()->stopAllTasks();
             return;
@@ -101,14 +146,50 @@ void ThumbsTask::run()
             break;
         }
 
-        // TODO Should be improved by some update procedure
-        d->catcher->thread()->deleteThumbnail(path);
-        d->catcher->thread()->find(ThumbnailIdentifier(path));
-        d->catcher->enqueue();
-        QList<QImage> images = d->catcher->waitForThumbnails();
-        emit signalFinished(images.first());
+        QImage image;
+
+        if (d->thumbnailPaths.contains(path))
+        {
+            // The stored thumbnail is removed first, so that find() creates it again
+            // from the image file and stores the new one.
+            d->catcher->thread()->deleteThumbnail(path);
+            d->catcher->thread()->find(ThumbnailIdentifier(path));
+            d->catcher->enqueue();
+            QList<QImage> images = d->catcher->waitForThumbnails();
+            image                = images.first();
+        }
+
+        if (d->fingerprintPaths.contains(path))
+        {
+            qCDebug(DIGIKAM_GENERAL_LOG) << "Updating fingerprints for file: " << path;
+
+            // The thumbnail is too small for a reliable signature: use a preview of the Haar size.
+            DImg dimg = PreviewLoadThread::loadFastSynchronously(path, HaarIface::preferredSize());
+
+            if (!dimg.isNull())
+            {
+                // compute Haar fingerprint and store it to DB with the next batch
+                d->haar.indexImage(path, dimg);
+            }
+
+            if (image.isNull())
+            {
+                image = dimg.smoothScale(22, 22, Qt::KeepAspectRatio).copyQImage();
+            }
+        }
+
+        d->pendingPaths << path;
+
+        if (d->pendingPaths.size() >= Private::FingerprintsBatchSize)
+        {
+            d->commit();
+        }
+
+        emit signalFinished(image);
     }
 
+    d->commit();
+
     emit signalDone();
 
     d->catcher->setActive(false);
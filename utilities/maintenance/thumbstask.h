@@ -27,6 +27,8 @@
 // Qt includes
 
 #include <QImage>
+#include <QSet>
+#include <QString>
 
 // Local includes
 
@@ -49,6 +51,14 @@ public:
 
     void setMaintenanceData(MaintenanceData* const data=0);
 
+    /** The thumbnails of these items are regenerated.
+     */
+    void setThumbnailPaths(const QSet<QString>& paths);
+
+    /** The Haar fingerprints of these items are computed from a preview of HaarIface::preferredSize().
+     */
+    void setFingerprintPaths(const QSet<QString>& paths);
+
 Q_SIGNALS:
 
     void signalFinished(const QImage&);